@@ -0,0 +1,136 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include "StdString.h"
+#include "Json.h"
+#include "SystemInterface.h"
+#include "CommandParams.h"
+#include "AnimationSequence.h"
+
+const int64_t AnimationSequence::MinLoopPeriod = 10000; // microseconds
+
+AnimationSequence::AnimationSequence ()
+: loopCount (1)
+, loopForever (false)
+, loopPeriod (0)
+{
+
+}
+
+AnimationSequence::~AnimationSequence () {
+	clear ();
+}
+
+bool AnimationSequence::StepCompare::operator() (const AnimationSequence::Step &a, const AnimationSequence::Step &b) const {
+	return (a.offset < b.offset);
+}
+
+void AnimationSequence::clear () {
+	steps.clear ();
+	loopCount = 1;
+	loopForever = false;
+	loopPeriod = 0;
+	source.unassign ();
+}
+
+bool AnimationSequence::empty () const {
+	return (steps.empty ());
+}
+
+bool AnimationSequence::hasIteration (int completedIterations) const {
+	if (steps.empty ()) {
+		return (false);
+	}
+	return (loopForever || (completedIterations < loopCount));
+}
+
+bool AnimationSequence::compile (PlayAnimationParams *params, Json *cmdInv, StdString *errorMessage) {
+	clear ();
+	if (! source.takeValue (cmdInv)) {
+		// cmdInv is a view of a value owned elsewhere, such as an ExecuteBatch item, and step commands must be decoded again from the stored copy
+		params->commands.clear ();
+		if (! params->decode (&source, errorMessage)) {
+			source.unassign ();
+			return (false);
+		}
+	}
+	compileSteps (&(params->commands), params->loopCount, params->loopForever, params->loopDuration);
+	return (true);
+}
+
+bool AnimationSequence::compile (StoreAnimationParams *params, Json *cmdInv, StdString *errorMessage) {
+	clear ();
+	if (! source.takeValue (cmdInv)) {
+		params->commands.clear ();
+		if (! params->decode (&source, errorMessage)) {
+			source.unassign ();
+			return (false);
+		}
+	}
+	compileSteps (&(params->commands), params->loopCount, params->loopForever, params->loopDuration);
+	return (true);
+}
+
+void AnimationSequence::compileSteps (std::vector<AnimationCommandParams> *commands, double loopCountParam, bool loopForeverParam, double loopDurationParam) {
+	std::vector<AnimationCommandParams>::iterator i, end;
+	AnimationSequence::Step step;
+
+	steps.reserve (commands->size ());
+	i = commands->begin ();
+	end = commands->end ();
+	while (i != end) {
+		step.offset = (int64_t) (i->executeTime * 1000.0f);
+		step.commandId = SystemInterface::instance->getCommandId (&(i->command));
+		step.windowId = SystemInterface::instance->getCommandStringParam (&(i->command), "windowId", "");
+		step.imagePath = SystemInterface::instance->getCommandStringParam (&(i->command), "imagePath", "");
+		step.command = i->command.getJsonValue ();
+		steps.push_back (step);
+		++i;
+	}
+	std::stable_sort (steps.begin (), steps.end (), AnimationSequence::StepCompare ());
+
+	loopCount = (int) loopCountParam;
+	if (loopCount < 1) {
+		loopCount = 1;
+	}
+	loopForever = loopForeverParam;
+	if (loopDurationParam > 0.0f) {
+		loopPeriod = (int64_t) (loopDurationParam * 1000.0f);
+	}
+	else if (! steps.empty ()) {
+		loopPeriod = steps.back ().offset;
+	}
+	if (loopPeriod < AnimationSequence::MinLoopPeriod) {
+		loopPeriod = AnimationSequence::MinLoopPeriod;
+	}
+}
@@ -0,0 +1,93 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that holds the compiled steps of an animation command, ordered by execute time, along with the settings that control repeated playback
+
+#ifndef ANIMATION_SEQUENCE_H
+#define ANIMATION_SEQUENCE_H
+
+#include <stdint.h>
+#include <vector>
+#include "StdString.h"
+#include "Json.h"
+#include "CommandParams.h"
+
+class AnimationSequence {
+public:
+	AnimationSequence ();
+	~AnimationSequence ();
+
+	// The minimum time period in microseconds between the starts of repeated sequence iterations
+	static const int64_t MinLoopPeriod;
+
+	struct Step {
+		int64_t offset;
+		int commandId;
+		StdString windowId;
+		StdString imagePath;
+		json_value *command;
+		Step ():
+			offset (0),
+			commandId (-1),
+			windowId (""),
+			imagePath (""),
+			command (NULL) { }
+	};
+
+	// Read-only data members
+	std::vector<AnimationSequence::Step> steps;
+	int loopCount;
+	bool loopForever;
+	int64_t loopPeriod;
+
+	// Remove all steps and release the command value they execute from
+	void clear ();
+
+	// Return a boolean value indicating if the sequence holds no steps
+	bool empty () const;
+
+	// Return a boolean value indicating if playback should begin another iteration after completing the specified number of iterations
+	bool hasIteration (int completedIterations) const;
+
+	// Replace the sequence with the steps of a PlayAnimation or StoreAnimation command, taking ownership of the command's value from cmdInv so that steps execute from it without being copied or parsed again. Returns a boolean value indicating if the compile succeeded; if not, errorMessage is set.
+	bool compile (PlayAnimationParams *params, Json *cmdInv, StdString *errorMessage);
+	bool compile (StoreAnimationParams *params, Json *cmdInv, StdString *errorMessage);
+
+private:
+	struct StepCompare {
+		bool operator() (const AnimationSequence::Step &a, const AnimationSequence::Step &b) const;
+	};
+
+	// Populate steps and loop settings from decoded params holding views of values in source
+	void compileSteps (std::vector<AnimationCommandParams> *commands, double loopCountParam, bool loopForeverParam, double loopDurationParam);
+
+	Json source;
+};
+
+#endif
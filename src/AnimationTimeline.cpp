@@ -0,0 +1,94 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include "AnimationTimeline.h"
+
+AnimationTimeline::AnimationTimeline ()
+: nextSequence (0)
+{
+
+}
+
+AnimationTimeline::~AnimationTimeline () {
+	clear ();
+}
+
+bool AnimationTimeline::StepCompare::operator() (const AnimationTimeline::Step &a, const AnimationTimeline::Step &b) const {
+	if (a.dueTime != b.dueTime) {
+		return (a.dueTime > b.dueTime);
+	}
+	return (a.sequence > b.sequence);
+}
+
+void AnimationTimeline::clear () {
+	stepHeap.clear ();
+	nextSequence = 0;
+}
+
+bool AnimationTimeline::empty () const {
+	return (stepHeap.empty ());
+}
+
+int AnimationTimeline::size () const {
+	return ((int) stepHeap.size ());
+}
+
+void AnimationTimeline::addStep (int64_t dueTime, int stepIndex) {
+	AnimationTimeline::Step step;
+
+	step.dueTime = dueTime;
+	step.sequence = nextSequence;
+	++nextSequence;
+	step.stepIndex = stepIndex;
+	stepHeap.push_back (step);
+	std::push_heap (stepHeap.begin (), stepHeap.end (), AnimationTimeline::StepCompare ());
+}
+
+int64_t AnimationTimeline::getNextDueTime () const {
+	if (stepHeap.empty ()) {
+		return (-1);
+	}
+	return (stepHeap.front ().dueTime);
+}
+
+bool AnimationTimeline::nextDueStep (int64_t now, int *destStepIndex) {
+	if (stepHeap.empty () || (stepHeap.front ().dueTime > now)) {
+		return (false);
+	}
+	if (destStepIndex) {
+		*destStepIndex = stepHeap.front ().stepIndex;
+	}
+	std::pop_heap (stepHeap.begin (), stepHeap.end (), AnimationTimeline::StepCompare ());
+	stepHeap.pop_back ();
+	return (true);
+}
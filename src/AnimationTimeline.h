@@ -0,0 +1,79 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that holds animation steps in a binary heap ordered by absolute due time
+
+#ifndef ANIMATION_TIMELINE_H
+#define ANIMATION_TIMELINE_H
+
+#include <stdint.h>
+#include <vector>
+
+class AnimationTimeline {
+public:
+	AnimationTimeline ();
+	~AnimationTimeline ();
+
+	// Remove all steps
+	void clear ();
+
+	// Return a boolean value indicating if the timeline holds no steps
+	bool empty () const;
+
+	// Return the number of steps held in the timeline
+	int size () const;
+
+	// Add a step that becomes due at dueTime, expressed in microseconds on the same monotonic clock used for nextDueStep calls. stepIndex is an opaque value returned by nextDueStep when the step becomes due, typically an index into a caller-owned step list.
+	void addStep (int64_t dueTime, int stepIndex);
+
+	// Return the due time of the earliest step, or -1 if the timeline is empty
+	int64_t getNextDueTime () const;
+
+	// Remove the earliest step with a due time at or before now and store its step index in destStepIndex. Steps with equal due times are returned in the order they were added. Returns a boolean value indicating if a step was found.
+	bool nextDueStep (int64_t now, int *destStepIndex);
+
+private:
+	struct Step {
+		int64_t dueTime;
+		int64_t sequence;
+		int stepIndex;
+		Step ():
+			dueTime (0),
+			sequence (0),
+			stepIndex (0) { }
+	};
+	struct StepCompare {
+		bool operator() (const AnimationTimeline::Step &a, const AnimationTimeline::Step &b) const;
+	};
+
+	std::vector<AnimationTimeline::Step> stepHeap;
+	int64_t nextSequence;
+};
+
+#endif
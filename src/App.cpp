@@ -42,13 +42,18 @@
 #include <io.h>
 #endif
 #include <vector>
-#include <stack>
+#include <list>
+#include <atomic>
 #include <iostream>
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_image.h"
 #include "StdString.h"
 #include "Log.h"
 #include "TaskGroup.h"
+#include "FramePacer.h"
+#include "TripleBuffer.h"
+#include "DrawList.h"
+#include "ImagePrefetch.h"
 #include "LuaScript.h"
 #include "OsUtil.h"
 #include "MathUtil.h"
@@ -58,6 +63,7 @@
 #include "Input.h"
 #include "Network.h"
 #include "Panel.h"
+#include "Scene.h"
 #include "MainUi.h"
 #include "App.h"
 
@@ -68,6 +74,7 @@ const int App::WindowSizeCount = 5;
 const float App::FontScales[] = { 0.66f, 0.8f, 1.0f, 1.25f, 1.5f };
 const int App::FontScaleCount = 5;
 const int App::MaxCornerRadius = 16;
+const int64_t App::MaxUpdateDelay = 86400000;
 
 const char *App::NetworkThreadsKey = "NetworkThreads";
 const char *App::WindowWidthKey = "WindowWidth";
@@ -83,12 +90,14 @@ void App::createInstance (bool shouldSkipInit) {
 		delete (App::instance);
 	}
 	App::instance = new App ();
+	Log::instance = &(App::instance->log);
 	Input::instance = &(App::instance->input);
 	Network::instance = &(App::instance->network);
 	UiConfiguration::instance = &(App::instance->uiConfig);
 	UiText::instance = &(App::instance->uiText);
 	SystemInterface::instance = &(App::instance->systemInterface);
 	TaskGroup::instance = &(App::instance->taskGroup);
+	ImagePrefetch::instance = &(App::instance->imagePrefetch);
 
 	if (! shouldSkipInit) {
 		App::instance->init ();
@@ -99,12 +108,14 @@ void App::freeInstance () {
 	if (App::instance) {
 		delete (App::instance);
 		App::instance = NULL;
+		Log::instance = NULL;
 		Input::instance = NULL;
 		Network::instance = NULL;
 		UiConfiguration::instance = NULL;
 		UiText::instance = NULL;
 		SystemInterface::instance = NULL;
 		TaskGroup::instance = NULL;
+		ImagePrefetch::instance = NULL;
 		IMG_Quit ();
 		SDL_Quit ();
 	}
@@ -115,6 +126,10 @@ App::App ()
 , nextWindowWidth (0)
 , nextWindowHeight (0)
 , isConsole (false)
+, isHeadless (false)
+, isDamageRedrawEnabled (true)
+, isDamageOverlayEnabled (false)
+, isVsyncEnabled (false)
 , shouldRefreshUi (false)
 , isInterfaceAnimationEnabled (false)
 , isShuttingDown (false)
@@ -132,10 +147,14 @@ App::App ()
 , windowHeight (0)
 , minDrawFrameDelay (0)
 , minUpdateFrameDelay (0)
+, drawKeepAlivePeriod (0)
 , fontScale (1.0f)
 , imageScale (0)
 , drawCount (0)
+, skippedDrawCount (0)
 , updateCount (0)
+, drawListRecordSerial (0)
+, drawListDrawSerial (0)
 , isPrefsWriteDisabled (false)
 , updateThread (NULL)
 , uniqueIdMutex (NULL)
@@ -146,12 +165,23 @@ App::App ()
 , isSuspendingUpdate (false)
 , updateMutex (NULL)
 , updateCond (NULL)
+, drawMutex (NULL)
+, isDrawWaiting (false)
+, isUpdateScheduled (false)
+, nextUpdateDeadline (0)
+, isFrameStatsEnabled (false)
+, lastPresentCounter (0)
+, lastDrawTime (0)
+, sceneTexture (NULL)
 {
 	uniqueIdMutex = SDL_CreateMutex ();
 	prefsMapMutex = SDL_CreateMutex ();
 	renderTaskMutex = SDL_CreateMutex ();
 	updateMutex = SDL_CreateMutex ();
 	updateCond = SDL_CreateCond ();
+	drawMutex = SDL_CreateMutex ();
+	taskGroup.wakeEvent = &updateWakeEvent;
+	network.wakeEvent = &updateWakeEvent;
 }
 
 App::~App () {
@@ -183,6 +213,10 @@ App::~App () {
 		SDL_DestroyCond (updateCond);
 		updateCond = NULL;
 	}
+	if (drawMutex) {
+		SDL_DestroyMutex (drawMutex);
+		drawMutex = NULL;
+	}
 }
 
 void App::init () {
@@ -250,8 +284,13 @@ void App::init () {
 	}
 
 	isConsole = OsUtil::getEnvValue ("CONSOLE", false);
+	isHeadless = OsUtil::getEnvValue ("HEADLESS", false);
+	isDamageRedrawEnabled = OsUtil::getEnvValue ("DAMAGE_REDRAW", true);
+	isDamageOverlayEnabled = OsUtil::getEnvValue ("SHOW_DAMAGE_RECTS", false);
+	isVsyncEnabled = OsUtil::getEnvValue ("DRAW_VSYNC", false);
 	minDrawFrameDelay = OsUtil::getEnvValue ("MIN_DRAW_FRAME_DELAY", 0);
 	minUpdateFrameDelay = OsUtil::getEnvValue ("MIN_UPDATE_FRAME_DELAY", 0);
+	drawKeepAlivePeriod = OsUtil::getEnvValue ("DRAW_KEEPALIVE_PERIOD", 0);
 	windowWidth = OsUtil::getEnvValue ("WINDOW_WIDTH", 0);
 	windowHeight = OsUtil::getEnvValue ("WINDOW_HEIGHT", 0);
 }
@@ -327,13 +366,18 @@ int App::runWindow () {
 	SDL_version version1, version2;
 	SDL_RendererInfo renderinfo;
 	StdString text;
-	int result, delay, i;
-	int64_t endtime, elapsed, t1, t2;
+	int result, i;
+	int64_t endtime, elapsed, t1;
 	Uint32 windowflags;
 	double fps;
 	Ui *ui;
 	SDL_Rect rect;
+	bool ispresented, isdrawlisttaken;
 
+	if (isHeadless) {
+		// The dummy video driver provides a software renderer with no display, as needed for running replay load tests on machines without one
+		SDL_setenv ("SDL_VIDEODRIVER", "dummy", 1);
+	}
 	if (SDL_Init (SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
 		Log::err ("Failed to start SDL: %s", SDL_GetError ());
 		return (OsUtil::SdlOperationFailedError);
@@ -378,6 +422,9 @@ int App::runWindow () {
 	}
 
 	windowflags = SDL_WINDOW_FULLSCREEN | SDL_WINDOW_BORDERLESS;
+	if (isVsyncEnabled) {
+		SDL_SetHint (SDL_HINT_RENDER_VSYNC, "1");
+	}
 	result = SDL_CreateWindowAndRenderer (windowWidth, windowHeight, windowflags, &window, &render);
 	if (result != 0) {
 		Log::err ("Failed to create application window: %s", SDL_GetError ());
@@ -394,11 +441,12 @@ int App::runWindow () {
 	if (isTextureRenderEnabled) {
 		isInterfaceAnimationEnabled = prefsMap.find (App::ShowInterfaceAnimationsKey, true);
 	}
+	if (! (renderinfo.flags & SDL_RENDERER_TARGETTEXTURE)) {
+		isDamageRedrawEnabled = false;
+	}
+	drawPacer.setPeriod (minDrawFrameDelay);
+	drawPacer.setPresentAligned (isVsyncEnabled && (renderinfo.flags & SDL_RENDERER_PRESENTVSYNC));
 
-	clipRect.x = 0;
-	clipRect.y = 0;
-	clipRect.w = windowWidth;
-	clipRect.h = windowHeight;
 	nextWindowWidth = windowWidth;
 	nextWindowHeight = windowHeight;
 
@@ -427,7 +475,7 @@ int App::runWindow () {
 	windowflags = SDL_GetWindowFlags (window);
 	SDL_VERSION (&version1);
 	SDL_GetVersion (&version2);
-	Log::debug ("* sdlBuildVersion=%i.%i.%i sdlLinkVersion=%i.%i.%i windowFlags=0x%x renderName=%s renderFlags=0x%x isTextureRenderEnabled=%s diagonalDpi=%.2f horizontalDpi=%.2f verticalDpi=%.2f imageScale=%i minDrawFrameDelay=%i minUpdateFrameDelay=%i", version1.major, version1.minor, version1.patch, version2.major, version2.minor, version2.patch, (unsigned int) windowflags, renderinfo.name, (unsigned int) renderinfo.flags, BOOL_STRING (isTextureRenderEnabled), displayDdpi, displayHdpi, displayVdpi, imageScale, minDrawFrameDelay, minUpdateFrameDelay);
+	Log::debug ("* sdlBuildVersion=%i.%i.%i sdlLinkVersion=%i.%i.%i windowFlags=0x%x renderName=%s renderFlags=0x%x isTextureRenderEnabled=%s diagonalDpi=%.2f horizontalDpi=%.2f verticalDpi=%.2f imageScale=%i minDrawFrameDelay=%i minUpdateFrameDelay=%i drawKeepAlivePeriod=%i isDamageRedrawEnabled=%s", version1.major, version1.minor, version1.patch, version2.major, version2.minor, version2.patch, (unsigned int) windowflags, renderinfo.name, (unsigned int) renderinfo.flags, BOOL_STRING (isTextureRenderEnabled), displayDdpi, displayHdpi, displayVdpi, imageScale, minDrawFrameDelay, minUpdateFrameDelay, drawKeepAlivePeriod, BOOL_STRING (isDamageRedrawEnabled));
 
 	text.assign ("");
 	if (windowflags & SDL_WINDOW_FULLSCREEN) {
@@ -514,12 +562,13 @@ int App::runWindow () {
 	Log::debug3 ("* Render flags:%s", text.c_str ());
 	text.assign ("");
 
+	drawPacer.start ();
 	while (true) {
 		if (isShutdown) {
 			break;
 		}
 
-		t1 = OsUtil::getTime ();
+		t1 = OsUtil::getMonotonicTime ();
 		input.pollEvents ();
 		if (! FLOAT_EQUALS (fontScale, nextFontScale)) {
 			if (uiConfig.reloadFonts (nextFontScale) != OsUtil::Success) {
@@ -539,20 +588,35 @@ int App::runWindow () {
 			}
 		}
 
+		// Take the draw list before executing render tasks, so that tasks queued ahead of its publication run before resource.compact destroys textures it retired
+		isdrawlisttaken = drawLists.take ();
+		if (isdrawlisttaken) {
+			drawListDrawSerial.store (drawLists.getReadItem ()->serial);
+		}
 		executeRenderTasks ();
-		draw ();
+		ispresented = false;
+		if (isdrawlisttaken || ((drawKeepAlivePeriod > 0) && ((t1 - lastDrawTime) >= (((int64_t) drawKeepAlivePeriod) * 1000000)))) {
+			draw (isdrawlisttaken);
+			lastDrawTime = t1;
+			ispresented = true;
+		}
+		else {
+			++skippedDrawCount;
+		}
 		if ((windowWidth != nextWindowWidth) || (windowHeight != nextWindowHeight)) {
 			resizeWindow ();
+			Scene::setChanged ();
+			updateWakeEvent.signal ();
 		}
 		uiStack.executeStackCommands ();
 		resource.compact ();
 
-		t2 = OsUtil::getTime ();
-		delay = (int) (minDrawFrameDelay - (t2 - t1));
-		if (delay < 1) {
-			delay = 1;
+		if (ispresented || input.isKeyRepeatPending ()) {
+			drawPacer.waitFrame (ispresented);
+		}
+		else {
+			waitDrawWork ();
 		}
-		SDL_Delay (delay);
 	}
 	SDL_WaitThread (updateThread, &result);
 
@@ -565,6 +629,11 @@ int App::runWindow () {
 	if (roundedCornerSprite) {
 		roundedCornerSprite->unload ();
 	}
+	if (sceneTexture) {
+		resource.unloadTexture (sceneTexturePath);
+		sceneTexture = NULL;
+	}
+	drawListDrawSerial.store (drawListRecordSerial.load () + 1);
 	resource.compact ();
 	resource.close ();
 
@@ -579,7 +648,7 @@ int App::runWindow () {
 	if (elapsed > 1000) {
 		fps /= ((double) elapsed) / 1000.0f;
 	}
-	Log::info ("Application ended; updateCount=%lli drawCount=%lli runtime=%.3fs FPS=%f pid=%i", (long long) updateCount, (long long) drawCount, ((double) elapsed) / 1000.0f, fps, OsUtil::getProcessId ());
+	Log::info ("Application ended; updateCount=%lli drawCount=%lli skippedDrawCount=%lli missedDrawDeadlineCount=%lli runtime=%.3fs FPS=%f pid=%i", (long long) updateCount, (long long) drawCount, (long long) skippedDrawCount, (long long) drawPacer.missedDeadlineCount, ((double) elapsed) / 1000.0f, fps, OsUtil::getProcessId ());
 
 	return (OsUtil::Success);
 }
@@ -648,19 +717,20 @@ void App::populateWidgets () {
 }
 
 void App::populateRoundedCornerSprite () {
-	Uint32 *pixels, *dest, color, rmask, gmask, bmask, amask;
+	Uint32 *pixelsets[App::MaxCornerRadius], *pixels, rmask, gmask, bmask, amask;
 	SDL_Surface *surface;
 	SDL_Texture *texture;
 	StdString path;
-	float dist, targetalpha, minalpha, opacity;
-	int radius, x, y, w, h;
-	uint8_t alpha;
+	int radius, w, h;
 
 	if (roundedCornerSprite) {
 		delete (roundedCornerSprite);
 	}
 	roundedCornerSprite = new Sprite ();
 
+	// Corner bitmaps are computed on task threads, while textures must be created on this thread
+	taskGroup.parallelFor (App::MaxCornerRadius, 1, App::createRoundedCornerPixels, pixelsets);
+
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
 	rmask = 0xFF000000;
 	gmask = 0x00FF0000;
@@ -672,18 +742,60 @@ void App::populateRoundedCornerSprite () {
 	bmask = 0x00FF0000;
 	amask = 0xFF000000;
 #endif
-	minalpha = 0.1f;
-	opacity = 8.0f;
 	radius = 1;
 	while (radius <= App::MaxCornerRadius) {
+		w = (radius * 2) + 1;
+		h = (radius * 2) + 1;
+		pixels = pixelsets[radius - 1];
+		if (! pixels) {
+			Log::warning ("Failed to create texture; err=\"Out of memory, dimensions %ix%i\"", w, h);
+			break;
+		}
+
+		surface = SDL_CreateRGBSurfaceFrom (pixels, w, h, 32, w * sizeof (Uint32), rmask, gmask, bmask, amask);
+		if (! surface) {
+			Log::warning ("Failed to create texture; err=\"SDL_CreateRGBSurfaceFrom, %s\"", SDL_GetError ());
+			break;
+		}
+
+		path.sprintf ("*_App::roundedCornerSprite_%llx", (long long int) App::instance->getUniqueId ());
+		texture = App::instance->resource.createTexture (path, surface);
+		SDL_FreeSurface (surface);
+		if (! texture) {
+			break;
+		}
+
+		roundedCornerSprite->addTexture (texture, path);
+		++radius;
+	}
+	if (radius <= App::MaxCornerRadius) {
+		delete (roundedCornerSprite);
+		roundedCornerSprite = NULL;
+	}
+	for (radius = 0; radius < App::MaxCornerRadius; ++radius) {
+		if (pixelsets[radius]) {
+			free (pixelsets[radius]);
+		}
+	}
+}
+
+void App::createRoundedCornerPixels (void *pixelSetsPtr, int rangeStart, int rangeEnd) {
+	Uint32 **pixelsets, *pixels, *dest, color;
+	float dist, targetalpha, minalpha, opacity;
+	int i, radius, x, y, w, h;
+	uint8_t alpha;
+
+	pixelsets = (Uint32 **) pixelSetsPtr;
+	minalpha = 0.1f;
+	opacity = 8.0f;
+	for (i = rangeStart; i < rangeEnd; ++i) {
+		radius = i + 1;
 		w = (radius * 2) + 1;
 		h = (radius * 2) + 1;
 		pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
+		pixelsets[i] = pixels;
 		if (! pixels) {
-			Log::warning ("Failed to create texture; err=\"Out of memory, dimensions %ix%i\"", radius, radius);
-			delete (roundedCornerSprite);
-			roundedCornerSprite = NULL;
-			return;
+			continue;
 		}
 
 		dest = pixels;
@@ -715,28 +827,6 @@ void App::populateRoundedCornerSprite () {
 
 			++y;
 		}
-
-		surface = SDL_CreateRGBSurfaceFrom (pixels, w, h, 32, w * sizeof (Uint32), rmask, gmask, bmask, amask);
-		if (! surface) {
-			free (pixels);
-			Log::warning ("Failed to create texture; err=\"SDL_CreateRGBSurfaceFrom, %s\"", SDL_GetError ());
-			delete (roundedCornerSprite);
-			roundedCornerSprite = NULL;
-			return;
-		}
-
-		path.sprintf ("*_App::roundedCornerSprite_%llx", (long long int) App::instance->getUniqueId ());
-		texture = App::instance->resource.createTexture (path, surface);
-		SDL_FreeSurface (surface);
-		free (pixels);
-		if (! texture) {
-			delete (roundedCornerSprite);
-			roundedCornerSprite = NULL;
-			return;
-		}
-
-		roundedCornerSprite->addTexture (texture, path);
-		++radius;
 	}
 }
 
@@ -761,6 +851,7 @@ void App::shutdown () {
 	taskGroup.stop ();
 	network.stop ();
 	input.stop ();
+	updateWakeEvent.signal ();
 }
 
 HashMap *App::lockPrefs () {
@@ -780,6 +871,9 @@ void App::executeRenderTasks () {
 	renderTaskList.swap (renderTaskAddList);
 	SDL_UnlockMutex (renderTaskMutex);
 
+	if (renderTaskList.empty ()) {
+		return;
+	}
 	i = renderTaskList.begin ();
 	end = renderTaskList.end ();
 	while (i != end) {
@@ -787,28 +881,246 @@ void App::executeRenderTasks () {
 		++i;
 	}
 	renderTaskList.clear ();
+	Scene::requestPresent ();
+	updateWakeEvent.signal ();
+}
+
+void App::waitDrawWork () {
+	int64_t timeout;
+	bool ispending;
+
+	// isDrawWaiting must be set before checking for pending work, so that a wakeDraw call made after the check is not lost
+	isDrawWaiting.store (true);
+	ispending = drawLists.isPending () || isShutdown;
+	if (! ispending) {
+		SDL_LockMutex (renderTaskMutex);
+		ispending = (! renderTaskAddList.empty ());
+		SDL_UnlockMutex (renderTaskMutex);
+	}
+	if (ispending) {
+		isDrawWaiting.store (false);
+		drawPacer.waitFrame ();
+		return;
+	}
+
+	if (drawKeepAlivePeriod > 0) {
+		timeout = ((lastDrawTime + (((int64_t) drawKeepAlivePeriod) * 1000000)) - OsUtil::getMonotonicTime ()) / 1000000;
+		if (timeout < 0) {
+			timeout = 0;
+		}
+		SDL_WaitEventTimeout (NULL, (int) timeout);
+	}
+	else {
+		SDL_WaitEvent (NULL);
+	}
+	isDrawWaiting.store (false);
+	drawPacer.start ();
 }
 
-void App::draw () {
+void App::wakeDraw () {
+	SDL_Event event;
+
+	if (! isDrawWaiting.exchange (false)) {
+		return;
+	}
+	memset (&event, 0, sizeof (event));
+	event.type = SDL_USEREVENT;
+	SDL_PushEvent (&event);
+}
+
+void App::scheduleUpdate (int64_t delayMs) {
+	int64_t deadline;
+
+	if (delayMs <= 0) {
+		isUpdateScheduled = true;
+		return;
+	}
+	if (delayMs > App::MaxUpdateDelay) {
+		delayMs = App::MaxUpdateDelay;
+	}
+	deadline = OsUtil::getMonotonicTime () + (delayMs * 1000000);
+	if ((nextUpdateDeadline <= 0) || (deadline < nextUpdateDeadline)) {
+		nextUpdateDeadline = deadline;
+	}
+}
+
+void App::draw (bool isNewDrawList) {
+	DrawList *drawlist;
+	std::vector<App::PresentWait>::iterator i, end;
+	std::vector<SDL_Rect>::iterator j, jend;
+	SDL_Rect windowrect, rect;
+	uint64_t now, freq;
+	int64_t area;
+	bool isfulldamage;
+
+	drawlist = drawLists.getReadItem ();
+	isfulldamage = isNewDrawList && drawlist->isFullDamage;
+	if (isDamageRedrawEnabled && (! sceneTexture)) {
+		if (! resetSceneTexture ()) {
+			isDamageRedrawEnabled = false;
+		}
+		isfulldamage = true;
+	}
+	if (! sceneTexture) {
+		SDL_RenderClear (render);
+		drawlist->execute (render);
+	}
+	else {
+		windowrect.x = 0;
+		windowrect.y = 0;
+		windowrect.w = windowWidth;
+		windowrect.h = windowHeight;
+		if (isNewDrawList && (! isfulldamage)) {
+			// Redraw the full scene if damage regions cover most of the window, avoiding a repeated pass over the draw list for each region
+			area = 0;
+			j = drawlist->damageRectList.begin ();
+			jend = drawlist->damageRectList.end ();
+			while (j != jend) {
+				if (SDL_IntersectRect (&(*j), &windowrect, &rect)) {
+					area += (int64_t) rect.w * rect.h;
+				}
+				++j;
+			}
+			if ((area * 2) >= ((int64_t) windowWidth * windowHeight)) {
+				isfulldamage = true;
+			}
+		}
+
+		SDL_SetRenderTarget (render, sceneTexture);
+		if (isfulldamage) {
+			SDL_RenderClear (render);
+			drawlist->execute (render);
+		}
+		else if (isNewDrawList) {
+			j = drawlist->damageRectList.begin ();
+			jend = drawlist->damageRectList.end ();
+			while (j != jend) {
+				if (SDL_IntersectRect (&(*j), &windowrect, &rect)) {
+					SDL_RenderSetClipRect (render, &rect);
+					SDL_RenderFillRect (render, &rect);
+					drawlist->execute (render, &rect);
+				}
+				++j;
+			}
+			SDL_RenderSetClipRect (render, NULL);
+		}
+		SDL_SetRenderTarget (render, NULL);
+		SDL_RenderCopy (render, sceneTexture, NULL, NULL);
+		if (isDamageOverlayEnabled && isNewDrawList) {
+			drawDamageOverlay (drawlist);
+		}
+	}
+
+	SDL_RenderPresent (render);
+	++drawCount;
+	SDL_LockMutex (drawMutex);
+	if (isFrameStatsEnabled) {
+		now = SDL_GetPerformanceCounter ();
+		freq = SDL_GetPerformanceFrequency ();
+		if (lastPresentCounter > 0) {
+			frameTimeList.push_back (OsUtil::getCounterMicroseconds (now - lastPresentCounter, freq));
+		}
+		lastPresentCounter = now;
+		if (isNewDrawList) {
+			// Collect waits added during the update cycle that recorded this list or any earlier list, including lists replaced before the main thread took them
+			i = presentWaitList.begin ();
+			end = presentWaitList.end ();
+			while ((i != end) && (i->serial <= drawlist->serial)) {
+				presentLatencyList.push_back (OsUtil::getCounterMicroseconds (now - i->startCounter, freq));
+				++i;
+			}
+			presentWaitList.erase (presentWaitList.begin (), i);
+		}
+	}
+	SDL_UnlockMutex (drawMutex);
+}
+
+void App::recordDrawList () {
+	DrawList *drawlist;
 	Ui *ui;
+	App::SceneDamage damage;
+	std::list<App::SceneDamage>::iterator i, end;
+	int64_t drawserial;
+
+	if (! Scene::takeChanged (&(damage.rects), &(damage.isFull))) {
+		return;
+	}
 
-	SDL_RenderClear (render);
+	// A published list may be replaced before the main thread takes it, so each list carries the damage of every list recorded since the one most recently taken
+	drawserial = drawListDrawSerial.load ();
+	while ((! sceneDamageList.empty ()) && (sceneDamageList.front ().serial <= drawserial)) {
+		sceneDamageList.pop_front ();
+	}
+	// The serial is advanced before recording, so that a texture unloaded while the list is recorded is retired no earlier than this list
+	damage.serial = ++drawListRecordSerial;
+	sceneDamageList.push_back (damage);
 
+	drawlist = drawLists.getWriteItem ();
+	drawlist->serial = damage.serial;
+	drawlist->clearDamage ();
+	i = sceneDamageList.begin ();
+	end = sceneDamageList.end ();
+	while (i != end) {
+		drawlist->addDamage (i->rects, i->isFull);
+		++i;
+	}
+	drawlist->isTextureTarget = false;
+	drawlist->reset (windowWidth, windowHeight);
 	ui = uiStack.getActiveUi ();
 	if (ui) {
-		ui->draw ();
-		rootPanel->draw ();
+		ui->draw (drawlist);
+		rootPanel->draw (drawlist);
 		ui->release ();
 	}
-	SDL_RenderPresent (render);
-	++drawCount;
+	drawLists.publish ();
+}
+
+void App::drawDamageOverlay (DrawList *drawList) {
+	std::vector<SDL_Rect>::iterator i, end;
+	SDL_Rect rect;
+
+	SDL_SetRenderDrawColor (render, 255, 0, 0, 255);
+	if (drawList->isFullDamage) {
+		rect.x = 0;
+		rect.y = 0;
+		rect.w = windowWidth;
+		rect.h = windowHeight;
+		SDL_RenderDrawRect (render, &rect);
+	}
+	else {
+		i = drawList->damageRectList.begin ();
+		end = drawList->damageRectList.end ();
+		while (i != end) {
+			SDL_RenderDrawRect (render, &(*i));
+			++i;
+		}
+	}
+	SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
+}
+
+bool App::resetSceneTexture () {
+	if (sceneTexture) {
+		resource.unloadTexture (sceneTexturePath);
+		sceneTexture = NULL;
+	}
+	sceneTexturePath.sprintf ("*_App_sceneTexture_%llx", (long long int) getUniqueId ());
+	sceneTexture = resource.createTexture (sceneTexturePath, windowWidth, windowHeight);
+	if (! sceneTexture) {
+		Log::warning ("Failed to create scene texture, damage redraw disabled; windowWidth=%i windowHeight=%i", windowWidth, windowHeight);
+		sceneTexturePath.assign ("");
+		return (false);
+	}
+	SDL_SetTextureBlendMode (sceneTexture, SDL_BLENDMODE_NONE);
+	Scene::setChanged ();
+	return (true);
 }
 
 int App::runUpdateThread (void *appPtr) {
 	App *app;
 	StdString line;
-	int64_t t1, t2, last;
-	int delay;
+	FramePacer pacer;
+	float elapsed;
+	int64_t changecount;
 
 	app = (App *) appPtr;
 
@@ -818,31 +1130,36 @@ int App::runUpdateThread (void *appPtr) {
 		line.assign ("");
 	}
 
-	last = OsUtil::getTime ();
+	pacer.setPeriod (app->minUpdateFrameDelay);
+	pacer.start ();
+	elapsed = 0.0f;
 	while (true) {
 		if (app->isShutdown) {
 			break;
 		}
 
-		t1 = OsUtil::getTime ();
-		app->update ((int) (t1 - last));
-		t2 = OsUtil::getTime ();
-		last = t1;
+		app->isUpdateScheduled = false;
+		app->nextUpdateDeadline = 0;
+		changecount = Scene::getChangeCount ();
+		app->update (elapsed);
+		app->wakeDraw ();
 
-		delay = (int) (app->minUpdateFrameDelay - (t2 - t1));
-		if (delay < 1) {
-			delay = 1;
+		// Keep running at the update frame rate while the scene is changing or a widget has requested it, and otherwise block until signaled or the nearest scheduled deadline
+		if (app->isUpdateScheduled || app->isShuttingDown || (Scene::getChangeCount () != changecount)) {
+			elapsed = pacer.waitFrame (false, &(app->updateWakeEvent));
+		}
+		else {
+			elapsed = pacer.waitIdle (&(app->updateWakeEvent), app->nextUpdateDeadline);
 		}
-		SDL_Delay (delay);
 	}
 
 	return (0);
 }
 
-void App::update (int msElapsed) {
+void App::update (float msElapsed) {
 	Ui *ui;
 
-	taskGroup.update (msElapsed);
+	taskGroup.update ((int) msElapsed);
 	uiStack.update (msElapsed);
 	if (shouldRefreshUi) {
 		uiStack.refresh ();
@@ -857,6 +1174,7 @@ void App::update (int msElapsed) {
 		ui->release ();
 	}
 	rootPanel->update (msElapsed, 0.0f, 0.0f);
+	recordDrawList ();
 
 	writePrefs ();
 	++updateCount;
@@ -907,6 +1225,7 @@ int64_t App::getUniqueId () {
 void App::suspendUpdate () {
 	SDL_LockMutex (updateMutex);
 	isSuspendingUpdate = true;
+	updateWakeEvent.signal ();
 	SDL_CondWait (updateCond, updateMutex);
 	SDL_UnlockMutex (updateMutex);
 }
@@ -918,74 +1237,51 @@ void App::unsuspendUpdate () {
 	SDL_UnlockMutex (updateMutex);
 }
 
-void App::pushClipRect (const SDL_Rect *rect, bool disableIntersection) {
-	int x, y, w, h, diff;
-
-	x = rect->x;
-	y = rect->y;
-	w = rect->w;
-	h = rect->h;
-	if ((! clipRectStack.empty ()) && (! disableIntersection)) {
-		diff = x - clipRect.x;
-		if (diff < 0) {
-			w += diff;
-			x = clipRect.x;
-		}
-		diff = y - clipRect.y;
-		if (diff < 0) {
-			h += diff;
-			y = clipRect.y;
-		}
-		diff = (x + w) - (clipRect.x + clipRect.w);
-		if (diff > 0) {
-			w -= diff;
-		}
-		diff = (y + h) - (clipRect.y + clipRect.h);
-		if (diff > 0) {
-			h -= diff;
-		}
+void App::startFrameStats () {
+	SDL_LockMutex (drawMutex);
+	frameTimeList.clear ();
+	presentLatencyList.clear ();
+	presentWaitList.clear ();
+	lastPresentCounter = 0;
+	isFrameStatsEnabled = true;
+	SDL_UnlockMutex (drawMutex);
+}
 
-		if (w < 0) {
-			w = 0;
-		}
-		if (h < 0) {
-			h = 0;
-		}
+void App::stopFrameStats (std::vector<int64_t> *frameTimes, std::vector<int64_t> *presentLatencies) {
+	SDL_LockMutex (drawMutex);
+	isFrameStatsEnabled = false;
+	if (frameTimes) {
+		frameTimes->swap (frameTimeList);
 	}
-
-	clipRect.x = x;
-	clipRect.y = y;
-	clipRect.w = w;
-	clipRect.h = h;
-	SDL_RenderSetClipRect (render, &clipRect);
-	clipRectStack.push (clipRect);
+	if (presentLatencies) {
+		presentLatencies->swap (presentLatencyList);
+	}
+	frameTimeList.clear ();
+	presentLatencyList.clear ();
+	presentWaitList.clear ();
+	SDL_UnlockMutex (drawMutex);
 }
 
-void App::popClipRect () {
-	if (clipRectStack.empty ()) {
-		return;
-	}
+void App::addPresentWait (uint64_t startCounter) {
+	App::PresentWait wait;
 
-	clipRectStack.pop ();
-	if (clipRectStack.empty ()) {
-		clipRect.x = 0;
-		clipRect.y = 0;
-		clipRect.w = windowWidth;
-		clipRect.h = windowHeight;
-		SDL_RenderSetClipRect (render, NULL);
-	}
-	else {
-		clipRect = clipRectStack.top ();
-		SDL_RenderSetClipRect (render, &clipRect);
+	Scene::requestPresent ();
+	SDL_LockMutex (drawMutex);
+	if (isFrameStatsEnabled) {
+		wait.serial = drawListRecordSerial.load () + 1;
+		wait.startCounter = startCounter;
+		presentWaitList.push_back (wait);
 	}
+	SDL_UnlockMutex (drawMutex);
 }
 
-void App::suspendClipRect () {
-	SDL_RenderSetClipRect (render, NULL);
-}
+int App::getPresentWaitCount () {
+	int count;
 
-void App::unsuspendClipRect () {
-	SDL_RenderSetClipRect (render, &clipRect);
+	SDL_LockMutex (drawMutex);
+	count = (int) presentWaitList.size ();
+	SDL_UnlockMutex (drawMutex);
+	return (count);
 }
 
 void App::addRenderTask (RenderTaskFunction fn, void *fnData) {
@@ -999,10 +1295,7 @@ void App::addRenderTask (RenderTaskFunction fn, void *fnData) {
 	SDL_LockMutex (renderTaskMutex);
 	renderTaskAddList.push_back (ctx);
 	SDL_UnlockMutex (renderTaskMutex);
-}
-
-void App::writeConsoleOutput (const StdString &text) {
-	// Do nothing
+	wakeDraw ();
 }
 
 void App::writePrefs () {
@@ -1041,10 +1334,9 @@ void App::resizeWindow () {
 	imageScale = scale;
 	uiConfig.resetScale ();
 
-	clipRect.x = 0;
-	clipRect.y = 0;
-	clipRect.w = windowWidth;
-	clipRect.h = windowHeight;
+	if (sceneTexture && (! resetSceneTexture ())) {
+		isDamageRedrawEnabled = false;
+	}
 	rootPanel->setFixedSize (true, windowWidth, windowHeight);
 
 	uiConfig.coreSprites.resize ();
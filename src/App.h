@@ -33,13 +33,19 @@
 #define APP_H
 
 #include <vector>
-#include <stack>
+#include <list>
+#include <atomic>
 #include "SDL2/SDL.h"
 #include "SystemInterface.h"
 #include "StdString.h"
 #include "Log.h"
 #include "Input.h"
 #include "TaskGroup.h"
+#include "ImagePrefetch.h"
+#include "FramePacer.h"
+#include "WakeEvent.h"
+#include "TripleBuffer.h"
+#include "DrawList.h"
 #include "Resource.h"
 #include "Network.h"
 #include "HashMap.h"
@@ -70,6 +76,7 @@ public:
 	static const float FontScales[];
 	static const int FontScaleCount;
 	static const int MaxCornerRadius;
+	static const int64_t MaxUpdateDelay;
 
 	// Key values for the prefs map
 	static const char *NetworkThreadsKey;
@@ -84,17 +91,23 @@ public:
 	Prng prng;
 	Input input;
 	TaskGroup taskGroup;
+	ImagePrefetch imagePrefetch;
 	UiStack uiStack;
 	UiText uiText;
 	UiConfiguration uiConfig;
 	Resource resource;
 	Network network;
 	SystemInterface systemInterface;
+	WakeEvent updateWakeEvent; // Signal to run an update cycle ahead of any scheduled update time
 	StdString prefsPath;
 	float nextFontScale;
 	int nextWindowWidth;
 	int nextWindowHeight;
 	bool isConsole;
+	bool isHeadless;
+	bool isDamageRedrawEnabled;
+	bool isDamageOverlayEnabled;
+	bool isVsyncEnabled;
 	bool shouldRefreshUi;
 	bool isInterfaceAnimationEnabled;
 
@@ -114,11 +127,14 @@ public:
 	int windowHeight;
 	int minDrawFrameDelay; // milliseconds
 	int minUpdateFrameDelay; // milliseconds
+	int drawKeepAlivePeriod; // milliseconds, or 0 to present only when the scene changes
 	float fontScale;
 	int imageScale;
 	int64_t drawCount;
+	int64_t skippedDrawCount;
 	int64_t updateCount;
-	SDL_Rect clipRect;
+	std::atomic<int64_t> drawListRecordSerial; // The serial value of the most recently recorded scene draw list
+	std::atomic<int64_t> drawListDrawSerial; // The serial value of the scene draw list most recently taken by the main thread
 	bool isPrefsWriteDisabled;
 
 	// Run the application, returning only after the application exits
@@ -142,17 +158,17 @@ public:
 	// Unsuspend the application's update thread after a previous call to suspendUpdate
 	void unsuspendUpdate ();
 
-	// Push the provided rectangle onto the clip stack and apply it to the application's renderer. Apply the new clip rectangle as an intersection of any existing clip rectangle unless disableIntersection is true.
-	void pushClipRect (const SDL_Rect *rect, bool disableIntersection = false);
+	// Begin collecting draw frame times and command-to-present latency samples, discarding any previously collected samples
+	void startFrameStats ();
 
-	// Pop the clip stack
-	void popClipRect ();
+	// Stop collecting frame statistics and store collected samples in the provided vectors, measured in microseconds
+	void stopFrameStats (std::vector<int64_t> *frameTimes, std::vector<int64_t> *presentLatencies);
 
-	// Disable any active clip rectangle, to be restored by a call to unsuspendClipRect
-	void suspendClipRect ();
+	// Record an SDL performance counter value, to be collected as a latency sample when the draw list recorded at the end of the current update cycle, or any later draw list, is presented. This method must be invoked from the update thread.
+	void addPresentWait (uint64_t startCounter);
 
-	// Restore a previously suspended clip rectangle
-	void unsuspendClipRect ();
+	// Return the number of values from addPresentWait that have not yet been collected by a presented frame
+	int getPresentWaitCount ();
 
 	// Return a texture containing a rounded corner of the specified radius, or NULL if no such texture is available. If a texture is found and width and height pointers are provided, those values are filled in with texture attributes.
 	SDL_Texture *getRoundedCornerTexture (int radius, int *textureWidth = NULL, int *textureHeight = NULL);
@@ -168,8 +184,11 @@ public:
 	// Schedule a task function to execute at the top of the next render loop
 	void addRenderTask (RenderTaskFunction fn, void *fnData);
 
-	// Append text to any previously set console window
-	void writeConsoleOutput (const StdString &text);
+	// Wake the application's main thread if it is blocked waiting for input events. This method may be invoked from any thread.
+	void wakeDraw ();
+
+	// Request that the update thread run its next cycle after no more than delayMs milliseconds, or at the next update frame if delayMs is zero or less. Delays longer than MaxUpdateDelay wake the update thread after MaxUpdateDelay, leaving the next cycle to schedule the remainder. Without a request, the update thread blocks after a cycle that leaves the scene unchanged until updateWakeEvent is signaled. This method must be invoked from the update thread.
+	void scheduleUpdate (int64_t delayMs = 0);
 
 	// Return a pseudorandom int value, chosen from within the specified inclusive range
 	int getRandomInt (int i1, int i2);
@@ -196,14 +215,29 @@ private:
 	// Create roundedCornerSprite and load it with textures
 	void populateRoundedCornerSprite ();
 
-	// Execute draw operations to update the application window
-	void draw ();
+	// Allocate and fill rounded corner bitmaps for the specified range of pixelSetsPtr indexes, where index 0 holds the bitmap for a radius of 1
+	static void createRoundedCornerPixels (void *pixelSetsPtr, int rangeStart, int rangeEnd);
+
+	// Execute the current scene draw list to update the application window, applying its damage regions if isNewDrawList is true
+	void draw (bool isNewDrawList);
+
+	// Record the active Ui and root panel into the next scene draw list and publish it to the main thread, if the scene has changed since the last recording. This method must be invoked from the update thread.
+	void recordDrawList ();
+
+	// Draw outlines of the damage regions held in drawList
+	void drawDamageOverlay (DrawList *drawList);
+
+	// Create sceneTexture at the current window size, replacing any existing texture. Returns a boolean value indicating if the operation succeeded.
+	bool resetSceneTexture ();
 
 	// Execute all operations in renderTaskList
 	void executeRenderTasks ();
 
+	// Block the main thread until an input event, render task, or newly published draw list requires another draw cycle, or until the draw keep-alive period elapses
+	void waitDrawWork ();
+
 	// Execute operations to update application state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	void update (float msElapsed);
 
 	// Close the application window and reopen it at the size indicated by nextWindowWidth and nextWindowHeight
 	void resizeWindow ();
@@ -217,13 +251,28 @@ private:
 	// Write the prefs file if any prefsMap keys have changed since the last write
 	void writePrefs ();
 
+	struct SceneDamage {
+		int64_t serial;
+		std::vector<SDL_Rect> rects;
+		bool isFull;
+		SceneDamage ():
+			serial (0),
+			isFull (false) { }
+	};
+	struct PresentWait {
+		int64_t serial;
+		uint64_t startCounter;
+		PresentWait ():
+			serial (0),
+			startCounter (0) { }
+	};
+
 	SDL_Thread *updateThread;
 	SDL_mutex *uniqueIdMutex;
 	int64_t nextUniqueId;
 	HashMap prefsMap;
 	SDL_mutex *prefsMapMutex;
 	std::vector<SDL_Keycode> keyPressList;
-	std::stack<SDL_Rect> clipRectStack;
 	Sprite *roundedCornerSprite;
 	SDL_mutex *renderTaskMutex;
 	std::vector<App::RenderTaskContext> renderTaskList;
@@ -231,6 +280,21 @@ private:
 	bool isSuspendingUpdate;
 	SDL_mutex *updateMutex;
 	SDL_cond *updateCond;
+	SDL_mutex *drawMutex; // Guards the frame statistics and present wait lists
+	std::atomic<bool> isDrawWaiting;
+	bool isUpdateScheduled;
+	int64_t nextUpdateDeadline; // monotonic nanoseconds, or 0 if no update deadline is scheduled
+	bool isFrameStatsEnabled;
+	uint64_t lastPresentCounter;
+	int64_t lastDrawTime; // monotonic nanoseconds
+	FramePacer drawPacer;
+	SDL_Texture *sceneTexture;
+	StdString sceneTexturePath;
+	TripleBuffer<DrawList> drawLists; // Scene draw lists passed from the update thread to the main thread
+	std::list<App::SceneDamage> sceneDamageList; // Damage recorded for draw lists not yet known to be taken by the main thread, accessed only from the update thread
+	std::vector<App::PresentWait> presentWaitList;
+	std::vector<int64_t> frameTimeList;
+	std::vector<int64_t> presentLatencyList;
 };
 
 #endif
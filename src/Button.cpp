@@ -60,7 +60,7 @@ Button::Button (Sprite *sprite, const StdString &labelText)
 , isImageColorEnabled (false)
 , label (NULL)
 , image (NULL)
-, pressClock (0)
+, pressClock (0.0f)
 {
 	classId = ClassId::Button;
 
@@ -246,17 +246,20 @@ void Button::mouseReleased (void *buttonPtr, Widget *widgetPtr) {
 	button->setFocused (button->isMouseEntered);
 }
 
-void Button::doUpdate (int msElapsed) {
+void Button::doUpdate (float msElapsed) {
 	Panel::doUpdate (msElapsed);
-	if (pressClock > 0) {
+	if (pressClock > 0.0f) {
 		pressClock -= msElapsed;
-		if (pressClock <= 0) {
-			pressClock = 0;
+		if (pressClock <= 0.0f) {
+			pressClock = 0.0f;
+		}
+		else {
+			App::instance->scheduleUpdate (((int) pressClock) + 1);
 		}
 	}
 
 	if (! isInputSuspended) {
-		if (isPressed && (pressClock <= 0)) {
+		if (isPressed && (pressClock <= 0.0f)) {
 			if ((! isMouseEntered) || (! Input::instance->isMouseLeftButtonDown)) {
 				setPressed (false);
 				if (isMouseEntered) {
@@ -102,7 +102,7 @@ public:
 
 protected:
 	// Execute subclass-specific operations to update object state as appropriate for an elapsed millisecond time period
-	virtual void doUpdate (int msElapsed);
+	virtual void doUpdate (float msElapsed);
 
 	// Update the widget as appropriate for a received keypress event and return a boolean value indicating if the event was consumed and should no longer be processed
 	virtual bool doProcessKeyEvent (SDL_Keycode keycode, bool isShiftDown, bool isControlDown);
@@ -116,7 +116,7 @@ protected:
 private:
 	Label *label;
 	Image *image;
-	int pressClock;
+	float pressClock;
 };
 
 #endif
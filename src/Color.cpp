@@ -31,6 +31,8 @@
 #include <stdlib.h>
 #include <math.h>
 #include "StdString.h"
+#include "App.h"
+#include "Scene.h"
 #include "Color.h"
 
 Color::Color (float r, float g, float b, float a)
@@ -44,7 +46,7 @@ Color::Color (float r, float g, float b, float a)
 , animateDuration (0)
 , animateRepeatDelay (0)
 , animateStage (0)
-, animateClock (0)
+, animateClock (0.0f)
 , targetR (0.0f)
 , targetG (0.0f)
 , targetB (0.0f)
@@ -62,14 +64,16 @@ Color::Color (float r, float g, float b, float a)
 , animateColor2B (0.0f)
 , animateColor2A (0.0f)
 {
-	normalize ();
+	normalize (false);
 }
 
 Color::~Color () {
 
 }
 
-void Color::normalize () {
+void Color::normalize (bool isChangeTracked) {
+	uint8_t rbyte, gbyte, bbyte, abyte;
+
 	if (r < 0.0f) {
 		r = 0.0f;
 	}
@@ -95,10 +99,17 @@ void Color::normalize () {
 		a = 1.0f;
 	}
 
-	rByte = (uint8_t) (r * 255.0f);
-	gByte = (uint8_t) (g * 255.0f);
-	bByte = (uint8_t) (b * 255.0f);
-	aByte = (uint8_t) (a * 255.0f);
+	rbyte = (uint8_t) (r * 255.0f);
+	gbyte = (uint8_t) (g * 255.0f);
+	bbyte = (uint8_t) (b * 255.0f);
+	abyte = (uint8_t) (a * 255.0f);
+	if (isChangeTracked && ((rbyte != rByte) || (gbyte != gByte) || (bbyte != bByte) || (abyte != aByte))) {
+		Scene::setPropertyChanged ();
+	}
+	rByte = rbyte;
+	gByte = gbyte;
+	bByte = bbyte;
+	aByte = abyte;
 }
 
 StdString Color::toString () const {
@@ -169,13 +180,13 @@ void Color::blend (const Color &sourceColor, float alpha) {
 	blend (sourceColor.r, sourceColor.g, sourceColor.b, alpha);
 }
 
-void Color::update (int msElapsed) {
+void Color::update (float msElapsed) {
 	int matchcount;
 
 	if (isTranslating) {
 		matchcount = 0;
 
-		r += (deltaR * (float) msElapsed);
+		r += (deltaR * msElapsed);
 		if (deltaR < 0.0f) {
 			if (r <= targetR) {
 				r = targetR;
@@ -189,7 +200,7 @@ void Color::update (int msElapsed) {
 			}
 		}
 
-		g += (deltaG * (float) msElapsed);
+		g += (deltaG * msElapsed);
 		if (deltaG < 0.0f) {
 			if (g <= targetG) {
 				g = targetG;
@@ -203,7 +214,7 @@ void Color::update (int msElapsed) {
 			}
 		}
 
-		b += (deltaB * (float) msElapsed);
+		b += (deltaB * msElapsed);
 		if (deltaB < 0.0f) {
 			if (b <= targetB) {
 				b = targetB;
@@ -217,7 +228,7 @@ void Color::update (int msElapsed) {
 			}
 		}
 
-		a += (deltaA * (float) msElapsed);
+		a += (deltaA * msElapsed);
 		if (deltaA < 0.0f) {
 			if (a <= targetA) {
 				a = targetA;
@@ -257,9 +268,12 @@ void Color::update (int msElapsed) {
 			case 2: {
 				if (! isTranslating) {
 					animateClock -= msElapsed;
-					if (animateClock <= 0) {
+					if (animateClock <= 0.0f) {
 						animateStage = 0;
 					}
+					else {
+						App::instance->scheduleUpdate (((int) animateClock) + 1);
+					}
 				}
 				break;
 			}
@@ -404,7 +418,7 @@ void Color::animate (const Color &color1, const Color &color2, int durationMs, i
 		animateRepeatDelay = 0;
 	}
 	animateStage = 0;
-	animateClock = 0;
+	animateClock = 0.0f;
 	isAnimating = true;
 }
 
@@ -70,7 +70,7 @@ public:
 	void blend (const Color &sourceColor, float alpha);
 
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	void update (float msElapsed);
 
 	// Begin an operation to change the color's value over time
 	void translate (float translateTargetR, float translateTargetG, float translateTargetB, int durationMs);
@@ -82,14 +82,14 @@ public:
 	void animate (const Color &color1, const Color &color2, int durationMs, int repeatDelayMs = 0);
 
 private:
-	// Clip the r, g, and b data members to valid ranges, and reset dependent data members
-	void normalize ();
+	// Clip the r, g, and b data members to valid ranges, and reset dependent data members. If isChangeTracked is true and the byte values differ from their previous values, mark the scene as changed.
+	void normalize (bool isChangeTracked = true);
 
 	int translateDuration;
 	int animateDuration;
 	int animateRepeatDelay;
 	int animateStage;
-	int animateClock;
+	float animateClock;
 	float targetR, targetG, targetB, targetA;
 	float deltaR, deltaG, deltaB, deltaA;
 	float animateColor1R, animateColor1G, animateColor1B, animateColor1A;
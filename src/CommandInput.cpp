@@ -0,0 +1,769 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <map>
+#include <atomic>
+#if PLATFORM_LINUX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#endif
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "Log.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+#include "Json.h"
+#include "SystemInterface.h"
+#include "CommandReader.h"
+#include "CommandJournal.h"
+#include "SpscQueue.h"
+#include "CommandInput.h"
+
+const int CommandInput::QueueCapacity = 1024;
+const int CommandInput::MaxConnectionOutputSize = (1024 * 1024); // bytes
+const int64_t CommandInput::PrimaryInputId = 0;
+
+// Values stored in epoll event data to identify descriptors other than control connections, which are identified by their positive connection ID
+static const int64_t EpollWakeTag = -1;
+static const int64_t EpollListenTag = -2;
+static const int64_t EpollInputTag = -3;
+static const int MaxEpollEvents = 32;
+static const int ListenBacklog = 16;
+
+CommandInput::CommandInput (int maxCommandSize)
+: wakeEvent (NULL)
+, isStarted (false)
+, isStopped (false)
+, reader (maxCommandSize)
+, controlSocketPath ("")
+, enqueueCount (0)
+, dequeueCount (0)
+, maxQueueDepth (0)
+, lastLatency (0)
+, maxLatency (0)
+, totalLatency (0)
+, connectionCount (0)
+, connectionFrameCount (0)
+, isReplaying (false)
+, commandQueue (CommandInput::QueueCapacity)
+, readThread (NULL)
+, inputFd (-1)
+, connectionFormat (CommandReader::JsonFormat)
+, isConnectionFormatHandshakeEnabled (true)
+, epollFd (-1)
+, listenSocket (-1)
+, nextConnectionId (1)
+, isReplayRealTime (false)
+, isReplayInputEnded (false)
+, connectionMapMutex (NULL)
+{
+	wakePipe[0] = -1;
+	wakePipe[1] = -1;
+	connectionMapMutex = SDL_CreateMutex ();
+}
+
+CommandInput::~CommandInput () {
+	stop ();
+	if (connectionMapMutex) {
+		SDL_DestroyMutex (connectionMapMutex);
+		connectionMapMutex = NULL;
+	}
+}
+
+OsUtil::Result CommandInput::start (int fd, int format, bool isFormatHandshakeEnabled, const StdString &socketPath) {
+	OsUtil::Result result;
+#if PLATFORM_LINUX
+	struct epoll_event ev;
+#endif
+
+	if (isStarted) {
+		return (OsUtil::Success);
+	}
+	reader.format = format;
+	reader.isFormatHandshakeEnabled = isFormatHandshakeEnabled;
+	connectionFormat = format;
+	isConnectionFormatHandshakeEnabled = isFormatHandshakeEnabled;
+	controlSocketPath.assign (socketPath);
+	if (pipe (wakePipe) != 0) {
+		Log::err ("Command input start failed; err=\"pipe: %s\"", strerror (errno));
+		wakePipe[0] = -1;
+		wakePipe[1] = -1;
+		return (OsUtil::SystemOperationFailedError);
+	}
+	inputFd = fd;
+	isStopped = false;
+
+#if PLATFORM_LINUX
+	epollFd = epoll_create1 (EPOLL_CLOEXEC);
+	if (epollFd < 0) {
+		Log::err ("Command input start failed; err=\"epoll_create1: %s\"", strerror (errno));
+		closeInputDescriptors ();
+		return (OsUtil::SystemOperationFailedError);
+	}
+	memset (&ev, 0, sizeof (ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = (uint64_t) EpollWakeTag;
+	if (epoll_ctl (epollFd, EPOLL_CTL_ADD, wakePipe[0], &ev) != 0) {
+		Log::err ("Command input start failed; err=\"epoll_ctl: %s\"", strerror (errno));
+		closeInputDescriptors ();
+		return (OsUtil::SystemOperationFailedError);
+	}
+#endif
+
+	if (! controlSocketPath.empty ()) {
+		result = openControlSocket ();
+		if (result != OsUtil::Success) {
+			closeInputDescriptors ();
+			return (result);
+		}
+	}
+
+	readThread = SDL_CreateThread (CommandInput::runReadThread, "runCommandInputThread", (void *) this);
+	if (! readThread) {
+		Log::err ("Command input start failed; err=\"thread create failed\"");
+		closeInputDescriptors ();
+		return (OsUtil::ThreadCreateFailedError);
+	}
+	isStarted = true;
+	return (OsUtil::Success);
+}
+
+OsUtil::Result CommandInput::openJournal (const StdString &journalPath) {
+	if (isStarted) {
+		return (OsUtil::InvalidParamError);
+	}
+	return (journal.openWrite (journalPath));
+}
+
+OsUtil::Result CommandInput::startReplay (const StdString &journalPath, bool isRealTime) {
+	OsUtil::Result result;
+
+	if (isStarted) {
+		return (OsUtil::Success);
+	}
+	result = journal.openRead (journalPath);
+	if (result != OsUtil::Success) {
+		return (result);
+	}
+	isReplaying = true;
+	isReplayRealTime = isRealTime;
+	isReplayInputEnded = false;
+	isStopped = false;
+	readThread = SDL_CreateThread (CommandInput::runReadThread, "runCommandInputThread", (void *) this);
+	if (! readThread) {
+		Log::err ("Command input start failed; err=\"thread create failed\"");
+		journal.close ();
+		isReplaying = false;
+		return (OsUtil::ThreadCreateFailedError);
+	}
+	isStarted = true;
+	return (OsUtil::Success);
+}
+
+bool CommandInput::isReplayComplete () const {
+	return (isReplaying && isReplayInputEnded && (commandQueue.size () <= 0));
+}
+
+void CommandInput::stop () {
+	CommandInput::Command item;
+	char c;
+	int result;
+
+	if ((! isStarted) || isStopped) {
+		return;
+	}
+	isStopped = true;
+	if (wakePipe[1] >= 0) {
+		c = 0;
+		if (write (wakePipe[1], &c, 1) < 0) {
+			Log::debug ("Failed to wake command input thread; err=\"%s\"", strerror (errno));
+		}
+	}
+	if (readThread) {
+		SDL_WaitThread (readThread, &result);
+		readThread = NULL;
+	}
+	closeInputDescriptors ();
+	if (journal.isWriting) {
+		Log::debug ("Command journal closed; path=\"%s\" entryCount=%lli byteCount=%lli", journal.path.c_str (), (long long) journal.entryCount, (long long) journal.byteCount);
+	}
+	journal.close ();
+
+	while (commandQueue.pop (&item)) {
+		if (item.json) {
+			delete (item.json);
+		}
+	}
+	isStarted = false;
+}
+
+bool CommandInput::nextCommand (CommandInput::Command *destCommand) {
+	int depth;
+	int64_t latency;
+
+	depth = commandQueue.size ();
+	if (depth <= 0) {
+		return (false);
+	}
+	if (depth > maxQueueDepth) {
+		maxQueueDepth = depth;
+	}
+	if (! commandQueue.pop (destCommand)) {
+		return (false);
+	}
+	latency = (int64_t) ((SDL_GetPerformanceCounter () - destCommand->enqueueTime) * 1000000 / SDL_GetPerformanceFrequency ());
+	lastLatency = latency;
+	totalLatency += latency;
+	if (latency > maxLatency) {
+		maxLatency = latency;
+	}
+	++dequeueCount;
+	return (true);
+}
+
+int CommandInput::getQueueDepth () const {
+	return (commandQueue.size ());
+}
+
+void CommandInput::appendRecord (Buffer *destBuffer, Json *command, int format) {
+	uint8_t len[CommandReader::LengthPrefixSize];
+	int i, start, sz;
+
+	if (format == CommandReader::MsgPackFormat) {
+		start = destBuffer->length;
+		memset (len, 0, sizeof (len));
+		destBuffer->add (len, sizeof (len));
+		if (command->writeMsgPack (destBuffer) != OsUtil::Success) {
+			destBuffer->setDataLength (start);
+			return;
+		}
+		sz = destBuffer->length - start - CommandReader::LengthPrefixSize;
+		for (i = CommandReader::LengthPrefixSize - 1; i >= 0; --i) {
+			destBuffer->data[start + i] = (uint8_t) (sz & 0xFF);
+			sz >>= 8;
+		}
+	}
+	else {
+		if (command->writeJson (destBuffer) != OsUtil::Success) {
+			return;
+		}
+		destBuffer->add ("\n");
+	}
+}
+
+void CommandInput::writeConnectionData (int64_t connectionId, const uint8_t *data, int dataLength) {
+	std::map<int64_t, CommandInput::Connection *>::iterator pos;
+	CommandInput::Connection *connection;
+
+	if (dataLength <= 0) {
+		return;
+	}
+	SDL_LockMutex (connectionMapMutex);
+	pos = connectionMap.find (connectionId);
+	if (pos == connectionMap.end ()) {
+		Log::debug ("Discard command result for closed control connection; id=%lli", (long long) connectionId);
+	}
+	else {
+		connection = pos->second;
+		if (connection->output.length > CommandInput::MaxConnectionOutputSize) {
+			Log::warning ("Discard command result for control connection (output buffer full); id=%lli length=%i", (long long) connection->id, connection->output.length);
+		}
+		else {
+			connection->output.add ((uint8_t *) data, dataLength);
+			if (! writeConnectionOutput (connection)) {
+#if PLATFORM_LINUX
+				// The input thread receives a hangup event and closes the connection
+				shutdown (connection->fd, SHUT_RDWR);
+#endif
+			}
+		}
+	}
+	SDL_UnlockMutex (connectionMapMutex);
+}
+
+StdString CommandInput::toString () {
+	int64_t avg;
+
+	avg = 0;
+	if (dequeueCount > 0) {
+		avg = totalLatency / dequeueCount;
+	}
+	return (StdString::createSprintf ("%s enqueueCount=%lli dequeueCount=%lli queueDepth=%i maxQueueDepth=%i lastLatency=%llius averageLatency=%llius maxLatency=%llius connectionCount=%lli connectionFrameCount=%lli", reader.toString ().c_str (), (long long) enqueueCount, (long long) dequeueCount, getQueueDepth (), maxQueueDepth, (long long) lastLatency, (long long) avg, (long long) maxLatency, (long long) connectionCount, (long long) connectionFrameCount));
+}
+
+int CommandInput::runReadThread (void *commandInputPtr) {
+	CommandInput *input;
+
+	input = (CommandInput *) commandInputPtr;
+	if (input->isReplaying) {
+		input->runReplayLoop ();
+		return (0);
+	}
+#if PLATFORM_LINUX
+	input->runEpollLoop ();
+#else
+	input->runPollLoop ();
+#endif
+	return (0);
+}
+
+bool CommandInput::enqueueRecords (CommandReader *commandReader, int64_t connectionId) {
+	StdString record;
+
+	while (commandReader->readRecord (&record)) {
+		if (journal.isWriting) {
+			journal.write (commandReader->format, record.c_str (), (int) record.length ());
+		}
+		if (! enqueueRecord (record, commandReader->format, connectionId)) {
+			return (false);
+		}
+	}
+	return (true);
+}
+
+bool CommandInput::enqueueRecord (const StdString &record, int format, int64_t connectionId) {
+	CommandInput::Command item;
+	Json *cmd;
+	StdString err;
+	bool parsed;
+
+	if (format == CommandReader::MsgPackFormat) {
+		parsed = SystemInterface::instance->parseMsgPackCommand ((uint8_t *) record.c_str (), (int) record.length (), &cmd, &err);
+	}
+	else {
+		parsed = SystemInterface::instance->parseCommand (record, &cmd, &err);
+	}
+	if (! parsed) {
+		Log::debug ("Discard malformed command record; connectionId=%lli format=%s length=%i err=%s", (long long) connectionId, CommandReader::getFormatName (format).c_str (), (int) record.length (), err.c_str ());
+		return (true);
+	}
+	item.json = cmd;
+	item.format = format;
+	item.connectionId = connectionId;
+	item.enqueueTime = SDL_GetPerformanceCounter ();
+	while (! commandQueue.push (item)) {
+		if (isStopped) {
+			delete (cmd);
+			return (false);
+		}
+		SDL_Delay (1);
+	}
+	++enqueueCount;
+	if (wakeEvent) {
+		wakeEvent->signal ();
+	}
+	return (true);
+}
+
+void CommandInput::runReplayLoop () {
+	CommandJournal::Entry entry;
+	uint64_t startcounter;
+	int64_t delay;
+
+	startcounter = SDL_GetPerformanceCounter ();
+	while (! isStopped) {
+		if (! journal.read (&entry)) {
+			break;
+		}
+		if (isReplayRealTime) {
+			while (! isStopped) {
+				delay = (entry.receiveTime - OsUtil::getCounterMicroseconds (SDL_GetPerformanceCounter () - startcounter, SDL_GetPerformanceFrequency ())) / 1000;
+				if (delay <= 0) {
+					break;
+				}
+				SDL_Delay ((delay > 100) ? 100 : (Uint32) delay);
+			}
+		}
+		if (! enqueueRecord (entry.record, entry.format, CommandInput::PrimaryInputId)) {
+			break;
+		}
+	}
+	Log::debug ("Command journal replay input ended; path=\"%s\" entryCount=%lli", journal.path.c_str (), (long long) journal.entryCount);
+	isReplayInputEnded = true;
+}
+
+bool CommandInput::readPrimaryInput () {
+	int result;
+
+	result = reader.readFd (inputFd);
+	if (result < 0) {
+		if ((errno == EINTR) || (errno == EAGAIN)) {
+			return (true);
+		}
+		Log::err ("Command input failed; err=\"read: %s\"", strerror (errno));
+		return (false);
+	}
+	if (result == 0) {
+		Log::debug ("Command input reached end of file");
+		return (false);
+	}
+	return (enqueueRecords (&reader, CommandInput::PrimaryInputId));
+}
+
+void CommandInput::runPollLoop () {
+	struct pollfd fds[2];
+	int result;
+
+	while (! isStopped) {
+		fds[0].fd = inputFd;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		fds[1].fd = wakePipe[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+		result = poll (fds, 2, -1);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			Log::err ("Command input failed; err=\"poll: %s\"", strerror (errno));
+			break;
+		}
+		if (isStopped || fds[1].revents) {
+			break;
+		}
+		if (! fds[0].revents) {
+			continue;
+		}
+		if (! readPrimaryInput ()) {
+			break;
+		}
+	}
+}
+
+void CommandInput::runEpollLoop () {
+#if PLATFORM_LINUX
+	std::map<int64_t, CommandInput::Connection *>::iterator pos;
+	CommandInput::Connection *connection;
+	struct epoll_event ev, events[MaxEpollEvents];
+	int64_t tag;
+	int i, count;
+	bool isinputopen, isinputpollable, isdone, result;
+
+	isinputopen = true;
+	isinputpollable = true;
+	memset (&ev, 0, sizeof (ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = (uint64_t) EpollInputTag;
+	if (epoll_ctl (epollFd, EPOLL_CTL_ADD, inputFd, &ev) != 0) {
+		if (errno == EPERM) {
+			// epoll rejects descriptors that are always readable, such as regular files
+			isinputpollable = false;
+		}
+		else {
+			Log::err ("Command input failed; err=\"epoll_ctl: %s\"", strerror (errno));
+			isinputopen = false;
+		}
+	}
+
+	isdone = false;
+	while ((! isdone) && (! isStopped)) {
+		if (isinputopen && (! isinputpollable)) {
+			isinputopen = readPrimaryInput ();
+		}
+		if ((! isinputopen) && (listenSocket < 0)) {
+			break;
+		}
+
+		count = epoll_wait (epollFd, events, MaxEpollEvents, (isinputopen && (! isinputpollable)) ? 0 : -1);
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			Log::err ("Command input failed; err=\"epoll_wait: %s\"", strerror (errno));
+			break;
+		}
+		for (i = 0; i < count; ++i) {
+			tag = (int64_t) events[i].data.u64;
+			if (tag == EpollWakeTag) {
+				isdone = true;
+				break;
+			}
+			if (tag == EpollInputTag) {
+				if (! readPrimaryInput ()) {
+					epoll_ctl (epollFd, EPOLL_CTL_DEL, inputFd, NULL);
+					isinputopen = false;
+				}
+				continue;
+			}
+			if (tag == EpollListenTag) {
+				acceptConnections ();
+				continue;
+			}
+
+			connection = NULL;
+			result = true;
+			SDL_LockMutex (connectionMapMutex);
+			pos = connectionMap.find (tag);
+			if (pos != connectionMap.end ()) {
+				connection = pos->second;
+				if (events[i].events & EPOLLOUT) {
+					result = writeConnectionOutput (connection);
+				}
+			}
+			SDL_UnlockMutex (connectionMapMutex);
+			if (! connection) {
+				continue;
+			}
+			if (result && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+				result = readConnection (connection);
+			}
+			if (! result) {
+				closeConnection (tag);
+			}
+		}
+	}
+#endif
+}
+
+OsUtil::Result CommandInput::openControlSocket () {
+#if PLATFORM_LINUX
+	struct sockaddr_un addr;
+	struct stat st;
+	struct epoll_event ev;
+
+	if (controlSocketPath.length () >= sizeof (addr.sun_path)) {
+		Log::err ("Failed to open control socket; err=\"path exceeds maximum length\" path=\"%s\"", controlSocketPath.c_str ());
+		return (OsUtil::InvalidConfigurationError);
+	}
+	if ((lstat (controlSocketPath.c_str (), &st) == 0) && S_ISSOCK (st.st_mode)) {
+		// Remove a stale socket file left behind by a previous process
+		unlink (controlSocketPath.c_str ());
+	}
+
+	listenSocket = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenSocket < 0) {
+		Log::err ("Failed to open control socket; err=\"socket: %s\"", strerror (errno));
+		return (OsUtil::SocketOperationFailedError);
+	}
+	memset (&addr, 0, sizeof (addr));
+	addr.sun_family = AF_UNIX;
+	strncpy (addr.sun_path, controlSocketPath.c_str (), sizeof (addr.sun_path) - 1);
+	if (bind (listenSocket, (struct sockaddr *) &addr, sizeof (addr)) < 0) {
+		Log::err ("Failed to open control socket; err=\"bind: %s\" path=\"%s\"", strerror (errno), controlSocketPath.c_str ());
+		close (listenSocket);
+		listenSocket = -1;
+		return (OsUtil::SocketOperationFailedError);
+	}
+	if (listen (listenSocket, ListenBacklog) < 0) {
+		Log::err ("Failed to open control socket; err=\"listen: %s\"", strerror (errno));
+		close (listenSocket);
+		listenSocket = -1;
+		unlink (controlSocketPath.c_str ());
+		return (OsUtil::SocketOperationFailedError);
+	}
+
+	memset (&ev, 0, sizeof (ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = (uint64_t) EpollListenTag;
+	if (epoll_ctl (epollFd, EPOLL_CTL_ADD, listenSocket, &ev) != 0) {
+		Log::err ("Failed to open control socket; err=\"epoll_ctl: %s\"", strerror (errno));
+		close (listenSocket);
+		listenSocket = -1;
+		unlink (controlSocketPath.c_str ());
+		return (OsUtil::SystemOperationFailedError);
+	}
+	Log::debug ("Control socket open; path=\"%s\"", controlSocketPath.c_str ());
+	return (OsUtil::Success);
+#else
+	Log::err ("Failed to open control socket; err=\"not supported on this platform\"");
+	return (OsUtil::NotImplementedError);
+#endif
+}
+
+void CommandInput::acceptConnections () {
+#if PLATFORM_LINUX
+	CommandInput::Connection *connection;
+	struct epoll_event ev;
+	int fd;
+
+	while (true) {
+		fd = accept4 (listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+				Log::warning ("Failed to accept control connection; err=\"accept: %s\"", strerror (errno));
+			}
+			break;
+		}
+
+		connection = new CommandInput::Connection ();
+		connection->id = nextConnectionId;
+		++nextConnectionId;
+		connection->fd = fd;
+		connection->reader = new CommandReader (reader.maxRecordSize);
+		connection->reader->format = connectionFormat;
+		connection->reader->isFormatHandshakeEnabled = isConnectionFormatHandshakeEnabled;
+
+		memset (&ev, 0, sizeof (ev));
+		ev.events = EPOLLIN;
+		ev.data.u64 = (uint64_t) connection->id;
+		if (epoll_ctl (epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+			Log::warning ("Failed to accept control connection; err=\"epoll_ctl: %s\"", strerror (errno));
+			close (fd);
+			delete (connection->reader);
+			delete (connection);
+			continue;
+		}
+
+		SDL_LockMutex (connectionMapMutex);
+		connectionMap.insert (std::pair<int64_t, CommandInput::Connection *> (connection->id, connection));
+		SDL_UnlockMutex (connectionMapMutex);
+		++connectionCount;
+		Log::debug ("Control connection open; id=%lli fd=%i", (long long) connection->id, fd);
+	}
+#endif
+}
+
+bool CommandInput::readConnection (CommandInput::Connection *connection) {
+	int result;
+
+	result = connection->reader->readFd (connection->fd);
+	if (result < 0) {
+		if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			return (true);
+		}
+		return (false);
+	}
+	if (result == 0) {
+		return (false);
+	}
+	if (! enqueueRecords (connection->reader, connection->id)) {
+		return (false);
+	}
+	return (true);
+}
+
+bool CommandInput::writeConnectionOutput (CommandInput::Connection *connection) {
+#if PLATFORM_LINUX
+	struct epoll_event ev;
+	int result;
+
+	while (connection->output.length > 0) {
+		result = send (connection->fd, connection->output.data, connection->output.length, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+				if (! connection->isOutputWaiting) {
+					memset (&ev, 0, sizeof (ev));
+					ev.events = EPOLLIN | EPOLLOUT;
+					ev.data.u64 = (uint64_t) connection->id;
+					epoll_ctl (epollFd, EPOLL_CTL_MOD, connection->fd, &ev);
+					connection->isOutputWaiting = true;
+				}
+				return (true);
+			}
+			return (false);
+		}
+		connection->output.advanceRead (result);
+	}
+	if (connection->isOutputWaiting) {
+		memset (&ev, 0, sizeof (ev));
+		ev.events = EPOLLIN;
+		ev.data.u64 = (uint64_t) connection->id;
+		epoll_ctl (epollFd, EPOLL_CTL_MOD, connection->fd, &ev);
+		connection->isOutputWaiting = false;
+	}
+	return (true);
+#else
+	return (false);
+#endif
+}
+
+void CommandInput::closeConnection (int64_t connectionId) {
+	std::map<int64_t, CommandInput::Connection *>::iterator pos;
+	CommandInput::Connection *connection;
+
+	connection = NULL;
+	SDL_LockMutex (connectionMapMutex);
+	pos = connectionMap.find (connectionId);
+	if (pos != connectionMap.end ()) {
+		connection = pos->second;
+		connectionMap.erase (pos);
+#if PLATFORM_LINUX
+		epoll_ctl (epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+#endif
+		close (connection->fd);
+		connection->fd = -1;
+	}
+	SDL_UnlockMutex (connectionMapMutex);
+	if (! connection) {
+		return;
+	}
+
+	Log::debug ("Control connection closed; id=%lli %s", (long long) connection->id, connection->reader->toString ().c_str ());
+	connectionFrameCount += connection->reader->frameCount;
+	delete (connection->reader);
+	delete (connection);
+}
+
+void CommandInput::closeInputDescriptors () {
+	std::map<int64_t, CommandInput::Connection *>::iterator i, end;
+
+	SDL_LockMutex (connectionMapMutex);
+	i = connectionMap.begin ();
+	end = connectionMap.end ();
+	while (i != end) {
+		close (i->second->fd);
+		connectionFrameCount += i->second->reader->frameCount;
+		delete (i->second->reader);
+		delete (i->second);
+		++i;
+	}
+	connectionMap.clear ();
+	SDL_UnlockMutex (connectionMapMutex);
+
+	if (listenSocket >= 0) {
+		close (listenSocket);
+		listenSocket = -1;
+		unlink (controlSocketPath.c_str ());
+	}
+	if (epollFd >= 0) {
+		close (epollFd);
+		epollFd = -1;
+	}
+	if (wakePipe[0] >= 0) {
+		close (wakePipe[0]);
+		wakePipe[0] = -1;
+	}
+	if (wakePipe[1] >= 0) {
+		close (wakePipe[1]);
+		wakePipe[1] = -1;
+	}
+}
@@ -0,0 +1,188 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that reads and parses surface commands from standard input and local control connections on a background thread
+
+#ifndef COMMAND_INPUT_H
+#define COMMAND_INPUT_H
+
+#include <stdint.h>
+#include <map>
+#include <atomic>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+#include "Json.h"
+#include "CommandReader.h"
+#include "CommandJournal.h"
+#include "SpscQueue.h"
+#include "WakeEvent.h"
+
+class CommandInput {
+public:
+	CommandInput (int maxCommandSize);
+	~CommandInput ();
+
+	static const int QueueCapacity;
+	static const int MaxConnectionOutputSize;
+
+	// The connection ID assigned to commands received from the primary input descriptor
+	static const int64_t PrimaryInputId;
+
+	struct Command {
+		Json *json;
+		int format;
+		int64_t connectionId;
+		uint64_t enqueueTime;
+		Command ():
+			json (NULL),
+			format (CommandReader::JsonFormat),
+			connectionId (0),
+			enqueueTime (0) { }
+	};
+
+	// Read-write data members
+	WakeEvent *wakeEvent; // If set, signaled each time a command is added to the queue
+
+	// Read-only data members
+	bool isStarted;
+	std::atomic<bool> isStopped; // Set by stop and polled by the input thread
+	CommandReader reader;
+	StdString controlSocketPath;
+	int64_t enqueueCount;
+	int64_t dequeueCount;
+	int maxQueueDepth;
+	int64_t lastLatency;
+	int64_t maxLatency;
+	int64_t totalLatency;
+	int64_t connectionCount;
+	int64_t connectionFrameCount;
+	bool isReplaying;
+	CommandJournal journal;
+
+	// Begin reading commands from the specified file descriptor, expecting records of the specified CommandReader format. If isFormatHandshakeEnabled is true, a stream beginning with CommandReader::MsgPackHandshakeByte switches the input to MessagePack records. If socketPath is not empty, also accept control connections on a Unix domain socket at that path. Returns a Result value.
+	OsUtil::Result start (int fd, int format = CommandReader::JsonFormat, bool isFormatHandshakeEnabled = true, const StdString &socketPath = StdString (""));
+
+	// Record all command records subsequently received by the input to a journal file at the specified path. Must be invoked before start. Returns a Result value.
+	OsUtil::Result openJournal (const StdString &journalPath);
+
+	// Begin reading commands from the journal file at the specified path instead of an input descriptor, passing each record through the same parse and queue steps used for received commands. If isRealTime is true, each command is enqueued after the delay recorded in the journal; otherwise, commands are enqueued as quickly as the queue accepts them. Returns a Result value.
+	OsUtil::Result startReplay (const StdString &journalPath, bool isRealTime);
+
+	// Return a boolean value indicating if the input is replaying a journal and all of its commands have been retrieved
+	bool isReplayComplete () const;
+
+	// Stop the input thread, close control connections, and discard any commands not yet retrieved, blocking until the thread terminates
+	void stop ();
+
+	// Remove the next parsed command from the input queue and store it in destCommand. Returns a boolean value indicating if a command was found. If so, the caller becomes responsible for deleting destCommand->json.
+	bool nextCommand (CommandInput::Command *destCommand);
+
+	// Return the number of parsed commands waiting in the input queue
+	int getQueueDepth () const;
+
+	// Write an encoded record to the control connection with the specified ID, discarding the data if the connection has closed
+	void writeConnectionData (int64_t connectionId, const uint8_t *data, int dataLength);
+
+	// Append an encoded record containing command to destBuffer, using the specified CommandReader format
+	static void appendRecord (Buffer *destBuffer, Json *command, int format);
+
+	// Return a string containing the input's counter values, suitable for use in a log message
+	StdString toString ();
+
+private:
+	struct Connection {
+		int64_t id;
+		int fd;
+		CommandReader *reader;
+		Buffer output;
+		bool isOutputWaiting;
+		Connection ():
+			id (0),
+			fd (-1),
+			reader (NULL),
+			isOutputWaiting (false) { }
+	};
+
+	// Run a thread that reads commands from input sources and adds them to commandQueue
+	static int runReadThread (void *commandInputPtr);
+
+	// Execute the read thread loop, using epoll to wait on the primary input, the control socket, and its connections
+	void runEpollLoop ();
+
+	// Execute the read thread loop, using poll to wait on the primary input only
+	void runPollLoop ();
+
+	// Read available data from the primary input. Returns a boolean value indicating if the input remains open.
+	bool readPrimaryInput ();
+
+	// Execute the read thread loop, reading records from journal until all entries have been enqueued
+	void runReplayLoop ();
+
+	// Parse all complete records found in a CommandReader and add the resulting commands to commandQueue, also writing them to journal if it's open. Returns a boolean value indicating if the input thread should continue.
+	bool enqueueRecords (CommandReader *commandReader, int64_t connectionId);
+
+	// Parse a command record and add the resulting command to commandQueue. Returns a boolean value indicating if the input thread should continue.
+	bool enqueueRecord (const StdString &record, int format, int64_t connectionId);
+
+	// Open the control socket listener. Returns a Result value.
+	OsUtil::Result openControlSocket ();
+
+	// Accept all pending connections on the control socket
+	void acceptConnections ();
+
+	// Read available data from a control connection. Returns a boolean value indicating if the connection remains open.
+	bool readConnection (CommandInput::Connection *connection);
+
+	// Write pending output data to a control connection. Must be invoked while holding connectionMapMutex. Returns a boolean value indicating if the write succeeded.
+	bool writeConnectionOutput (CommandInput::Connection *connection);
+
+	// Close a control connection and remove it from connectionMap
+	void closeConnection (int64_t connectionId);
+
+	// Close all control connections, the control socket listener, and other descriptors opened by start
+	void closeInputDescriptors ();
+
+	SpscQueue<CommandInput::Command> commandQueue;
+	SDL_Thread *readThread;
+	int inputFd;
+	int connectionFormat;
+	bool isConnectionFormatHandshakeEnabled;
+	int wakePipe[2];
+	int epollFd;
+	int listenSocket;
+	int64_t nextConnectionId;
+	bool isReplayRealTime;
+	std::atomic<bool> isReplayInputEnded;
+	std::map<int64_t, CommandInput::Connection *> connectionMap;
+	SDL_mutex *connectionMapMutex;
+};
+
+#endif
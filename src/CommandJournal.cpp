@@ -0,0 +1,181 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "Log.h"
+#include "OsUtil.h"
+#include "CommandJournal.h"
+
+const char *CommandJournal::FileHeader = "MSCJRNL1";
+const int CommandJournal::EntryHeaderSize = 13; // bytes: 8 receive time, 1 format, 4 record length
+const int CommandJournal::MaxRecordSize = (64 * 1024 * 1024); // bytes
+
+CommandJournal::CommandJournal ()
+: path ("")
+, isWriting (false)
+, isReading (false)
+, entryCount (0)
+, byteCount (0)
+, file (NULL)
+, openCounter (0)
+{
+
+}
+
+CommandJournal::~CommandJournal () {
+	close ();
+}
+
+OsUtil::Result CommandJournal::openWrite (const StdString &filePath) {
+	close ();
+	file = fopen (filePath.c_str (), "wb");
+	if (! file) {
+		Log::err ("Failed to open command journal for writing; path=\"%s\" err=\"%s\"", filePath.c_str (), strerror (errno));
+		return (OsUtil::FileOpenFailedError);
+	}
+	if (fwrite (CommandJournal::FileHeader, 1, strlen (CommandJournal::FileHeader), file) != strlen (CommandJournal::FileHeader)) {
+		fclose (file);
+		file = NULL;
+		return (OsUtil::FileOperationFailedError);
+	}
+	path.assign (filePath);
+	entryCount = 0;
+	byteCount = 0;
+	openCounter = SDL_GetPerformanceCounter ();
+	isWriting = true;
+	return (OsUtil::Success);
+}
+
+OsUtil::Result CommandJournal::openRead (const StdString &filePath) {
+	char header[16];
+	int len;
+
+	close ();
+	file = fopen (filePath.c_str (), "rb");
+	if (! file) {
+		Log::err ("Failed to open command journal for reading; path=\"%s\" err=\"%s\"", filePath.c_str (), strerror (errno));
+		return (OsUtil::FileOpenFailedError);
+	}
+	len = (int) strlen (CommandJournal::FileHeader);
+	if ((fread (header, 1, len, file) != (size_t) len) || (memcmp (header, CommandJournal::FileHeader, len) != 0)) {
+		Log::err ("Failed to open command journal for reading; path=\"%s\" err=\"Unknown file format\"", filePath.c_str ());
+		fclose (file);
+		file = NULL;
+		return (OsUtil::MalformedDataError);
+	}
+	path.assign (filePath);
+	entryCount = 0;
+	byteCount = 0;
+	isReading = true;
+	return (OsUtil::Success);
+}
+
+void CommandJournal::close () {
+	if (file) {
+		fclose (file);
+		file = NULL;
+	}
+	isWriting = false;
+	isReading = false;
+}
+
+OsUtil::Result CommandJournal::write (int format, const char *record, int recordLength) {
+	uint8_t header[CommandJournal::EntryHeaderSize];
+	int64_t t;
+	uint32_t len;
+	int i;
+
+	if ((! isWriting) || (! file) || (recordLength < 0)) {
+		return (OsUtil::InvalidParamError);
+	}
+	t = OsUtil::getCounterMicroseconds (SDL_GetPerformanceCounter () - openCounter, SDL_GetPerformanceFrequency ());
+	for (i = 7; i >= 0; --i) {
+		header[i] = (uint8_t) (t & 0xFF);
+		t >>= 8;
+	}
+	header[8] = (uint8_t) format;
+	len = (uint32_t) recordLength;
+	for (i = 12; i >= 9; --i) {
+		header[i] = (uint8_t) (len & 0xFF);
+		len >>= 8;
+	}
+	if ((fwrite (header, 1, sizeof (header), file) != sizeof (header)) || (fwrite (record, 1, recordLength, file) != (size_t) recordLength)) {
+		Log::err ("Failed to write command journal; path=\"%s\" err=\"%s\"", path.c_str (), strerror (errno));
+		close ();
+		return (OsUtil::FileOperationFailedError);
+	}
+	++entryCount;
+	byteCount += (int64_t) sizeof (header) + recordLength;
+	return (OsUtil::Success);
+}
+
+bool CommandJournal::read (CommandJournal::Entry *destEntry) {
+	uint8_t header[CommandJournal::EntryHeaderSize];
+	char *data;
+	int64_t t;
+	int i, len;
+
+	if ((! isReading) || (! file)) {
+		return (false);
+	}
+	if (fread (header, 1, sizeof (header), file) != sizeof (header)) {
+		return (false);
+	}
+	t = 0;
+	for (i = 0; i < 8; ++i) {
+		t = (t << 8) | header[i];
+	}
+	len = (int) (((uint32_t) header[9] << 24) | ((uint32_t) header[10] << 16) | ((uint32_t) header[11] << 8) | (uint32_t) header[12]);
+	if ((len < 0) || (len > CommandJournal::MaxRecordSize)) {
+		Log::err ("Failed to read command journal; path=\"%s\" err=\"Invalid record length %i\"", path.c_str (), len);
+		return (false);
+	}
+	data = (char *) malloc (len + 1);
+	if (! data) {
+		return (false);
+	}
+	if (fread (data, 1, len, file) != (size_t) len) {
+		Log::err ("Failed to read command journal; path=\"%s\" err=\"Truncated record\"", path.c_str ());
+		free (data);
+		return (false);
+	}
+	destEntry->receiveTime = t;
+	destEntry->format = (int) header[8];
+	destEntry->record.assign (data, len);
+	free (data);
+	++entryCount;
+	byteCount += (int64_t) sizeof (header) + len;
+	return (true);
+}
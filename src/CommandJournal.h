@@ -0,0 +1,85 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that records received command records to a journal file and reads them back for replay
+
+#ifndef COMMAND_JOURNAL_H
+#define COMMAND_JOURNAL_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "StdString.h"
+#include "OsUtil.h"
+
+class CommandJournal {
+public:
+	CommandJournal ();
+	~CommandJournal ();
+
+	static const char *FileHeader;
+	static const int EntryHeaderSize;
+	static const int MaxRecordSize;
+
+	struct Entry {
+		int64_t receiveTime;
+		int format;
+		StdString record;
+		Entry ():
+			receiveTime (0),
+			format (0) { }
+	};
+
+	// Read-only data members
+	StdString path;
+	bool isWriting;
+	bool isReading;
+	int64_t entryCount;
+	int64_t byteCount;
+
+	// Create the journal file at the specified path and prepare it for writing entries. Returns a Result value.
+	OsUtil::Result openWrite (const StdString &filePath);
+
+	// Open the journal file at the specified path and prepare it for reading entries. Returns a Result value.
+	OsUtil::Result openRead (const StdString &filePath);
+
+	// Flush any buffered entries and close the journal file
+	void close ();
+
+	// Write an entry containing a command record, stamped with its receive time in microseconds since the journal was opened. Returns a Result value.
+	OsUtil::Result write (int format, const char *record, int recordLength);
+
+	// Read the next entry from the journal and store it in destEntry. Returns a boolean value indicating if an entry was found.
+	bool read (CommandJournal::Entry *destEntry);
+
+private:
+	FILE *file;
+	uint64_t openCounter;
+};
+
+#endif
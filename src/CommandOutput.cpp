@@ -0,0 +1,463 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <list>
+#if PLATFORM_LINUX || PLATFORM_MACOS
+#include <sys/uio.h>
+#endif
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "Log.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+#include "Json.h"
+#include "JsonWriter.h"
+#include "SystemInterface.h"
+#include "CommandReader.h"
+#include "CommandInput.h"
+#include "CommandOutput.h"
+
+const int CommandOutput::MaxPendingSize = (4 * 1024 * 1024); // bytes
+
+// The createTime value used to locate the position of the field in encoded result templates. SystemInterface stores createTime as a double, which encodes as a fixed-width MessagePack float64 and, holding an integer, as plain digits in JSON.
+static const int64_t TemplateCreateTime = 0x5A5A5A5A5A5ALL;
+static const int MaxWriteVectors = 64;
+
+CommandOutput::CommandOutput ()
+: isStarted (false)
+, isStopped (false)
+, resultCount (0)
+, templateResultCount (0)
+, flushCount (0)
+, writeCount (0)
+, bytesWritten (0)
+, discardCount (0)
+, cycleBuffer (NULL)
+, pendingSize (0)
+, isWriteFailed (false)
+, outputFd (-1)
+, writeThread (NULL)
+, writeMutex (NULL)
+, writeCond (NULL)
+{
+	cycleBuffer = new Buffer ();
+	writeMutex = SDL_CreateMutex ();
+	writeCond = SDL_CreateCond ();
+}
+
+CommandOutput::~CommandOutput () {
+	std::list<Buffer *>::iterator i, end;
+
+	stop ();
+	i = writeList.begin ();
+	end = writeList.end ();
+	while (i != end) {
+		delete (*i);
+		++i;
+	}
+	writeList.clear ();
+	i = freeList.begin ();
+	end = freeList.end ();
+	while (i != end) {
+		delete (*i);
+		++i;
+	}
+	freeList.clear ();
+	if (cycleBuffer) {
+		delete (cycleBuffer);
+		cycleBuffer = NULL;
+	}
+	if (writeCond) {
+		SDL_DestroyCond (writeCond);
+		writeCond = NULL;
+	}
+	if (writeMutex) {
+		SDL_DestroyMutex (writeMutex);
+		writeMutex = NULL;
+	}
+}
+
+OsUtil::Result CommandOutput::start (int fd) {
+	if (isStarted) {
+		return (OsUtil::Success);
+	}
+	if (! CommandOutput::createResultTemplate (CommandReader::JsonFormat, &jsonTemplate)) {
+		Log::warning ("Failed to create CommandResult template; format=json");
+	}
+	if (! CommandOutput::createResultTemplate (CommandReader::MsgPackFormat, &msgPackTemplate)) {
+		Log::warning ("Failed to create CommandResult template; format=msgpack");
+	}
+
+	outputFd = fd;
+	isStopped = false;
+	isWriteFailed = false;
+	writeThread = SDL_CreateThread (CommandOutput::runWriteThread, "runCommandOutputThread", (void *) this);
+	if (! writeThread) {
+		Log::err ("Command output start failed; err=\"thread create failed\"");
+		return (OsUtil::ThreadCreateFailedError);
+	}
+	isStarted = true;
+	return (OsUtil::Success);
+}
+
+void CommandOutput::stop () {
+	int result;
+
+	if ((! isStarted) || isStopped) {
+		return;
+	}
+	flush ();
+	SDL_LockMutex (writeMutex);
+	isStopped = true;
+	SDL_CondSignal (writeCond);
+	SDL_UnlockMutex (writeMutex);
+	if (writeThread) {
+		SDL_WaitThread (writeThread, &result);
+		writeThread = NULL;
+	}
+	isStarted = false;
+}
+
+void CommandOutput::appendCommandResult (Buffer *destBuffer, int format, bool success, const StdString &errorMessage) {
+	CommandOutput::ResultTemplate *t;
+	SystemInterface::Prefix prefix;
+	Json *cmd, *params;
+	uint8_t digits[32];
+	double d;
+	uint64_t bits;
+	int64_t now;
+	int i;
+
+	++resultCount;
+	now = OsUtil::getTime ();
+	t = (format == CommandReader::MsgPackFormat) ? &msgPackTemplate : &jsonTemplate;
+	if (errorMessage.empty () && t->isReady) {
+		destBuffer->add (t->head.data, t->head.length);
+		if (format == CommandReader::MsgPackFormat) {
+			d = (double) now;
+			memcpy (&bits, &d, sizeof (bits));
+			for (i = 7; i >= 0; --i) {
+				digits[i] = (uint8_t) (bits & 0xFF);
+				bits >>= 8;
+			}
+			destBuffer->add (digits, 8);
+			destBuffer->add (t->middle.data, t->middle.length);
+			digits[0] = success ? 0xC3 : 0xC2;
+			destBuffer->add (digits, 1);
+		}
+		else {
+			destBuffer->add (digits, JsonWriter::formatNumber ((double) now, (char *) digits));
+			destBuffer->add (t->middle.data, t->middle.length);
+			destBuffer->add (success ? "true" : "false");
+		}
+		if (t->tail.length > 0) {
+			destBuffer->add (t->tail.data, t->tail.length);
+		}
+		++templateResultCount;
+		return;
+	}
+
+	prefix.createTime = now;
+	params = new Json ();
+	params->set ("success", success);
+	if (! errorMessage.empty ()) {
+		params->set ("error", errorMessage);
+	}
+	cmd = SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_CommandResult, params);
+	if (! cmd) {
+		return;
+	}
+	CommandInput::appendRecord (destBuffer, cmd, format);
+	delete (cmd);
+}
+
+void CommandOutput::addCommandResult (int format, bool success, const StdString &errorMessage) {
+	if (format != CommandReader::MsgPackFormat) {
+		// JSON results on the primary output keep the timestamp prefix written by Log::printf
+		cycleBuffer->add ("[");
+		cycleBuffer->add (OsUtil::getTimestampString (OsUtil::getTime (), true).c_str ());
+		cycleBuffer->add ("] ");
+	}
+	appendCommandResult (cycleBuffer, format, success, errorMessage);
+}
+
+void CommandOutput::flush () {
+	int length, pendingsize;
+	bool discard, iswritefailed;
+
+	length = cycleBuffer->length;
+	if (length <= 0) {
+		return;
+	}
+	discard = false;
+	SDL_LockMutex (writeMutex);
+	pendingsize = pendingSize;
+	iswritefailed = isWriteFailed;
+	if ((! isStarted) || isStopped || isWriteFailed || ((pendingSize + length) > CommandOutput::MaxPendingSize)) {
+		discard = true;
+		++discardCount;
+	}
+	else {
+		writeList.push_back (cycleBuffer);
+		pendingSize += length;
+		if (freeList.empty ()) {
+			cycleBuffer = new Buffer ();
+		}
+		else {
+			cycleBuffer = freeList.front ();
+			freeList.pop_front ();
+		}
+		++flushCount;
+		SDL_CondSignal (writeCond);
+	}
+	SDL_UnlockMutex (writeMutex);
+
+	if (discard) {
+		Log::warning ("Discard command output; length=%i pendingSize=%i isWriteFailed=%s", length, pendingsize, BOOL_STRING (iswritefailed));
+		cycleBuffer->setDataLength (0);
+	}
+}
+
+StdString CommandOutput::toString () {
+	return (StdString::createSprintf ("resultCount=%lli templateResultCount=%lli flushCount=%lli writeCount=%lli bytesWritten=%lli discardCount=%lli", (long long) resultCount, (long long) templateResultCount, (long long) flushCount, (long long) writeCount, (long long) bytesWritten, (long long) discardCount));
+}
+
+int CommandOutput::runWriteThread (void *commandOutputPtr) {
+	((CommandOutput *) commandOutputPtr)->runWriteLoop ();
+	return (0);
+}
+
+void CommandOutput::runWriteLoop () {
+	Buffer *buffers[MaxWriteVectors];
+	int i, count;
+	bool iswritefailed;
+
+	while (true) {
+		SDL_LockMutex (writeMutex);
+		while (writeList.empty () && (! isStopped)) {
+			SDL_CondWait (writeCond, writeMutex);
+		}
+		if (writeList.empty ()) {
+			SDL_UnlockMutex (writeMutex);
+			break;
+		}
+		count = 0;
+		while ((! writeList.empty ()) && (count < MaxWriteVectors)) {
+			buffers[count] = writeList.front ();
+			writeList.pop_front ();
+			++count;
+		}
+		iswritefailed = isWriteFailed;
+		SDL_UnlockMutex (writeMutex);
+
+		if (! iswritefailed) {
+			// Log messages written to stdout before this point must not appear after or inside the records being written
+			Log::flushStdout ();
+			if (! writeBuffers (buffers, count)) {
+				iswritefailed = true;
+			}
+		}
+
+		SDL_LockMutex (writeMutex);
+		isWriteFailed = iswritefailed;
+		for (i = 0; i < count; ++i) {
+			pendingSize -= buffers[i]->length;
+			buffers[i]->setDataLength (0);
+			freeList.push_back (buffers[i]);
+		}
+		SDL_UnlockMutex (writeMutex);
+	}
+}
+
+bool CommandOutput::writeBuffers (Buffer **buffers, int bufferCount) {
+#if PLATFORM_LINUX || PLATFORM_MACOS
+	struct iovec iov[MaxWriteVectors];
+	int i, j, offset, count, len;
+	ssize_t result;
+
+	i = 0;
+	offset = 0;
+	while ((i < bufferCount) && (offset >= buffers[i]->length)) {
+		++i;
+	}
+	while (i < bufferCount) {
+		count = 0;
+		for (j = i; (j < bufferCount) && (count < MaxWriteVectors); ++j) {
+			len = buffers[j]->length - ((j == i) ? offset : 0);
+			if (len > 0) {
+				iov[count].iov_base = buffers[j]->data + (buffers[j]->length - len);
+				iov[count].iov_len = (size_t) len;
+				++count;
+			}
+		}
+		result = writev (outputFd, iov, count);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			Log::err ("Failed to write command output; err=\"writev: %s\"", strerror (errno));
+			return (false);
+		}
+		++writeCount;
+		bytesWritten += result;
+
+		while ((result > 0) && (i < bufferCount)) {
+			len = buffers[i]->length - offset;
+			if (result >= len) {
+				result -= len;
+				++i;
+				offset = 0;
+			}
+			else {
+				offset += (int) result;
+				result = 0;
+			}
+		}
+		while ((i < bufferCount) && (offset >= buffers[i]->length)) {
+			++i;
+			offset = 0;
+		}
+	}
+	return (true);
+#else
+	int i;
+
+	for (i = 0; i < bufferCount; ++i) {
+		if (buffers[i]->length > 0) {
+			if (fwrite (buffers[i]->data, 1, buffers[i]->length, stdout) != (size_t) buffers[i]->length) {
+				return (false);
+			}
+			++writeCount;
+			bytesWritten += buffers[i]->length;
+		}
+	}
+	fflush (stdout);
+	return (true);
+#endif
+}
+
+bool CommandOutput::createResultTemplate (int format, CommandOutput::ResultTemplate *destTemplate) {
+	SystemInterface::Prefix prefix;
+	Json *cmd, *params;
+	Buffer record;
+	StdString s;
+	uint8_t pattern[32];
+	double d;
+	uint64_t bits;
+	int i, timepos, timelen, successpos, successlen, pos;
+
+	destTemplate->isReady = false;
+	prefix.createTime = TemplateCreateTime;
+	params = new Json ();
+	params->set ("success", true);
+	cmd = SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_CommandResult, params);
+	if (! cmd) {
+		return (false);
+	}
+	CommandInput::appendRecord (&record, cmd, format);
+	delete (cmd);
+	if (record.length <= 0) {
+		return (false);
+	}
+
+	if (format == CommandReader::MsgPackFormat) {
+		pattern[0] = 0xCB;
+		d = (double) TemplateCreateTime;
+		memcpy (&bits, &d, sizeof (bits));
+		for (i = 8; i >= 1; --i) {
+			pattern[i] = (uint8_t) (bits & 0xFF);
+			bits >>= 8;
+		}
+		timepos = CommandOutput::findData (record.data, record.length, pattern, 9);
+		if (timepos < 0) {
+			return (false);
+		}
+		timepos += 1;
+		timelen = 8;
+
+		pattern[0] = 0xA7;
+		memcpy (pattern + 1, "success", 7);
+		pattern[8] = 0xC3;
+		pos = timepos + timelen;
+		successpos = CommandOutput::findData (record.data + pos, record.length - pos, pattern, 9);
+		if (successpos < 0) {
+			return (false);
+		}
+		successpos += pos + 8;
+		successlen = 1;
+	}
+	else {
+		s.assign ((char *) pattern, JsonWriter::formatNumber ((double) TemplateCreateTime, (char *) pattern));
+		timepos = CommandOutput::findData (record.data, record.length, (const uint8_t *) s.c_str (), (int) s.length ());
+		if (timepos < 0) {
+			return (false);
+		}
+		timelen = (int) s.length ();
+
+		s.assign ("\"success\":true");
+		pos = timepos + timelen;
+		successpos = CommandOutput::findData (record.data + pos, record.length - pos, (const uint8_t *) s.c_str (), (int) s.length ());
+		if (successpos < 0) {
+			return (false);
+		}
+		successpos += pos + (int) s.length () - 4;
+		successlen = 4;
+	}
+
+	destTemplate->head.setDataLength (0);
+	destTemplate->middle.setDataLength (0);
+	destTemplate->tail.setDataLength (0);
+	destTemplate->head.add (record.data, timepos);
+	destTemplate->middle.add (record.data + timepos + timelen, successpos - (timepos + timelen));
+	pos = successpos + successlen;
+	if (pos < record.length) {
+		destTemplate->tail.add (record.data + pos, record.length - pos);
+	}
+	destTemplate->isReady = true;
+	return (true);
+}
+
+int CommandOutput::findData (const uint8_t *data, int dataLength, const uint8_t *pattern, int patternLength) {
+	int i;
+
+	if ((patternLength <= 0) || (dataLength < patternLength)) {
+		return (-1);
+	}
+	for (i = 0; i <= (dataLength - patternLength); ++i) {
+		if ((data[i] == pattern[0]) && (memcmp (data + i, pattern, patternLength) == 0)) {
+			return (i);
+		}
+	}
+	return (-1);
+}
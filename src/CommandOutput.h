@@ -0,0 +1,115 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that writes encoded command results to an output descriptor from a background thread, batching all results from each update cycle into a single write
+
+#ifndef COMMAND_OUTPUT_H
+#define COMMAND_OUTPUT_H
+
+#include <stdint.h>
+#include <list>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+
+class CommandOutput {
+public:
+	CommandOutput ();
+	~CommandOutput ();
+
+	static const int MaxPendingSize;
+
+	// Read-only data members
+	bool isStarted;
+	bool isStopped;
+	int64_t resultCount;
+	int64_t templateResultCount;
+	int64_t flushCount;
+	int64_t writeCount;
+	int64_t bytesWritten;
+	int64_t discardCount;
+
+	// Prepare CommandResult templates and begin writing flushed output to the specified file descriptor. Returns a Result value.
+	OsUtil::Result start (int fd);
+
+	// Stop the output thread, blocking until all flushed output has been written
+	void stop ();
+
+	// Append an encoded CommandResult record to destBuffer, using the specified CommandReader format. If errorMessage is empty, the record is copied from a pre-serialized template with its createTime and success values patched in.
+	void appendCommandResult (Buffer *destBuffer, int format, bool success, const StdString &errorMessage);
+
+	// Add an encoded CommandResult record to the output buffer for the current update cycle, preceded by a log timestamp prefix if format is CommandReader::JsonFormat
+	void addCommandResult (int format, bool success, const StdString &errorMessage);
+
+	// Pass all output added since the last flush to the output thread for writing. Data written to the output descriptor by the output thread does not block the caller.
+	void flush ();
+
+	// Return a string containing the output's counter values, suitable for use in a log message
+	StdString toString ();
+
+private:
+	// A CommandResult record split around the values that change between results
+	struct ResultTemplate {
+		Buffer head;
+		Buffer middle;
+		Buffer tail;
+		bool isReady;
+		ResultTemplate (): isReady (false) { }
+	};
+
+	// Run a thread that writes buffers from writeList to the output descriptor
+	static int runWriteThread (void *commandOutputPtr);
+
+	// Execute the write thread loop
+	void runWriteLoop ();
+
+	// Write all data from the provided buffers to outputFd, using as few system calls as possible. Returns a boolean value indicating if the write succeeded.
+	bool writeBuffers (Buffer **buffers, int bufferCount);
+
+	// Encode a CommandResult in the specified format and store it in destTemplate. Returns a boolean value indicating if the template was created.
+	static bool createResultTemplate (int format, CommandOutput::ResultTemplate *destTemplate);
+
+	// Return the position of pattern in data, or -1 if the pattern was not found
+	static int findData (const uint8_t *data, int dataLength, const uint8_t *pattern, int patternLength);
+
+	CommandOutput::ResultTemplate jsonTemplate;
+	CommandOutput::ResultTemplate msgPackTemplate;
+	Buffer *cycleBuffer;
+	std::list<Buffer *> writeList;
+	std::list<Buffer *> freeList;
+	int pendingSize;
+	bool isWriteFailed; // Accessed only while holding writeMutex
+	int outputFd;
+	SDL_Thread *writeThread;
+	SDL_mutex *writeMutex;
+	SDL_cond *writeCond;
+};
+
+#endif
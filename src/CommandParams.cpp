@@ -0,0 +1,1109 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+* contributors may be used to endorse or promote products derived from this
+* software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <string.h>
+#include "SystemInterface.h"
+#include "CommandParams.h"
+
+const char *CommandParams::version = "25-stable-71094b9f";
+
+static constexpr CommandParams::Field AnimationCommandFields[] = {
+  { "executeTime", 11 },
+  { "command", 7 },
+};
+static constexpr CommandParams::Field AnimationOverrideFields[] = {
+  { "windowId", 8 },
+  { "labelText", 9 },
+};
+static constexpr CommandParams::Field CommandResultFields[] = {
+  { "success", 7 },
+  { "error", 5 },
+  { "itemId", 6 },
+  { "item", 4 },
+  { "taskId", 6 },
+  { "stringResult", 12 },
+};
+static constexpr CommandParams::Field ExecuteBatchFields[] = {
+  { "commands", 8 },
+};
+static constexpr CommandParams::Field PlayAnimationFields[] = {
+  { "commands", 8 },
+  { "loopCount", 9 },
+  { "loopForever", 11 },
+  { "loopDuration", 12 },
+};
+static constexpr CommandParams::Field RemoveWindowFields[] = {
+  { "windowId", 8 },
+};
+static constexpr CommandParams::Field ShowColorFillBackgroundFields[] = {
+  { "fillColorR", 10 },
+  { "fillColorG", 10 },
+  { "fillColorB", 10 },
+};
+static constexpr CommandParams::Field ShowCountdownWindowFields[] = {
+  { "windowId", 8 },
+  { "icon", 4 },
+  { "positionX", 9 },
+  { "positionY", 9 },
+  { "labelText", 9 },
+  { "countdownTime", 13 },
+};
+static constexpr CommandParams::Field ShowFileImageBackgroundFields[] = {
+  { "imagePath", 9 },
+  { "background", 10 },
+};
+static constexpr CommandParams::Field ShowIconLabelWindowFields[] = {
+  { "windowId", 8 },
+  { "icon", 4 },
+  { "positionX", 9 },
+  { "positionY", 9 },
+  { "labelText", 9 },
+};
+static constexpr CommandParams::Field ShowResourceImageBackgroundFields[] = {
+  { "imagePath", 9 },
+};
+static constexpr CommandParams::Field StartAnimationFields[] = {
+  { "name", 4 },
+  { "overrides", 9 },
+};
+static constexpr CommandParams::Field StoreAnimationFields[] = {
+  { "name", 4 },
+  { "commands", 8 },
+  { "loopCount", 9 },
+  { "loopForever", 11 },
+  { "loopDuration", 12 },
+};
+
+int CommandParams::findField (const CommandParams::Field *fields, int fieldCount, const char *name, unsigned int nameLength) {
+  int i;
+
+  for (i = 0; i < fieldCount; ++i) {
+    if ((fields[i].nameLength == nameLength) && (memcmp (fields[i].name, name, nameLength) == 0)) {
+      return (i);
+    }
+  }
+  return (-1);
+}
+
+json_value *CommandParams::findValue (json_value *object, const char *name) {
+  unsigned int i, len;
+
+  if ((! object) || (object->type != json_object)) {
+    return (NULL);
+  }
+  len = strlen (name);
+  for (i = 0; i < object->u.object.length; ++i) {
+    if ((object->u.object.values[i].name_length == len) && (memcmp (object->u.object.values[i].name, name, len) == 0)) {
+      return (object->u.object.values[i].value);
+    }
+  }
+  return (NULL);
+}
+
+bool CommandParams::setTypeError (StdString *errorMessage, const char *fieldName, const char *typeName) {
+  errorMessage->sprintf ("Parameter field \"%s\" has incorrect type (expecting %s)", fieldName, typeName);
+  return (false);
+}
+
+bool CommandParams::validateCommand (json_value *command, StdString *errorMessage) {
+  json_value *value;
+  int64_t id;
+
+  value = CommandParams::findValue (command, "command");
+  if (value && (value->type == json_integer)) {
+    id = value->u.integer;
+  }
+  else if (value && (value->type == json_double)) {
+    id = (int64_t) value->u.dbl;
+  }
+  else {
+    errorMessage->assign ("Command is missing its ID field");
+    return (false);
+  }
+  switch (id) {
+    case SystemInterface::CommandId_CommandResult: {
+      CommandResultParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_GetStatus: {
+      EmptyObjectParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_EndSet: {
+      EmptyObjectParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ShowColorFillBackground: {
+      ShowColorFillBackgroundParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ClearCache: {
+      EmptyObjectParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ShowResourceImageBackground: {
+      ShowResourceImageBackgroundParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ShowFileImageBackground: {
+      ShowFileImageBackgroundParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_PlayAnimation: {
+      PlayAnimationParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ShowIconLabelWindow: {
+      ShowIconLabelWindowParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_RemoveWindow: {
+      RemoveWindowParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ShowCountdownWindow: {
+      ShowCountdownWindowParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_ExecuteBatch: {
+      ExecuteBatchParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_StoreAnimation: {
+      StoreAnimationParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_StartAnimation: {
+      StartAnimationParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+    case SystemInterface::CommandId_StopAnimation: {
+      EmptyObjectParams params;
+      return (params.decodeFields (CommandParams::findValue (command, "params"), errorMessage));
+    }
+  }
+  errorMessage->sprintf ("Unknown command ID %lli", (long long) id);
+  return (false);
+}
+
+bool AnimationCommandParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool AnimationCommandParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (AnimationCommandFields, 2, entry->name, entry->name_length)) {
+      case 0: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "executeTime", "number"));
+        }
+        executeTime = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if (executeTime < 0) {
+          errorMessage->assign ("Parameter field \"executeTime\" must be a number greater than or equal to zero");
+          return (false);
+        }
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if (value->type != json_object) {
+          return (CommandParams::setTypeError (errorMessage, "command", "object"));
+        }
+        if (! CommandParams::validateCommand (value, errorMessage)) {
+          return (false);
+        }
+        command.assignView (value);
+        found |= 0x2;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    executeTime = 0;
+  }
+  if (! (found & 0x2)) {
+    errorMessage->assign ("Missing required parameter field \"command\"");
+    return (false);
+  }
+  return (true);
+}
+
+bool AnimationOverrideParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool AnimationOverrideParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (AnimationOverrideFields, 2, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "windowId", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"windowId\" cannot contain an empty string");
+          return (false);
+        }
+        windowId.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "labelText", "string"));
+        }
+        labelText.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x2;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"windowId\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    labelText.assign ("");
+  }
+  return (true);
+}
+
+bool CommandResultParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool CommandResultParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (CommandResultFields, 6, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_boolean) {
+          return (CommandParams::setTypeError (errorMessage, "success", "boolean"));
+        }
+        success = value->u.boolean ? true : false;
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "error", "string"));
+        }
+        error.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x2;
+        break;
+      }
+      case 2: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "itemId", "string"));
+        }
+        if ((value->u.string.length > 0) && (! SystemInterface::isUuid (value->u.string.ptr, value->u.string.length))) {
+          errorMessage->assign ("Parameter field \"itemId\" must contain a UUID string");
+          return (false);
+        }
+        itemId.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x4;
+        break;
+      }
+      case 3: {
+        if (value->type != json_object) {
+          return (CommandParams::setTypeError (errorMessage, "item", "object"));
+        }
+        if (! CommandParams::validateCommand (value, errorMessage)) {
+          return (false);
+        }
+        item.assignView (value);
+        found |= 0x8;
+        break;
+      }
+      case 4: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "taskId", "string"));
+        }
+        if ((value->u.string.length > 0) && (! SystemInterface::isUuid (value->u.string.ptr, value->u.string.length))) {
+          errorMessage->assign ("Parameter field \"taskId\" must contain a UUID string");
+          return (false);
+        }
+        taskId.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x10;
+        break;
+      }
+      case 5: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "stringResult", "string"));
+        }
+        stringResult.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x20;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"success\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    error.assign ("");
+  }
+  if (! (found & 0x4)) {
+    itemId.assign ("");
+  }
+  if (! (found & 0x8)) {
+    item.unassign ();
+  }
+  if (! (found & 0x10)) {
+    taskId.assign ("");
+  }
+  if (! (found & 0x20)) {
+    stringResult.assign ("");
+  }
+  return (true);
+}
+
+bool EmptyObjectParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool EmptyObjectParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  return (true);
+}
+
+bool ExecuteBatchParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool ExecuteBatchParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  unsigned int j;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (ExecuteBatchFields, 1, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_array) {
+          return (CommandParams::setTypeError (errorMessage, "commands", "array"));
+        }
+        if (value->u.array.length <= 0) {
+          errorMessage->assign ("Parameter field \"commands\" cannot contain an empty array");
+          return (false);
+        }
+        commands.resize (value->u.array.length);
+        for (j = 0; j < value->u.array.length; ++j) {
+          if (value->u.array.values[j]->type != json_object) {
+            return (CommandParams::setTypeError (errorMessage, "commands", "object array"));
+          }
+          if (! CommandParams::validateCommand (value->u.array.values[j], errorMessage)) {
+            return (false);
+          }
+          commands[j].assignView (value->u.array.values[j]);
+        }
+        found |= 0x1;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"commands\"");
+    return (false);
+  }
+  return (true);
+}
+
+bool PlayAnimationParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool PlayAnimationParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  unsigned int j;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (PlayAnimationFields, 4, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_array) {
+          return (CommandParams::setTypeError (errorMessage, "commands", "array"));
+        }
+        commands.resize (value->u.array.length);
+        for (j = 0; j < value->u.array.length; ++j) {
+          if (! commands[j].decodeFields (value->u.array.values[j], errorMessage)) {
+            return (false);
+          }
+        }
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "loopCount", "number"));
+        }
+        loopCount = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if (loopCount <= 0) {
+          errorMessage->assign ("Parameter field \"loopCount\" must be a number greater than zero");
+          return (false);
+        }
+        found |= 0x2;
+        break;
+      }
+      case 2: {
+        if (value->type != json_boolean) {
+          return (CommandParams::setTypeError (errorMessage, "loopForever", "boolean"));
+        }
+        loopForever = value->u.boolean ? true : false;
+        found |= 0x4;
+        break;
+      }
+      case 3: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "loopDuration", "number"));
+        }
+        loopDuration = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if (loopDuration < 0) {
+          errorMessage->assign ("Parameter field \"loopDuration\" must be a number greater than or equal to zero");
+          return (false);
+        }
+        found |= 0x8;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"commands\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    loopCount = 1;
+  }
+  if (! (found & 0x4)) {
+    loopForever = false;
+  }
+  if (! (found & 0x8)) {
+    loopDuration = 0;
+  }
+  return (true);
+}
+
+bool RemoveWindowParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool RemoveWindowParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (RemoveWindowFields, 1, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "windowId", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"windowId\" cannot contain an empty string");
+          return (false);
+        }
+        windowId.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"windowId\"");
+    return (false);
+  }
+  return (true);
+}
+
+bool ShowColorFillBackgroundParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool ShowColorFillBackgroundParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (ShowColorFillBackgroundFields, 3, entry->name, entry->name_length)) {
+      case 0: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "fillColorR", "number"));
+        }
+        fillColorR = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if ((fillColorR < 0) || (fillColorR > 255)) {
+          errorMessage->assign ("Parameter field \"fillColorR\" must be a number in the range [0..255]");
+          return (false);
+        }
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "fillColorG", "number"));
+        }
+        fillColorG = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if ((fillColorG < 0) || (fillColorG > 255)) {
+          errorMessage->assign ("Parameter field \"fillColorG\" must be a number in the range [0..255]");
+          return (false);
+        }
+        found |= 0x2;
+        break;
+      }
+      case 2: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "fillColorB", "number"));
+        }
+        fillColorB = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if ((fillColorB < 0) || (fillColorB > 255)) {
+          errorMessage->assign ("Parameter field \"fillColorB\" must be a number in the range [0..255]");
+          return (false);
+        }
+        found |= 0x4;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"fillColorR\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    errorMessage->assign ("Missing required parameter field \"fillColorG\"");
+    return (false);
+  }
+  if (! (found & 0x4)) {
+    errorMessage->assign ("Missing required parameter field \"fillColorB\"");
+    return (false);
+  }
+  return (true);
+}
+
+bool ShowCountdownWindowParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool ShowCountdownWindowParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (ShowCountdownWindowFields, 6, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "windowId", "string"));
+        }
+        windowId.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "icon", "number"));
+        }
+        icon = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x2;
+        break;
+      }
+      case 2: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "positionX", "number"));
+        }
+        positionX = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x4;
+        break;
+      }
+      case 3: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "positionY", "number"));
+        }
+        positionY = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x8;
+        break;
+      }
+      case 4: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "labelText", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"labelText\" cannot contain an empty string");
+          return (false);
+        }
+        labelText.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x10;
+        break;
+      }
+      case 5: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "countdownTime", "number"));
+        }
+        countdownTime = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x20;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    windowId.assign ("");
+  }
+  if (! (found & 0x2)) {
+    icon = 0;
+  }
+  if (! (found & 0x4)) {
+    errorMessage->assign ("Missing required parameter field \"positionX\"");
+    return (false);
+  }
+  if (! (found & 0x8)) {
+    errorMessage->assign ("Missing required parameter field \"positionY\"");
+    return (false);
+  }
+  if (! (found & 0x10)) {
+    errorMessage->assign ("Missing required parameter field \"labelText\"");
+    return (false);
+  }
+  if (! (found & 0x20)) {
+    countdownTime = 20000;
+  }
+  return (true);
+}
+
+bool ShowFileImageBackgroundParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool ShowFileImageBackgroundParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (ShowFileImageBackgroundFields, 2, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "imagePath", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"imagePath\" cannot contain an empty string");
+          return (false);
+        }
+        imagePath.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "background", "number"));
+        }
+        background = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x2;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"imagePath\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    background = 0;
+  }
+  return (true);
+}
+
+bool ShowIconLabelWindowParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool ShowIconLabelWindowParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (ShowIconLabelWindowFields, 5, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "windowId", "string"));
+        }
+        windowId.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "icon", "number"));
+        }
+        icon = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x2;
+        break;
+      }
+      case 2: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "positionX", "number"));
+        }
+        positionX = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x4;
+        break;
+      }
+      case 3: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "positionY", "number"));
+        }
+        positionY = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        found |= 0x8;
+        break;
+      }
+      case 4: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "labelText", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"labelText\" cannot contain an empty string");
+          return (false);
+        }
+        labelText.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x10;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    windowId.assign ("");
+  }
+  if (! (found & 0x2)) {
+    icon = 0;
+  }
+  if (! (found & 0x4)) {
+    errorMessage->assign ("Missing required parameter field \"positionX\"");
+    return (false);
+  }
+  if (! (found & 0x8)) {
+    errorMessage->assign ("Missing required parameter field \"positionY\"");
+    return (false);
+  }
+  if (! (found & 0x10)) {
+    errorMessage->assign ("Missing required parameter field \"labelText\"");
+    return (false);
+  }
+  return (true);
+}
+
+bool ShowResourceImageBackgroundParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool ShowResourceImageBackgroundParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (ShowResourceImageBackgroundFields, 1, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "imagePath", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"imagePath\" cannot contain an empty string");
+          return (false);
+        }
+        imagePath.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"imagePath\"");
+    return (false);
+  }
+  return (true);
+}
+
+bool StartAnimationParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool StartAnimationParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  unsigned int j;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (StartAnimationFields, 2, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "name", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"name\" cannot contain an empty string");
+          return (false);
+        }
+        name.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if (value->type != json_array) {
+          return (CommandParams::setTypeError (errorMessage, "overrides", "array"));
+        }
+        overrides.resize (value->u.array.length);
+        for (j = 0; j < value->u.array.length; ++j) {
+          if (! overrides[j].decodeFields (value->u.array.values[j], errorMessage)) {
+            return (false);
+          }
+        }
+        found |= 0x2;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"name\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    overrides.clear ();
+  }
+  return (true);
+}
+
+bool StoreAnimationParams::decode (Json *cmdInv, StdString *errorMessage) {
+  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), "params"), errorMessage));
+}
+
+bool StoreAnimationParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {
+  json_object_entry *entry;
+  json_value *value;
+  unsigned int i;
+  unsigned int j;
+  int found;
+
+  if ((! paramsValue) || (paramsValue->type != json_object)) {
+    errorMessage->assign ("Missing or invalid params object");
+    return (false);
+  }
+  found = 0;
+  for (i = 0; i < paramsValue->u.object.length; ++i) {
+    entry = &(paramsValue->u.object.values[i]);
+    value = entry->value;
+    switch (CommandParams::findField (StoreAnimationFields, 5, entry->name, entry->name_length)) {
+      case 0: {
+        if (value->type != json_string) {
+          return (CommandParams::setTypeError (errorMessage, "name", "string"));
+        }
+        if (value->u.string.length <= 0) {
+          errorMessage->assign ("Parameter field \"name\" cannot contain an empty string");
+          return (false);
+        }
+        name.assign (value->u.string.ptr, value->u.string.length);
+        found |= 0x1;
+        break;
+      }
+      case 1: {
+        if (value->type != json_array) {
+          return (CommandParams::setTypeError (errorMessage, "commands", "array"));
+        }
+        commands.resize (value->u.array.length);
+        for (j = 0; j < value->u.array.length; ++j) {
+          if (! commands[j].decodeFields (value->u.array.values[j], errorMessage)) {
+            return (false);
+          }
+        }
+        found |= 0x2;
+        break;
+      }
+      case 2: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "loopCount", "number"));
+        }
+        loopCount = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if (loopCount <= 0) {
+          errorMessage->assign ("Parameter field \"loopCount\" must be a number greater than zero");
+          return (false);
+        }
+        found |= 0x4;
+        break;
+      }
+      case 3: {
+        if (value->type != json_boolean) {
+          return (CommandParams::setTypeError (errorMessage, "loopForever", "boolean"));
+        }
+        loopForever = value->u.boolean ? true : false;
+        found |= 0x8;
+        break;
+      }
+      case 4: {
+        if ((value->type != json_integer) && (value->type != json_double)) {
+          return (CommandParams::setTypeError (errorMessage, "loopDuration", "number"));
+        }
+        loopDuration = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;
+        if (loopDuration < 0) {
+          errorMessage->assign ("Parameter field \"loopDuration\" must be a number greater than or equal to zero");
+          return (false);
+        }
+        found |= 0x10;
+        break;
+      }
+    }
+  }
+  if (! (found & 0x1)) {
+    errorMessage->assign ("Missing required parameter field \"name\"");
+    return (false);
+  }
+  if (! (found & 0x2)) {
+    errorMessage->assign ("Missing required parameter field \"commands\"");
+    return (false);
+  }
+  if (! (found & 0x4)) {
+    loopCount = 1;
+  }
+  if (! (found & 0x8)) {
+    loopForever = false;
+  }
+  if (! (found & 0x10)) {
+    loopDuration = 0;
+  }
+  return (true);
+}
@@ -0,0 +1,183 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+* contributors may be used to endorse or promote products derived from this
+* software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Structs holding typed command params, generated from SystemInterface definitions by generate-command-params (do not edit). Each struct's decode method stores and validates fields from the params object of a command, or decodeFields from a params object value, replacing all struct values and returning false with errorMessage set if a field was invalid.
+
+#ifndef COMMAND_PARAMS_H
+#define COMMAND_PARAMS_H
+
+#include <vector>
+#include "StdString.h"
+#include "Json.h"
+
+class CommandParams {
+public:
+  static const char *version;
+  struct Field {
+    const char *name;
+    unsigned int nameLength;
+  };
+
+  // Return the index of the item in fields with a name matching the provided value, or -1 if no such item was found
+  static int findField (const CommandParams::Field *fields, int fieldCount, const char *name, unsigned int nameLength);
+
+  // Return the named item from a json object value, or NULL if no such item was found
+  static json_value *findValue (json_value *object, const char *name);
+
+  // Return a boolean value indicating if the provided value holds a command with a known ID and valid params fields. If not, errorMessage is set.
+  static bool validateCommand (json_value *command, StdString *errorMessage);
+
+  // Set errorMessage to indicate that the named field holds the wrong type and return false
+  static bool setTypeError (StdString *errorMessage, const char *fieldName, const char *typeName);
+};
+
+struct AnimationCommandParams {
+  double executeTime;
+  Json command;
+  AnimationCommandParams (): executeTime (0), command () { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct AnimationOverrideParams {
+  StdString windowId;
+  StdString labelText;
+  AnimationOverrideParams (): windowId (""), labelText ("") { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct CommandResultParams {
+  bool success;
+  StdString error;
+  StdString itemId;
+  Json item;
+  StdString taskId;
+  StdString stringResult;
+  CommandResultParams (): success (false), error (""), itemId (""), item (), taskId (""), stringResult ("") { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct EmptyObjectParams {
+  EmptyObjectParams () { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct ExecuteBatchParams {
+  std::vector<Json> commands;
+  ExecuteBatchParams (): commands () { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct PlayAnimationParams {
+  std::vector<AnimationCommandParams> commands;
+  double loopCount;
+  bool loopForever;
+  double loopDuration;
+  PlayAnimationParams (): commands (), loopCount (1), loopForever (false), loopDuration (0) { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct RemoveWindowParams {
+  StdString windowId;
+  RemoveWindowParams (): windowId ("") { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct ShowColorFillBackgroundParams {
+  double fillColorR;
+  double fillColorG;
+  double fillColorB;
+  ShowColorFillBackgroundParams (): fillColorR (0), fillColorG (0), fillColorB (0) { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct ShowCountdownWindowParams {
+  StdString windowId;
+  double icon;
+  double positionX;
+  double positionY;
+  StdString labelText;
+  double countdownTime;
+  ShowCountdownWindowParams (): windowId (""), icon (0), positionX (0), positionY (0), labelText (""), countdownTime (20000) { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct ShowFileImageBackgroundParams {
+  StdString imagePath;
+  double background;
+  ShowFileImageBackgroundParams (): imagePath (""), background (0) { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct ShowIconLabelWindowParams {
+  StdString windowId;
+  double icon;
+  double positionX;
+  double positionY;
+  StdString labelText;
+  ShowIconLabelWindowParams (): windowId (""), icon (0), positionX (0), positionY (0), labelText ("") { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct ShowResourceImageBackgroundParams {
+  StdString imagePath;
+  ShowResourceImageBackgroundParams (): imagePath ("") { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct StartAnimationParams {
+  StdString name;
+  std::vector<AnimationOverrideParams> overrides;
+  StartAnimationParams (): name (""), overrides () { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+
+struct StoreAnimationParams {
+  StdString name;
+  std::vector<AnimationCommandParams> commands;
+  double loopCount;
+  bool loopForever;
+  double loopDuration;
+  StoreAnimationParams (): name (""), commands (), loopCount (1), loopForever (false), loopDuration (0) { }
+  bool decode (Json *cmdInv, StdString *errorMessage);
+  bool decodeFields (json_value *paramsValue, StdString *errorMessage);
+};
+#endif
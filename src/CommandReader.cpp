@@ -0,0 +1,251 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "StdString.h"
+#include "Log.h"
+#include "Buffer.h"
+#include "CommandReader.h"
+
+const uint8_t CommandReader::MsgPackHandshakeByte = 0xC1;
+const int CommandReader::LengthPrefixSize = 4; // bytes
+const int CommandReader::ReadSize = 8192; // bytes
+
+CommandReader::CommandReader (int maxRecordSize)
+: format (CommandReader::JsonFormat)
+, isFormatHandshakeEnabled (false)
+, maxRecordSize (maxRecordSize)
+, bytesRead (0)
+, readCount (0)
+, partialReadCount (0)
+, frameCount (0)
+, discardCount (0)
+, readPosition (0)
+, scanPosition (0)
+, isDiscarding (false)
+, discardLength (0)
+, isReadPending (false)
+, isHandshakeChecked (false)
+{
+
+}
+
+CommandReader::~CommandReader () {
+
+}
+
+StdString CommandReader::getFormatName (int formatValue) {
+	switch (formatValue) {
+		case CommandReader::JsonFormat: {
+			return (StdString ("json"));
+		}
+		case CommandReader::MsgPackFormat: {
+			return (StdString ("msgpack"));
+		}
+	}
+	return (StdString (""));
+}
+
+int CommandReader::getFormat (const StdString &formatName) {
+	StdString s;
+
+	s = formatName.lowercased ();
+	if (s.equals ("json")) {
+		return (CommandReader::JsonFormat);
+	}
+	if (s.equals ("msgpack")) {
+		return (CommandReader::MsgPackFormat);
+	}
+	return (-1);
+}
+
+void CommandReader::addData (uint8_t *dataPtr, int dataLength) {
+	if (dataLength <= 0) {
+		return;
+	}
+	if (readPosition > 0) {
+		buffer.advanceRead (readPosition);
+		scanPosition -= readPosition;
+		readPosition = 0;
+	}
+	buffer.add (dataPtr, dataLength);
+	bytesRead += dataLength;
+	++readCount;
+	isReadPending = true;
+}
+
+int CommandReader::readFd (int fd) {
+	char buf[CommandReader::ReadSize];
+	int len;
+
+	len = read (fd, buf, sizeof (buf));
+	if (len > 0) {
+		addData ((uint8_t *) buf, len);
+	}
+	return (len);
+}
+
+bool CommandReader::readRecord (StdString *destString) {
+	bool result;
+
+	if ((! isHandshakeChecked) && (buffer.length > readPosition)) {
+		isHandshakeChecked = true;
+		if (isFormatHandshakeEnabled && (buffer.data[readPosition] == CommandReader::MsgPackHandshakeByte)) {
+			format = CommandReader::MsgPackFormat;
+			++readPosition;
+			scanPosition = readPosition;
+		}
+	}
+
+	if (format == CommandReader::MsgPackFormat) {
+		result = readLengthPrefixRecord (destString);
+	}
+	else {
+		result = readLineRecord (destString);
+	}
+	if (result) {
+		++frameCount;
+		return (true);
+	}
+
+	if (isReadPending) {
+		isReadPending = false;
+		if (hasPartialRecord ()) {
+			++partialReadCount;
+		}
+	}
+	if (readPosition >= buffer.length) {
+		buffer.setDataLength (0);
+		readPosition = 0;
+		scanPosition = 0;
+	}
+	return (false);
+}
+
+bool CommandReader::readLineRecord (StdString *destString) {
+	uint8_t *pos;
+	int start, len;
+
+	while (scanPosition < buffer.length) {
+		pos = (uint8_t *) memchr (buffer.data + scanPosition, '\n', buffer.length - scanPosition);
+		if (! pos) {
+			scanPosition = buffer.length;
+			if ((! isDiscarding) && ((buffer.length - readPosition) > maxRecordSize)) {
+				Log::warning ("Discard oversized command record; length=%i maxRecordSize=%i", buffer.length - readPosition, maxRecordSize);
+				isDiscarding = true;
+				++discardCount;
+			}
+			if (isDiscarding) {
+				readPosition = buffer.length;
+			}
+			break;
+		}
+
+		start = readPosition;
+		len = (int) (pos - (buffer.data + start));
+		readPosition = (int) (pos - buffer.data) + 1;
+		scanPosition = readPosition;
+		if (isDiscarding) {
+			isDiscarding = false;
+			continue;
+		}
+		if ((len > 0) && (buffer.data[start + len - 1] == '\r')) {
+			--len;
+		}
+		if (len <= 0) {
+			continue;
+		}
+		if (len > maxRecordSize) {
+			Log::warning ("Discard oversized command record; length=%i maxRecordSize=%i", len, maxRecordSize);
+			++discardCount;
+			continue;
+		}
+
+		destString->assign ((char *) (buffer.data + start), len);
+		return (true);
+	}
+	return (false);
+}
+
+bool CommandReader::readLengthPrefixRecord (StdString *destString) {
+	uint8_t *d;
+	int64_t len;
+	int avail;
+
+	while (true) {
+		avail = buffer.length - readPosition;
+		if (discardLength > 0) {
+			if (avail <= 0) {
+				break;
+			}
+			len = (discardLength < avail) ? discardLength : avail;
+			readPosition += (int) len;
+			discardLength -= len;
+			continue;
+		}
+		if (avail < CommandReader::LengthPrefixSize) {
+			break;
+		}
+
+		d = buffer.data + readPosition;
+		len = ((int64_t) d[0] << 24) | ((int64_t) d[1] << 16) | ((int64_t) d[2] << 8) | (int64_t) d[3];
+		if (len > maxRecordSize) {
+			Log::warning ("Discard oversized command record; length=%lli maxRecordSize=%i", (long long) len, maxRecordSize);
+			++discardCount;
+			readPosition += CommandReader::LengthPrefixSize;
+			discardLength = len;
+			continue;
+		}
+		if ((avail - CommandReader::LengthPrefixSize) < len) {
+			break;
+		}
+
+		readPosition += CommandReader::LengthPrefixSize;
+		if (len <= 0) {
+			continue;
+		}
+		destString->assign ((char *) (buffer.data + readPosition), (size_t) len);
+		readPosition += (int) len;
+		scanPosition = readPosition;
+		return (true);
+	}
+	scanPosition = readPosition;
+	return (false);
+}
+
+bool CommandReader::hasPartialRecord () const {
+	return (buffer.length > readPosition);
+}
+
+StdString CommandReader::toString () {
+	return (StdString::createSprintf ("format=%s bytesRead=%lli readCount=%lli partialReadCount=%lli frameCount=%lli discardCount=%lli", CommandReader::getFormatName (format).c_str (), (long long) bytesRead, (long long) readCount, (long long) partialReadCount, (long long) frameCount, (long long) discardCount));
+}
@@ -0,0 +1,119 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Object that splits a byte stream into command records, delimited by newlines for JSON or by length prefixes for MessagePack
+
+#ifndef COMMAND_READER_H
+#define COMMAND_READER_H
+
+#include <stdint.h>
+#include "StdString.h"
+#include "Buffer.h"
+
+class CommandReader {
+public:
+	CommandReader (int maxRecordSize);
+	~CommandReader ();
+
+	// Record formats
+	enum {
+		JsonFormat = 0,
+		MsgPackFormat = 1
+	};
+
+	// A byte value that, if received as the first byte of the stream, switches the reader to MsgPackFormat. The value is never used in MessagePack data and cannot begin a JSON record.
+	static const uint8_t MsgPackHandshakeByte;
+
+	// The size of the big-endian length field preceding each MsgPackFormat record
+	static const int LengthPrefixSize;
+
+	// Read-write data members
+	int format;
+	bool isFormatHandshakeEnabled;
+
+	// Read-only data members
+	int maxRecordSize;
+	int64_t bytesRead;
+	int64_t readCount;
+	int64_t partialReadCount;
+	int64_t frameCount;
+	int64_t discardCount;
+
+	// Add data received from the input stream
+	void addData (uint8_t *dataPtr, int dataLength);
+
+	// Read data from the specified file descriptor and return the number of bytes added, or a value less than or equal to zero if the read failed or reached end of file
+	int readFd (int fd);
+
+	// Find the next complete record in received data and assign its content to destString. Returns a boolean value indicating if a record was found.
+	bool readRecord (StdString *destString);
+
+	// Return a string containing the name of the specified format
+	static StdString getFormatName (int formatValue);
+
+	// Return the format value matching the provided name, or -1 if no format matched
+	static int getFormat (const StdString &formatName);
+
+	// Return a boolean value indicating if the reader holds received data that has not yet formed a complete record
+	bool hasPartialRecord () const;
+
+	// Return a string containing the reader's counter values, suitable for use in a log message
+	StdString toString ();
+
+private:
+	static const int ReadSize;
+
+	Buffer buffer;
+
+	// The buffer position of the first byte not yet returned as part of a record
+	int readPosition;
+
+	// The buffer position of the first byte not yet checked for a record delimiter
+	int scanPosition;
+
+	// A flag indicating that an oversized record is being dropped until its delimiter arrives
+	bool isDiscarding;
+
+	// The number of bytes remaining in an oversized MsgPackFormat record being dropped
+	int64_t discardLength;
+
+	// A flag indicating that data has been added since the last time readRecord found no complete record
+	bool isReadPending;
+
+	// A flag indicating that the first byte of the stream has been checked for MsgPackHandshakeByte
+	bool isHandshakeChecked;
+
+	// Find the next newline-delimited record. Returns a boolean value indicating if a record was found.
+	bool readLineRecord (StdString *destString);
+
+	// Find the next length-prefixed record. Returns a boolean value indicating if a record was found.
+	bool readLengthPrefixRecord (StdString *destString);
+};
+
+#endif
@@ -45,7 +45,7 @@ CountdownWindow::CountdownWindow (Sprite *iconSprite, const StdString &labelText
 , image (NULL)
 , progressBar (NULL)
 , countdownTime (0)
-, countdownClock (0)
+, countdownClock (0.0f)
 {
 	setFillBg (true, UiConfiguration::instance->lightBackgroundColor);
 	setBorder (true, UiConfiguration::instance->mediumInverseBackgroundColor);
@@ -77,14 +77,14 @@ void CountdownWindow::countdown (int duration) {
 	progressBar->setProgress (0.0f, (float) countdownTime);
 }
 
-void CountdownWindow::doUpdate (int msElapsed) {
+void CountdownWindow::doUpdate (float msElapsed) {
 	Panel::doUpdate (msElapsed);
-	if (countdownClock > 0) {
+	if (countdownClock > 0.0f) {
 		countdownClock -= msElapsed;
-		if (countdownClock < 0) {
-			countdownClock = 0;
+		if (countdownClock < 0.0f) {
+			countdownClock = 0.0f;
 		}
-		progressBar->setProgress ((float) (countdownTime - countdownClock));
+		progressBar->setProgress (((float) countdownTime) - countdownClock);
 	}
 }
 
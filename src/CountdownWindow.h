@@ -57,14 +57,14 @@ protected:
 	void refreshLayout ();
 
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	void doUpdate (int msElapsed);
+	void doUpdate (float msElapsed);
 
 private:
 	Label *label;
 	Image *image;
 	ProgressBar *progressBar;
 	int countdownTime;
-	int countdownClock;
+	float countdownClock;
 };
 
 #endif
@@ -0,0 +1,308 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <vector>
+#include <stack>
+#include "SDL2/SDL.h"
+#include "Scene.h"
+#include "DrawList.h"
+
+DrawList::DrawList ()
+: isTextureTarget (false)
+, serial (0)
+, isFullDamage (false)
+, targetWidth (0)
+, targetHeight (0)
+{
+	clipRect.x = 0;
+	clipRect.y = 0;
+	clipRect.w = 0;
+	clipRect.h = 0;
+}
+
+DrawList::~DrawList () {
+
+}
+
+void DrawList::reset (int targetWidth, int targetHeight) {
+	commandList.clear ();
+	while (! clipRectStack.empty ()) {
+		clipRectStack.pop ();
+	}
+	this->targetWidth = targetWidth;
+	this->targetHeight = targetHeight;
+	clipRect.x = 0;
+	clipRect.y = 0;
+	clipRect.w = targetWidth;
+	clipRect.h = targetHeight;
+}
+
+void DrawList::clearDamage () {
+	damageRectList.clear ();
+	isFullDamage = false;
+}
+
+void DrawList::addDamage (const std::vector<SDL_Rect> &rects, bool isFull) {
+	std::vector<SDL_Rect>::iterator i, end;
+	SDL_Rect rect, result;
+
+	if (isFullDamage) {
+		return;
+	}
+	if (isFull) {
+		isFullDamage = true;
+		damageRectList.clear ();
+		return;
+	}
+	damageRectList.insert (damageRectList.end (), rects.begin (), rects.end ());
+	if ((int) damageRectList.size () > Scene::MaxDamageRectCount) {
+		i = damageRectList.begin ();
+		end = damageRectList.end ();
+		rect = *i;
+		++i;
+		while (i != end) {
+			SDL_UnionRect (&rect, &(*i), &result);
+			rect = result;
+			++i;
+		}
+		damageRectList.clear ();
+		damageRectList.push_back (rect);
+	}
+}
+
+void DrawList::pushClipRect (const SDL_Rect *rect, bool disableIntersection) {
+	int x, y, w, h, diff;
+
+	x = rect->x;
+	y = rect->y;
+	w = rect->w;
+	h = rect->h;
+	if ((! clipRectStack.empty ()) && (! disableIntersection)) {
+		diff = x - clipRect.x;
+		if (diff < 0) {
+			w += diff;
+			x = clipRect.x;
+		}
+		diff = y - clipRect.y;
+		if (diff < 0) {
+			h += diff;
+			y = clipRect.y;
+		}
+		diff = (x + w) - (clipRect.x + clipRect.w);
+		if (diff > 0) {
+			w -= diff;
+		}
+		diff = (y + h) - (clipRect.y + clipRect.h);
+		if (diff > 0) {
+			h -= diff;
+		}
+
+		if (w < 0) {
+			w = 0;
+		}
+		if (h < 0) {
+			h = 0;
+		}
+	}
+
+	clipRect.x = x;
+	clipRect.y = y;
+	clipRect.w = w;
+	clipRect.h = h;
+	clipRectStack.push (clipRect);
+}
+
+void DrawList::popClipRect () {
+	if (clipRectStack.empty ()) {
+		return;
+	}
+
+	clipRectStack.pop ();
+	if (clipRectStack.empty ()) {
+		clipRect.x = 0;
+		clipRect.y = 0;
+		clipRect.w = targetWidth;
+		clipRect.h = targetHeight;
+	}
+	else {
+		clipRect = clipRectStack.top ();
+	}
+}
+
+void DrawList::addCommand (DrawList::Command *command) {
+	command->isClipped = (! clipRectStack.empty ());
+	if (command->isClipped) {
+		command->clipRect = clipRect;
+	}
+	commandList.push_back (*command);
+}
+
+void DrawList::fillRect (const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	DrawList::Command command;
+
+	command.type = DrawList::FillRectCommand;
+	command.rect = *rect;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	addCommand (&command);
+}
+
+void DrawList::drawLine (int x1, int y1, int x2, int y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	DrawList::Command command;
+
+	command.type = DrawList::DrawLineCommand;
+	command.rect.x = x1;
+	command.rect.y = y1;
+	command.rect.w = x2;
+	command.rect.h = y2;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	addCommand (&command);
+}
+
+void DrawList::copyTexture (SDL_Texture *texture, const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool isTextureBlendEnabled) {
+	DrawList::Command command;
+
+	if (! texture) {
+		return;
+	}
+	command.type = DrawList::CopyTextureCommand;
+	command.texture = texture;
+	command.rect = *rect;
+	command.r = r;
+	command.g = g;
+	command.b = b;
+	command.a = a;
+	command.isTextureBlendEnabled = isTextureBlendEnabled;
+	addCommand (&command);
+}
+
+int DrawList::getCommandCount () {
+	return ((int) commandList.size ());
+}
+
+void DrawList::execute (SDL_Renderer *render, const SDL_Rect *damageRect) {
+	std::vector<DrawList::Command>::iterator i, end;
+	DrawList::Command *command;
+	SDL_Rect bounds, clip, activeclip;
+	SDL_BlendMode blendmode, activeblendmode;
+	bool isclipped, isactiveclipped;
+
+	isactiveclipped = false;
+	activeclip.x = 0;
+	activeclip.y = 0;
+	activeclip.w = 0;
+	activeclip.h = 0;
+	activeblendmode = SDL_BLENDMODE_NONE;
+	SDL_RenderSetClipRect (render, NULL);
+	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
+	i = commandList.begin ();
+	end = commandList.end ();
+	while (i != end) {
+		command = &(*i);
+		++i;
+
+		if (command->type == DrawList::DrawLineCommand) {
+			bounds.x = (command->rect.x < command->rect.w) ? command->rect.x : command->rect.w;
+			bounds.y = (command->rect.y < command->rect.h) ? command->rect.y : command->rect.h;
+			bounds.w = abs (command->rect.w - command->rect.x) + 1;
+			bounds.h = abs (command->rect.h - command->rect.y) + 1;
+		}
+		else {
+			bounds = command->rect;
+		}
+
+		// Commands entirely outside the effective clip region are skipped, so that a small damage region replays only the commands that reach it
+		isclipped = false;
+		if (command->isClipped) {
+			clip = command->clipRect;
+			if (damageRect && (! SDL_IntersectRect (&clip, damageRect, &clip))) {
+				continue;
+			}
+			isclipped = true;
+		}
+		else if (damageRect) {
+			clip = *damageRect;
+			isclipped = true;
+		}
+		if (isclipped && (! SDL_HasIntersection (&bounds, &clip))) {
+			continue;
+		}
+
+		if (isclipped != isactiveclipped) {
+			SDL_RenderSetClipRect (render, isclipped ? &clip : NULL);
+			isactiveclipped = isclipped;
+			activeclip = clip;
+		}
+		else if (isclipped && ((clip.x != activeclip.x) || (clip.y != activeclip.y) || (clip.w != activeclip.w) || (clip.h != activeclip.h))) {
+			SDL_RenderSetClipRect (render, &clip);
+			activeclip = clip;
+		}
+
+		switch (command->type) {
+			case DrawList::FillRectCommand:
+			case DrawList::DrawLineCommand: {
+				blendmode = (command->a < 255) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE;
+				if (blendmode != activeblendmode) {
+					SDL_SetRenderDrawBlendMode (render, blendmode);
+					activeblendmode = blendmode;
+				}
+				SDL_SetRenderDrawColor (render, command->r, command->g, command->b, command->a);
+				if (command->type == DrawList::FillRectCommand) {
+					SDL_RenderFillRect (render, &(command->rect));
+				}
+				else {
+					SDL_RenderDrawLine (render, command->rect.x, command->rect.y, command->rect.w, command->rect.h);
+				}
+				break;
+			}
+			case DrawList::CopyTextureCommand: {
+				SDL_SetTextureColorMod (command->texture, command->r, command->g, command->b);
+				SDL_SetTextureAlphaMod (command->texture, command->a);
+				if (command->isTextureBlendEnabled) {
+					SDL_SetTextureBlendMode (command->texture, SDL_BLENDMODE_BLEND);
+				}
+				SDL_RenderCopy (render, command->texture, NULL, &(command->rect));
+				break;
+			}
+		}
+	}
+
+	SDL_RenderSetClipRect (render, NULL);
+	if (activeblendmode != SDL_BLENDMODE_NONE) {
+		SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
+	}
+	SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
+}
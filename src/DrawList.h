@@ -0,0 +1,120 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that holds a flat list of draw commands recorded from the widget tree, for execution on the application's main thread
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <stdint.h>
+#include <vector>
+#include <stack>
+#include "SDL2/SDL.h"
+
+class DrawList {
+public:
+	DrawList ();
+	~DrawList ();
+
+	// Command type values
+	enum {
+		FillRectCommand = 0,
+		DrawLineCommand = 1,
+		CopyTextureCommand = 2
+	};
+
+	struct Command {
+		int type;
+		SDL_Rect rect; // For DrawLineCommand, holds the line start point in x and y and the line end point in w and h
+		SDL_Rect clipRect;
+		bool isClipped;
+		SDL_Texture *texture;
+		Uint8 r, g, b, a; // Draw color, or texture color and alpha modulation
+		bool isTextureBlendEnabled;
+		Command ():
+			type (DrawList::FillRectCommand),
+			isClipped (false),
+			texture (NULL),
+			r (0),
+			g (0),
+			b (0),
+			a (255),
+			isTextureBlendEnabled (false) { }
+	};
+
+	// Read-write data members
+	bool isTextureTarget; // Set if the list is recorded for a widget's own render texture rather than the application scene
+	int64_t serial; // Increases each time the application records a scene draw list, to be used when releasing textures
+	std::vector<SDL_Rect> damageRectList;
+	bool isFullDamage;
+
+	// Read-only data members
+	SDL_Rect clipRect; // The active clip rectangle, or the full target area if the clip stack is empty
+	int targetWidth;
+	int targetHeight;
+
+	// Remove all commands and clip rectangles and prepare to record commands for a target of the specified size. Damage rectangles and the full damage flag are not modified.
+	void reset (int targetWidth, int targetHeight);
+
+	// Remove all damage rectangles and clear the full damage flag
+	void clearDamage ();
+
+	// Add the provided damage rectangles to the list's damage region, or mark the full target as damaged if isFull is true
+	void addDamage (const std::vector<SDL_Rect> &rects, bool isFull);
+
+	// Push the provided rectangle onto the clip stack, applying it to subsequently added commands. Apply the new clip rectangle as an intersection of any existing clip rectangle unless disableIntersection is true.
+	void pushClipRect (const SDL_Rect *rect, bool disableIntersection = false);
+
+	// Pop the clip stack
+	void popClipRect ();
+
+	// Add a command that fills rect with the specified color, blending if the color's alpha value is less than 255
+	void fillRect (const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+
+	// Add a command that draws a line with the specified color
+	void drawLine (int x1, int y1, int x2, int y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+
+	// Add a command that copies texture to rect with the specified color and alpha modulation, optionally setting the texture to blend mode first
+	void copyTexture (SDL_Texture *texture, const SDL_Rect *rect, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255, bool isTextureBlendEnabled = false);
+
+	// Return the number of commands in the list
+	int getCommandCount ();
+
+	// Execute the list's commands with the current render target. If damageRect is not NULL, skip commands that fall outside it and clip drawing to it.
+	void execute (SDL_Renderer *render, const SDL_Rect *damageRect = NULL);
+
+private:
+	// Set fields in command for the active clip rectangle and add it to the command list
+	void addCommand (DrawList::Command *command);
+
+	std::vector<DrawList::Command> commandList;
+	std::stack<SDL_Rect> clipRectStack;
+};
+
+#endif
@@ -42,10 +42,13 @@
 #include "StdString.h"
 #include "Resource.h"
 #include "Buffer.h"
+#include "TaskGroup.h"
 #include "Font.h"
 
 const char *Font::GlyphCharacters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_=+[]{}\\\"';:,.<>/?!@#$%^&*()|";
 const StdString Font::DotTruncateSuffix = StdString ("...");
+const int Font::GlyphGrainSize = 16;
+SDL_SpinLock Font::faceLock = 0;
 
 Font::Font (FT_Library freetype, const StdString &name)
 : name (name)
@@ -61,7 +64,9 @@ Font::Font (FT_Library freetype, const StdString &name)
 Font::~Font () {
 	clearGlyphMap ();
 	if (isLoaded) {
+		SDL_AtomicLock (&Font::faceLock);
 		FT_Done_Face (face);
+		SDL_AtomicUnlock (&Font::faceLock);
 		isLoaded = false;
 	}
 }
@@ -83,15 +88,17 @@ void Font::clearGlyphMap () {
 
 OsUtil::Result Font::load (Buffer *fontData, int pointSize) {
 	Font::Glyph glyph;
-	FT_GlyphSlot slot;
+	Font::RasterizeContext ctx;
+	Font::GlyphBitmap *bitmap;
 	SDL_Surface *surface;
-	char *s, c;
-	int result, charindex, x, y, w, h, pitch, maxw, maxtopbearing;
-	uint8_t *row, *bitmap, alpha;
-	Uint32 *pixels, *dest, color, rmask, gmask, bmask, amask;
+	char c;
+	int result, glyphcount, glyphindex, h, maxw, maxtopbearing;
+	Uint32 rmask, gmask, bmask, amask;
 	std::map<char, Font::Glyph>::iterator i, end;
 
+	SDL_AtomicLock (&Font::faceLock);
 	result = FT_New_Memory_Face (freetype, (FT_Byte *) fontData->data, fontData->length, 0, &face);
+	SDL_AtomicUnlock (&Font::faceLock);
 	if (result != 0) {
 		Log::err ("Failed to load font; name=\"%s\" err=\"FT_New_Memory_Face: %i\"", name.c_str (), result);
 		return (OsUtil::FreetypeOperationFailedError);
@@ -102,99 +109,73 @@ OsUtil::Result Font::load (Buffer *fontData, int pointSize) {
 		return (OsUtil::FreetypeOperationFailedError);
 	}
 
-	maxw = 0;
-	maxtopbearing = 0;
-	s = (char *) Font::GlyphCharacters;
-	while (1) {
-		c = *s;
-		if (c == 0) {
-			break;
-		}
-		++s;
-
-		charindex = FT_Get_Char_Index (face, c);
-		result = FT_Load_Glyph (face, charindex, FT_LOAD_RENDER);
-		if (result != 0) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"FT_Load_Glyph: %i\"", name.c_str (), c, result);
-			continue;
-		}
-
-		slot = face->glyph;
-		w = slot->bitmap.width;
-		h = slot->bitmap.rows;
-		if ((w <= 0) || (h <= 0)) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Invalid bitmap dimensions %ix%i\"", name.c_str (), c, w, h);
-			continue;
-		}
-
-		pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
-		if (! pixels) {
-			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Out of memory, bitmap dimensions %ix%i\"", name.c_str (), c, w, h);
-			continue;
-		}
+	// Glyph bitmaps are rendered on task threads, each range with its own face, and textures are then created from the results on this thread
+	glyphcount = (int) strlen (Font::GlyphCharacters);
+	ctx.font = this;
+	ctx.fontData = fontData;
+	ctx.pointSize = pointSize;
+	ctx.bitmaps = new Font::GlyphBitmap[glyphcount];
+	if (TaskGroup::instance) {
+		TaskGroup::instance->parallelFor (glyphcount, Font::GlyphGrainSize, Font::rasterizeGlyphs, &ctx);
+	}
+	else {
+		Font::rasterizeGlyphs (&ctx, 0, glyphcount);
+	}
 
-		dest = pixels;
-		row = (uint8_t *) slot->bitmap.buffer;
-		pitch = slot->bitmap.pitch;
-		y = 0;
-		while (y < h) {
-			bitmap = row;
-			x = 0;
-			while (x < w) {
-				alpha = *bitmap;
-				++bitmap;
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-				color = 0xFFFFFF00 | (alpha & 0xFF);
+	rmask = 0xFF000000;
+	gmask = 0x00FF0000;
+	bmask = 0x0000FF00;
+	amask = 0x000000FF;
 #else
-				color = 0x00FFFFFF | (((Uint32) (alpha & 0xFF)) << 24);
+	rmask = 0x000000FF;
+	gmask = 0x0000FF00;
+	bmask = 0x00FF0000;
+	amask = 0xFF000000;
 #endif
-				*dest = color;
-				++dest;
-				++x;
-			}
-			row += pitch;
-			++y;
+	maxw = 0;
+	maxtopbearing = 0;
+	for (glyphindex = 0; glyphindex < glyphcount; ++glyphindex) {
+		c = Font::GlyphCharacters[glyphindex];
+		bitmap = &(ctx.bitmaps[glyphindex]);
+		if (! bitmap->pixels) {
+			continue;
 		}
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-		rmask = 0xFF000000;
-		gmask = 0x00FF0000;
-		bmask = 0x0000FF00;
-		amask = 0x000000FF;
-#else
-		rmask = 0x000000FF;
-		gmask = 0x0000FF00;
-		bmask = 0x00FF0000;
-		amask = 0xFF000000;
-#endif
-		surface = SDL_CreateRGBSurfaceFrom (pixels, w, h, 32, w * sizeof (Uint32), rmask, gmask, bmask, amask);
+
+		surface = SDL_CreateRGBSurfaceFrom (bitmap->pixels, bitmap->width, bitmap->height, 32, bitmap->width * sizeof (Uint32), rmask, gmask, bmask, amask);
 		if (! surface) {
 			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"SDL_CreateRGBSurfaceFrom, %s\"", name.c_str (), c, SDL_GetError ());
-			free (pixels);
 			continue;
 		}
 
 		glyph.texturePath.sprintf ("*_Font_%s_%i_%i", name.c_str (), pointSize, (int) c);
 		glyph.texture = App::instance->resource.createTexture (glyph.texturePath, surface);
 		SDL_FreeSurface (surface);
-		free (pixels);
 		if (! glyph.texture) {
 			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"SDL_CreateTextureFromSurface, %s\"", name.c_str (), c, SDL_GetError ());
 			continue;
 		}
 
-		glyph.width = w;
-		glyph.height = h;
-		glyph.leftBearing = (int) slot->bitmap_left;
-		glyph.topBearing = (int) slot->bitmap_top;
-		glyph.advanceWidth = (int) ((FT_CeilFix (slot->linearHoriAdvance) >> 16) & 0xFFFF);
+		glyph.width = bitmap->width;
+		glyph.height = bitmap->height;
+		glyph.leftBearing = bitmap->leftBearing;
+		glyph.topBearing = bitmap->topBearing;
+		glyph.advanceWidth = bitmap->advanceWidth;
 		glyphMap.insert (std::pair<char, Font::Glyph> (c, glyph));
-		if (w > maxw) {
-			maxw = w;
+		if (glyph.width > maxw) {
+			maxw = glyph.width;
 		}
 		if ((maxtopbearing <= 0) || (glyph.topBearing > maxtopbearing)) {
 			maxtopbearing = glyph.topBearing;
 		}
 	}
+	for (glyphindex = 0; glyphindex < glyphcount; ++glyphindex) {
+		if (ctx.bitmaps[glyphindex].pixels) {
+			free (ctx.bitmaps[glyphindex].pixels);
+		}
+	}
+	delete[] (ctx.bitmaps);
+
 	if (face->face_flags & FT_FACE_FLAG_FIXED_WIDTH) {
 		spaceWidth = maxw;
 	}
@@ -223,6 +204,93 @@ OsUtil::Result Font::load (Buffer *fontData, int pointSize) {
 	return (OsUtil::Success);
 }
 
+void Font::rasterizeGlyphs (void *contextPtr, int rangeStart, int rangeEnd) {
+	Font::RasterizeContext *ctx;
+	Font::GlyphBitmap *glyphbitmap;
+	FT_Face rangeface;
+	FT_GlyphSlot slot;
+	char c;
+	int result, glyphindex, charindex, x, y, w, h, pitch;
+	uint8_t *row, *bitmap, alpha;
+	Uint32 *pixels, *dest, color;
+
+	ctx = (Font::RasterizeContext *) contextPtr;
+	SDL_AtomicLock (&Font::faceLock);
+	result = FT_New_Memory_Face (ctx->font->freetype, (FT_Byte *) ctx->fontData->data, ctx->fontData->length, 0, &rangeface);
+	SDL_AtomicUnlock (&Font::faceLock);
+	if (result != 0) {
+		Log::warning ("Failed to load font characters; name=\"%s\" err=\"FT_New_Memory_Face: %i\"", ctx->font->name.c_str (), result);
+		return;
+	}
+	result = FT_Set_Char_Size (rangeface, ctx->pointSize << 6, 0, 100, 0);
+	if (result != 0) {
+		Log::warning ("Failed to load font characters; name=\"%s\" err=\"FT_Set_Char_Size: %i\"", ctx->font->name.c_str (), result);
+		SDL_AtomicLock (&Font::faceLock);
+		FT_Done_Face (rangeface);
+		SDL_AtomicUnlock (&Font::faceLock);
+		return;
+	}
+
+	for (glyphindex = rangeStart; glyphindex < rangeEnd; ++glyphindex) {
+		c = Font::GlyphCharacters[glyphindex];
+		charindex = FT_Get_Char_Index (rangeface, c);
+		result = FT_Load_Glyph (rangeface, charindex, FT_LOAD_RENDER);
+		if (result != 0) {
+			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"FT_Load_Glyph: %i\"", ctx->font->name.c_str (), c, result);
+			continue;
+		}
+
+		slot = rangeface->glyph;
+		w = slot->bitmap.width;
+		h = slot->bitmap.rows;
+		if ((w <= 0) || (h <= 0)) {
+			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Invalid bitmap dimensions %ix%i\"", ctx->font->name.c_str (), c, w, h);
+			continue;
+		}
+
+		pixels = (Uint32 *) malloc (w * h * sizeof (Uint32));
+		if (! pixels) {
+			Log::warning ("Failed to load font character; name=\"%s\" index=\"%c\" err=\"Out of memory, bitmap dimensions %ix%i\"", ctx->font->name.c_str (), c, w, h);
+			continue;
+		}
+
+		dest = pixels;
+		row = (uint8_t *) slot->bitmap.buffer;
+		pitch = slot->bitmap.pitch;
+		y = 0;
+		while (y < h) {
+			bitmap = row;
+			x = 0;
+			while (x < w) {
+				alpha = *bitmap;
+				++bitmap;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+				color = 0xFFFFFF00 | (alpha & 0xFF);
+#else
+				color = 0x00FFFFFF | (((Uint32) (alpha & 0xFF)) << 24);
+#endif
+				*dest = color;
+				++dest;
+				++x;
+			}
+			row += pitch;
+			++y;
+		}
+
+		glyphbitmap = &(ctx->bitmaps[glyphindex]);
+		glyphbitmap->pixels = pixels;
+		glyphbitmap->width = w;
+		glyphbitmap->height = h;
+		glyphbitmap->leftBearing = (int) slot->bitmap_left;
+		glyphbitmap->topBearing = (int) slot->bitmap_top;
+		glyphbitmap->advanceWidth = (int) ((FT_CeilFix (slot->linearHoriAdvance) >> 16) & 0xFFFF);
+	}
+
+	SDL_AtomicLock (&Font::faceLock);
+	FT_Done_Face (rangeface);
+	SDL_AtomicUnlock (&Font::faceLock);
+}
+
 Font::Glyph *Font::getGlyph (char glyphCharacter) {
 	std::map<char, Font::Glyph>::iterator i;
 
@@ -101,9 +101,44 @@ public:
 	StdString truncatedText (const StdString &text, float maxWidth, const StdString &truncateSuffix = StdString (""));
 
 private:
+	// The number of glyph characters rendered by each range of a parallel load
+	static const int GlyphGrainSize;
+
+	struct GlyphBitmap {
+		Uint32 *pixels;
+		int width, height;
+		int leftBearing;
+		int topBearing;
+		int advanceWidth;
+		GlyphBitmap ():
+			pixels (NULL),
+			width (0),
+			height (0),
+			leftBearing (0),
+			topBearing (0),
+			advanceWidth (0) { }
+	};
+	struct RasterizeContext {
+		Font *font;
+		Buffer *fontData;
+		int pointSize;
+		Font::GlyphBitmap *bitmaps;
+		RasterizeContext ():
+			font (NULL),
+			fontData (NULL),
+			pointSize (0),
+			bitmaps (NULL) { }
+	};
+
 	// Remove all items from the glyph map
 	void clearGlyphMap ();
 
+	// Render bitmaps for the specified range of GlyphCharacters indexes and store them in a RasterizeContext
+	static void rasterizeGlyphs (void *contextPtr, int rangeStart, int rangeEnd);
+
+	// Lock held while creating or destroying a face, since those operations modify the shared freetype library object
+	static SDL_SpinLock faceLock;
+
 	FT_Library freetype;
 	FT_Face face;
 	bool isLoaded;
@@ -0,0 +1,108 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include "OsUtil.h"
+#include "FramePacer.h"
+
+FramePacer::FramePacer ()
+: period (0)
+, isPresentAligned (false)
+, missedDeadlineCount (0)
+, nextDeadline (0)
+, lastFrameTime (0)
+{
+
+}
+
+FramePacer::~FramePacer () {
+
+}
+
+void FramePacer::setPeriod (int periodMs) {
+	if (periodMs < 1) {
+		periodMs = 1;
+	}
+	period = ((int64_t) periodMs) * 1000000;
+}
+
+void FramePacer::setPresentAligned (bool enable) {
+	isPresentAligned = enable;
+}
+
+void FramePacer::start () {
+	lastFrameTime = OsUtil::getMonotonicTime ();
+	nextDeadline = lastFrameTime + period;
+}
+
+float FramePacer::waitFrame (bool isPresented, WakeEvent *wakeEvent) {
+	int64_t now, elapsed;
+	bool iswoken;
+
+	now = OsUtil::getMonotonicTime ();
+	if (isPresentAligned && isPresented) {
+		// The present operation blocked until a display refresh, which becomes the reference point for the next deadline
+		nextDeadline = now + period;
+	}
+	else {
+		iswoken = false;
+		if (now < nextDeadline) {
+			if (wakeEvent) {
+				iswoken = wakeEvent->wait (nextDeadline);
+			}
+			else {
+				OsUtil::sleepUntilMonotonicTime (nextDeadline);
+			}
+		}
+		else if ((now - nextDeadline) >= period) {
+			++missedDeadlineCount;
+			nextDeadline = now;
+		}
+		if (! iswoken) {
+			nextDeadline += period;
+		}
+		now = OsUtil::getMonotonicTime ();
+	}
+
+	elapsed = now - lastFrameTime;
+	lastFrameTime = now;
+	return ((float) (((double) elapsed) / 1000000.0f));
+}
+
+float FramePacer::waitIdle (WakeEvent *wakeEvent, int64_t deadline) {
+	int64_t now, elapsed;
+
+	wakeEvent->wait (deadline);
+	now = OsUtil::getMonotonicTime ();
+	elapsed = now - lastFrameTime;
+	lastFrameTime = now;
+	nextDeadline = now + period;
+	return ((float) (((double) elapsed) / 1000000.0f));
+}
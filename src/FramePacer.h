@@ -0,0 +1,68 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that paces a loop to a fixed frame period using absolute deadlines on the monotonic clock
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <stdint.h>
+#include "WakeEvent.h"
+
+class FramePacer {
+public:
+	FramePacer ();
+	~FramePacer ();
+
+	// Read-only data members
+	int64_t period; // nanoseconds
+	bool isPresentAligned;
+	int64_t missedDeadlineCount;
+
+	// Set the target frame period, measured in milliseconds
+	void setPeriod (int periodMs);
+
+	// Set whether a frame that ended with a present operation should be treated as already aligned to the display refresh, as is the case when the renderer waits for vsync on present
+	void setPresentAligned (bool enable);
+
+	// Reset the pacer's deadline to one period from the current time
+	void start ();
+
+	// Block until the next frame deadline and return the number of milliseconds elapsed since the previous call. Deadlines advance by a fixed period from the previous deadline rather than from the end of the frame's work, so sleep overshoot does not accumulate. If a deadline was missed by more than a full period, the pacer resumes from the current time instead of running a burst of frames to catch up. isPresented indicates if the frame ended with a present operation. If wakeEvent is provided, a signal on it ends the wait early without moving the pending deadline.
+	float waitFrame (bool isPresented = false, WakeEvent *wakeEvent = NULL);
+
+	// Block until wakeEvent is signaled or the monotonic clock reaches deadline, waiting without a time limit if deadline is zero or less. Returns the number of milliseconds elapsed since the previous frame and resets the pacer's deadline to one period from the current time.
+	float waitIdle (WakeEvent *wakeEvent, int64_t deadline);
+
+private:
+	int64_t nextDeadline;
+	int64_t lastFrameTime;
+};
+
+#endif
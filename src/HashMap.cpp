@@ -34,6 +34,7 @@
 #include "StdString.h"
 #include "Buffer.h"
 #include "Json.h"
+#include "JsonWriter.h"
 #include "HashMap.h"
 
 HashMap::HashMap ()
@@ -112,6 +113,27 @@ Json *HashMap::toJson () const {
 	return (json);
 }
 
+OsUtil::Result HashMap::writeJson (Buffer *destBuffer) const {
+	JsonWriter writer (destBuffer);
+	std::map<StdString, StdString>::const_iterator i, end;
+	int start;
+
+	start = destBuffer->length;
+	writer.beginObject ();
+	i = valueMap.cbegin ();
+	end = valueMap.cend ();
+	while (i != end) {
+		writer.writeKey (i->first);
+		writer.writeString (i->second);
+		++i;
+	}
+	writer.endObject ();
+	if (writer.result != OsUtil::Success) {
+		destBuffer->setDataLength (start);
+	}
+	return (writer.result);
+}
+
 void HashMap::readJson (Json *json) {
 	StringList keys;
 	StringList::iterator i, end;
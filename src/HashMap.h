@@ -72,6 +72,9 @@ public:
 	// Return a newly created Json object containing map values
 	Json *toJson () const;
 
+	// Append map values to the provided buffer as a JSON object with the same content as toJson. Returns a Result value.
+	OsUtil::Result writeJson (Buffer *destBuffer) const;
+
 	// Clear map values and replace them with values from the provided Json object, as previously created by toJson
 	void readJson (Json *json);
 
@@ -37,7 +37,9 @@
 #include "StdString.h"
 #include "Sprite.h"
 #include "SpriteHandle.h"
+#include "DrawList.h"
 #include "Widget.h"
+#include "Scene.h"
 #include "Image.h"
 
 Image::Image (Sprite *sprite, int spriteFrame, bool shouldDestroySprite)
@@ -88,6 +90,7 @@ void Image::setFrame (int frame) {
 	}
 	spriteHandle.frame = frame;
 	resetSize ();
+	addSceneDamage ();
 }
 
 void Image::setMouseHighlightScale (bool enable, float highlightScale) {
@@ -102,6 +105,9 @@ void Image::setSpriteDestroy (bool enable) {
 }
 
 void Image::setDrawColor (bool enable, const Color &color) {
+	if (enable != isDrawColorEnabled) {
+		addSceneDamage ();
+	}
 	isDrawColorEnabled = enable;
 	if (isDrawColorEnabled) {
 		drawColor.assign (color);
@@ -122,6 +128,9 @@ void Image::translateAlpha (float startAlpha, float targetAlpha, int durationMs)
 		targetAlpha = 1.0f;
 	}
 
+	if (! FLOAT_EQUALS (drawAlpha, startAlpha)) {
+		addSceneDamage ();
+	}
 	drawAlpha = startAlpha;
 	translateAlphaValue.translateX (startAlpha, targetAlpha, durationMs);
 }
@@ -140,7 +149,7 @@ void Image::resetSize () {
 	height = ((float) th) * drawScale;
 }
 
-void Image::doUpdate (int msElapsed) {
+void Image::doUpdate (float msElapsed) {
 	if (isMouseHighlightScaled) {
 		if (isMouseEntered) {
 			if (! FLOAT_EQUALS (drawScale, mouseHighlightScale)) {
@@ -170,7 +179,7 @@ void Image::doRefresh () {
 	resetSize ();
 }
 
-void Image::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
+void Image::doDraw (DrawList *drawList, float originX, float originY) {
 	SDL_Texture *texture;
 	SDL_Rect rect;
 
@@ -180,12 +189,10 @@ void Image::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 	rect.w = (int) width;
 	rect.h = (int) height;
 
-	SDL_SetTextureAlphaMod (texture, (Uint8) (drawAlpha * 255.0f));
 	if (isDrawColorEnabled) {
-		SDL_SetTextureColorMod (texture, drawColor.rByte, drawColor.gByte, drawColor.bByte);
+		drawList->copyTexture (texture, &rect, drawColor.rByte, drawColor.gByte, drawColor.bByte, (Uint8) (drawAlpha * 255.0f));
 	}
-	SDL_RenderCopy (App::instance->render, texture, NULL, &rect);
-	if (isDrawColorEnabled) {
-		SDL_SetTextureColorMod (texture, 255, 255, 255);
+	else {
+		drawList->copyTexture (texture, &rect, 255, 255, 255, (Uint8) (drawAlpha * 255.0f));
 	}
 }
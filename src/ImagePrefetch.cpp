@@ -0,0 +1,244 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <map>
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include "StdString.h"
+#include "App.h"
+#include "Log.h"
+#include "TaskGroup.h"
+#include "ImagePrefetch.h"
+
+ImagePrefetch *ImagePrefetch::instance = NULL;
+const int ImagePrefetch::MaxEntryCount = 4;
+
+ImagePrefetch::ImagePrefetch ()
+: entryMapMutex (NULL)
+, cancelToken (NULL)
+, nextSequence (0)
+, requestCount (0)
+, hitCount (0)
+, missCount (0)
+{
+	entryMapMutex = SDL_CreateMutex ();
+	cancelToken = new TaskGroup::CancelToken ();
+	cancelToken->retain ();
+}
+
+ImagePrefetch::~ImagePrefetch () {
+	clear ();
+	if (cancelToken) {
+		cancelToken->release ();
+		cancelToken = NULL;
+	}
+	if (entryMapMutex) {
+		SDL_DestroyMutex (entryMapMutex);
+		entryMapMutex = NULL;
+	}
+}
+
+StdString ImagePrefetch::getKey (const StdString &path, bool isExternalPath) {
+	return (StdString::createSprintf ("%s:%s", isExternalPath ? "file" : "resource", path.c_str ()));
+}
+
+void ImagePrefetch::prefetch (const StdString &path, bool isExternalPath) {
+	ImagePrefetch::Entry entry;
+	ImagePrefetch::LoadContext *ctx;
+	TaskGroup::RunContext run;
+	StdString key;
+
+	if (path.empty ()) {
+		return;
+	}
+	key = ImagePrefetch::getKey (path, isExternalPath);
+	SDL_LockMutex (entryMapMutex);
+	if (entryMap.count (key) > 0) {
+		SDL_UnlockMutex (entryMapMutex);
+		return;
+	}
+	if (((int) entryMap.size () >= ImagePrefetch::MaxEntryCount) && (! evictEntry ())) {
+		SDL_UnlockMutex (entryMapMutex);
+		return;
+	}
+	entry.sequence = nextSequence;
+	++nextSequence;
+	entryMap.insert (std::pair<StdString, ImagePrefetch::Entry> (key, entry));
+
+	ctx = new ImagePrefetch::LoadContext ();
+	ctx->prefetch = this;
+	ctx->key.assign (key);
+	ctx->path.assign (path);
+	ctx->isExternalPath = isExternalPath;
+	ctx->sequence = entry.sequence;
+
+	// An animation step waits on each prefetched image, so decodes run ahead of other queued tasks
+	run = TaskGroup::RunContext (ImagePrefetch::loadSurface, ctx, TaskGroup::HighPriority);
+	run.cancelToken = cancelToken;
+	run.cancelFn = ImagePrefetch::freeLoadContext;
+
+	// entryMapMutex is held until the task has retained cancelToken, which clear may otherwise replace and release
+	if (! TaskGroup::instance->run (run)) {
+		entryMap.erase (key);
+		SDL_UnlockMutex (entryMapMutex);
+		delete (ctx);
+		return;
+	}
+	++requestCount;
+	SDL_UnlockMutex (entryMapMutex);
+}
+
+void ImagePrefetch::loadSurface (void *contextPtr) {
+	ImagePrefetch::LoadContext *ctx;
+	ImagePrefetch *prefetch;
+	std::map<StdString, ImagePrefetch::Entry>::iterator pos;
+	SDL_RWops *rw;
+	SDL_Surface *surface;
+
+	ctx = (ImagePrefetch::LoadContext *) contextPtr;
+	prefetch = ctx->prefetch;
+	surface = NULL;
+	if (ctx->isExternalPath) {
+		rw = SDL_RWFromFile (ctx->path.c_str (), "r");
+		if (rw) {
+			surface = IMG_Load_RW (rw, 1);
+		}
+	}
+	else {
+		surface = App::instance->resource.loadSurface (ctx->path);
+	}
+	if (! surface) {
+		Log::debug ("Failed to prefetch image; path=\"%s\" err=\"%s\"", ctx->path.c_str (), SDL_GetError ());
+	}
+
+	SDL_LockMutex (prefetch->entryMapMutex);
+	pos = prefetch->entryMap.find (ctx->key);
+	if ((pos != prefetch->entryMap.end ()) && (pos->second.sequence == ctx->sequence)) {
+		if (surface) {
+			pos->second.surface = surface;
+			pos->second.isLoaded = true;
+			surface = NULL;
+		}
+		else {
+			prefetch->entryMap.erase (pos);
+		}
+	}
+	SDL_UnlockMutex (prefetch->entryMapMutex);
+
+	if (surface) {
+		// The entry was taken or evicted while the decode was in progress
+		SDL_FreeSurface (surface);
+	}
+	delete (ctx);
+}
+
+void ImagePrefetch::freeLoadContext (void *contextPtr) {
+	delete ((ImagePrefetch::LoadContext *) contextPtr);
+}
+
+SDL_Surface *ImagePrefetch::takeSurface (const StdString &path, bool isExternalPath) {
+	std::map<StdString, ImagePrefetch::Entry>::iterator pos;
+	SDL_Surface *surface;
+
+	surface = NULL;
+	SDL_LockMutex (entryMapMutex);
+	pos = entryMap.find (ImagePrefetch::getKey (path, isExternalPath));
+	if (pos != entryMap.end ()) {
+		if (pos->second.isLoaded) {
+			surface = pos->second.surface;
+			++hitCount;
+		}
+		else {
+			++missCount;
+		}
+		entryMap.erase (pos);
+	}
+	SDL_UnlockMutex (entryMapMutex);
+
+	return (surface);
+}
+
+bool ImagePrefetch::evictEntry () {
+	std::map<StdString, ImagePrefetch::Entry>::iterator i, end, pos;
+
+	pos = entryMap.end ();
+	i = entryMap.begin ();
+	end = entryMap.end ();
+	while (i != end) {
+		if (i->second.isLoaded && ((pos == end) || (i->second.sequence < pos->second.sequence))) {
+			pos = i;
+		}
+		++i;
+	}
+	if (pos == end) {
+		return (false);
+	}
+	if (pos->second.surface) {
+		SDL_FreeSurface (pos->second.surface);
+	}
+	entryMap.erase (pos);
+	return (true);
+}
+
+void ImagePrefetch::clear () {
+	std::map<StdString, ImagePrefetch::Entry>::iterator i, end;
+
+	SDL_LockMutex (entryMapMutex);
+	i = entryMap.begin ();
+	end = entryMap.end ();
+	while (i != end) {
+		if (i->second.surface) {
+			SDL_FreeSurface (i->second.surface);
+			i->second.surface = NULL;
+		}
+		++i;
+	}
+	entryMap.clear ();
+	cancelToken->cancel ();
+	cancelToken->release ();
+	cancelToken = new TaskGroup::CancelToken ();
+	cancelToken->retain ();
+	SDL_UnlockMutex (entryMapMutex);
+}
+
+void ImagePrefetch::getStats (int64_t *destRequestCount, int64_t *destHitCount, int64_t *destMissCount) {
+	SDL_LockMutex (entryMapMutex);
+	if (destRequestCount) {
+		*destRequestCount = requestCount;
+	}
+	if (destHitCount) {
+		*destHitCount = hitCount;
+	}
+	if (destMissCount) {
+		*destMissCount = missCount;
+	}
+	SDL_UnlockMutex (entryMapMutex);
+}
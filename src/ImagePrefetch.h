@@ -0,0 +1,105 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that decodes image files in background tasks ahead of their use, holding the resulting surfaces until taken by a render task
+
+#ifndef IMAGE_PREFETCH_H
+#define IMAGE_PREFETCH_H
+
+#include <stdint.h>
+#include <map>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "TaskGroup.h"
+
+class ImagePrefetch {
+public:
+	ImagePrefetch ();
+	~ImagePrefetch ();
+	static ImagePrefetch *instance;
+
+	// The maximum number of images held at once, including images still decoding
+	static const int MaxEntryCount;
+
+	// Begin decoding the image at path in a background task, unless the image is already held. If isExternalPath is true, read data from a filesystem path instead of application resources.
+	void prefetch (const StdString &path, bool isExternalPath);
+
+	// Remove the decoded surface for path and return it, or NULL if no decoded surface was held. The caller becomes responsible for freeing a returned surface. If path was passed to prefetch, record the call as a hit or a miss according to whether its surface was ready.
+	SDL_Surface *takeSurface (const StdString &path, bool isExternalPath);
+
+	// Remove all held images, cancelling decode tasks not yet started and discarding the results of any still in progress
+	void clear ();
+
+	// Store prefetch counters in the provided pointers
+	void getStats (int64_t *destRequestCount, int64_t *destHitCount, int64_t *destMissCount);
+
+private:
+	// Task functions
+	static void loadSurface (void *contextPtr);
+	static void freeLoadContext (void *contextPtr);
+
+	struct Entry {
+		SDL_Surface *surface;
+		bool isLoaded;
+		int64_t sequence;
+		Entry ():
+			surface (NULL),
+			isLoaded (false),
+			sequence (0) { }
+	};
+	struct LoadContext {
+		ImagePrefetch *prefetch;
+		StdString key;
+		StdString path;
+		bool isExternalPath;
+		int64_t sequence;
+		LoadContext ():
+			prefetch (NULL),
+			key (""),
+			path (""),
+			isExternalPath (false),
+			sequence (0) { }
+	};
+
+	// Return the entryMap key for an image path
+	static StdString getKey (const StdString &path, bool isExternalPath);
+
+	// Remove the oldest loaded entry from entryMap and return a boolean value indicating if an entry was found. This method must be invoked while holding a lock on entryMapMutex.
+	bool evictEntry ();
+
+	std::map<StdString, ImagePrefetch::Entry> entryMap;
+	SDL_mutex *entryMapMutex;
+	TaskGroup::CancelToken *cancelToken;
+	int64_t nextSequence;
+	int64_t requestCount;
+	int64_t hitCount;
+	int64_t missCount;
+};
+
+#endif
@@ -42,9 +42,12 @@
 #include "Sprite.h"
 #include "Image.h"
 #include "ImageWindow.h"
+#include "ImagePrefetch.h"
+#include "TaskGroup.h"
 #include "Log.h"
 
 const float ImageWindow::UrlImageShowAreaMultiplier = 2.0f;
+const int ImageWindow::ScaleRowGrainSize = 64;
 
 ImageWindow::ImageWindow (Image *image)
 : Panel ()
@@ -235,15 +238,17 @@ void ImageWindow::setImageFilePath (const StdString &filePath, bool isExternalPa
 	if (loadCallback.callback) {
 		shouldInvokeLoadCallback = true;
 	}
-	surface = NULL;
-	if (isImageFileExternal) {
-		rw = SDL_RWFromFile (imageFilePath.c_str (), "r");
-		if (rw) {
-			surface = IMG_Load_RW (rw, 1);
+	surface = ImagePrefetch::instance->takeSurface (imageFilePath, isImageFileExternal);
+	if (! surface) {
+		if (isImageFileExternal) {
+			rw = SDL_RWFromFile (imageFilePath.c_str (), "r");
+			if (rw) {
+				surface = IMG_Load_RW (rw, 1);
+			}
+		}
+		else {
+			surface = App::instance->resource.loadSurface (imageFilePath);
 		}
-	}
-	else {
-		surface = App::instance->resource.loadSurface (imageFilePath);
 	}
 	if (! surface) {
 		imageFilePath.assign ("");
@@ -309,7 +314,7 @@ void ImageWindow::refreshLayout () {
 	}
 }
 
-void ImageWindow::doUpdate (int msElapsed) {
+void ImageWindow::doUpdate (float msElapsed) {
 	bool shouldload;
 
 	Panel::doUpdate (msElapsed);
@@ -381,7 +386,8 @@ void ImageWindow::createFileTexture (void *windowPtr) {
 		return;
 	}
 
-	if (window->isImageFileExternal) {
+	surface = ImagePrefetch::instance->takeSurface (window->imageFilePath, window->isImageFileExternal);
+	if ((! surface) && window->isImageFileExternal) {
 		rw = SDL_RWFromFile (window->imageFilePath.c_str (), "r");
 		if (! rw) {
 			Log::debug ("Failed to open external image file; filePath=\"%s\"", window->imageFilePath.c_str ());
@@ -396,7 +402,7 @@ void ImageWindow::createFileTexture (void *windowPtr) {
 			return;
 		}
 	}
-	else {
+	else if (! surface) {
 		surface = App::instance->resource.loadSurface (window->imageFilePath);
 		if (! surface) {
 			window->endLoadImageResource (true);
@@ -407,9 +413,8 @@ void ImageWindow::createFileTexture (void *windowPtr) {
 	window->imageLoadSourceWidth = (float) surface->w;
 	window->imageLoadSourceHeight = (float) surface->h;
 	if (window->getOnLoadScaleSize (&scaledw, &scaledh)) {
-		scaledsurface = SDL_CreateRGBSurface (0, (int) floorf (scaledw), (int) floorf (scaledh), surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, surface->format->Amask);
+		scaledsurface = ImageWindow::scaleSurface (surface, (int) floorf (scaledw), (int) floorf (scaledh));
 		if (scaledsurface) {
-			SDL_BlitScaled (surface, NULL, scaledsurface, NULL);
 			SDL_FreeSurface (surface);
 			surface = scaledsurface;
 		}
@@ -516,9 +521,8 @@ void ImageWindow::createUrlDataTexture (void *windowPtr) {
 	window->imageLoadSourceWidth = (float) surface->w;
 	window->imageLoadSourceHeight = (float) surface->h;
 	if (window->getOnLoadScaleSize (&scaledw, &scaledh)) {
-		scaledsurface = SDL_CreateRGBSurface (0, (int) floorf (scaledw), (int) floorf (scaledh), surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, surface->format->Amask);
+		scaledsurface = ImageWindow::scaleSurface (surface, (int) floorf (scaledw), (int) floorf (scaledh));
 		if (scaledsurface) {
-			SDL_BlitScaled (surface, NULL, scaledsurface, NULL);
 			SDL_FreeSurface (surface);
 			surface = scaledsurface;
 		}
@@ -540,6 +544,78 @@ void ImageWindow::createUrlDataTexture (void *windowPtr) {
 	window->endRequestImage ();
 }
 
+SDL_Surface *ImageWindow::scaleSurface (SDL_Surface *surface, int targetWidth, int targetHeight) {
+	ImageWindow::ScaleContext ctx;
+	SDL_Surface *source, *dest;
+
+	if ((targetWidth <= 0) || (targetHeight <= 0) || (surface->w <= 0) || (surface->h <= 0)) {
+		return (NULL);
+	}
+	source = surface;
+	if (source->format->BytesPerPixel != 4) {
+		source = SDL_ConvertSurfaceFormat (surface, SDL_PIXELFORMAT_RGBA32, 0);
+		if (! source) {
+			Log::debug ("Failed to scale image; err=\"SDL_ConvertSurfaceFormat: %s\"", SDL_GetError ());
+			return (NULL);
+		}
+	}
+	dest = SDL_CreateRGBSurface (0, targetWidth, targetHeight, 32, source->format->Rmask, source->format->Gmask, source->format->Bmask, source->format->Amask);
+	if (! dest) {
+		Log::debug ("Failed to scale image; err=\"SDL_CreateRGBSurface: %s\"", SDL_GetError ());
+		if (source != surface) {
+			SDL_FreeSurface (source);
+		}
+		return (NULL);
+	}
+
+	if (SDL_MUSTLOCK (source)) {
+		SDL_LockSurface (source);
+	}
+	ctx.sourcePixels = (uint8_t *) source->pixels;
+	ctx.sourcePitch = source->pitch;
+	ctx.sourceWidth = source->w;
+	ctx.sourceHeight = source->h;
+	ctx.destPixels = (uint8_t *) dest->pixels;
+	ctx.destPitch = dest->pitch;
+	ctx.destWidth = targetWidth;
+	ctx.destHeight = targetHeight;
+	if (TaskGroup::instance) {
+		TaskGroup::instance->parallelFor (targetHeight, ImageWindow::ScaleRowGrainSize, ImageWindow::scaleRows, &ctx);
+	}
+	else {
+		ImageWindow::scaleRows (&ctx, 0, targetHeight);
+	}
+	if (SDL_MUSTLOCK (source)) {
+		SDL_UnlockSurface (source);
+	}
+
+	if (source != surface) {
+		SDL_FreeSurface (source);
+	}
+	return (dest);
+}
+
+void ImageWindow::scaleRows (void *contextPtr, int rangeStart, int rangeEnd) {
+	ImageWindow::ScaleContext *ctx;
+	Uint32 *src, *dest;
+	int x, y;
+	int64_t stepx, stepy, posx;
+
+	ctx = (ImageWindow::ScaleContext *) contextPtr;
+	// Source positions are stepped in 16.16 fixed point to avoid a division per pixel
+	stepx = (((int64_t) ctx->sourceWidth) << 16) / ctx->destWidth;
+	stepy = (((int64_t) ctx->sourceHeight) << 16) / ctx->destHeight;
+	for (y = rangeStart; y < rangeEnd; ++y) {
+		src = (Uint32 *) (ctx->sourcePixels + (((stepy * y) >> 16) * ctx->sourcePitch));
+		dest = (Uint32 *) (ctx->destPixels + (y * ctx->destPitch));
+		posx = 0;
+		for (x = 0; x < ctx->destWidth; ++x) {
+			dest[x] = src[posx >> 16];
+			posx += stepx;
+		}
+	}
+}
+
 bool ImageWindow::getOnLoadScaleSize (float *destWidth, float *destHeight) {
 	float w, h;
 
@@ -32,6 +32,7 @@
 #ifndef IMAGE_WINDOW_H
 #define IMAGE_WINDOW_H
 
+#include "SDL2/SDL.h"
 #include "StdString.h"
 #include "SharedBuffer.h"
 #include "Image.h"
@@ -103,7 +104,7 @@ protected:
 	StdString toStringDetail ();
 
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	void doUpdate (int msElapsed);
+	void doUpdate (float msElapsed);
 
 	// Reset the panel's widget layout as appropriate for its content and configuration
 	void refreshLayout ();
@@ -135,6 +136,35 @@ private:
 	// Assign destWidth and destHeight to target size values for configured onLoad settings and return a boolean value indicating if the operation succeeded
 	bool getOnLoadScaleSize (float *destWidth, float *destHeight);
 
+	// The number of rows computed by each range of a parallel image scale
+	static const int ScaleRowGrainSize;
+
+	struct ScaleContext {
+		uint8_t *sourcePixels;
+		int sourcePitch;
+		int sourceWidth;
+		int sourceHeight;
+		uint8_t *destPixels;
+		int destPitch;
+		int destWidth;
+		int destHeight;
+		ScaleContext ():
+			sourcePixels (NULL),
+			sourcePitch (0),
+			sourceWidth (0),
+			sourceHeight (0),
+			destPixels (NULL),
+			destPitch (0),
+			destWidth (0),
+			destHeight (0) { }
+	};
+
+	// Return a newly created surface holding the contents of surface scaled to the specified size, or NULL if the surface could not be created. Rows of the scaled surface are computed on task threads.
+	static SDL_Surface *scaleSurface (SDL_Surface *surface, int targetWidth, int targetHeight);
+
+	// Fill the specified range of destination rows in a ScaleContext by nearest-neighbor sampling
+	static void scaleRows (void *contextPtr, int rangeStart, int rangeEnd);
+
 	Image *image;
 	bool isWindowSizeEnabled;
 	float windowWidth;
@@ -33,6 +33,7 @@
 #include "SDL2/SDL.h"
 #include "App.h"
 #include "OsUtil.h"
+#include "Scene.h"
 #include "Input.h"
 
 Input *Input::instance = NULL;
@@ -155,9 +156,15 @@ void Input::pollEvents () {
 	std::map<SDL_Keycode, bool>::iterator i;
 	SDL_Event event;
 	int64_t now;
+	bool isinput;
 
 	now = OsUtil::getTime ();
+	isinput = false;
 	while (SDL_PollEvent (&event)) {
+		if (event.type != SDL_USEREVENT) {
+			// SDL_USEREVENT is pushed only to wake the main thread from App::waitDrawWork
+			isinput = true;
+		}
 		switch (event.type) {
 			case SDL_KEYDOWN: {
 				i = keyDownMap.find (event.key.keysym.sym);
@@ -234,6 +241,16 @@ void Input::pollEvents () {
 				if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
 					++windowCloseCount;
 				}
+				else {
+					// Window events such as exposure may require the window content to be presented again
+					Scene::requestPresent ();
+				}
+				break;
+			}
+			case SDL_RENDER_TARGETS_RESET:
+			case SDL_RENDER_DEVICE_RESET: {
+				// Target texture content has been lost and must be drawn again
+				Scene::setChanged ();
 				break;
 			}
 		}
@@ -256,6 +273,7 @@ void Input::pollEvents () {
 				keyPressList.push_back (keyRepeatCode);
 				isKeyPressListPopulated = true;
 				SDL_UnlockMutex (keyPressListMutex);
+				isinput = true;
 			}
 		}
 	}
@@ -263,6 +281,13 @@ void Input::pollEvents () {
 	lastMouseX = mouseX;
 	lastMouseY = mouseY;
 	SDL_GetMouseState (&mouseX, &mouseY);
+	if (isinput) {
+		App::instance->updateWakeEvent.signal ();
+	}
+}
+
+bool Input::isKeyRepeatPending () {
+	return (keyRepeatCode != SDLK_UNKNOWN);
 }
 
 bool Input::isKeyDown (SDL_Keycode keycode) {
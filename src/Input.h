@@ -65,6 +65,9 @@ public:
 	// Poll events to update input state. This method must be invoked only from the application's main thread.
 	void pollEvents ();
 
+	// Return a boolean value indicating if a held key may generate repeat keypress events, requiring pollEvents to continue running at the draw frame rate
+	bool isKeyRepeatPending ();
+
 	// Return a boolean value indicating if the specified key is down
 	bool isKeyDown (SDL_Keycode keycode);
 
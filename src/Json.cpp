@@ -38,20 +38,55 @@
 #include <list>
 #include "json-parser.h"
 #include "json-builder.h"
-#include "Log.h"
+#include "OsUtil.h"
+#include "Buffer.h"
 #include "StdString.h"
+#include "JsonArena.h"
+#include "JsonWriter.h"
 #include "Json.h"
 
+const int Json::MaxMsgPackDepth = 64;
+const unsigned int Json::KeyIndexThreshold = 16;
+
 Json::Json ()
 : json (NULL)
 , shouldFreeJson (false)
 , isJsonBuilder (false)
+, arena (NULL)
+, keyIndexValues (NULL)
+, keyIndexLength (0)
+, keyLookupCount (0)
+, objectView (NULL)
+{
+
+}
+
+Json::Json (const Json &other)
+: json (NULL)
+, shouldFreeJson (false)
+, isJsonBuilder (false)
+, arena (NULL)
+, keyIndexValues (NULL)
+, keyIndexLength (0)
+, keyLookupCount (0)
+, objectView (NULL)
 {
+	setJsonValue (other.json, other.isJsonBuilder);
+}
 
+Json &Json::operator= (const Json &other) {
+	if (this != &other) {
+		setJsonValue (other.json, other.isJsonBuilder);
+	}
+	return (*this);
 }
 
 Json::~Json () {
 	unassign ();
+	if (objectView) {
+		delete (objectView);
+		objectView = NULL;
+	}
 }
 
 void Json::freeObject (void *jsonPtr) {
@@ -65,7 +100,10 @@ bool Json::isAssigned () {
 void Json::unassign () {
 	if (json) {
 		if (shouldFreeJson) {
-			if (isJsonBuilder) {
+			if (arena) {
+				arena->release ();
+			}
+			else if (isJsonBuilder) {
 				json_builder_free (json);
 			}
 			else {
@@ -74,8 +112,14 @@ void Json::unassign () {
 		}
 		json = NULL;
 	}
+	arena = NULL;
 	shouldFreeJson = false;
 	isJsonBuilder = false;
+	keyIndexValues = NULL;
+	keyLookupCount = 0;
+	if (objectView) {
+		objectView->unassign ();
+	}
 }
 
 void Json::resetBuilder () {
@@ -90,12 +134,37 @@ void Json::setEmpty () {
 	resetBuilder ();
 }
 
+json_value *Json::getJsonValue () {
+	return (json);
+}
+
+void Json::assignView (json_value *value) {
+	setJsonValue (value, false);
+}
+
 void Json::setJsonValue (json_value *value, bool isJsonBuilder) {
 	unassign ();
 	json = value;
 	this->isJsonBuilder = isJsonBuilder;
 }
 
+json_value *Json::detachJsonValue () {
+	json_value *value;
+
+	if (! json) {
+		return (json_object_new (0));
+	}
+	if (arena || (! shouldFreeJson)) {
+		value = copyJsonValue (json);
+		unassign ();
+		return (value);
+	}
+	value = json;
+	json = NULL;
+	unassign ();
+	return (value);
+}
+
 void Json::jsonObjectPush (const json_char *name, json_value *value) {
 	if ((! json) || (! isJsonBuilder)) {
 		resetBuilder ();
@@ -103,27 +172,108 @@ void Json::jsonObjectPush (const json_char *name, json_value *value) {
 	json_object_push (json, name, value);
 }
 
-bool Json::exists (const StdString &key) const {
-	int i, len;
+json_value *Json::findValue (const char *key, int keyLength) const {
 	json_object_entry *entry;
+	unsigned int i, len, mask, pos;
 
-	if (! json) {
-		return (false);
+	if ((! json) || (json->type != json_object)) {
+		return (NULL);
 	}
+	len = json->u.object.length;
+	if ((len > Json::KeyIndexThreshold) && ((keyIndexValues != json->u.object.values) || (keyIndexLength != len))) {
+		// A Json view created for a single lookup, such as a destination object filled by getObject, gains nothing from an index that costs more than one search to build. The index is built only on a repeated lookup.
+		if (keyLookupCount > 0) {
+			buildKeyIndex ();
+		}
+		else {
+			++keyLookupCount;
+		}
+	}
+	if ((len <= Json::KeyIndexThreshold) || (keyIndexValues != json->u.object.values) || (keyIndexLength != len)) {
+		for (i = 0; i < len; ++i) {
+			entry = &(json->u.object.values[i]);
+			if ((entry->name_length == (unsigned int) keyLength) && (memcmp (entry->name, key, keyLength) == 0)) {
+				return (entry->value);
+			}
+		}
+		return (NULL);
+	}
+
+	mask = (unsigned int) keyIndex.size () - 1;
+	pos = Json::getKeyHash (key, keyLength) & mask;
+	while (keyIndex[pos] != 0) {
+		entry = &(json->u.object.values[keyIndex[pos] - 1]);
+		if ((entry->name_length == (unsigned int) keyLength) && (memcmp (entry->name, key, keyLength) == 0)) {
+			return (entry->value);
+		}
+		pos = (pos + 1) & mask;
+	}
+	return (NULL);
+}
+
+json_value *Json::findArrayItem (const char *key, int index) const {
+	json_value *value;
+
+	if (index < 0) {
+		return (NULL);
+	}
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_array) || (index >= (int) value->u.array.length)) {
+		return (NULL);
+	}
+	return (value->u.array.values[index]);
+}
+
+void Json::buildKeyIndex () const {
+	json_object_entry *entry, *other;
+	unsigned int i, len, size, mask, pos;
 
 	len = json->u.object.length;
+	size = 1;
+	while (size < (len * 2)) {
+		size <<= 1;
+	}
+	keyIndex.assign (size, 0);
+	mask = size - 1;
+
+	// Entries are added in object order, and a key that appears more than once resolves to its first entry, matching the result of a linear search
 	for (i = 0; i < len; ++i) {
 		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			return (true);
+		pos = Json::getKeyHash (entry->name, entry->name_length) & mask;
+		while (keyIndex[pos] != 0) {
+			other = &(json->u.object.values[keyIndex[pos] - 1]);
+			if ((other->name_length == entry->name_length) && (memcmp (other->name, entry->name, entry->name_length) == 0)) {
+				break;
+			}
+			pos = (pos + 1) & mask;
+		}
+		if (keyIndex[pos] == 0) {
+			keyIndex[pos] = i + 1;
 		}
 	}
+	keyIndexValues = json->u.object.values;
+	keyIndexLength = len;
+}
 
-	return (false);
+unsigned int Json::getKeyHash (const char *key, int keyLength) {
+	unsigned int hash;
+	int i;
+
+	// FNV-1a
+	hash = 2166136261U;
+	for (i = 0; i < keyLength; ++i) {
+		hash ^= (unsigned char) key[i];
+		hash *= 16777619U;
+	}
+	return (hash);
+}
+
+bool Json::exists (const StdString &key) const {
+	return (exists (key.c_str ()));
 }
 
 bool Json::exists (const char *key) const {
-	return (exists (StdString (key)));
+	return (findValue (key, (int) strlen (key)) ? true : false);
 }
 
 void Json::getKeys (std::vector<StdString> *destVector, bool shouldClear) {
@@ -159,141 +309,92 @@ void Json::getKeys (StringList *destList, bool shouldClear) {
 }
 
 bool Json::isNull (const StdString &key) const {
-	int i, len;
-	json_object_entry *entry;
-
-	if (! json) {
-		return (false);
-	}
-
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			return ((entry->value->type == json_null) ? true : false);
-		}
-	}
-
-	return (false);
+	return (isNull (key.c_str ()));
 }
 
 bool Json::isNull (const char *key) const {
-	return (isNull (StdString (key)));
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	return ((value && (value->type == json_null)) ? true : false);
 }
 
 bool Json::isNumber (const StdString &key) const {
-	int i, len;
-	json_object_entry *entry;
-
-	if (! json) {
-		return (false);
-	}
-
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_integer: {
-					return (true);
-				}
-				case json_double: {
-					return (true);
-				}
-				default: {
-					return (false);
-				}
-			}
-			break;
-		}
-	}
-
-	return (false);
+	return (isNumber (key.c_str ()));
 }
 
 bool Json::isNumber (const char *key) const {
-	return (isNumber (StdString (key)));
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	return ((value && ((value->type == json_integer) || (value->type == json_double))) ? true : false);
 }
 
 bool Json::isBoolean (const StdString &key) const {
-	int i, len;
-	json_object_entry *entry;
-
-	if (! json) {
-		return (false);
-	}
-
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			return ((entry->value->type == json_boolean) ? true : false);
-		}
-	}
-
-	return (false);
+	return (isBoolean (key.c_str ()));
 }
 
 bool Json::isBoolean (const char *key) const {
-	return (isBoolean (StdString (key)));
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	return ((value && (value->type == json_boolean)) ? true : false);
 }
 
 bool Json::isString (const StdString &key) const {
-	int i, len;
-	json_object_entry *entry;
+	return (isString (key.c_str ()));
+}
 
-	if (! json) {
-		return (false);
-	}
+bool Json::isString (const char *key) const {
+	json_value *value;
 
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			return ((entry->value->type == json_string) ? true : false);
-		}
-	}
+	value = findValue (key, (int) strlen (key));
+	return ((value && (value->type == json_string)) ? true : false);
+}
 
-	return (false);
+bool Json::isArray (const StdString &key) const {
+	return (isArray (key.c_str ()));
 }
 
-bool Json::isString (const char *key) const {
-	return (isString (StdString (key)));
+bool Json::isArray (const char *key) const {
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	return ((value && (value->type == json_array)) ? true : false);
 }
 
-bool Json::isArray (const StdString &key) const {
-	int i, len;
-	json_object_entry *entry;
+bool Json::parse (const char *data, const int dataLength) {
+	json_settings settings;
+	json_value *value;
+	char buf[json_error_max];
 
-	if (! json) {
+	memset (&settings, 0, sizeof (settings));
+	settings.value_extra = json_builder_extra;
+	value = json_parse_ex (&settings, data, dataLength, buf);
+	if (! value) {
 		return (false);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			if (entry->value->type == json_array) {
-				return (true);
-			}
-			break;
-		}
-	}
-	return (false);
-}
 
-bool Json::isArray (const char *key) const {
-	return (isArray (StdString (key)));
+	unassign ();
+	json = value;
+	shouldFreeJson = true;
+	isJsonBuilder = false;
+	return (true);
 }
 
-bool Json::parse (const char *data, const int dataLength) {
+bool Json::parse (const char *data, const int dataLength, JsonArena *arena) {
 	json_settings settings;
 	json_value *value;
 	char buf[json_error_max];
 
 	memset (&settings, 0, sizeof (settings));
 	settings.value_extra = json_builder_extra;
+	settings.mem_alloc = JsonArena::jsonAlloc;
+	settings.mem_free = JsonArena::jsonFree;
+	settings.user_data = arena;
 	value = json_parse_ex (&settings, data, dataLength, buf);
 	if (! value) {
+		arena->release ();
 		return (false);
 	}
 
@@ -301,6 +402,7 @@ bool Json::parse (const char *data, const int dataLength) {
 	json = value;
 	shouldFreeJson = true;
 	isJsonBuilder = false;
+	this->arena = arena;
 	return (true);
 }
 
@@ -308,6 +410,244 @@ bool Json::parse (const StdString &data) {
 	return (parse (data.c_str (), data.length ()));
 }
 
+bool Json::parseMsgPack (const uint8_t *data, const int dataLength) {
+	json_value *value;
+	int pos;
+
+	pos = 0;
+	value = decodeMsgPackValue (data, dataLength, &pos, 0);
+	if (! value) {
+		return (false);
+	}
+	if ((value->type != json_object) || (pos != dataLength)) {
+		json_builder_free (value);
+		return (false);
+	}
+
+	unassign ();
+	json = value;
+	shouldFreeJson = true;
+	isJsonBuilder = true;
+	return (true);
+}
+
+static bool readMsgPackLength (const uint8_t *data, int dataLength, int *position, int byteCount, uint64_t *destValue) {
+	uint64_t val;
+	int i;
+
+	if ((dataLength - *position) < byteCount) {
+		return (false);
+	}
+	val = 0;
+	for (i = 0; i < byteCount; ++i) {
+		val = (val << 8) | data[*position + i];
+	}
+	*position += byteCount;
+	*destValue = val;
+	return (true);
+}
+
+json_value *Json::decodeMsgPackValue (const uint8_t *data, int dataLength, int *position, int depth) {
+	json_value *value, *item;
+	json_type container;
+	uint64_t len, n, i;
+	uint32_t f32;
+	float f;
+	double d;
+	uint8_t c;
+	int keypos, keylen;
+
+	if ((*position >= dataLength) || (depth > Json::MaxMsgPackDepth)) {
+		return (NULL);
+	}
+	c = data[*position];
+	++(*position);
+	container = json_none;
+	len = 0;
+
+	if (c <= 0x7F) {
+		return (json_integer_new (c));
+	}
+	if (c >= 0xE0) {
+		return (json_integer_new ((int8_t) c));
+	}
+	if ((c >= 0xA0) && (c <= 0xBF)) {
+		container = json_string;
+		len = c & 0x1F;
+	}
+	else if ((c >= 0x90) && (c <= 0x9F)) {
+		container = json_array;
+		len = c & 0x0F;
+	}
+	else if ((c >= 0x80) && (c <= 0x8F)) {
+		container = json_object;
+		len = c & 0x0F;
+	}
+	else {
+		switch (c) {
+			case 0xC0: {
+				return (json_null_new ());
+			}
+			case 0xC2: {
+				return (json_boolean_new (0));
+			}
+			case 0xC3: {
+				return (json_boolean_new (1));
+			}
+			case 0xCC:
+			case 0xCD:
+			case 0xCE:
+			case 0xCF: {
+				if (! readMsgPackLength (data, dataLength, position, 1 << (c - 0xCC), &n)) {
+					return (NULL);
+				}
+				return (json_integer_new ((json_int_t) n));
+			}
+			case 0xD0: {
+				if (! readMsgPackLength (data, dataLength, position, 1, &n)) {
+					return (NULL);
+				}
+				return (json_integer_new ((int8_t) n));
+			}
+			case 0xD1: {
+				if (! readMsgPackLength (data, dataLength, position, 2, &n)) {
+					return (NULL);
+				}
+				return (json_integer_new ((int16_t) n));
+			}
+			case 0xD2: {
+				if (! readMsgPackLength (data, dataLength, position, 4, &n)) {
+					return (NULL);
+				}
+				return (json_integer_new ((int32_t) n));
+			}
+			case 0xD3: {
+				if (! readMsgPackLength (data, dataLength, position, 8, &n)) {
+					return (NULL);
+				}
+				return (json_integer_new ((int64_t) n));
+			}
+			case 0xCA: {
+				if (! readMsgPackLength (data, dataLength, position, 4, &n)) {
+					return (NULL);
+				}
+				f32 = (uint32_t) n;
+				memcpy (&f, &f32, sizeof (f));
+				return (json_double_new (f));
+			}
+			case 0xCB: {
+				if (! readMsgPackLength (data, dataLength, position, 8, &n)) {
+					return (NULL);
+				}
+				memcpy (&d, &n, sizeof (d));
+				return (json_double_new (d));
+			}
+			case 0xC4:
+			case 0xC5:
+			case 0xC6: {
+				container = json_string;
+				if (! readMsgPackLength (data, dataLength, position, 1 << (c - 0xC4), &len)) {
+					return (NULL);
+				}
+				break;
+			}
+			case 0xD9:
+			case 0xDA:
+			case 0xDB: {
+				container = json_string;
+				if (! readMsgPackLength (data, dataLength, position, 1 << (c - 0xD9), &len)) {
+					return (NULL);
+				}
+				break;
+			}
+			case 0xDC:
+			case 0xDD: {
+				container = json_array;
+				if (! readMsgPackLength (data, dataLength, position, (c == 0xDC) ? 2 : 4, &len)) {
+					return (NULL);
+				}
+				break;
+			}
+			case 0xDE:
+			case 0xDF: {
+				container = json_object;
+				if (! readMsgPackLength (data, dataLength, position, (c == 0xDE) ? 2 : 4, &len)) {
+					return (NULL);
+				}
+				break;
+			}
+		}
+	}
+
+	// Each string byte, array item, or map entry occupies at least one byte of input, which bounds len before any allocation takes place
+	if ((container == json_none) || (len > (uint64_t) (dataLength - *position))) {
+		return (NULL);
+	}
+
+	if (container == json_string) {
+		value = json_string_new_length ((unsigned int) len, (const json_char *) (data + *position));
+		*position += (int) len;
+		return (value);
+	}
+
+	if (container == json_array) {
+		value = json_array_new ((size_t) len);
+		if (! value) {
+			return (NULL);
+		}
+		for (i = 0; i < len; ++i) {
+			item = decodeMsgPackValue (data, dataLength, position, depth + 1);
+			if (! item) {
+				json_builder_free (value);
+				return (NULL);
+			}
+			json_array_push (value, item);
+		}
+		return (value);
+	}
+
+	value = json_object_new ((size_t) len);
+	if (! value) {
+		return (NULL);
+	}
+	for (i = 0; i < len; ++i) {
+		n = 0;
+		if (*position < dataLength) {
+			c = data[*position];
+			++(*position);
+			if ((c >= 0xA0) && (c <= 0xBF)) {
+				n = c & 0x1F;
+			}
+			else if ((c >= 0xD9) && (c <= 0xDB)) {
+				if (! readMsgPackLength (data, dataLength, position, 1 << (c - 0xD9), &n)) {
+					c = 0;
+				}
+			}
+			else {
+				c = 0;
+			}
+		}
+		else {
+			c = 0;
+		}
+		if ((c == 0) || (n > (uint64_t) (dataLength - *position))) {
+			json_builder_free (value);
+			return (NULL);
+		}
+		keypos = *position;
+		keylen = (int) n;
+		*position += keylen;
+
+		item = decodeMsgPackValue (data, dataLength, position, depth + 1);
+		if (! item) {
+			json_builder_free (value);
+			return (NULL);
+		}
+		json_object_push_length (value, (unsigned int) keylen, (const json_char *) (data + keypos), item);
+	}
+	return (value);
+}
+
 void Json::assign (Json *otherJson) {
 	if (! otherJson) {
 		unassign ();
@@ -316,8 +656,10 @@ void Json::assign (Json *otherJson) {
 
 	if (otherJson->json) {
 		setJsonValue (otherJson->json, otherJson->isJsonBuilder);
+		shouldFreeJson = otherJson->shouldFreeJson;
+		arena = otherJson->arena;
 		otherJson->json = NULL;
-		shouldFreeJson = true;
+		otherJson->arena = NULL;
 	}
 	else {
 		unassign ();
@@ -342,6 +684,19 @@ Json *Json::copy () {
 	return (j);
 }
 
+bool Json::takeValue (Json *sourceJson) {
+	if ((! sourceJson->json) || (! sourceJson->shouldFreeJson)) {
+		copyValue (sourceJson);
+		return (false);
+	}
+	setJsonValue (sourceJson->json, sourceJson->isJsonBuilder);
+	shouldFreeJson = true;
+	arena = sourceJson->arena;
+	sourceJson->shouldFreeJson = false;
+	sourceJson->arena = NULL;
+	return (true);
+}
+
 json_value *Json::copyJsonValue (json_value *sourceValue) {
 	json_value *value;
 	json_object_entry *entry;
@@ -485,562 +840,338 @@ bool Json::deepEqualsValue (json_value *thisValue, json_value *otherValue) {
 }
 
 int Json::getNumber (const StdString &key, int defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
-
-	if (! json) {
-		return (defaultValue);
-	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_integer: {
-					return (entry->value->u.integer);
-				}
-				case json_double: {
-					return ((int) entry->value->u.dbl);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
-	}
-	return (defaultValue);
+	return (getNumber (key.c_str (), defaultValue));
 }
 
 int Json::getNumber (const char *key, int defaultValue) const {
-	return (getNumber (StdString (key), defaultValue));
-}
-
-int64_t Json::getNumber (const StdString &key, int64_t defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+	json_value *value;
 
-	if (! json) {
+	value = findValue (key, (int) strlen (key));
+	if (! value) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_integer: {
-					return ((int64_t) entry->value->u.integer);
-				}
-				case json_double: {
-					return ((int64_t) entry->value->u.dbl);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
+	switch (value->type) {
+		case json_integer: {
+			return (value->u.integer);
+		}
+		case json_double: {
+			return ((int) value->u.dbl);
+		}
+		default: {
+			return (defaultValue);
 		}
 	}
-	return (defaultValue);
 }
 
-int64_t Json::getNumber (const char *key, int64_t defaultValue) const {
-	return (getNumber (StdString (key), defaultValue));
+int64_t Json::getNumber (const StdString &key, int64_t defaultValue) const {
+	return (getNumber (key.c_str (), defaultValue));
 }
 
-double Json::getNumber (const StdString &key, double defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+int64_t Json::getNumber (const char *key, int64_t defaultValue) const {
+	json_value *value;
 
-	if (! json) {
+	value = findValue (key, (int) strlen (key));
+	if (! value) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_integer: {
-					return ((double) entry->value->u.integer);
-				}
-				case json_double: {
-					return (entry->value->u.dbl);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
+	switch (value->type) {
+		case json_integer: {
+			return ((int64_t) value->u.integer);
+		}
+		case json_double: {
+			return ((int64_t) value->u.dbl);
+		}
+		default: {
+			return (defaultValue);
 		}
 	}
-	return (defaultValue);
 }
 
-double Json::getNumber (const char *key, double defaultValue) const {
-	return (getNumber (StdString (key), defaultValue));
+double Json::getNumber (const StdString &key, double defaultValue) const {
+	return (getNumber (key.c_str (), defaultValue));
 }
 
-float Json::getNumber (const StdString &key, float defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+double Json::getNumber (const char *key, double defaultValue) const {
+	json_value *value;
 
-	if (! json) {
+	value = findValue (key, (int) strlen (key));
+	if (! value) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_integer: {
-					return ((float) entry->value->u.integer);
-				}
-				case json_double: {
-					return ((float) entry->value->u.dbl);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
+	switch (value->type) {
+		case json_integer: {
+			return ((double) value->u.integer);
+		}
+		case json_double: {
+			return (value->u.dbl);
+		}
+		default: {
+			return (defaultValue);
 		}
 	}
-	return (defaultValue);
 }
 
-float Json::getNumber (const char *key, float defaultValue) const {
-	return (getNumber (StdString (key), defaultValue));
+float Json::getNumber (const StdString &key, float defaultValue) const {
+	return (getNumber (key.c_str (), defaultValue));
 }
 
-bool Json::getBoolean (const StdString &key, bool defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+float Json::getNumber (const char *key, float defaultValue) const {
+	json_value *value;
 
-	if (! json) {
-		return (defaultValue);
-	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_boolean: {
-					return (entry->value->u.boolean);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
+	value = findValue (key, (int) strlen (key));
+	if (! value) {
+		return (defaultValue);
+	}
+	switch (value->type) {
+		case json_integer: {
+			return ((float) value->u.integer);
+		}
+		case json_double: {
+			return ((float) value->u.dbl);
+		}
+		default: {
+			return (defaultValue);
 		}
 	}
-	return (defaultValue);
 }
 
-bool Json::getBoolean (const char *key, bool defaultValue) const {
-	return (getBoolean (StdString (key), defaultValue));
+bool Json::getBoolean (const StdString &key, bool defaultValue) const {
+	return (getBoolean (key.c_str (), defaultValue));
 }
 
-StdString Json::getString (const StdString &key, const StdString &defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+bool Json::getBoolean (const char *key, bool defaultValue) const {
+	json_value *value;
 
-	if (! json) {
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_boolean)) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_string: {
-					return (StdString (entry->value->u.string.ptr, entry->value->u.string.length));
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
-	}
-	return (defaultValue);
+	return (value->u.boolean);
+}
+
+StdString Json::getString (const StdString &key, const StdString &defaultValue) const {
+	return (getString (key.c_str (), defaultValue));
 }
 
 StdString Json::getString (const char *key, const StdString &defaultValue) const {
-	return (getString (StdString (key), defaultValue));
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_string)) {
+		return (defaultValue);
+	}
+	return (StdString (value->u.string.ptr, value->u.string.length));
 }
 
 StdString Json::getString (const StdString &key, const char *defaultValue) const {
-	return (getString (key, StdString (defaultValue)));
+	return (getString (key.c_str (), defaultValue));
 }
 
 StdString Json::getString (const char *key, const char *defaultValue) const {
-	return (getString (StdString (key), StdString (defaultValue)));
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_string)) {
+		return (StdString (defaultValue));
+	}
+	return (StdString (value->u.string.ptr, value->u.string.length));
 }
 
 bool Json::getStringList (const StdString &key, StringList *destList) const {
-	int i, len;
+	return (getStringList (key.c_str (), destList));
+}
+
+bool Json::getStringList (const char *key, StringList *destList) const {
+	json_value *value, *item;
+	unsigned int i;
 
 	destList->clear ();
-	if (! isArray (key)) {
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_array)) {
 		return (false);
 	}
-
-	len = getArrayLength (key);
-	if (len <= 0) {
-		return (true);
-	}
-
-	for (i = 0; i < len; ++i) {
-		destList->push_back (getArrayString (key, i, StdString ("")));
+	for (i = 0; i < value->u.array.length; ++i) {
+		item = value->u.array.values[i];
+		if (item->type == json_string) {
+			destList->push_back (StdString (item->u.string.ptr, item->u.string.length));
+		}
+		else {
+			destList->push_back (StdString (""));
+		}
 	}
 	return (true);
 }
 
-bool Json::getStringList (const char *key, StringList *destList) const {
-	return (getStringList (StdString (key), destList));
+bool Json::getObject (const StdString &key, Json *destJson) {
+	return (getObject (key.c_str (), destJson));
 }
 
-bool Json::getObject (const StdString &key, Json *destJson) {
-	int i, len;
-	json_object_entry *entry;
+bool Json::getObject (const char *key, Json *destJson) {
+	json_value *value;
 
-	if (! json) {
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_object)) {
 		return (false);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_object: {
-					if (destJson) {
-						destJson->setJsonValue (entry->value, isJsonBuilder);
-					}
-					return (true);
-				}
-				default: {
-					return (false);
-				}
-			}
-			break;
-		}
+	if (destJson) {
+		destJson->setJsonValue (value, isJsonBuilder);
 	}
-	return (false);
+	return (true);
 }
 
-bool Json::getObject (const char *key, Json *destJson) {
-	return (getObject (StdString (key), destJson));
+Json *Json::getObjectView (const char *key) {
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_object)) {
+		return (NULL);
+	}
+	if (! objectView) {
+		objectView = new Json ();
+	}
+	if (objectView->json != value) {
+		objectView->setJsonValue (value, isJsonBuilder);
+	}
+	return (objectView);
 }
 
 int Json::getArrayLength (const StdString &key) const {
-	int i, len;
-	json_object_entry *entry;
+	return (getArrayLength (key.c_str ()));
+}
 
-	if (! json) {
+int Json::getArrayLength (const char *key) const {
+	json_value *value;
+
+	value = findValue (key, (int) strlen (key));
+	if ((! value) || (value->type != json_array)) {
 		return (0);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					return (entry->value->u.array.length);
-				}
-				default: {
-					return (0);
-				}
-			}
-			break;
-		}
-	}
-	return (0);
+	return (value->u.array.length);
 }
 
-int Json::getArrayLength (const char *key) const {
-	return (getArrayLength (StdString (key)));
+int Json::getArrayNumber (const StdString &key, int index, int defaultValue) const {
+	return (getArrayNumber (key.c_str (), index, defaultValue));
 }
 
-int Json::getArrayNumber (const StdString &key, int index, int defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+int Json::getArrayNumber (const char *key, int index, int defaultValue) const {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if (! item) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (defaultValue);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type == json_integer) {
-						return (item->u.integer);
-					}
-					else if (item->type == json_double) {
-						return ((int) item->u.dbl);
-					}
-
-					return (defaultValue);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
+	if (item->type == json_integer) {
+		return (item->u.integer);
+	}
+	else if (item->type == json_double) {
+		return ((int) item->u.dbl);
 	}
 	return (defaultValue);
 }
 
-int Json::getArrayNumber (const char *key, int index, int defaultValue) const {
-	return (getArrayNumber (StdString (key), index, defaultValue));
+int64_t Json::getArrayNumber (const StdString &key, int index, int64_t defaultValue) const {
+	return (getArrayNumber (key.c_str (), index, defaultValue));
 }
 
-int64_t Json::getArrayNumber (const StdString &key, int index, int64_t defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+int64_t Json::getArrayNumber (const char *key, int index, int64_t defaultValue) const {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if (! item) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (defaultValue);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type == json_integer) {
-						return ((int64_t) item->u.integer);
-					}
-					else if (item->type == json_double) {
-						return ((int64_t) item->u.dbl);
-					}
-
-					return (defaultValue);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
+	if (item->type == json_integer) {
+		return ((int64_t) item->u.integer);
+	}
+	else if (item->type == json_double) {
+		return ((int64_t) item->u.dbl);
 	}
 	return (defaultValue);
 }
 
-int64_t Json::getArrayNumber (const char *key, int index, int64_t defaultValue) const {
-	return (getArrayNumber (StdString (key), index, defaultValue));
+double Json::getArrayNumber (const StdString &key, int index, double defaultValue) const {
+	return (getArrayNumber (key.c_str (), index, defaultValue));
 }
 
-double Json::getArrayNumber (const StdString &key, int index, double defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+double Json::getArrayNumber (const char *key, int index, double defaultValue) const {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if (! item) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (defaultValue);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type == json_integer) {
-						return ((double) item->u.integer);
-					}
-					else if (item->type == json_double) {
-						return (item->u.dbl);
-					}
-
-					return (defaultValue);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
+	if (item->type == json_integer) {
+		return ((double) item->u.integer);
+	}
+	else if (item->type == json_double) {
+		return (item->u.dbl);
 	}
 	return (defaultValue);
 }
 
-double Json::getArrayNumber (const char *key, int index, double defaultValue) const {
-	return (getArrayNumber (StdString (key), index, defaultValue));
+float Json::getArrayNumber (const StdString &key, int index, float defaultValue) const {
+	return (getArrayNumber (key.c_str (), index, defaultValue));
 }
 
-float Json::getArrayNumber (const StdString &key, int index, float defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+float Json::getArrayNumber (const char *key, int index, float defaultValue) const {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if (! item) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (defaultValue);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type == json_integer) {
-						return ((float) item->u.integer);
-					}
-					else if (item->type == json_double) {
-						return ((float) item->u.dbl);
-					}
-
-					return (defaultValue);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
+	if (item->type == json_integer) {
+		return ((float) item->u.integer);
+	}
+	else if (item->type == json_double) {
+		return ((float) item->u.dbl);
 	}
 	return (defaultValue);
 }
 
-float Json::getArrayNumber (const char *key, int index, float defaultValue) const {
-	return (getArrayNumber (StdString (key), index, defaultValue));
+StdString Json::getArrayString (const StdString &key, int index, const StdString &defaultValue) const {
+	return (getArrayString (key.c_str (), index, defaultValue));
 }
 
-StdString Json::getArrayString (const StdString &key, int index, const StdString &defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+StdString Json::getArrayString (const char *key, int index, const StdString &defaultValue) const {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if ((! item) || (item->type != json_string)) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (defaultValue);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type == json_string) {
-						return (StdString (item->u.string.ptr, item->u.string.length));
-					}
-
-					return (defaultValue);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
-	}
-	return (defaultValue);
+	return (StdString (item->u.string.ptr, item->u.string.length));
 }
 
-StdString Json::getArrayString (const char *key, int index, const StdString &defaultValue) const {
-	return (getArrayString (StdString (key), index, defaultValue));
+bool Json::getArrayBoolean (const StdString &key, int index, bool defaultValue) const {
+	return (getArrayBoolean (key.c_str (), index, defaultValue));
 }
 
-bool Json::getArrayBoolean (const StdString &key, int index, bool defaultValue) const {
-	int i, len;
-	json_object_entry *entry;
+bool Json::getArrayBoolean (const char *key, int index, bool defaultValue) const {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if ((! item) || (item->type != json_boolean)) {
 		return (defaultValue);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (defaultValue);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type == json_boolean) {
-						return (item->u.boolean);
-					}
-
-					return (defaultValue);
-				}
-				default: {
-					return (defaultValue);
-				}
-			}
-			break;
-		}
-	}
-	return (defaultValue);
+	return (item->u.boolean);
 }
 
-bool Json::getArrayBoolean (const char *key, int index, bool defaultValue) const {
-	return (getArrayBoolean (StdString (key), index, defaultValue));
+bool Json::getArrayObject (const StdString &key, int index, Json *destJson) {
+	return (getArrayObject (key.c_str (), index, destJson));
 }
 
-bool Json::getArrayObject (const StdString &key, int index, Json *destJson) {
-	int i, len;
-	json_object_entry *entry;
+bool Json::getArrayObject (const char *key, int index, Json *destJson) {
 	json_value *item;
 
-	if ((! json) || (index < 0)) {
+	item = findArrayItem (key, index);
+	if ((! item) || (item->type != json_object)) {
 		return (false);
 	}
-	len = json->u.object.length;
-	for (i = 0; i < len; ++i) {
-		entry = &(json->u.object.values[i]);
-		if (key.equals (0, key.length (), entry->name, 0, entry->name_length)) {
-			switch (entry->value->type) {
-				case json_array: {
-					if (index >= (int) entry->value->u.array.length) {
-						return (false);
-					}
-					item = entry->value->u.array.values[index];
-					if (item->type != json_object) {
-						return (false);
-					}
-
-					if (destJson) {
-						destJson->setJsonValue (item, isJsonBuilder);
-					}
-					return (true);
-				}
-				default: {
-					return (false);
-				}
-			}
-			break;
-		}
+	if (destJson) {
+		destJson->setJsonValue (item, isJsonBuilder);
 	}
-	return (false);
-}
-
-bool Json::getArrayObject (const char *key, int index, Json *destJson) {
-	return (getArrayObject (StdString (key), index, destJson));
+	return (true);
 }
 
 Json *Json::set (const StdString &key, const char *value) {
@@ -1107,13 +1238,7 @@ Json *Json::set (const char *key, const bool value) {
 }
 
 Json *Json::set (const StdString &key, Json *value) {
-	if (value->json) {
-		jsonObjectPush (key.c_str (), value->json);
-		value->json = NULL;
-	}
-	else {
-		jsonObjectPush (key.c_str (), json_object_new (0));
-	}
+	jsonObjectPush (key.c_str (), value->detachJsonValue ());
 	delete (value);
 	return (this);
 }
@@ -1246,11 +1371,7 @@ Json *Json::set (const StdString &key, std::vector<Json *> *value) {
 	end = value->end ();
 	while (i != end) {
 		item = *i;
-		if (! item->json) {
-			item->setEmpty ();
-		}
-		json_array_push (a, item->json);
-		item->json = NULL;
+		json_array_push (a, item->detachJsonValue ());
 		delete (item);
 		++i;
 	}
@@ -1273,11 +1394,7 @@ Json *Json::set (const StdString &key, std::list<Json *> *value) {
 	end = value->end ();
 	while (i != end) {
 		item = *i;
-		if (! item->json) {
-			item->setEmpty ();
-		}
-		json_array_push (a, item->json);
-		item->json = NULL;
+		json_array_push (a, item->detachJsonValue ());
 		delete (item);
 		++i;
 	}
@@ -1300,11 +1417,7 @@ Json *Json::set (const StdString &key, JsonList *value) {
 	end = value->end ();
 	while (i != end) {
 		item = *i;
-		if (! item->json) {
-			item->setEmpty ();
-		}
-		json_array_push (a, item->json);
-		item->json = NULL;
+		json_array_push (a, item->detachJsonValue ());
 		++i;
 	}
 	jsonObjectPush (key.c_str (), a);
@@ -1350,36 +1463,121 @@ Json *Json::setNull (const char *key) {
 }
 
 StdString Json::toString () {
-	StdString s;
-	char *buf;
-	json_serialize_opts opts;
-	int len;
+	Buffer buffer;
 
-	if (! json) {
+	if (writeJson (&buffer) != OsUtil::Success) {
 		return (StdString (""));
 	}
+	return (StdString ((char *) buffer.data, buffer.length));
+}
 
-	// TODO: Possibly employ a locking mechanism here (json_measure_ex modifies json data structures while measuring)
+OsUtil::Result Json::writeJson (Buffer *destBuffer) {
+	JsonWriter writer (destBuffer);
+	int start;
 
-	opts.mode = json_serialize_mode_packed;
-	opts.opts = json_serialize_opt_no_space_after_colon | json_serialize_opt_no_space_after_comma | json_serialize_opt_pack_brackets;
-	opts.indent_size = 0;
-	len = json_measure_ex (json, opts);
-	if (len <= 0) {
-		return (StdString (""));
+	if (! json) {
+		return (OsUtil::InvalidParamError);
+	}
+	start = destBuffer->length;
+	writer.writeValue (json);
+	if (writer.result != OsUtil::Success) {
+		destBuffer->setDataLength (start);
 	}
+	return (writer.result);
+}
 
-	buf = (char *) malloc (len);
-	if (! buf) {
-		Log::err ("Out of memory in Json::toString; len=%i", len);
-		return (StdString (""));
+OsUtil::Result Json::writeMsgPack (Buffer *destBuffer) {
+	if (! json) {
+		return (OsUtil::InvalidParamError);
+	}
+	return (encodeMsgPackValue (json, destBuffer));
+}
+
+static OsUtil::Result writeMsgPackHeader (Buffer *destBuffer, uint8_t typeByte, uint64_t value, int byteCount) {
+	uint8_t buf[9];
+	int i;
+
+	buf[0] = typeByte;
+	for (i = byteCount; i > 0; --i) {
+		buf[i] = (uint8_t) (value & 0xFF);
+		value >>= 8;
+	}
+	return (destBuffer->add (buf, byteCount + 1));
+}
+
+static OsUtil::Result writeMsgPackLength (Buffer *destBuffer, uint64_t length, uint8_t fixType, uint64_t fixMax, uint8_t type8, uint8_t type16, uint8_t type32) {
+	if (length <= fixMax) {
+		return (writeMsgPackHeader (destBuffer, (uint8_t) (fixType | length), 0, 0));
 	}
+	if (type8 && (length <= 0xFF)) {
+		return (writeMsgPackHeader (destBuffer, type8, length, 1));
+	}
+	if (length <= 0xFFFF) {
+		return (writeMsgPackHeader (destBuffer, type16, length, 2));
+	}
+	return (writeMsgPackHeader (destBuffer, type32, length, 4));
+}
 
-	json_serialize_ex (buf, json, opts);
-	s.assign (buf);
-	free (buf);
+OsUtil::Result Json::encodeMsgPackValue (json_value *value, Buffer *destBuffer) {
+	OsUtil::Result result;
+	json_object_entry *entry;
+	json_int_t n;
+	uint64_t d;
+	unsigned int i;
 
-	return (s);
+	switch (value->type) {
+		case json_object: {
+			result = writeMsgPackLength (destBuffer, value->u.object.length, 0x80, 0x0F, 0, 0xDE, 0xDF);
+			for (i = 0; (result == OsUtil::Success) && (i < value->u.object.length); ++i) {
+				entry = &(value->u.object.values[i]);
+				result = writeMsgPackLength (destBuffer, entry->name_length, 0xA0, 0x1F, 0xD9, 0xDA, 0xDB);
+				if (result == OsUtil::Success) {
+					result = destBuffer->add ((uint8_t *) entry->name, (int) entry->name_length);
+				}
+				if (result == OsUtil::Success) {
+					result = encodeMsgPackValue (entry->value, destBuffer);
+				}
+			}
+			return (result);
+		}
+		case json_array: {
+			result = writeMsgPackLength (destBuffer, value->u.array.length, 0x90, 0x0F, 0, 0xDC, 0xDD);
+			for (i = 0; (result == OsUtil::Success) && (i < value->u.array.length); ++i) {
+				result = encodeMsgPackValue (value->u.array.values[i], destBuffer);
+			}
+			return (result);
+		}
+		case json_integer: {
+			n = value->u.integer;
+			if ((n >= 0) && (n <= 0x7F)) {
+				return (writeMsgPackHeader (destBuffer, (uint8_t) n, 0, 0));
+			}
+			if ((n < 0) && (n >= -32)) {
+				return (writeMsgPackHeader (destBuffer, (uint8_t) (int8_t) n, 0, 0));
+			}
+			if ((n >= INT32_MIN) && (n <= INT32_MAX)) {
+				return (writeMsgPackHeader (destBuffer, 0xD2, (uint32_t) (int32_t) n, 4));
+			}
+			return (writeMsgPackHeader (destBuffer, 0xD3, (uint64_t) n, 8));
+		}
+		case json_double: {
+			memcpy (&d, &(value->u.dbl), sizeof (d));
+			return (writeMsgPackHeader (destBuffer, 0xCB, d, 8));
+		}
+		case json_string: {
+			result = writeMsgPackLength (destBuffer, value->u.string.length, 0xA0, 0x1F, 0xD9, 0xDA, 0xDB);
+			if ((result == OsUtil::Success) && (value->u.string.length > 0)) {
+				result = destBuffer->add ((uint8_t *) value->u.string.ptr, (int) value->u.string.length);
+			}
+			return (result);
+		}
+		case json_boolean: {
+			return (writeMsgPackHeader (destBuffer, value->u.boolean ? 0xC3 : 0xC2, 0, 0));
+		}
+		default: {
+			return (writeMsgPackHeader (destBuffer, 0xC0, 0, 0));
+		}
+	}
 }
 
 JsonList::JsonList ()
@@ -1405,27 +1603,34 @@ void JsonList::clear () {
 }
 
 StdString JsonList::toString () {
+	Buffer buffer;
+
+	if (writeJson (&buffer) != OsUtil::Success) {
+		return (StdString ("[]"));
+	}
+	return (StdString ((char *) buffer.data, buffer.length));
+}
+
+OsUtil::Result JsonList::writeJson (Buffer *destBuffer) {
+	JsonWriter writer (destBuffer);
 	JsonList::iterator i, iend;
-	StdString s;
-	bool first;
+	int start;
 
-	s.assign ("[");
-	first = true;
+	start = destBuffer->length;
+	writer.beginArray ();
 	i = begin ();
 	iend = end ();
 	while (i != iend) {
-		if (first) {
-			first = false;
+		if ((*i)->isAssigned ()) {
+			writer.writeValue ((*i)->getJsonValue ());
 		}
-		else {
-			s.append (",");
-		}
-		s.append ((*i)->toString ());
 		++i;
 	}
-	s.append ("]");
-
-	return (s);
+	writer.endArray ();
+	if (writer.result != OsUtil::Success) {
+		destBuffer->setDataLength (start);
+	}
+	return (writer.result);
 }
 
 void JsonList::copyValues (JsonList *sourceList) {
@@ -37,16 +37,23 @@
 #include <list>
 #include "StdString.h"
 #include "StringList.h"
+#include "OsUtil.h"
 #include "json-parser.h"
 #include "json-builder.h"
 
 class JsonList;
+class JsonArena;
+class Buffer;
 
 class Json {
 public:
 	Json ();
 	~Json ();
 
+	// Copies hold a view of the source object's value, which remains owned by the source object
+	Json (const Json &other);
+	Json &operator= (const Json &other);
+
 	// Free the provided Json object pointer
 	static void freeObject (void *jsonPtr);
 
@@ -59,13 +66,31 @@ public:
 	// Reassign the Json object to a newly created empty object, clearing any pointer that might already be present
 	void setEmpty ();
 
+	// Return the object's json_value pointer, or NULL if no value is assigned. The returned value remains owned by the Json object.
+	json_value *getJsonValue ();
+
+	// Reassign the Json object to reference a json_value owned elsewhere, clearing any pointer that might already be present. The referenced value must remain valid while the Json object holds it.
+	void assignView (json_value *value);
+
 	// Parse a JSON string containing key-value pairs and store the resulting data. Returns a boolean value indicating if the parse succeeded.
 	bool parse (const StdString &data);
 	bool parse (const char *data, const int dataLength);
 
+	// Parse a JSON string containing key-value pairs, allocating the resulting data from arena. The Json object takes ownership of arena and releases it when the parsed value is unassigned, including if the parse fails. Returns a boolean value indicating if the parse succeeded.
+	bool parse (const char *data, const int dataLength, JsonArena *arena);
+
+	// Parse MessagePack data containing key-value pairs and store the resulting data. Returns a boolean value indicating if the parse succeeded.
+	bool parseMsgPack (const uint8_t *data, const int dataLength);
+
 	// Return a JSON string containing object fields
 	StdString toString ();
 
+	// Append a JSON encoding of object fields to the provided buffer. Returns a Result value.
+	OsUtil::Result writeJson (Buffer *destBuffer);
+
+	// Append a MessagePack encoding of object fields to the provided buffer. Returns a Result value.
+	OsUtil::Result writeMsgPack (Buffer *destBuffer);
+
 	// Replace the Json object's content with another object's json pointer and free the other object
 	void assign (Json *otherJson);
 
@@ -75,6 +100,9 @@ public:
 	// Return a newly created Json object with contents copied from this object
 	Json *copy ();
 
+	// Replace the Json object's content with the source object's value, taking ownership of the value and any arena holding it if the source owns them. sourceJson retains a view of the value, which remains valid for as long as this object holds it. If sourceJson does not own its value, store a copy instead. Returns a boolean value indicating if ownership was transferred.
+	bool takeValue (Json *sourceJson);
+
 	// Return a boolean value indicating if the object's content matches that of another
 	bool deepEquals (Json *other);
 
@@ -134,6 +162,9 @@ public:
 	bool getObject (const StdString &key, Json *destJson);
 	bool getObject (const char *key, Json *destJson);
 
+	// Return a Json object holding a view of the named object key, or NULL if no such object was found. The returned object remains owned by this Json object and is valid until its value is unassigned or replaced. Repeated calls for the same key return the same view, so lookups made through it share one key index.
+	Json *getObjectView (const char *key);
+
 	// Return the length of the named array key. A return value of zero indicates an empty or nonexistent array.
 	int getArrayLength (const StdString &key) const;
 	int getArrayLength (const char *key) const;
@@ -205,12 +236,30 @@ public:
 	Json *setNull (const char *key);
 
 private:
+	static const int MaxMsgPackDepth;
+	static const unsigned int KeyIndexThreshold;
+
+	// Return the value stored under the specified key, or NULL if no such key was found. Objects with more than KeyIndexThreshold keys are searched through keyIndex once they have been read more than once, populating it again if the object's entries change.
+	json_value *findValue (const char *key, int keyLength) const;
+
+	// Return an item from the named array key, or NULL if no such item was found
+	json_value *findArrayItem (const char *key, int index) const;
+
+	// Populate keyIndex with the positions of the current object entries
+	void buildKeyIndex () const;
+
+	// Return the hash value of a key
+	static unsigned int getKeyHash (const char *key, int keyLength);
+
 	// Set the json value to a newly created builder object
 	void resetBuilder ();
 
 	// Use the json_object_push method to set a key in the json object, creating the object if needed
 	void jsonObjectPush (const json_char *name, json_value *value);
 
+	// Return the json value for insertion into a builder value, leaving the object unassigned. Creates an empty object if no value is assigned, and a copy if the value is held in an arena or owned elsewhere.
+	json_value *detachJsonValue ();
+
 	// Reassign the json pointer, clearing any pointer that might already be present
 	void setJsonValue (json_value *value, bool isJsonBuilder);
 
@@ -220,9 +269,23 @@ private:
 	// Return a boolean value indicating if a value's content matches that of a value from another object
 	bool deepEqualsValue (json_value *thisValue, json_value *otherValue);
 
+	// Return a newly created json_value object containing the MessagePack value found at the specified data position, or NULL if the data could not be decoded. On success, position is advanced past the decoded value.
+	json_value *decodeMsgPackValue (const uint8_t *data, int dataLength, int *position, int depth);
+
+	// Append a MessagePack encoding of the provided value to destBuffer. Returns a Result value.
+	OsUtil::Result encodeMsgPackValue (json_value *value, Buffer *destBuffer);
+
 	json_value *json;
 	bool shouldFreeJson;
 	bool isJsonBuilder;
+	JsonArena *arena;
+
+	// Open addressing table of object entry positions plus one, with zero marking an empty slot
+	mutable std::vector<unsigned int> keyIndex;
+	mutable json_object_entry *keyIndexValues;
+	mutable unsigned int keyIndexLength;
+	mutable int keyLookupCount;
+	Json *objectView; // The view most recently returned by getObjectView, or NULL if no view has been created
 };
 
 // Json list class that extends std::list<Json *> and frees all contained Json objects when destroyed
@@ -237,6 +300,9 @@ public:
 	// Return a string containing the list as a JSON array
 	StdString toString ();
 
+	// Append the list to the provided buffer as a JSON array. Returns a Result value.
+	OsUtil::Result writeJson (Buffer *destBuffer);
+
 	// Remove all elements from the list and add copies of all objects in sourceList
 	void copyValues (JsonList *sourceList);
 
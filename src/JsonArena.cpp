@@ -0,0 +1,197 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "JsonArena.h"
+
+const size_t JsonArena::DefaultBlockSize = 4096; // bytes
+const size_t JsonArena::MaxRetainedBlockSize = (512 * 1024); // bytes
+const int JsonArena::MaxPoolSize = 64;
+const size_t JsonArena::Alignment = 16; // bytes
+
+static SDL_SpinLock poolLock = 0;
+static std::vector<JsonArena *> pool;
+static int64_t poolUseCount = 0;
+static int64_t poolValueAllocCount = 0;
+static int64_t poolHeapAllocCount = 0;
+
+JsonArena::JsonArena ()
+: allocCount (0)
+, blockAllocCount (0)
+{
+
+}
+
+JsonArena::~JsonArena () {
+	clearBlocks ();
+}
+
+JsonArena *JsonArena::acquire () {
+	JsonArena *arena;
+
+	arena = NULL;
+	SDL_AtomicLock (&poolLock);
+	if (! pool.empty ()) {
+		arena = pool.back ();
+		pool.pop_back ();
+	}
+	SDL_AtomicUnlock (&poolLock);
+	if (! arena) {
+		arena = new JsonArena ();
+	}
+	return (arena);
+}
+
+void JsonArena::release () {
+	int64_t allocs, blockallocs;
+	bool found;
+
+	allocs = allocCount;
+	blockallocs = blockAllocCount;
+	reset ();
+	found = false;
+	SDL_AtomicLock (&poolLock);
+	++poolUseCount;
+	poolValueAllocCount += allocs;
+	poolHeapAllocCount += blockallocs;
+	if ((int) pool.size () < JsonArena::MaxPoolSize) {
+		pool.push_back (this);
+		found = true;
+	}
+	SDL_AtomicUnlock (&poolLock);
+	if (! found) {
+		delete (this);
+	}
+}
+
+void JsonArena::getStats (int64_t *useCount, int64_t *valueAllocCount, int64_t *heapAllocCount) {
+	SDL_AtomicLock (&poolLock);
+	if (useCount) {
+		*useCount = poolUseCount;
+	}
+	if (valueAllocCount) {
+		*valueAllocCount = poolValueAllocCount;
+	}
+	if (heapAllocCount) {
+		*heapAllocCount = poolHeapAllocCount;
+	}
+	SDL_AtomicUnlock (&poolLock);
+}
+
+void *JsonArena::alloc (size_t size, bool shouldZero) {
+	JsonArena::Block *block;
+	uint8_t *ptr;
+
+	size = (size + JsonArena::Alignment - 1) & ~(JsonArena::Alignment - 1);
+	if (size == 0) {
+		size = JsonArena::Alignment;
+	}
+	block = blockList.empty () ? NULL : &(blockList.back ());
+	if ((! block) || ((block->size - block->position) < size)) {
+		if (! addBlock (size)) {
+			return (NULL);
+		}
+		block = &(blockList.back ());
+	}
+	ptr = block->data + block->position;
+	block->position += size;
+	if (shouldZero) {
+		memset (ptr, 0, size);
+	}
+	++allocCount;
+	return (ptr);
+}
+
+void JsonArena::reset () {
+	std::vector<JsonArena::Block>::iterator i, end;
+	size_t total;
+
+	allocCount = 0;
+	blockAllocCount = 0;
+	if (blockList.size () == 1) {
+		blockList.front ().position = 0;
+		return;
+	}
+
+	// Replace a chain of blocks with a single block large enough to hold the same values next time, so that a command of similar size parses without further heap allocation
+	total = 0;
+	i = blockList.begin ();
+	end = blockList.end ();
+	while (i != end) {
+		total += i->size;
+		++i;
+	}
+	clearBlocks ();
+	if ((total > 0) && (total <= JsonArena::MaxRetainedBlockSize)) {
+		addBlock (total);
+	}
+}
+
+bool JsonArena::addBlock (size_t minSize) {
+	JsonArena::Block block;
+
+	block.size = JsonArena::DefaultBlockSize;
+	if (! blockList.empty ()) {
+		block.size = blockList.back ().size * 2;
+	}
+	while (block.size < minSize) {
+		block.size *= 2;
+	}
+	block.data = (uint8_t *) malloc (block.size);
+	if (! block.data) {
+		return (false);
+	}
+	blockList.push_back (block);
+	++blockAllocCount;
+	return (true);
+}
+
+void JsonArena::clearBlocks () {
+	std::vector<JsonArena::Block>::iterator i, end;
+
+	i = blockList.begin ();
+	end = blockList.end ();
+	while (i != end) {
+		free (i->data);
+		++i;
+	}
+	blockList.clear ();
+}
+
+void *JsonArena::jsonAlloc (size_t size, int zero, void *user_data) {
+	return (((JsonArena *) user_data)->alloc (size, zero ? true : false));
+}
+
+void JsonArena::jsonFree (void *ptr, void *user_data) {
+	// Arena memory is released only by reset
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that serves memory for parsed json values from a bump-allocated block, releasing all values at once when reset
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class JsonArena {
+public:
+	JsonArena ();
+	~JsonArena ();
+
+	static const size_t DefaultBlockSize;
+	static const size_t MaxRetainedBlockSize;
+	static const int MaxPoolSize;
+	static const size_t Alignment;
+
+	// Read-only data members
+	int64_t allocCount;
+	int64_t blockAllocCount;
+
+	// Return a JsonArena object from the shared pool, creating a new one if the pool is empty
+	static JsonArena *acquire ();
+
+	// Reset the arena and return it to the shared pool, or delete it if the pool is full. The arena must not be used after calling this method.
+	void release ();
+
+	// Store totals for arenas returned to the pool: the number of arena uses, values allocated from arenas, and heap blocks allocated to hold them
+	static void getStats (int64_t *useCount, int64_t *valueAllocCount, int64_t *heapAllocCount);
+
+	// Return a pointer to size bytes of arena memory, optionally filled with zeros, or NULL if the memory could not be allocated
+	void *alloc (size_t size, bool shouldZero);
+
+	// Invalidate all memory allocated from the arena, retaining a single block sized to hold the previous contents
+	void reset ();
+
+	// Callback functions for use as json_settings mem_alloc and mem_free, with user_data set to a JsonArena pointer
+	static void *jsonAlloc (size_t size, int zero, void *user_data);
+	static void jsonFree (void *ptr, void *user_data);
+
+private:
+	struct Block {
+		uint8_t *data;
+		size_t size;
+		size_t position;
+		Block ():
+			data (NULL),
+			size (0),
+			position (0) { }
+	};
+
+	// Append a newly allocated block with the specified minimum size. Returns a boolean value indicating if the block was created.
+	bool addBlock (size_t minSize);
+
+	// Free all blocks
+	void clearBlocks ();
+
+	std::vector<JsonArena::Block> blockList;
+};
+
+#endif
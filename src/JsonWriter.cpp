@@ -0,0 +1,400 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "StdString.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+#include "json-parser.h"
+#include "JsonWriter.h"
+
+const int JsonWriter::MaxDepth = 64; // Limited by the bit count of itemMask
+const int JsonWriter::MaxNumberLength = 32;
+
+// Doubles with an absolute value below this limit hold an exact integer if they hold any integer at all
+static const double MaxExactInteger = 9007199254740992.0;
+
+// Limits for printing doubles as fixed point digits, chosen so that the scaled value stays below MaxExactInteger
+static const int MaxFixedPointPlaces = 6;
+static const double MaxFixedPointValue = 1000000000.0;
+static const double FixedPointScales[] = { 1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0 };
+
+JsonWriter::JsonWriter (Buffer *destBuffer)
+: buffer (destBuffer)
+, result (OsUtil::Success)
+, depth (0)
+, itemMask (0)
+, isKeyWritten (false)
+{
+
+}
+
+JsonWriter::~JsonWriter () {
+
+}
+
+void JsonWriter::add (const char *data, int dataLength) {
+	if (result != OsUtil::Success) {
+		return;
+	}
+	result = buffer->add ((uint8_t *) data, dataLength);
+}
+
+void JsonWriter::beginItem () {
+	if (isKeyWritten) {
+		isKeyWritten = false;
+		return;
+	}
+	// Each bit of itemMask records whether a value has been written at the corresponding nesting depth
+	if (itemMask & (((uint64_t) 1) << depth)) {
+		add (",", 1);
+	}
+	itemMask |= (((uint64_t) 1) << depth);
+}
+
+void JsonWriter::beginObject () {
+	beginItem ();
+	if ((depth + 1) >= JsonWriter::MaxDepth) {
+		result = OsUtil::ArrayIndexOutOfBoundsError;
+		return;
+	}
+	add ("{", 1);
+	++depth;
+	itemMask &= ~(((uint64_t) 1) << depth);
+}
+
+void JsonWriter::endObject () {
+	if (depth > 0) {
+		--depth;
+	}
+	add ("}", 1);
+}
+
+void JsonWriter::beginArray () {
+	beginItem ();
+	if ((depth + 1) >= JsonWriter::MaxDepth) {
+		result = OsUtil::ArrayIndexOutOfBoundsError;
+		return;
+	}
+	add ("[", 1);
+	++depth;
+	itemMask &= ~(((uint64_t) 1) << depth);
+}
+
+void JsonWriter::endArray () {
+	if (depth > 0) {
+		--depth;
+	}
+	add ("]", 1);
+}
+
+void JsonWriter::writeKey (const char *key) {
+	writeKey (key, (int) strlen (key));
+}
+
+void JsonWriter::writeKey (const StdString &key) {
+	writeKey (key.c_str (), (int) key.length ());
+}
+
+void JsonWriter::writeKey (const char *key, int keyLength) {
+	writeString (key, keyLength);
+	add (":", 1);
+	isKeyWritten = true;
+}
+
+void JsonWriter::writeString (const char *value) {
+	writeString (value, (int) strlen (value));
+}
+
+void JsonWriter::writeString (const StdString &value) {
+	writeString (value.c_str (), (int) value.length ());
+}
+
+void JsonWriter::writeString (const char *value, int valueLength) {
+	static const char hexdigits[] = "0123456789abcdef";
+	char escape[6];
+	unsigned char c;
+	int i, start, escapelen;
+
+	beginItem ();
+	add ("\"", 1);
+
+	// Copy each run of characters that need no escaping with a single add
+	start = 0;
+	for (i = 0; i < valueLength; ++i) {
+		c = (unsigned char) value[i];
+		if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+			continue;
+		}
+		if (i > start) {
+			add (value + start, i - start);
+		}
+		start = i + 1;
+		escape[0] = '\\';
+		escapelen = 2;
+		switch (c) {
+			case '"': {
+				escape[1] = '"';
+				break;
+			}
+			case '\\': {
+				escape[1] = '\\';
+				break;
+			}
+			case '\b': {
+				escape[1] = 'b';
+				break;
+			}
+			case '\f': {
+				escape[1] = 'f';
+				break;
+			}
+			case '\n': {
+				escape[1] = 'n';
+				break;
+			}
+			case '\r': {
+				escape[1] = 'r';
+				break;
+			}
+			case '\t': {
+				escape[1] = 't';
+				break;
+			}
+			default: {
+				escape[1] = 'u';
+				escape[2] = '0';
+				escape[3] = '0';
+				escape[4] = hexdigits[(c >> 4) & 0x0F];
+				escape[5] = hexdigits[c & 0x0F];
+				escapelen = 6;
+				break;
+			}
+		}
+		add (escape, escapelen);
+	}
+	if (i > start) {
+		add (value + start, i - start);
+	}
+	add ("\"", 1);
+}
+
+void JsonWriter::writeNumber (int value) {
+	writeNumber ((int64_t) value);
+}
+
+void JsonWriter::writeNumber (int64_t value) {
+	char text[JsonWriter::MaxNumberLength];
+
+	beginItem ();
+	add (text, JsonWriter::formatNumber (value, text));
+}
+
+void JsonWriter::writeNumber (double value) {
+	char text[JsonWriter::MaxNumberLength];
+
+	beginItem ();
+	add (text, JsonWriter::formatNumber (value, text));
+}
+
+void JsonWriter::writeBoolean (bool value) {
+	beginItem ();
+	if (value) {
+		add ("true", 4);
+	}
+	else {
+		add ("false", 5);
+	}
+}
+
+void JsonWriter::writeNull () {
+	beginItem ();
+	add ("null", 4);
+}
+
+void JsonWriter::writeValue (json_value *value) {
+	unsigned int i;
+
+	switch (value->type) {
+		case json_object: {
+			beginObject ();
+			for (i = 0; i < value->u.object.length; ++i) {
+				writeKey (value->u.object.values[i].name, (int) value->u.object.values[i].name_length);
+				writeValue (value->u.object.values[i].value);
+			}
+			endObject ();
+			break;
+		}
+		case json_array: {
+			beginArray ();
+			for (i = 0; i < value->u.array.length; ++i) {
+				writeValue (value->u.array.values[i]);
+			}
+			endArray ();
+			break;
+		}
+		case json_integer: {
+			writeNumber ((int64_t) value->u.integer);
+			break;
+		}
+		case json_double: {
+			writeNumber (value->u.dbl);
+			break;
+		}
+		case json_string: {
+			writeString (value->u.string.ptr, (int) value->u.string.length);
+			break;
+		}
+		case json_boolean: {
+			writeBoolean (value->u.boolean ? true : false);
+			break;
+		}
+		default: {
+			writeNull ();
+			break;
+		}
+	}
+}
+
+void JsonWriter::write (const char *key, const char *value) {
+	writeKey (key);
+	writeString (value);
+}
+
+void JsonWriter::write (const char *key, const StdString &value) {
+	writeKey (key);
+	writeString (value);
+}
+
+void JsonWriter::write (const char *key, int value) {
+	writeKey (key);
+	writeNumber ((int64_t) value);
+}
+
+void JsonWriter::write (const char *key, int64_t value) {
+	writeKey (key);
+	writeNumber (value);
+}
+
+void JsonWriter::write (const char *key, double value) {
+	writeKey (key);
+	writeNumber (value);
+}
+
+void JsonWriter::write (const char *key, bool value) {
+	writeKey (key);
+	writeBoolean (value);
+}
+
+int JsonWriter::formatNumber (int64_t value, char *destText) {
+	char digits[JsonWriter::MaxNumberLength];
+	uint64_t n;
+	int pos, len;
+
+	pos = JsonWriter::MaxNumberLength;
+	n = (value < 0) ? (0 - (uint64_t) value) : (uint64_t) value;
+	do {
+		--pos;
+		digits[pos] = (char) ('0' + (n % 10));
+		n /= 10;
+	} while (n > 0);
+	if (value < 0) {
+		--pos;
+		digits[pos] = '-';
+	}
+	len = JsonWriter::MaxNumberLength - pos;
+	memcpy (destText, digits + pos, len);
+	return (len);
+}
+
+int JsonWriter::formatNumber (double value, char *destText) {
+	double scaled;
+	int i, len, precision;
+
+	if (! isfinite (value)) {
+		memcpy (destText, "null", 4);
+		return (4);
+	}
+	if ((fabs (value) < MaxExactInteger) && (floor (value) == value)) {
+		return (JsonWriter::formatNumber ((int64_t) value, destText));
+	}
+
+	// Values with a few decimal places, as are typical of positions and sizes, print as fixed point digits if the scaled integer divides back to the same double. Division of exact integers rounds to the nearest double as strtod does, so the text reads back unchanged.
+	if (fabs (value) < MaxFixedPointValue) {
+		for (i = 1; i <= MaxFixedPointPlaces; ++i) {
+			scaled = value * FixedPointScales[i];
+			if ((floor (scaled) == scaled) && ((scaled / FixedPointScales[i]) == value)) {
+				return (formatFixedPoint ((int64_t) scaled, i, destText));
+			}
+		}
+	}
+
+	// Most values print exactly at 15 significant digits; those that don't read back as the same double need 16 or 17
+	for (precision = 15; precision < 17; ++precision) {
+		len = snprintf (destText, JsonWriter::MaxNumberLength, "%.*g", precision, value);
+		if (strtod (destText, NULL) == value) {
+			return (len);
+		}
+	}
+	return (snprintf (destText, JsonWriter::MaxNumberLength, "%.17g", value));
+}
+
+int JsonWriter::formatFixedPoint (int64_t scaledValue, int decimalPlaces, char *destText) {
+	char digits[JsonWriter::MaxNumberLength];
+	uint64_t n;
+	int pos, len;
+
+	pos = JsonWriter::MaxNumberLength;
+	n = (scaledValue < 0) ? (0 - (uint64_t) scaledValue) : (uint64_t) scaledValue;
+	while ((n > 0) && ((n % 10) == 0)) {
+		n /= 10;
+		--decimalPlaces;
+	}
+	do {
+		--pos;
+		digits[pos] = (char) ('0' + (n % 10));
+		n /= 10;
+		--decimalPlaces;
+		if (decimalPlaces == 0) {
+			--pos;
+			digits[pos] = '.';
+		}
+	} while ((n > 0) || (decimalPlaces >= 0));
+	if (scaledValue < 0) {
+		--pos;
+		digits[pos] = '-';
+	}
+	len = JsonWriter::MaxNumberLength - pos;
+	memcpy (destText, digits + pos, len);
+	return (len);
+}
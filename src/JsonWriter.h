@@ -0,0 +1,107 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that appends JSON text to a Buffer as values are written, without building an intermediate json_value tree
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include "StdString.h"
+#include "OsUtil.h"
+#include "json-parser.h"
+
+class Buffer;
+
+class JsonWriter {
+public:
+	JsonWriter (Buffer *destBuffer);
+	~JsonWriter ();
+
+	static const int MaxDepth;
+	static const int MaxNumberLength;
+
+	// Read-only data members
+	Buffer *buffer;
+	OsUtil::Result result;
+
+	// Begin or end an object or array value
+	void beginObject ();
+	void endObject ();
+	void beginArray ();
+	void endArray ();
+
+	// Write an object key, to be followed by its value
+	void writeKey (const char *key);
+	void writeKey (const char *key, int keyLength);
+	void writeKey (const StdString &key);
+
+	// Write a value, as an object member following a key or as an array item
+	void writeString (const char *value);
+	void writeString (const char *value, int valueLength);
+	void writeString (const StdString &value);
+	void writeNumber (int value);
+	void writeNumber (int64_t value);
+	void writeNumber (double value);
+	void writeBoolean (bool value);
+	void writeNull ();
+
+	// Write a json_value and all of its contents
+	void writeValue (json_value *value);
+
+	// Write an object key and its value
+	void write (const char *key, const char *value);
+	void write (const char *key, const StdString &value);
+	void write (const char *key, int value);
+	void write (const char *key, int64_t value);
+	void write (const char *key, double value);
+	void write (const char *key, bool value);
+
+	// Store the text representation of an integer in destText, which must hold at least MaxNumberLength characters, and return its length
+	static int formatNumber (int64_t value, char *destText);
+
+	// Store the shortest text representation that parses back to the same double value in destText, which must hold at least MaxNumberLength characters, and return its length. Values that JSON cannot represent are stored as null.
+	static int formatNumber (double value, char *destText);
+
+private:
+	// Store the text of scaledValue divided by 10 to the power of decimalPlaces in destText and return its length. scaledValue must not be a multiple of 10 to that power.
+	static int formatFixedPoint (int64_t scaledValue, int decimalPlaces, char *destText);
+
+	// Write a separator if one is needed before the next value or key
+	void beginItem ();
+
+	// Add data to buffer, recording any failure in result
+	void add (const char *data, int dataLength);
+
+	int depth;
+	uint64_t itemMask;
+	bool isKeyWritten;
+};
+
+#endif
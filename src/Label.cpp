@@ -37,7 +37,9 @@
 #include "Sprite.h"
 #include "Resource.h"
 #include "Font.h"
+#include "DrawList.h"
 #include "Widget.h"
+#include "Scene.h"
 #include "Label.h"
 
 const char Label::ObscureCharacter = '*';
@@ -156,6 +158,7 @@ void Label::setUnderlined (bool enable) {
 		return;
 	}
 	isUnderlined = enable;
+	addSceneDamage ();
 	underlineMargin = UiConfiguration::instance->textUnderlineMargin;
 	if (isUnderlined) {
 		height = maxGlyphTopBearing + underlineMargin + 1.0f;
@@ -173,7 +176,7 @@ void Label::setObscured (bool enable) {
 	setText (text, textFontType, true);
 }
 
-void Label::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
+void Label::doDraw (DrawList *drawList, float originX, float originY) {
 	Font::Glyph *glyph;
 	std::list<Font::Glyph *>::iterator i, end;
 	std::list<int>::iterator ki, kend;
@@ -216,8 +219,7 @@ void Label::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 			if (((rect.x + glyph->advanceWidth) >= 0) && (rect.x < App::instance->windowWidth) && ((rect.y + maxGlyphTopBearing) >= 0) && (rect.y < App::instance->windowHeight)) {
 				rect.w = glyph->width;
 				rect.h = glyph->height;
-				SDL_SetTextureColorMod (glyph->texture, textColor.rByte, textColor.gByte, textColor.bByte);
-				SDL_RenderCopy (App::instance->render, glyph->texture, NULL, &rect);
+				drawList->copyTexture (glyph->texture, &rect, textColor.rByte, textColor.gByte, textColor.bByte);
 			}
 
 			x += glyph->advanceWidth;
@@ -237,8 +239,7 @@ void Label::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 
 	if (isUnderlined) {
 		y = y0 + maxGlyphTopBearing + (int) underlineMargin;
-		SDL_SetRenderDrawColor (App::instance->render, textColor.rByte, textColor.gByte, textColor.bByte, 255);
-		SDL_RenderDrawLine (App::instance->render, x0, y, (int) (x0 + width), y);
+		drawList->drawLine (x0, y, (int) (x0 + width), y, textColor.rByte, textColor.gByte, textColor.bByte);
 	}
 	SDL_UnlockMutex (textMutex);
 }
@@ -251,7 +252,7 @@ void Label::doRefresh () {
 	}
 }
 
-void Label::doUpdate (int msElapsed) {
+void Label::doUpdate (float msElapsed) {
 	textColor.update (msElapsed);
 }
 
@@ -289,6 +290,7 @@ void Label::setText (const StdString &textContent, UiConfiguration::FontType fon
 		return;
 	}
 
+	addSceneDamage ();
 	SDL_LockMutex (textMutex);
 	text.assign (textContent);
 	glyphList.clear ();
@@ -47,7 +47,7 @@ LabelWindow::LabelWindow (Label *label)
 , isMouseoverHighlightEnabled (false)
 , mouseoverColorTranslateDuration (0)
 , crawlStage (0)
-, crawlClock (0)
+, crawlClock (0.0f)
 {
 	addWidget (label);
 	setPadding (UiConfiguration::instance->paddingSize, UiConfiguration::instance->paddingSize);
@@ -148,21 +148,24 @@ bool LabelWindow::doProcessMouseState (const Widget::MouseState &mouseState) {
 	return (false);
 }
 
-void LabelWindow::doUpdate (int msElapsed) {
+void LabelWindow::doUpdate (float msElapsed) {
 	Panel::doUpdate (msElapsed);
 	if (isCrawlEnabled) {
 		switch (crawlStage) {
 			case 0: {
-				crawlClock = 7000;
+				crawlClock = 7000.0f;
 				crawlStage = 1;
 				break;
 			}
 			case 1: {
 				crawlClock -= msElapsed;
-				if (crawlClock <= 0) {
+				if (crawlClock <= 0.0f) {
 					crawlStage = 2;
 					label->position.translateX (-(label->width), 100 * (int) label->text.length ());
 				}
+				else {
+					App::instance->scheduleUpdate (((int) crawlClock) + 1);
+				}
 				break;
 			}
 			case 2: {
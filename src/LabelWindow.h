@@ -83,7 +83,7 @@ protected:
 	virtual bool doProcessMouseState (const Widget::MouseState &mouseState);
 
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	void doUpdate (int msElapsed);
+	void doUpdate (float msElapsed);
 
 	// Reset the panel's widget layout as appropriate for its content and configuration
 	void refreshLayout ();
@@ -100,7 +100,7 @@ private:
 	Color mouseoverHighlightBgColor;
 	int mouseoverColorTranslateDuration;
 	int crawlStage;
-	int crawlClock;
+	float crawlClock;
 };
 
 #endif
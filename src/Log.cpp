@@ -44,7 +44,6 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include "SDL2/SDL.h"
-#include "App.h"
 #include "StdString.h"
 #include "OsUtil.h"
 #include "Log.h"
@@ -61,6 +60,8 @@ const char *Log::LevelNames[Log::LevelCount] = {
 	"DEBUG4"
 };
 
+Log *Log::instance = NULL;
+
 Log::Log ()
 : isStdoutWriteEnabled (false)
 , isFileWriteEnabled (false)
@@ -221,13 +222,19 @@ void Log::voutput (Log::LogLevel level, const char *str, va_list args) {
 void Log::write (Log::LogLevel level, const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (level, str, ap);
+	Log::instance->voutput (level, str, ap);
 	va_end (ap);
 }
 
 void Log::write (Log::LogLevel level, const char *str, va_list args) {
-	App::instance->log.voutput (level, str, args);
+	if (! Log::instance) {
+		return;
+	}
+	Log::instance->voutput (level, str, args);
 }
 
 void Log::printf (const char *str, ...) {
@@ -239,77 +246,113 @@ void Log::printf (const char *str, ...) {
 	va_end (ap);
 	::printf ("[%s] %s\n", OsUtil::getTimestampString (OsUtil::getTime (), true).c_str (), text.c_str ());
 	fflush (stdout);
-	App::instance->writeConsoleOutput (text);
+}
+
+void Log::flushStdout () {
+	if (! Log::instance) {
+		fflush (stdout);
+		return;
+	}
+	SDL_LockMutex (Log::instance->mutex);
+	fflush (stdout);
+	SDL_UnlockMutex (Log::instance->mutex);
 }
 
 void Log::err (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::ErrLevel, str, ap);
+	Log::instance->voutput (Log::ErrLevel, str, ap);
 	va_end (ap);
 }
 
 void Log::warning (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::WarningLevel, str, ap);
+	Log::instance->voutput (Log::WarningLevel, str, ap);
 	va_end (ap);
 }
 
 void Log::notice (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::NoticeLevel, str, ap);
+	Log::instance->voutput (Log::NoticeLevel, str, ap);
 	va_end (ap);
 }
 
 void Log::info (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::InfoLevel, str, ap);
+	Log::instance->voutput (Log::InfoLevel, str, ap);
 	va_end (ap);
 }
 
 void Log::debug (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::DebugLevel, str, ap);
+	Log::instance->voutput (Log::DebugLevel, str, ap);
 	va_end (ap);
 }
 
 void Log::debug1 (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::Debug1Level, str, ap);
+	Log::instance->voutput (Log::Debug1Level, str, ap);
 	va_end (ap);
 }
 
 void Log::debug2 (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::Debug2Level, str, ap);
+	Log::instance->voutput (Log::Debug2Level, str, ap);
 	va_end (ap);
 }
 
 void Log::debug3 (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::Debug3Level, str, ap);
+	Log::instance->voutput (Log::Debug3Level, str, ap);
 	va_end (ap);
 }
 
 void Log::debug4 (const char *str, ...) {
 	va_list ap;
 
+	if (! Log::instance) {
+		return;
+	}
 	va_start (ap, str);
-	App::instance->log.voutput (Log::Debug4Level, str, ap);
+	Log::instance->voutput (Log::Debug4Level, str, ap);
 	va_end (ap);
 }
@@ -57,6 +57,7 @@ public:
 
 	Log ();
 	~Log ();
+	static Log *instance;
 
 	// Read-write data members
 	bool isStdoutWriteEnabled;
@@ -89,6 +90,9 @@ public:
 	// Write a message to the default log instance without specifying a level
 	static void printf (const char *str, ...) __attribute__((format(printf, 1, 2)));
 
+	// Write any log output held in the standard output stream buffer, as needed before writing data directly to the standard output descriptor
+	static void flushStdout ();
+
 	// Write a message to the default log instance at the ERR level
 	static void err (const char *str, ...) __attribute__((format(printf, 1, 2)));
 
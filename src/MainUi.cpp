@@ -29,19 +29,27 @@
 */
 #include "Config.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <unistd.h>
-#include <sys/select.h>
 #include <list>
+#include <vector>
+#include <algorithm>
+#include "SDL2/SDL.h"
 #include "StdString.h"
 #include "App.h"
 #include "Label.h"
 #include "Image.h"
 #include "ImageWindow.h"
+#include "ImagePrefetch.h"
 #include "Ui.h"
-#include "Buffer.h"
+#include "CommandReader.h"
+#include "CommandInput.h"
+#include "CommandOutput.h"
 #include "OsUtil.h"
 #include "SystemInterface.h"
+#include "CommandParams.h"
 #include "Json.h"
+#include "JsonArena.h"
 #include "Color.h"
 #include "Panel.h"
 #include "IconLabelWindow.h"
@@ -49,32 +57,63 @@
 #include "MainUi.h"
 
 const int MainUi::MaxCommandSize = (256 * 1024); // bytes
+const int MainUi::MaxScheduledCommands = 4096;
+const int MainUi::MaxStoredAnimations = 64;
+const int MainUi::DefaultAnimationPrefetchTime = 2000; // milliseconds
 
 MainUi::MainUi ()
 : Ui ()
+, coalescedCommandCount (0)
+, isReplaying (false)
+, commandInput (MainUi::MaxCommandSize)
 , backgroundPanel (NULL)
+, replayStartCounter (0)
+, replayCommandCount (0)
+, animationSequence (NULL)
+, animationIterationStartTime (0)
+, animationIterationCount (0)
+, animationPrefetchTime (0)
+, animationPrefetchStartTime (0)
+, animationPrefetchIndex (0)
+, animationPrefetchIteration (0)
+, nextScheduleSequence (0)
 {
 
 }
 
 MainUi::~MainUi () {
 	clearAnimation ();
+	clearStoredAnimations ();
+	clearScheduledCommands ();
+	clearWindowExpiration ();
 	clearWindowIdMap ();
 }
 
 void MainUi::clearAnimation () {
-	std::list<MainUi::AnimationCommand>::iterator i, end;
+	animationTimeline.clear ();
+	animationSequence = NULL;
+	animationIterationStartTime = 0;
+	animationIterationCount = 0;
+	animationPrefetchStartTime = 0;
+	animationPrefetchIndex = 0;
+	animationPrefetchIteration = 0;
+	animationLabelOverrideMap.clear ();
+	playAnimationSequence.clear ();
+}
+
+void MainUi::clearStoredAnimations () {
+	std::map<StdString, AnimationSequence *>::iterator i, end;
 
-	i = animationList.begin ();
-	end = animationList.end ();
+	i = storedAnimationMap.begin ();
+	end = storedAnimationMap.end ();
 	while (i != end) {
-		if (i->cmdInv) {
-			delete (i->cmdInv);
-			i->cmdInv = NULL;
+		if (i->second) {
+			delete (i->second);
+			i->second = NULL;
 		}
 		++i;
 	}
-	animationList.clear ();
+	storedAnimationMap.clear ();
 }
 
 void MainUi::clearWindowIdMap () {
@@ -113,9 +152,52 @@ void MainUi::setWindowId (const StdString &windowId, Widget *widget) {
 }
 
 OsUtil::Result MainUi::doLoad () {
-	StdString path;
+	StdString path, formatname;
 	ImageWindow *image;
 	MainUi::BackgroundImageLoadedContext *ctx;
+	OsUtil::Result result;
+	int format;
+
+	format = CommandReader::JsonFormat;
+	formatname = OsUtil::getEnvValue ("COMMAND_FORMAT", "");
+	if (! formatname.empty ()) {
+		format = CommandReader::getFormat (formatname);
+		if (format < 0) {
+			Log::err ("Invalid COMMAND_FORMAT value \"%s\", expected json or msgpack", formatname.c_str ());
+			return (OsUtil::InvalidConfigurationError);
+		}
+	}
+	result = commandOutput.start (STDOUT_FILENO);
+	if (result != OsUtil::Success) {
+		return (result);
+	}
+	commandInput.wakeEvent = &(App::instance->updateWakeEvent);
+	replayPath = OsUtil::getEnvValue ("REPLAY_JOURNAL", "");
+	if (! replayPath.empty ()) {
+		result = commandInput.startReplay (replayPath, OsUtil::getEnvValue ("REPLAY_REALTIME", false));
+		if (result != OsUtil::Success) {
+			return (result);
+		}
+		isReplaying = true;
+		replayCommandCount = 0;
+		replayStartCounter = SDL_GetPerformanceCounter ();
+		App::instance->startFrameStats ();
+	}
+	else {
+		path = OsUtil::getEnvValue ("RECORD_JOURNAL", "");
+		if (! path.empty ()) {
+			result = commandInput.openJournal (path);
+			if (result != OsUtil::Success) {
+				return (result);
+			}
+		}
+		result = commandInput.start (STDIN_FILENO, format, formatname.empty (), OsUtil::getEnvValue ("SURFACE_CONTROL_SOCKET", ""));
+		if (result != OsUtil::Success) {
+			return (result);
+		}
+	}
+
+	animationPrefetchTime = ((int64_t) OsUtil::getEnvValue ("ANIMATION_PREFETCH_TIME", MainUi::DefaultAnimationPrefetchTime)) * 1000;
 
 	backgroundPanel = (Panel *) addWidget (new Panel ());
 	backgroundPanel->setFixedSize (true, App::instance->windowWidth, App::instance->windowHeight);
@@ -147,116 +229,562 @@ OsUtil::Result MainUi::doLoad () {
 }
 
 void MainUi::doUnload () {
+	int64_t arenacount, valuecount, heapcount, requestcount, hitcount, misscount;
+
+	commandInput.stop ();
+	Log::debug ("Command input ended; %s coalescedCount=%lli", commandInput.toString ().c_str (), (long long int) coalescedCommandCount);
+	commandOutput.stop ();
+	Log::debug ("Command output ended; %s", commandOutput.toString ().c_str ());
+	JsonArena::getStats (&arenacount, &valuecount, &heapcount);
+	if (arenacount > 0) {
+		Log::debug ("Command parse allocation totals; commandCount=%lli parseAllocCount=%lli heapAllocCount=%lli parseAllocsPerCommand=%.2f heapAllocsPerCommand=%.2f", (long long int) arenacount, (long long int) valuecount, (long long int) heapcount, (double) valuecount / (double) arenacount, (double) heapcount / (double) arenacount);
+	}
+	ImagePrefetch::instance->getStats (&requestcount, &hitcount, &misscount);
+	if (requestcount > 0) {
+		Log::debug ("Animation prefetch totals; requestCount=%lli hitCount=%lli missCount=%lli", (long long int) requestcount, (long long int) hitcount, (long long int) misscount);
+	}
+	ImagePrefetch::instance->clear ();
 	backgroundPanel = NULL;
 }
 
-void MainUi::doUpdate (int msElapsed) {
-	StdString s;
-	Json *cmd;
+void MainUi::doUpdate (float msElapsed) {
+	MainUi::PendingCommand item;
+	std::vector<MainUi::PendingCommand>::iterator i, end;
 	SystemInterface::Prefix prefix;
-	fd_set rfds;
-	struct timeval tv;
-	char buf[8192];
-	int len;
+	StdString err;
+	int64_t now;
 	bool result;
 
-	while (true) {
-		FD_ZERO (&rfds);
-		FD_SET (0, &rfds);
-		tv.tv_sec = 0;
-		tv.tv_usec = 0;
-		len = select (1, &rfds, NULL, NULL, &tv);
-		if (len != 1) {
-			break;
+	now = OsUtil::getTime ();
+	executeScheduledCommands (now);
+
+	pendingCommandList.clear ();
+	while (commandInput.nextCommand (&(item.command))) {
+		prefix = SystemInterface::instance->getCommandPrefix (item.command.json);
+		item.isScheduled = (prefix.startTime > now);
+		item.startTime = prefix.startTime;
+		item.priority = prefix.priority;
+		pendingCommandList.push_back (item);
+	}
+	if (pendingCommandList.size () > 1) {
+		coalescePendingCommands ();
+	}
+
+	i = pendingCommandList.begin ();
+	end = pendingCommandList.end ();
+	while (i != end) {
+		err.assign ("");
+		if (i->isScheduled) {
+			result = scheduleCommand (&(*i), &err);
+		}
+		else if (i->isSuperseded) {
+			result = CommandParams::validateCommand (i->command.json->getJsonValue (), &err);
+			if (result) {
+				++coalescedCommandCount;
+			}
+		}
+		else {
+			result = executeCommand (i->command.json, true, &err);
+		}
+		if (i->command.json) {
+			delete (i->command.json);
+			i->command.json = NULL;
 		}
-		len = read (0, buf, sizeof (buf));
-		if (len <= 0) {
+		writeCommandResult (i->command, result, err);
+		if (isReplaying) {
+			App::instance->addPresentWait (i->command.enqueueTime);
+			++replayCommandCount;
+		}
+		++i;
+	}
+	pendingCommandList.clear ();
+	commandOutput.flush ();
+
+	if (isReplaying && commandInput.isReplayComplete () && scheduledCommandQueue.empty () && (App::instance->getPresentWaitCount () <= 0)) {
+		endReplay ();
+	}
+	if (isReplaying) {
+		// Replay completion depends on frames presented by the main thread, which does not signal the update thread
+		App::instance->scheduleUpdate ();
+	}
+	if (! scheduledCommandQueue.empty ()) {
+		App::instance->scheduleUpdate (scheduledCommandQueue.top ().startTime - now);
+	}
+
+	updateWindowExpiration (now);
+	updateAnimation ();
+}
+
+bool MainUi::ScheduledCommandCompare::operator() (const MainUi::ScheduledCommand &a, const MainUi::ScheduledCommand &b) const {
+	if (a.startTime != b.startTime) {
+		return (a.startTime > b.startTime);
+	}
+	if (a.priority != b.priority) {
+		return (a.priority < b.priority);
+	}
+	return (a.sequence > b.sequence);
+}
+
+bool MainUi::scheduleCommand (MainUi::PendingCommand *item, StdString *errorMessage) {
+	MainUi::ScheduledCommand cmd;
+
+	if (! CommandParams::validateCommand (item->command.json->getJsonValue (), errorMessage)) {
+		return (false);
+	}
+	if ((int) scheduledCommandQueue.size () >= MainUi::MaxScheduledCommands) {
+		errorMessage->sprintf ("Scheduled command limit exceeded (%i)", MainUi::MaxScheduledCommands);
+		return (false);
+	}
+	cmd.startTime = item->startTime;
+	cmd.priority = item->priority;
+	cmd.sequence = nextScheduleSequence;
+	++nextScheduleSequence;
+	cmd.cmdInv = item->command.json;
+	item->command.json = NULL;
+	scheduledCommandQueue.push (cmd);
+	return (true);
+}
+
+void MainUi::executeScheduledCommands (int64_t now) {
+	MainUi::ScheduledCommand cmd;
+	StdString err;
+
+	while (! scheduledCommandQueue.empty ()) {
+		if (scheduledCommandQueue.top ().startTime > now) {
 			break;
 		}
-		if (buf[len - 1] == '\n') {
-			--len;
+		cmd = scheduledCommandQueue.top ();
+		scheduledCommandQueue.pop ();
+		err.assign ("");
+		if (! executeCommand (cmd.cmdInv, true, &err)) {
+			Log::debug ("Scheduled command failed; startTime=%lli delay=%llims err=\"%s\"", (long long) cmd.startTime, (long long) (now - cmd.startTime), err.c_str ());
 		}
+		delete (cmd.cmdInv);
+	}
+}
 
-		if (! commandBuffer.empty ()) {
-			commandBuffer.add ((uint8_t *) buf, len);
-			s.assignBuffer (&commandBuffer);
+void MainUi::clearScheduledCommands () {
+	while (! scheduledCommandQueue.empty ()) {
+		delete (scheduledCommandQueue.top ().cmdInv);
+		scheduledCommandQueue.pop ();
+	}
+}
+
+void MainUi::setWindowExpiration (Widget *widget, Json *cmdInv) {
+	MainUi::WindowExpiration item;
+	SystemInterface::Prefix prefix;
+
+	if (! widget) {
+		return;
+	}
+	prefix = SystemInterface::instance->getCommandPrefix (cmdInv);
+	if (prefix.duration <= 0) {
+		return;
+	}
+	widget->retain ();
+	item.expireTime = OsUtil::getTime () + prefix.duration;
+	item.widget = widget;
+	windowExpirationList.push_back (item);
+}
+
+void MainUi::updateWindowExpiration (int64_t now) {
+	std::list<MainUi::WindowExpiration>::iterator i;
+	std::map<StdString, Widget *>::iterator pos, end;
+
+	i = windowExpirationList.begin ();
+	while (i != windowExpirationList.end ()) {
+		if ((! i->widget->isDestroyed) && (i->expireTime > now)) {
+			App::instance->scheduleUpdate (i->expireTime - now);
+			++i;
+			continue;
+		}
+		if (! i->widget->isDestroyed) {
+			i->widget->isDestroyed = true;
+			pos = windowIdMap.begin ();
+			end = windowIdMap.end ();
+			while (pos != end) {
+				if (pos->second == i->widget) {
+					pos->second->release ();
+					windowIdMap.erase (pos);
+					break;
+				}
+				++pos;
+			}
+		}
+		i->widget->release ();
+		i = windowExpirationList.erase (i);
+	}
+}
+
+void MainUi::clearWindowExpiration () {
+	std::list<MainUi::WindowExpiration>::iterator i, end;
+
+	i = windowExpirationList.begin ();
+	end = windowExpirationList.end ();
+	while (i != end) {
+		if (i->widget) {
+			i->widget->release ();
+			i->widget = NULL;
+		}
+		++i;
+	}
+	windowExpirationList.clear ();
+}
+
+void MainUi::endReplay () {
+	std::vector<int64_t> frametimes, latencies;
+	Json report;
+	StdString text;
+	FILE *fp;
+	int64_t elapsed;
+	double rate;
+
+	isReplaying = false;
+	elapsed = OsUtil::getCounterMicroseconds (SDL_GetPerformanceCounter () - replayStartCounter, SDL_GetPerformanceFrequency ());
+	App::instance->stopFrameStats (&frametimes, &latencies);
+	std::sort (frametimes.begin (), frametimes.end ());
+	std::sort (latencies.begin (), latencies.end ());
+	rate = 0.0f;
+	if (elapsed > 0) {
+		rate = ((double) replayCommandCount) * 1000000.0f / ((double) elapsed);
+	}
+
+	report.setEmpty ();
+	report.set ("journal", replayPath);
+	report.set ("commandCount", replayCommandCount);
+	report.set ("elapsedUs", elapsed);
+	report.set ("commandsPerSecond", rate);
+	report.set ("latencySampleCount", (int) latencies.size ());
+	report.set ("latencyP50Us", MainUi::getPercentile (latencies, 50));
+	report.set ("latencyP99Us", MainUi::getPercentile (latencies, 99));
+	report.set ("latencyMaxUs", MainUi::getPercentile (latencies, 100));
+	report.set ("frameCount", (int) frametimes.size ());
+	report.set ("frameTimeMeanUs", MainUi::getMean (frametimes));
+	report.set ("frameTimeP50Us", MainUi::getPercentile (frametimes, 50));
+	report.set ("frameTimeP99Us", MainUi::getPercentile (frametimes, 99));
+	report.set ("frameTimeMaxUs", MainUi::getPercentile (frametimes, 100));
+	text = report.toString ();
+	Log::printf ("Replay ended; %s", text.c_str ());
+
+	replayPath = OsUtil::getEnvValue ("REPLAY_REPORT", "");
+	if (! replayPath.empty ()) {
+		fp = fopen (replayPath.c_str (), "wb");
+		if (! fp) {
+			Log::err ("Failed to write replay report; path=\"%s\"", replayPath.c_str ());
 		}
 		else {
-			s.assign (buf, len);
+			fprintf (fp, "%s\n", text.c_str ());
+			fclose (fp);
+		}
+	}
+	App::instance->shutdown ();
+}
+
+int64_t MainUi::getPercentile (const std::vector<int64_t> &sortedValues, int percent) {
+	int index;
+
+	if (sortedValues.empty ()) {
+		return (0);
+	}
+	index = (int) ((((int64_t) sortedValues.size ()) * percent + 99) / 100) - 1;
+	if (index < 0) {
+		index = 0;
+	}
+	if (index >= (int) sortedValues.size ()) {
+		index = (int) sortedValues.size () - 1;
+	}
+	return (sortedValues[index]);
+}
+
+double MainUi::getMean (const std::vector<int64_t> &values) {
+	std::vector<int64_t>::const_iterator i, end;
+	double sum;
+
+	if (values.empty ()) {
+		return (0.0f);
+	}
+	sum = 0.0f;
+	i = values.begin ();
+	end = values.end ();
+	while (i != end) {
+		sum += (double) *i;
+		++i;
+	}
+	return (sum / (double) values.size ());
+}
+
+void MainUi::coalescePendingCommands () {
+	std::vector<MainUi::PendingCommand>::reverse_iterator i, end;
+	StdString err;
+	bool isbackgroundset;
+
+	// Walk the list from newest to oldest, recording the effects of later commands that would replace those of earlier ones. A command only supersedes others if it passes validation and would take effect when executed.
+	isbackgroundset = false;
+	coalesceWindowIdSet.clear ();
+	i = pendingCommandList.rbegin ();
+	end = pendingCommandList.rend ();
+	while (i != end) {
+		if (i->isScheduled) {
+			++i;
+			continue;
 		}
-		if (!(SystemInterface::instance->parseCommand (s, &cmd))) {
-			if (commandBuffer.empty ()) {
-				commandBuffer.add ((uint8_t *) buf, len);
+		switch (SystemInterface::instance->getCommandId (i->command.json)) {
+			case SystemInterface::CommandId_ShowColorFillBackground:
+			case SystemInterface::CommandId_ShowResourceImageBackground:
+			case SystemInterface::CommandId_ShowFileImageBackground: {
+				if (isbackgroundset) {
+					i->isSuperseded = true;
+				}
+				else if (CommandParams::validateCommand (i->command.json->getJsonValue (), &err)) {
+					isbackgroundset = true;
+				}
+				break;
 			}
-			if (commandBuffer.length > MainUi::MaxCommandSize) {
-				commandBuffer.reset ();
+			case SystemInterface::CommandId_ShowIconLabelWindow: {
+				ShowIconLabelWindowParams params;
+				if (isbackgroundset) {
+					i->isSuperseded = true;
+				}
+				else if (params.decode (i->command.json, &err)) {
+					i->isSuperseded = isWindowIdSuperseded (params.windowId, getIconType ((int) params.icon) >= 0);
+				}
+				break;
+			}
+			case SystemInterface::CommandId_ShowCountdownWindow: {
+				ShowCountdownWindowParams params;
+				if (isbackgroundset) {
+					i->isSuperseded = true;
+				}
+				else if (params.decode (i->command.json, &err)) {
+					i->isSuperseded = isWindowIdSuperseded (params.windowId, getIconType ((int) params.icon) >= 0);
+				}
+				break;
+			}
+			case SystemInterface::CommandId_RemoveWindow: {
+				RemoveWindowParams params;
+				if (isbackgroundset) {
+					i->isSuperseded = true;
+				}
+				else if (params.decode (i->command.json, &err)) {
+					i->isSuperseded = isWindowIdSuperseded (params.windowId, true);
+				}
+				break;
 			}
-			continue;
 		}
+		++i;
+	}
+	coalesceWindowIdSet.clear ();
+}
 
-		commandBuffer.reset ();
-		result = executeCommand (cmd, true);
-		delete (cmd);
-
-		prefix.createTime = OsUtil::getTime ();
-		cmd = SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_CommandResult, (new Json ())->set ("success", result));
-		Log::printf ("%s", cmd->toString ().c_str ());
-		delete (cmd);
+bool MainUi::isWindowIdSuperseded (const StdString &windowId, bool isEffective) {
+	if (windowId.empty ()) {
+		return (false);
 	}
+	if (coalesceWindowIdSet.count (windowId) > 0) {
+		return (true);
+	}
+	if (isEffective) {
+		coalesceWindowIdSet.insert (windowId);
+	}
+	return (false);
+}
 
-	updateAnimation (msElapsed);
+void MainUi::writeCommandResult (const CommandInput::Command &command, bool success, const StdString &errorMessage) {
+	if (command.connectionId == CommandInput::PrimaryInputId) {
+		commandOutput.addCommandResult (command.format, success, errorMessage);
+		return;
+	}
+	connectionResultBuffer.setDataLength (0);
+	commandOutput.appendCommandResult (&connectionResultBuffer, command.format, success, errorMessage);
+	commandInput.writeConnectionData (command.connectionId, connectionResultBuffer.data, connectionResultBuffer.length);
 }
 
 bool MainUi::inputCommand (Json *cmdInv) {
 	return (executeCommand (cmdInv, true));
 }
 
-bool MainUi::executeCommand (Json *cmdInv, bool allowPlayAnimation) {
-	switch (SystemInterface::instance->getCommandId (cmdInv)) {
+bool MainUi::executeCommand (Json *cmdInv, bool allowPlayAnimation, StdString *errorMessage) {
+	StdString err;
+	int id;
+
+	id = SystemInterface::instance->getCommandId (cmdInv);
+	switch (id) {
 		case SystemInterface::CommandId_RemoveWindow: {
-			removeWindow (cmdInv);
+			RemoveWindowParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			removeWindow (&params);
+			return (true);
+		}
+		case SystemInterface::CommandId_ExecuteBatch: {
+			ExecuteBatchParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			if (! executeBatch (&params, allowPlayAnimation, &err)) {
+				break;
+			}
 			return (true);
 		}
 		case SystemInterface::CommandId_PlayAnimation: {
-			if (allowPlayAnimation) {
-				playAnimation (cmdInv);
-				return (true);
+			PlayAnimationParams params;
+			if (! allowPlayAnimation) {
+				return (false);
 			}
-			break;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			if (! playAnimation (&params, cmdInv, &err)) {
+				break;
+			}
+			return (true);
+		}
+		case SystemInterface::CommandId_StoreAnimation: {
+			StoreAnimationParams params;
+			if (! allowPlayAnimation) {
+				return (false);
+			}
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			if (! storeAnimation (&params, cmdInv, &err)) {
+				break;
+			}
+			return (true);
+		}
+		case SystemInterface::CommandId_StartAnimation: {
+			StartAnimationParams params;
+			if (! allowPlayAnimation) {
+				return (false);
+			}
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			if (! startAnimation (&params, &err)) {
+				break;
+			}
+			return (true);
+		}
+		case SystemInterface::CommandId_StopAnimation: {
+			if (! allowPlayAnimation) {
+				return (false);
+			}
+			clearAnimation ();
+			return (true);
 		}
 		case SystemInterface::CommandId_ShowColorFillBackground: {
-			showColorFillBackground (cmdInv);
+			ShowColorFillBackgroundParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			showColorFillBackground (&params);
 			return (true);
 		}
 		case SystemInterface::CommandId_ShowResourceImageBackground: {
-			showResourceImageBackground (cmdInv);
+			ShowResourceImageBackgroundParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			showResourceImageBackground (&params);
 			return (true);
 		}
 		case SystemInterface::CommandId_ShowFileImageBackground: {
-			showFileImageBackground (cmdInv);
+			ShowFileImageBackgroundParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			showFileImageBackground (&params);
 			return (true);
 		}
 		case SystemInterface::CommandId_ShowIconLabelWindow: {
-			showIconLabelWindow (cmdInv);
+			ShowIconLabelWindowParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			setWindowExpiration (showIconLabelWindow (&params), cmdInv);
 			return (true);
 		}
 		case SystemInterface::CommandId_ShowCountdownWindow: {
-			showCountdownWindow (cmdInv);
+			ShowCountdownWindowParams params;
+			if (! params.decode (cmdInv, &err)) {
+				break;
+			}
+			setWindowExpiration (showCountdownWindow (&params), cmdInv);
 			return (true);
 		}
+		default: {
+			err.sprintf ("Unsupported command ID %i", id);
+			break;
+		}
+	}
+
+	Log::debug ("Command rejected; id=%i err=\"%s\"", id, err.c_str ());
+	if (errorMessage) {
+		errorMessage->assign (err);
 	}
 	return (false);
 }
 
-void MainUi::removeWindow (Json *cmdInv) {
-	StdString id;
-	std::map<StdString, Widget *>::iterator pos;
+bool MainUi::executeBatch (ExecuteBatchParams *params, bool allowPlayAnimation, StdString *errorMessage) {
+	std::vector<Json>::iterator i, end;
+	StdString err;
+	int index, id, failindex;
 
-	id = SystemInterface::instance->getCommandStringParam (cmdInv, "windowId", StdString (""));
-	if (id.empty ()) {
-		return;
+	i = params->commands.begin ();
+	end = params->commands.end ();
+	index = 0;
+	while (i != end) {
+		id = SystemInterface::instance->getCommandId (&(*i));
+		switch (id) {
+			case SystemInterface::CommandId_RemoveWindow:
+			case SystemInterface::CommandId_ShowColorFillBackground:
+			case SystemInterface::CommandId_ShowResourceImageBackground:
+			case SystemInterface::CommandId_ShowFileImageBackground:
+			case SystemInterface::CommandId_ShowIconLabelWindow:
+			case SystemInterface::CommandId_ShowCountdownWindow: {
+				break;
+			}
+			case SystemInterface::CommandId_PlayAnimation:
+			case SystemInterface::CommandId_StoreAnimation:
+			case SystemInterface::CommandId_StartAnimation:
+			case SystemInterface::CommandId_StopAnimation: {
+				if (! allowPlayAnimation) {
+					errorMessage->sprintf ("Batch command %i: %s is not allowed in this context", index, SystemInterface::instance->getCommandName (&(*i)).c_str ());
+					return (false);
+				}
+				break;
+			}
+			default: {
+				errorMessage->sprintf ("Batch command %i: unsupported command ID %i", index, id);
+				return (false);
+			}
+		}
+		++index;
+		++i;
 	}
-	pos = windowIdMap.find (id);
+
+	backgroundPanel->beginBatch ();
+	failindex = -1;
+	i = params->commands.begin ();
+	index = 0;
+	while (i != end) {
+		if ((! executeCommand (&(*i), allowPlayAnimation, &err)) && (failindex < 0)) {
+			failindex = index;
+			errorMessage->sprintf ("Batch command %i: %s", index, err.c_str ());
+		}
+		++index;
+		++i;
+	}
+	backgroundPanel->endBatch ();
+
+	return (failindex < 0);
+}
+
+void MainUi::removeWindow (RemoveWindowParams *params) {
+	std::map<StdString, Widget *>::iterator pos;
+
+	pos = windowIdMap.find (params->windowId);
 	if (pos == windowIdMap.end ()) {
 		return;
 	}
@@ -268,61 +796,205 @@ void MainUi::removeWindow (Json *cmdInv) {
 	windowIdMap.erase (pos);
 }
 
-void MainUi::playAnimation (Json *cmdInv) {
-	Json item, execcmd;
-	MainUi::AnimationCommand listcmd;
-	int i, count;
-
+bool MainUi::playAnimation (PlayAnimationParams *params, Json *cmdInv, StdString *errorMessage) {
 	clearAnimation ();
-	count = SystemInterface::instance->getCommandArrayLength (cmdInv, "commands");
-	for (i = 0; i < count; ++i) {
-		if (SystemInterface::instance->getCommandObjectArrayItem (cmdInv, "commands", i, &item)) {
-			listcmd.executeTime = item.getNumber ("executeTime", (int) 0);
-			if (item.getObject ("command", &execcmd)) {
-				listcmd.cmdInv = execcmd.copy ();
-				animationList.push_back (listcmd);
+	if (! playAnimationSequence.compile (params, cmdInv, errorMessage)) {
+		return (false);
+	}
+	beginAnimation (&playAnimationSequence, MainUi::getAnimationTime ());
+	return (true);
+}
+
+bool MainUi::storeAnimation (StoreAnimationParams *params, Json *cmdInv, StdString *errorMessage) {
+	std::map<StdString, AnimationSequence *>::iterator pos;
+	AnimationSequence *sequence;
+
+	pos = storedAnimationMap.find (params->name);
+	if ((pos == storedAnimationMap.end ()) && ((int) storedAnimationMap.size () >= MainUi::MaxStoredAnimations)) {
+		errorMessage->sprintf ("Stored animation limit reached (%i)", MainUi::MaxStoredAnimations);
+		return (false);
+	}
+	sequence = new AnimationSequence ();
+	if (! sequence->compile (params, cmdInv, errorMessage)) {
+		delete (sequence);
+		return (false);
+	}
+	if (pos == storedAnimationMap.end ()) {
+		storedAnimationMap.insert (std::pair<StdString, AnimationSequence *> (params->name, sequence));
+	}
+	else {
+		if (pos->second) {
+			if (animationSequence == pos->second) {
+				clearAnimation ();
 			}
+			delete (pos->second);
 		}
+		pos->second = sequence;
 	}
+	return (true);
 }
 
-void MainUi::updateAnimation (int msElapsed) {
-	std::list<MainUi::AnimationCommand>::iterator i, end, pos;
-	int mintime;
+bool MainUi::startAnimation (StartAnimationParams *params, StdString *errorMessage) {
+	std::map<StdString, AnimationSequence *>::iterator pos;
+	std::vector<AnimationOverrideParams>::iterator i, end;
 
-	if (animationList.size () <= 0) {
+	pos = storedAnimationMap.find (params->name);
+	if ((pos == storedAnimationMap.end ()) || (! pos->second)) {
+		errorMessage->sprintf ("Unknown animation name \"%s\"", params->name.c_str ());
+		return (false);
+	}
+	clearAnimation ();
+	i = params->overrides.begin ();
+	end = params->overrides.end ();
+	while (i != end) {
+		if (! i->labelText.empty ()) {
+			animationLabelOverrideMap[i->windowId] = i->labelText;
+		}
+		++i;
+	}
+	beginAnimation (pos->second, MainUi::getAnimationTime ());
+	return (true);
+}
+
+void MainUi::beginAnimation (AnimationSequence *sequence, int64_t startTime) {
+	animationTimeline.clear ();
+	animationSequence = sequence;
+	animationIterationCount = 0;
+	animationPrefetchStartTime = startTime;
+	animationPrefetchIndex = 0;
+	animationPrefetchIteration = 0;
+	scheduleAnimationIteration (startTime);
+	prefetchAnimationSteps (startTime);
+}
+
+void MainUi::scheduleAnimationIteration (int64_t startTime) {
+	int i, len;
+
+	animationIterationStartTime = startTime;
+	len = (int) animationSequence->steps.size ();
+	for (i = 0; i < len; ++i) {
+		animationTimeline.addStep (startTime + animationSequence->steps[i].offset, i);
+	}
+	if (animationSequence->hasIteration (animationIterationCount + 1)) {
+		// A negative step index marks the end of the iteration, and is added last so that steps due at the same time execute before it
+		animationTimeline.addStep (startTime + animationSequence->loopPeriod, -1);
+	}
+}
+
+void MainUi::updateAnimation () {
+	int64_t now, starttime, waketime, prefetchtime;
+	int index;
+
+	if (animationTimeline.empty () || (! animationSequence)) {
+		return;
+	}
+	now = MainUi::getAnimationTime ();
+	while (animationSequence && animationTimeline.nextDueStep (now, &index)) {
+		if (index < 0) {
+			++animationIterationCount;
+			starttime = animationIterationStartTime + animationSequence->loopPeriod;
+			if ((starttime + animationSequence->loopPeriod) <= now) {
+				// Playback fell more than a full iteration behind, as after a long stall; resume from the current time rather than executing the missed iterations in a burst
+				starttime = now;
+				animationPrefetchStartTime = now;
+				animationPrefetchIndex = 0;
+				animationPrefetchIteration = animationIterationCount;
+			}
+			scheduleAnimationIteration (starttime);
+			continue;
+		}
+		if (index < (int) animationSequence->steps.size ()) {
+			executeAnimationStep (&(animationSequence->steps[index]));
+		}
+	}
+	if (animationTimeline.empty ()) {
+		clearAnimation ();
 		return;
 	}
+	prefetchtime = prefetchAnimationSteps (now);
+
+	// Wake for the next prefetch as well as the next step, since steps spaced further apart than animationPrefetchTime would otherwise be reached without a prefetch
+	waketime = animationTimeline.getNextDueTime ();
+	if ((prefetchtime >= 0) && (prefetchtime < waketime)) {
+		waketime = prefetchtime;
+	}
+	App::instance->scheduleUpdate ((waketime - now + 999) / 1000);
+}
+
+int64_t MainUi::prefetchAnimationSteps (int64_t now) {
+	AnimationSequence::Step *step;
+	int len;
 
+	if ((animationPrefetchTime <= 0) || (! animationSequence)) {
+		return (-1);
+	}
+	len = (int) animationSequence->steps.size ();
 	while (true) {
-		i = animationList.begin ();
-		end = animationList.end ();
-		mintime = -1;
-		pos = end;
-		while (i != end) {
-			if ((mintime < 0) || (i->executeTime < mintime)) {
-				mintime = i->executeTime;
-				pos = i;
+		if (animationPrefetchIndex >= len) {
+			if (! animationSequence->hasIteration (animationPrefetchIteration + 1)) {
+				return (-1);
 			}
-			++i;
+			++animationPrefetchIteration;
+			animationPrefetchStartTime += animationSequence->loopPeriod;
+			animationPrefetchIndex = 0;
 		}
-		if ((mintime > msElapsed) || (pos == end)) {
-			break;
+		step = &(animationSequence->steps[animationPrefetchIndex]);
+		if ((animationPrefetchStartTime + step->offset) > (now + animationPrefetchTime)) {
+			return (animationPrefetchStartTime + step->offset - animationPrefetchTime);
 		}
-
-		if (pos->cmdInv) {
-			executeCommand (pos->cmdInv);
-			delete (pos->cmdInv);
+		if (! step->imagePath.empty ()) {
+			switch (step->commandId) {
+				case SystemInterface::CommandId_ShowFileImageBackground: {
+					ImagePrefetch::instance->prefetch (step->imagePath, true);
+					break;
+				}
+				case SystemInterface::CommandId_ShowResourceImageBackground: {
+					ImagePrefetch::instance->prefetch (step->imagePath, false);
+					break;
+				}
+			}
 		}
-		animationList.erase (pos);
+		++animationPrefetchIndex;
 	}
+}
 
-	i = animationList.begin ();
-	end = animationList.end ();
-	while (i != end) {
-		i->executeTime -= msElapsed;
-		++i;
+void MainUi::executeAnimationStep (AnimationSequence::Step *step) {
+	std::map<StdString, StdString>::iterator pos;
+	Json cmd;
+	StdString err;
+
+	if (! step->command) {
+		return;
+	}
+	cmd.assignView (step->command);
+	if ((! step->windowId.empty ()) && (! animationLabelOverrideMap.empty ())) {
+		pos = animationLabelOverrideMap.find (step->windowId);
+		if (pos != animationLabelOverrideMap.end ()) {
+			switch (step->commandId) {
+				case SystemInterface::CommandId_ShowIconLabelWindow: {
+					ShowIconLabelWindowParams params;
+					if (params.decode (&cmd, &err)) {
+						params.labelText.assign (pos->second);
+						setWindowExpiration (showIconLabelWindow (&params), &cmd);
+					}
+					return;
+				}
+				case SystemInterface::CommandId_ShowCountdownWindow: {
+					ShowCountdownWindowParams params;
+					if (params.decode (&cmd, &err)) {
+						params.labelText.assign (pos->second);
+						setWindowExpiration (showCountdownWindow (&params), &cmd);
+					}
+					return;
+				}
+			}
+		}
 	}
+	executeCommand (&cmd);
+}
+
+int64_t MainUi::getAnimationTime () {
+	return (OsUtil::getMonotonicTime () / 1000);
 }
 
 int MainUi::getIconType (int icon) {
@@ -353,31 +1025,21 @@ void MainUi::setWidgetPosition (Widget *widget, float x, float y) {
 	widget->position.assign (x, y);
 }
 
-void MainUi::showColorFillBackground (Json *cmdInv) {
-	uint8_t r, g, b;
-
+void MainUi::showColorFillBackground (ShowColorFillBackgroundParams *params) {
 	backgroundPanel->clear ();
 	clearWindowIdMap ();
-	r = (uint8_t) SystemInterface::instance->getCommandNumberParam (cmdInv, "fillColorR", (int) 0);
-	g = (uint8_t) SystemInterface::instance->getCommandNumberParam (cmdInv, "fillColorG", (int) 0);
-	b = (uint8_t) SystemInterface::instance->getCommandNumberParam (cmdInv, "fillColorB", (int) 0);
-	backgroundPanel->setFillBg (true, Color::fromByteValues (r, g, b));
+	backgroundPanel->setFillBg (true, Color::fromByteValues ((uint8_t) params->fillColorR, (uint8_t) params->fillColorG, (uint8_t) params->fillColorB));
 }
 
-void MainUi::showResourceImageBackground (Json *cmdInv) {
+void MainUi::showResourceImageBackground (ShowResourceImageBackgroundParams *params) {
 	ImageWindow *image;
-	StdString path;
 
-	path = SystemInterface::instance->getCommandStringParam (cmdInv, "imagePath", StdString (""));
-	if (path.empty ()) {
-		return;
-	}
 	backgroundPanel->clear ();
 	clearWindowIdMap ();
 
 	image = (ImageWindow *) backgroundPanel->addWidget (new ImageWindow ());
 	image->onLoadFit ((float) App::instance->windowWidth, (float) App::instance->windowHeight);
-	image->setImageFilePath (path);
+	image->setImageFilePath (params->imagePath);
 }
 
 void MainUi::showFileImageBackground_imageLoaded (void *ctxPtr, Widget *widgetPtr) {
@@ -409,21 +1071,16 @@ void MainUi::showFileImageBackground_imageLoaded (void *ctxPtr, Widget *widgetPt
 	delete (ctx);
 }
 
-void MainUi::showFileImageBackground (Json *cmdInv) {
+void MainUi::showFileImageBackground (ShowFileImageBackgroundParams *params) {
 	ImageWindow *image;
-	StdString path;
 	MainUi::BackgroundImageLoadedContext *ctx;
 
-	path = SystemInterface::instance->getCommandStringParam (cmdInv, "imagePath", StdString (""));
-	if (path.empty ()) {
-		return;
-	}
 	backgroundPanel->clear ();
 	clearWindowIdMap ();
 
 	ctx = new MainUi::BackgroundImageLoadedContext ();
 	ctx->ui = this;
-	ctx->backgroundType = SystemInterface::instance->getCommandNumberParam (cmdInv, "background", (int) 0);
+	ctx->backgroundType = (int) params->background;
 	retain ();
 	image = (ImageWindow *) backgroundPanel->addWidget (new ImageWindow ());
 	image->loadCallback = Widget::EventCallbackContext (showFileImageBackground_imageLoaded, ctx);
@@ -437,45 +1094,43 @@ void MainUi::showFileImageBackground (Json *cmdInv) {
 			break;
 		}
 	}
-	image->setImageFilePath (path, true);
+	image->setImageFilePath (params->imagePath, true);
 }
 
-void MainUi::showIconLabelWindow (Json *cmdInv) {
+Widget *MainUi::showIconLabelWindow (ShowIconLabelWindowParams *params) {
 	IconLabelWindow *window;
-	StdString id;
 	int icon;
 
-	icon = getIconType (SystemInterface::instance->getCommandNumberParam (cmdInv, "icon", (int) 0));
+	icon = getIconType ((int) params->icon);
 	if (icon < 0) {
-		return;
+		return (NULL);
 	}
-	window = (IconLabelWindow *) backgroundPanel->addWidget (new IconLabelWindow (UiConfiguration::instance->coreSprites.getSprite (icon), SystemInterface::instance->getCommandStringParam (cmdInv, "labelText", StdString (""))));
-	setWidgetPosition (window, SystemInterface::instance->getCommandNumberParam (cmdInv, "positionX", (float) 0.0f), SystemInterface::instance->getCommandNumberParam (cmdInv, "positionY", (float) 0.0f));
+	window = (IconLabelWindow *) backgroundPanel->addWidget (new IconLabelWindow (UiConfiguration::instance->coreSprites.getSprite (icon), params->labelText));
+	setWidgetPosition (window, (float) params->positionX, (float) params->positionY);
 	window->setFillBg (true, Color (1.0f, 1.0f, 1.0f));
 
-	id = SystemInterface::instance->getCommandStringParam (cmdInv, "windowId", StdString (""));
-	if (! id.empty ()) {
-		setWindowId (id, window);
+	if (! params->windowId.empty ()) {
+		setWindowId (params->windowId, window);
 	}
+	return (window);
 }
 
-void MainUi::showCountdownWindow (Json *cmdInv) {
+Widget *MainUi::showCountdownWindow (ShowCountdownWindowParams *params) {
 	CountdownWindow *window;
-	StdString id;
 	int icon;
 
-	icon = getIconType (SystemInterface::instance->getCommandNumberParam (cmdInv, "icon", (int) 0));
+	icon = getIconType ((int) params->icon);
 	if (icon < 0) {
-		return;
+		return (NULL);
 	}
-	window = (CountdownWindow *) backgroundPanel->addWidget (new CountdownWindow (UiConfiguration::instance->coreSprites.getSprite (icon), SystemInterface::instance->getCommandStringParam (cmdInv, "labelText", StdString (""))));
+	window = (CountdownWindow *) backgroundPanel->addWidget (new CountdownWindow (UiConfiguration::instance->coreSprites.getSprite (icon), params->labelText));
 	window->setDropShadow (true, UiConfiguration::instance->dropShadowColor, UiConfiguration::instance->dropShadowWidth);
-	setWidgetPosition (window, SystemInterface::instance->getCommandNumberParam (cmdInv, "positionX", (float) 0.0f), SystemInterface::instance->getCommandNumberParam (cmdInv, "positionY", (float) 0.0f));
-	window->countdown (SystemInterface::instance->getCommandNumberParam (cmdInv, "countdownTime", (int) 0));
+	setWidgetPosition (window, (float) params->positionX, (float) params->positionY);
+	window->countdown ((int) params->countdownTime);
 	window->reveal ();
 
-	id = SystemInterface::instance->getCommandStringParam (cmdInv, "windowId", StdString (""));
-	if (! id.empty ()) {
-		setWindowId (id, window);
+	if (! params->windowId.empty ()) {
+		setWindowId (params->windowId, window);
 	}
+	return (window);
 }
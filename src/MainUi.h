@@ -34,19 +34,34 @@
 
 #include <list>
 #include <map>
+#include <set>
+#include <vector>
+#include <queue>
 #include "StdString.h"
 #include "Buffer.h"
+#include "CommandInput.h"
+#include "CommandOutput.h"
+#include "CommandParams.h"
 #include "Panel.h"
 #include "Json.h"
+#include "AnimationTimeline.h"
+#include "AnimationSequence.h"
 #include "Ui.h"
 
 class MainUi : public Ui {
 public:
 	static const int MaxCommandSize;
+	static const int MaxScheduledCommands;
+	static const int MaxStoredAnimations;
+	static const int DefaultAnimationPrefetchTime;
 
 	MainUi ();
 	~MainUi ();
 
+	// Read-only data members
+	int64_t coalescedCommandCount;
+	bool isReplaying;
+
 	// Execute cmdInv as a SystemInterface command and return a boolean value indicating if the attempt succeeded
 	bool inputCommand (Json *cmdInv);
 
@@ -58,18 +73,34 @@ protected:
 	void doUnload ();
 
 	// Update subclass-specific interface state as appropriate for an elapsed millisecond time period
-	void doUpdate (int msElapsed);
+	void doUpdate (float msElapsed);
 
 private:
-	// Execute cmdInv as a surface command and return a boolean value indicating if the command was accepted. If the command is PlayAnimation, execute it only if allowPlayAnimation is true.
-	bool executeCommand (Json *cmdInv, bool allowPlayAnimation = false);
-	void removeWindow (Json *cmdInv);
-	void playAnimation (Json *cmdInv);
-	void showColorFillBackground (Json *cmdInv);
-	void showResourceImageBackground (Json *cmdInv);
-	void showFileImageBackground (Json *cmdInv);
-	void showIconLabelWindow (Json *cmdInv);
-	void showCountdownWindow (Json *cmdInv);
+	// Execute cmdInv as a surface command and return a boolean value indicating if the command was accepted. If the command is PlayAnimation or another command that controls animation playback, execute it only if allowPlayAnimation is true. If the command's params fail validation and errorMessage is not NULL, store the reason in errorMessage.
+	bool executeCommand (Json *cmdInv, bool allowPlayAnimation = false, StdString *errorMessage = NULL);
+	void removeWindow (RemoveWindowParams *params);
+
+	// Execute all commands from an ExecuteBatch command against backgroundPanel, deferring panel size updates until the batch ends and causing resulting changes to appear in the same draw frame. Returns a boolean value indicating if all commands were accepted; if not, errorMessage is set. If any command in the batch is not a surface command, the batch is rejected without executing any of its commands.
+	bool executeBatch (ExecuteBatchParams *params, bool allowPlayAnimation, StdString *errorMessage);
+
+	// Replace the playing animation with the steps of a PlayAnimation command, taking ownership of the command's value from cmdInv so that steps execute from it without being copied. Step execute times are measured from the time of this call. Returns a boolean value indicating if the animation started; if not, errorMessage is set.
+	bool playAnimation (PlayAnimationParams *params, Json *cmdInv, StdString *errorMessage);
+
+	// Compile the steps of a StoreAnimation command into storedAnimationMap, replacing and stopping any sequence previously stored under the same name. Returns a boolean value indicating if the sequence was stored; if not, errorMessage is set.
+	bool storeAnimation (StoreAnimationParams *params, Json *cmdInv, StdString *errorMessage);
+
+	// Replace the playing animation with a sequence from storedAnimationMap, starting it from its first step with the label overrides specified in params. Returns a boolean value indicating if the animation started; if not, errorMessage is set.
+	bool startAnimation (StartAnimationParams *params, StdString *errorMessage);
+	void showColorFillBackground (ShowColorFillBackgroundParams *params);
+	void showResourceImageBackground (ShowResourceImageBackgroundParams *params);
+	void showFileImageBackground (ShowFileImageBackgroundParams *params);
+
+	// Show windows as specified by the provided params and return the created window, or NULL if no window was created
+	Widget *showIconLabelWindow (ShowIconLabelWindowParams *params);
+	Widget *showCountdownWindow (ShowCountdownWindowParams *params);
+
+	// Write a CommandResult command to the source of the provided command, including errorMessage if it's not empty. Results for the primary input are buffered in commandOutput until the next flush.
+	void writeCommandResult (const CommandInput::Command &command, bool success, const StdString &errorMessage);
 
 	// Callback functions
 	struct BackgroundImageLoadedContext {
@@ -78,28 +109,122 @@ private:
 	};
 	static void showFileImageBackground_imageLoaded (void *ctxPtr, Widget *widgetPtr);
 
-	Buffer commandBuffer;
+	CommandInput commandInput;
+	CommandOutput commandOutput;
+	Buffer connectionResultBuffer;
 	Panel *backgroundPanel;
 
-	struct AnimationCommand {
-		int executeTime;
-		Json *cmdInv;
-		AnimationCommand (): executeTime (0), cmdInv (NULL) { }
+	struct PendingCommand {
+		CommandInput::Command command;
+		bool isSuperseded;
+		bool isScheduled;
+		int64_t startTime;
+		int priority;
+		PendingCommand (): isSuperseded (false), isScheduled (false), startTime (0), priority (0) { }
 	};
-	std::list<MainUi::AnimationCommand> animationList;
+	std::vector<MainUi::PendingCommand> pendingCommandList;
+	std::set<StdString> coalesceWindowIdSet;
+	StdString replayPath;
+	uint64_t replayStartCounter;
+	int64_t replayCommandCount;
+
+	// Set the isSuperseded flag on each pendingCommandList item whose effect is fully replaced by a later item in the list
+	void coalescePendingCommands ();
+
+	// Record statistics from a completed journal replay and shut down the application
+	void endReplay ();
+
+	// Return the value at the specified percentile in a sorted vector, or zero if the vector is empty
+	static int64_t getPercentile (const std::vector<int64_t> &sortedValues, int percent);
+
+	// Return the mean value of a vector, or zero if the vector is empty
+	static double getMean (const std::vector<int64_t> &values);
+
+	// Return a boolean value indicating if a command targeting windowId is superseded by a later command, as recorded in coalesceWindowIdSet. If not and isEffective is true, add windowId to the set.
+	bool isWindowIdSuperseded (const StdString &windowId, bool isEffective);
+
+	AnimationTimeline animationTimeline;
+	AnimationSequence playAnimationSequence;
+	AnimationSequence *animationSequence;
+	int64_t animationIterationStartTime;
+	int animationIterationCount;
+	std::map<StdString, StdString> animationLabelOverrideMap;
+	std::map<StdString, AnimationSequence *> storedAnimationMap;
+	int64_t animationPrefetchTime;
+	int64_t animationPrefetchStartTime;
+	int animationPrefetchIndex;
+	int animationPrefetchIteration;
 	std::map<StdString, Widget *> windowIdMap;
 
-	// Remove all items from animationList
+	// A command held until its prefix startTime. Commands with equal start times execute in order of descending priority, then in the order received.
+	struct ScheduledCommand {
+		int64_t startTime;
+		int priority;
+		int64_t sequence;
+		Json *cmdInv;
+		ScheduledCommand (): startTime (0), priority (0), sequence (0), cmdInv (NULL) { }
+	};
+	struct ScheduledCommandCompare {
+		bool operator() (const MainUi::ScheduledCommand &a, const MainUi::ScheduledCommand &b) const;
+	};
+	std::priority_queue<MainUi::ScheduledCommand, std::vector<MainUi::ScheduledCommand>, MainUi::ScheduledCommandCompare> scheduledCommandQueue;
+	int64_t nextScheduleSequence;
+
+	// A window to be removed when its prefix duration elapses
+	struct WindowExpiration {
+		int64_t expireTime;
+		Widget *widget;
+		WindowExpiration (): expireTime (0), widget (NULL) { }
+	};
+	std::list<MainUi::WindowExpiration> windowExpirationList;
+
+	// Add a pending command to scheduledCommandQueue, taking ownership of its Json object. Returns a boolean value indicating if the command was accepted; if not, errorMessage is set.
+	bool scheduleCommand (MainUi::PendingCommand *item, StdString *errorMessage);
+
+	// Execute all commands from scheduledCommandQueue with a start time at or before the provided time
+	void executeScheduledCommands (int64_t now);
+
+	// Remove all items from scheduledCommandQueue
+	void clearScheduledCommands ();
+
+	// Schedule a window's removal if the command that created it specifies a prefix duration
+	void setWindowExpiration (Widget *widget, Json *cmdInv);
+
+	// Remove windows from windowExpirationList whose expire time is at or before the provided time
+	void updateWindowExpiration (int64_t now);
+
+	// Remove all items from windowExpirationList
+	void clearWindowExpiration ();
+
+	// Stop the playing animation and remove all steps from animationTimeline
 	void clearAnimation ();
 
+	// Remove all items from storedAnimationMap
+	void clearStoredAnimations ();
+
 	// Remove all items from windowIdMap
 	void clearWindowIdMap ();
 
 	// Set an entry in windowIdMap
 	void setWindowId (const StdString &windowId, Widget *widget);
 
-	// Update animation state for an elapsed time period
-	void updateAnimation (int msElapsed);
+	// Begin playing sequence from its first iteration at startTime, replacing any playing animation. animationLabelOverrideMap must be populated before calling this method.
+	void beginAnimation (AnimationSequence *sequence, int64_t startTime);
+
+	// Add animationTimeline steps for an iteration of animationSequence beginning at startTime, along with a loop step at the end of the iteration if the sequence repeats
+	void scheduleAnimationIteration (int64_t startTime);
+
+	// Execute all animationTimeline steps that have become due
+	void updateAnimation ();
+
+	// Request prefetch of images referenced by animationSequence steps that become due within animationPrefetchTime of now, advancing the prefetch position into later iterations as needed. Returns the animation time at which the next step enters the prefetch window, or a negative value if no steps remain to prefetch.
+	int64_t prefetchAnimationSteps (int64_t now);
+
+	// Execute a step from animationSequence, applying any label text override held in animationLabelOverrideMap
+	void executeAnimationStep (AnimationSequence::Step *step);
+
+	// Return the current time in microseconds on the monotonic clock used for animation step due times
+	static int64_t getAnimationTime ();
 
 	// Return the UiConfiguration core sprites index associated with a SystemInterface Icon constant, or -1 if no sprite index matched
 	int getIconType (int icon);
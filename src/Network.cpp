@@ -74,6 +74,7 @@ const int Network::MaxDatagramSize = 1500; // bytes
 Network::Network ()
 : maxRequestThreads (Network::DefaultMaxRequestThreads)
 , enableDatagramSocket (false)
+, wakeEvent (NULL)
 , isStarted (false)
 , isStopped (false)
 , datagramPort (0)
@@ -614,6 +615,9 @@ int Network::runDatagramReceiveThread (void *networkPtr) {
 		}
 		if (network->datagramCallback.callback) {
 			network->datagramCallback.callback (network->datagramCallback.callbackData, buf, msglen, host, (int) srcaddr.sin_port);
+			if (network->wakeEvent) {
+				network->wakeEvent->signal ();
+			}
 		}
 	}
 
@@ -809,6 +813,9 @@ int Network::runHttpRequestThread (void *networkPtr) {
 		}
 		if (item.callback.callback) {
 			item.callback.callback (item.callback.callbackData, item.url, statuscode, responsebuffer);
+			if (network->wakeEvent) {
+				network->wakeEvent->signal ();
+			}
 		}
 		if (responsebuffer) {
 			responsebuffer->release ();
@@ -40,6 +40,7 @@
 #include "OsUtil.h"
 #include "Buffer.h"
 #include "SharedBuffer.h"
+#include "WakeEvent.h"
 
 class Network {
 public:
@@ -86,6 +87,7 @@ public:
 	StdString httpUserAgent;
 	bool enableDatagramSocket;
 	Network::DatagramCallbackContext datagramCallback;
+	WakeEvent *wakeEvent; // If set, signaled after each datagram or HTTP response callback
 
 	// Read-only data members
 	bool isStarted;
@@ -35,6 +35,7 @@
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 #include <signal.h>
 #endif
@@ -81,6 +82,74 @@ int64_t OsUtil::getTime () {
 	return (t);
 }
 
+int64_t OsUtil::getMonotonicTime () {
+#if PLATFORM_LINUX || PLATFORM_MACOS
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return ((((int64_t) now.tv_sec) * 1000000000) + (int64_t) now.tv_nsec);
+#endif
+#if PLATFORM_WINDOWS
+	static LARGE_INTEGER frequency = { 0 };
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart <= 0) {
+		QueryPerformanceFrequency (&frequency);
+	}
+	QueryPerformanceCounter (&counter);
+	return (((counter.QuadPart / frequency.QuadPart) * 1000000000) + (((counter.QuadPart % frequency.QuadPart) * 1000000000) / frequency.QuadPart));
+#endif
+}
+
+void OsUtil::sleepUntilMonotonicTime (int64_t deadline) {
+#if PLATFORM_LINUX
+	struct timespec ts;
+
+	ts.tv_sec = (time_t) (deadline / 1000000000);
+	ts.tv_nsec = (long) (deadline % 1000000000);
+	while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+	}
+#endif
+#if PLATFORM_MACOS
+	struct timespec ts;
+	int64_t remaining;
+
+	while (true) {
+		remaining = deadline - OsUtil::getMonotonicTime ();
+		if (remaining <= 0) {
+			break;
+		}
+		ts.tv_sec = (time_t) (remaining / 1000000000);
+		ts.tv_nsec = (long) (remaining % 1000000000);
+		nanosleep (&ts, NULL);
+	}
+#endif
+#if PLATFORM_WINDOWS
+	int64_t remaining;
+
+	// Sleep calls are coarse on Windows, so sleep until just short of the deadline and yield for the remainder
+	while (true) {
+		remaining = deadline - OsUtil::getMonotonicTime ();
+		if (remaining <= 0) {
+			break;
+		}
+		if (remaining > 2000000) {
+			Sleep ((DWORD) ((remaining / 1000000) - 1));
+		}
+		else {
+			SwitchToThread ();
+		}
+	}
+#endif
+}
+
+int64_t OsUtil::getCounterMicroseconds (uint64_t counterDelta, uint64_t counterFrequency) {
+	if (counterFrequency <= 0) {
+		return (0);
+	}
+	return ((int64_t) (((counterDelta / counterFrequency) * 1000000) + (((counterDelta % counterFrequency) * 1000000) / counterFrequency)));
+}
+
 int OsUtil::getProcessId () {
 #if PLATFORM_WINDOWS
 	return ((int) GetCurrentProcessId ());
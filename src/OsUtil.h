@@ -80,6 +80,15 @@ public:
 	// Return the current time in milliseconds since the epoch
 	static int64_t getTime ();
 
+	// Return the current value of a monotonic clock in nanoseconds, measured from an unspecified starting point. Unlike getTime, the returned value is never affected by changes to the system clock.
+	static int64_t getMonotonicTime ();
+
+	// Block the calling thread until getMonotonicTime reaches or passes the provided deadline value
+	static void sleepUntilMonotonicTime (int64_t deadline);
+
+	// Return the number of microseconds represented by a difference between two high resolution counter values, such as those provided by SDL_GetPerformanceCounter
+	static int64_t getCounterMicroseconds (uint64_t counterDelta, uint64_t counterFrequency);
+
 	// Return the application's process ID
 	static int getProcessId ();
 
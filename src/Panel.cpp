@@ -38,8 +38,10 @@
 #include "UiConfiguration.h"
 #include "Input.h"
 #include "OsUtil.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "ProgressBar.h"
+#include "Scene.h"
 #include "Panel.h"
 
 const int Panel::LongPressDuration = 1000;
@@ -81,6 +83,9 @@ Panel::Panel ()
 , drawTextureWidth (0)
 , drawTextureHeight (0)
 , isResettingDrawTexture (false)
+, nextDrawTexture (NULL)
+, isNextDrawTextureEnabled (false)
+, isDrawTextureResetComplete (false)
 , isMouseInputStarted (false)
 , lastMouseLeftUpCount (0)
 , lastMouseLeftDownCount (0)
@@ -112,6 +117,7 @@ Panel::Panel ()
 , cornerBottomDw (0)
 , cornerBottomDh (0)
 , cornerSize (0)
+, batchDepth (0)
 , widgetListMutex (NULL)
 , widgetAddListMutex (NULL)
 {
@@ -128,6 +134,11 @@ Panel::~Panel () {
 		drawTexturePath.assign ("");
 	}
 	drawTexture = NULL;
+	if ((! nextDrawTexturePath.empty ()) && (! nextDrawTexturePath.equals (drawTexturePath))) {
+		App::instance->resource.unloadTexture (nextDrawTexturePath);
+		nextDrawTexturePath.assign ("");
+	}
+	nextDrawTexture = NULL;
 
 	if (widgetListMutex) {
 		SDL_DestroyMutex (widgetListMutex);
@@ -155,46 +166,55 @@ void Panel::resetDrawTexture (void *panelPtr) {
 	SDL_Texture *texture;
 
 	panel = (Panel *) panelPtr;
-	if (! panel->isTextureRenderEnabled) {
-		if (! panel->drawTexturePath.empty ()) {
-			App::instance->resource.unloadTexture (panel->drawTexturePath);
-			panel->drawTexturePath.assign ("");
-		}
-		panel->drawTexture = NULL;
-		panel->isResettingDrawTexture = false;
-		panel->release ();
-		return;
-	}
-
-	texture = panel->drawTexture;
-	if (texture) {
-		if (((int) panel->width) != panel->drawTextureWidth || (((int) panel->height) != panel->drawTextureHeight)) {
-			texture = NULL;
+	if (panel->isNextDrawTextureEnabled) {
+		texture = panel->nextDrawTexture;
+		if (! texture) {
+			panel->nextDrawTexturePath.sprintf ("*_Panel_%llx_%llx", (long long int) panel->id, (long long int) App::instance->getUniqueId ());
+			texture = App::instance->resource.createTexture (panel->nextDrawTexturePath, panel->textureDrawList.targetWidth, panel->textureDrawList.targetHeight);
+			if (! texture) {
+				panel->nextDrawTexturePath.assign ("");
+			}
+			panel->nextDrawTexture = texture;
+		}
+		if (texture) {
+			SDL_SetRenderTarget (App::instance->render, texture);
+			panel->textureDrawList.execute (App::instance->render);
+			SDL_SetRenderTarget (App::instance->render, NULL);
 		}
 	}
+	panel->isDrawTextureResetComplete.store (true);
+	panel->release ();
+}
 
-	if (! texture) {
-		if (! panel->drawTexturePath.empty ()) {
-			App::instance->resource.unloadTexture (panel->drawTexturePath);
+void Panel::applyDrawTextureReset () {
+	if (! isNextDrawTextureEnabled) {
+		if (! drawTexturePath.empty ()) {
+			App::instance->resource.unloadTexture (drawTexturePath);
+			drawTexturePath.assign ("");
 		}
-		panel->drawTexture = NULL;
-
-		panel->drawTexturePath.sprintf ("*_Panel_%llx_%llx", (long long int) panel->id, (long long int) App::instance->getUniqueId ());
-		panel->drawTextureWidth = (int) panel->width;
-		panel->drawTextureHeight = (int) panel->height;
-		texture = App::instance->resource.createTexture (panel->drawTexturePath, panel->drawTextureWidth, panel->drawTextureHeight);
+		drawTexture = NULL;
 	}
-	if (! texture) {
-		panel->drawTexturePath.assign ("");
-		panel->isTextureRenderEnabled = false;
+	else if (! nextDrawTexture) {
+		if (! drawTexturePath.empty ()) {
+			App::instance->resource.unloadTexture (drawTexturePath);
+			drawTexturePath.assign ("");
+		}
+		drawTexture = NULL;
+		isTextureRenderEnabled = false;
 	}
-	else {
-		panel->drawTexture = texture;
-		panel->draw (texture, -(panel->position.x), -(panel->position.y));
+	else if (nextDrawTexture != drawTexture) {
+		if (! drawTexturePath.empty ()) {
+			App::instance->resource.unloadTexture (drawTexturePath);
+		}
+		drawTexture = nextDrawTexture;
+		drawTexturePath.assign (nextDrawTexturePath);
+		drawTextureWidth = textureDrawList.targetWidth;
+		drawTextureHeight = textureDrawList.targetHeight;
 	}
-	panel->shouldRefreshTexture = false;
-	panel->isResettingDrawTexture = false;
-	panel->release ();
+	nextDrawTexture = NULL;
+	nextDrawTexturePath.assign ("");
+	isResettingDrawTexture = false;
+	addSceneDamage ();
 }
 
 void Panel::animateScale (float startScale, float targetScale, int duration) {
@@ -244,8 +264,11 @@ void Panel::clear () {
 	}
 	widgetList.clear ();
 	SDL_UnlockMutex (widgetListMutex);
+	addSceneDamage ();
 
-	resetSize ();
+	if (batchDepth <= 0) {
+		resetSize ();
+	}
 }
 
 Widget *Panel::addWidget (Widget *widget, float positionX, float positionY, int zLevel) {
@@ -262,10 +285,26 @@ Widget *Panel::addWidget (Widget *widget, float positionX, float positionY, int
 	widgetAddList.push_back (widget);
 	SDL_UnlockMutex (widgetAddListMutex);
 
-	resetSize ();
+	if (batchDepth <= 0) {
+		resetSize ();
+	}
 	return (widget);
 }
 
+void Panel::beginBatch () {
+	++batchDepth;
+}
+
+void Panel::endBatch () {
+	if (batchDepth <= 0) {
+		return;
+	}
+	--batchDepth;
+	if (batchDepth <= 0) {
+		resetSize ();
+	}
+}
+
 void Panel::removeWidget (Widget *targetWidget) {
 	std::list<Widget *>::iterator i, end;
 	Widget *widget;
@@ -291,6 +330,7 @@ void Panel::removeWidget (Widget *targetWidget) {
 		widget = *i;
 		if (widget == targetWidget) {
 			widgetList.erase (i);
+			widget->addSceneDamage ();
 			widget->release ();
 			break;
 		}
@@ -389,7 +429,7 @@ void Panel::getWidgetNames (StringList *destList) {
 	SDL_UnlockMutex (widgetListMutex);
 }
 
-void Panel::doUpdate (int msElapsed) {
+void Panel::doUpdate (float msElapsed) {
 	std::list<Widget *> addlist;
 	std::list<Widget *>::iterator i, end;
 	Widget *widget;
@@ -425,6 +465,7 @@ void Panel::doUpdate (int msElapsed) {
 			if (widget->isDestroyed) {
 				found = true;
 				widgetList.erase (i);
+				widget->addSceneDamage ();
 				widget->release ();
 				break;
 			}
@@ -457,10 +498,26 @@ void Panel::doUpdate (int msElapsed) {
 	}
 	SDL_UnlockMutex (widgetListMutex);
 
+	if (isResettingDrawTexture && isDrawTextureResetComplete.load ()) {
+		applyDrawTextureReset ();
+	}
 	if (! isResettingDrawTexture) {
 		if ((isTextureRenderEnabled && (! drawTexture)) || ((! isTextureRenderEnabled) && drawTexture) || shouldRefreshTexture) {
 			isResettingDrawTexture = true;
 			shouldRefreshTexture = false;
+			isNextDrawTextureEnabled = isTextureRenderEnabled;
+			nextDrawTexture = NULL;
+			nextDrawTexturePath.assign ("");
+			if (isTextureRenderEnabled) {
+				textureDrawList.isTextureTarget = true;
+				textureDrawList.reset ((int) width, (int) height);
+				draw (&textureDrawList, -position.x, -position.y);
+				if (drawTexture && (drawTextureWidth == textureDrawList.targetWidth) && (drawTextureHeight == textureDrawList.targetHeight)) {
+					nextDrawTexture = drawTexture;
+					nextDrawTexturePath.assign (drawTexturePath);
+				}
+			}
+			isDrawTextureResetComplete.store (false);
 			retain ();
 			App::instance->addRenderTask (Panel::resetDrawTexture, this);
 		}
@@ -713,8 +770,7 @@ void Panel::doResetInputState () {
 	SDL_UnlockMutex (widgetListMutex);
 }
 
-void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
-	SDL_Renderer *render;
+void Panel::doDraw (DrawList *drawList, float originX, float originY) {
 	SDL_Texture *cornertexture;
 	SDL_Rect rect;
 	std::list<Widget *>::iterator i, end;
@@ -722,11 +778,10 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 	int x0, y0, texturew, textureh;
 	float w, h;
 
-	render = App::instance->render;
 	x0 = (int) (originX + position.x);
 	y0 = (int) (originY + position.y);
 
-	if ((! targetTexture) && isTextureRenderEnabled) {
+	if ((! drawList->isTextureTarget) && isTextureRenderEnabled) {
 		if (drawTexture) {
 			rect.x = x0;
 			rect.y = y0;
@@ -741,25 +796,18 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 
 			rect.w = (int) w;
 			rect.h = (int) h;
-			SDL_RenderCopy (render, drawTexture, NULL, &rect);
+			drawList->copyTexture (drawTexture, &rect);
 		}
 		return;
 	}
 
-	SDL_SetRenderTarget (render, targetTexture);
 	rect.x = x0;
 	rect.y = y0;
 	rect.w = (int) width;
 	rect.h = (int) height;
-	App::instance->pushClipRect (&rect);
+	drawList->pushClipRect (&rect);
 
 	if (isFilledBg && (bgColor.aByte > 0)) {
-		SDL_SetRenderTarget (render, targetTexture);
-		if (bgColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-		}
-		SDL_SetRenderDrawColor (render, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
-
 		if ((cornerSize > 0) && ((int) width >= cornerSize) && ((int) height >= cornerSize)) {
 			if (topLeftCornerRadius > 0) {
 				cornertexture = App::instance->getRoundedCornerTexture (topLeftCornerRadius, &texturew, &textureh);
@@ -768,9 +816,7 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 					rect.y = y0;
 					rect.w = texturew;
 					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					drawList->copyTexture (cornertexture, &rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, 255, true);
 				}
 			}
 			if (topRightCornerRadius > 0) {
@@ -780,9 +826,7 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 					rect.y = y0;
 					rect.w = texturew;
 					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					drawList->copyTexture (cornertexture, &rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, 255, true);
 				}
 			}
 			if (bottomLeftCornerRadius > 0) {
@@ -792,9 +836,7 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 					rect.y = y0 + (int) height - textureh;
 					rect.w = texturew;
 					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					drawList->copyTexture (cornertexture, &rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, 255, true);
 				}
 			}
 			if (bottomRightCornerRadius > 0) {
@@ -804,9 +846,7 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 					rect.y = y0 + (int) height - textureh;
 					rect.w = texturew;
 					rect.h = textureh;
-					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					drawList->copyTexture (cornertexture, &rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, 255, true);
 				}
 			}
 
@@ -818,35 +858,35 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 			rect.y += cornerCenterDy;
 			rect.w += cornerCenterDw;
 			rect.h += cornerCenterDh;
-			SDL_RenderFillRect (render, &rect);
+			drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 
 			if (cornerTopDh > 0) {
 				rect.x = x0 + cornerTopDx;
 				rect.y = y0 + cornerTopDy;
 				rect.w = ((int) width) + cornerTopDw;
 				rect.h = cornerTopDh;
-				SDL_RenderFillRect (render, &rect);
+				drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 			}
 			if (cornerLeftDw > 0) {
 				rect.x = x0 + cornerLeftDx;
 				rect.y = y0 + cornerLeftDy;
 				rect.w = cornerLeftDw;
 				rect.h = ((int) height) + cornerLeftDh;
-				SDL_RenderFillRect (render, &rect);
+				drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 			}
 			if (cornerRightDw > 0) {
 				rect.x = x0 + width + cornerRightDx;
 				rect.y = y0 + cornerRightDy;
 				rect.w = cornerRightDw;
 				rect.h = ((int) height) + cornerRightDh;
-				SDL_RenderFillRect (render, &rect);
+				drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 			}
 			if (cornerBottomDh > 0) {
 				rect.x = x0 + cornerBottomDx;
 				rect.y = y0 + height + cornerBottomDy;
 				rect.w = ((int) width) + cornerBottomDw;
 				rect.h = cornerBottomDh;
-				SDL_RenderFillRect (render, &rect);
+				drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 			}
 		}
 		else {
@@ -854,14 +894,8 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 			rect.y = y0;
 			rect.w = (int) width;
 			rect.h = (int) height;
-			SDL_RenderFillRect (render, &rect);
+			drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte, bgColor.aByte);
 		}
-
-		if (bgColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-		}
-		SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
-		SDL_SetRenderTarget (render, NULL);
 	}
 
 	SDL_LockMutex (widgetListMutex);
@@ -874,70 +908,51 @@ void Panel::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
 			continue;
 		}
 
-		widget->draw (targetTexture, x0 - (int) viewOriginX, y0 - (int) viewOriginY);
+		widget->draw (drawList, x0 - (int) viewOriginX, y0 - (int) viewOriginY);
 	}
 	SDL_UnlockMutex (widgetListMutex);
 
 	if (isBordered && (borderColor.aByte > 0) && (borderWidth >= 1.0f)) {
-		SDL_SetRenderTarget (render, targetTexture);
-		if (borderColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-		}
-		SDL_SetRenderDrawColor (render, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte);
 
 		rect.x = x0;
 		rect.y = y0;
 		rect.w = (int) width;
 		rect.h = (int) borderWidth;
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (&rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte);
 
 		rect.y = y0 + (int) (height - borderWidth);
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (&rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte);
 
 		rect.y = y0 + (int) borderWidth;
 		rect.w = (int) borderWidth;
 		rect.h = ((int) height) - (int) (borderWidth * 2.0f);
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (&rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte);
 
 		rect.x = x0 + (int) (width - borderWidth);
-		SDL_RenderFillRect (render, &rect);
-
-		if (borderColor.aByte < 255) {
-			SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-		}
-		SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
-		SDL_SetRenderTarget (render, NULL);
+		drawList->fillRect (&rect, borderColor.rByte, borderColor.gByte, borderColor.bByte, borderColor.aByte);
 	}
-	App::instance->popClipRect ();
+	drawList->popClipRect ();
 
 	if (isDropShadowed && (dropShadowColor.aByte > 0) && (dropShadowWidth >= 1.0f)) {
-		SDL_SetRenderTarget (render, targetTexture);
-		SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-		SDL_SetRenderDrawColor (render, dropShadowColor.rByte, dropShadowColor.gByte, dropShadowColor.bByte, dropShadowColor.aByte);
-
-		rect.x = App::instance->clipRect.x;
-		rect.y = App::instance->clipRect.y;
-		rect.w = App::instance->clipRect.w + dropShadowWidth;
-		rect.h = App::instance->clipRect.h + dropShadowWidth;
-		App::instance->pushClipRect (&rect, true);
+		rect.x = drawList->clipRect.x;
+		rect.y = drawList->clipRect.y;
+		rect.w = drawList->clipRect.w + dropShadowWidth;
+		rect.h = drawList->clipRect.h + dropShadowWidth;
+		drawList->pushClipRect (&rect, true);
 
 		rect.x = x0 + (int) width;
 		rect.y = y0 + (int) dropShadowWidth;
 		rect.w = (int) dropShadowWidth;
 		rect.h = (int) height;
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (&rect, dropShadowColor.rByte, dropShadowColor.gByte, dropShadowColor.bByte, dropShadowColor.aByte);
 
 		rect.x = x0 + (int) dropShadowWidth;
 		rect.y = y0 + (int) height;
 		rect.w = (int) (width - dropShadowWidth);
 		rect.h = (int) dropShadowWidth;
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (&rect, dropShadowColor.rByte, dropShadowColor.gByte, dropShadowColor.bByte, dropShadowColor.aByte);
 
-		App::instance->popClipRect ();
-
-		SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-		SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
-		SDL_SetRenderTarget (render, NULL);
+		drawList->popClipRect ();
 	}
 }
 
@@ -1290,6 +1305,9 @@ void Panel::setLayout (int layoutType, float maxPanelWidth) {
 }
 
 void Panel::setFillBg (bool enable, const Color &color) {
+	if (enable != isFilledBg) {
+		addSceneDamage ();
+	}
 	if (enable) {
 		bgColor.assign (color);
 		isFilledBg = true;
@@ -1306,6 +1324,8 @@ void Panel::setCornerRadius (int radius) {
 void Panel::setCornerRadius (int topLeftRadius, int topRightRadius, int bottomLeftRadius, int bottomRightRadius) {
 	int centerx, centery, centerw, centerh, topx, topy, topw, toph, leftx, lefty, leftw, lefth, rightx, righty, rightw, righth, bottomx, bottomy, bottomw, bottomh, amt;
 
+	addSceneDamage ();
+
 	if (topLeftRadius < 0) {
 		topLeftRadius = 0;
 	}
@@ -1486,6 +1506,7 @@ void Panel::setCornerRadius (int topLeftRadius, int topRightRadius, int bottomLe
 }
 
 void Panel::setBorder (bool enable, const Color &color, float borderWidthValue) {
+	addSceneDamage ();
 	if (enable) {
 		borderColor.assign (color);
 		if (borderWidthValue < 1.0f) {
@@ -1500,6 +1521,7 @@ void Panel::setBorder (bool enable, const Color &color, float borderWidthValue)
 }
 
 void Panel::setDropShadow (bool enable, const Color &color, float dropShadowWidthValue) {
+	addSceneDamage ();
 	if (enable) {
 		dropShadowColor.assign (color);
 		if (dropShadowWidthValue < 1.0f) {
@@ -1507,10 +1529,13 @@ void Panel::setDropShadow (bool enable, const Color &color, float dropShadowWidt
 		}
 		dropShadowWidth = dropShadowWidthValue;
 		isDropShadowed = true;
+		sceneMargin = dropShadowWidth;
 	}
 	else {
 		isDropShadowed = false;
+		sceneMargin = 0.0f;
 	}
+	addSceneDamage ();
 }
 
 void Panel::setViewOrigin (float originX, float originY) {
@@ -1534,6 +1559,9 @@ void Panel::setViewOrigin (float originX, float originY) {
 		}
 	}
 
+	if ((! FLOAT_EQUALS (viewOriginX, x)) || (! FLOAT_EQUALS (viewOriginY, y))) {
+		addSceneDamage ();
+	}
 	viewOriginX = x;
 	viewOriginY = y;
 }
@@ -34,6 +34,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <atomic>
 #include "SDL2/SDL.h"
 #include "StdString.h"
 #include "StringList.h"
@@ -124,6 +125,12 @@ public:
 	// Remove the specified widget from the panel
 	void removeWidget (Widget *targetWidget);
 
+	// Begin a batch of widget changes, deferring size resets until a matching call to endBatch
+	void beginBatch ();
+
+	// End a batch of widget changes started by beginBatch and reset the panel's size if no other batch remains open
+	void endBatch ();
+
 	// Return the topmost child widget at the specified screen position, or NULL if no such widget was found. If requireMouseHoverEnabled is true, return a widget only if it has enabled the isMouseHoverEnabled option.
 	Widget *findWidget (float screenPositionX, float screenPositionY, bool requireMouseHoverEnabled = false);
 
@@ -151,15 +158,15 @@ public:
 	// Update widget state to reflect the latest input events
 	void processInput ();
 
-	// Reset the panel's draw texture as appropriate for a new enable state
+	// Draw the commands held in textureDrawList to nextDrawTexture, creating the texture if needed. This method must be invoked from the application's main thread, and leaves the result for the update thread to apply from doUpdate.
 	static void resetDrawTexture (void *panelPtr);
 
 protected:
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	virtual void doUpdate (int msElapsed);
+	virtual void doUpdate (float msElapsed);
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list's isTextureTarget value is set, commands are drawn to a render texture and coordinates should be adjusted as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
 
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
@@ -179,6 +186,9 @@ protected:
 	// Reset the panel's widget layout as appropriate for its content and configuration
 	virtual void refreshLayout ();
 
+	// Replace drawTexture with the result of a completed resetDrawTexture task, unloading any texture no longer in use
+	void applyDrawTextureReset ();
+
 	// Check if the widget list is correctly sorted for drawing by z-level, and sort the list if not. This method must only be invoked while holding a lock on widgetListMutex.
 	void sortWidgetList ();
 
@@ -186,6 +196,14 @@ protected:
 	int drawTextureWidth, drawTextureHeight;
 	StdString drawTexturePath;
 	bool isResettingDrawTexture;
+	DrawList textureDrawList; // Commands recorded by the update thread for drawing to drawTexture
+
+	// Fields passed to and returned from the resetDrawTexture task, owned by the task while it is queued and by the update thread once isDrawTextureResetComplete is set
+	SDL_Texture *nextDrawTexture;
+	StdString nextDrawTexturePath;
+	bool isNextDrawTextureEnabled;
+	std::atomic<bool> isDrawTextureResetComplete;
+
 	bool isMouseInputStarted;
 	int lastMouseLeftUpCount, lastMouseLeftDownCount;
 	int lastMouseRightUpCount, lastMouseRightDownCount;
@@ -198,6 +216,7 @@ protected:
 	int cornerRightDx, cornerRightDy, cornerRightDw, cornerRightDh;
 	int cornerBottomDx, cornerBottomDy, cornerBottomDw, cornerBottomDh;
 	int cornerSize;
+	int batchDepth;
 	SDL_mutex *widgetListMutex;
 	std::list<Widget *> widgetList;
 	SDL_mutex *widgetAddListMutex;
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <queue>
+#include "Scene.h"
 #include "Position.h"
 
 Position::Position (float x, float y)
@@ -42,7 +43,7 @@ Position::Position (float x, float y)
 , translateDx (0.0f)
 , translateDy (0.0f)
 , translateDuration (0)
-, translateClock (0)
+, translateClock (0.0f)
 {
 }
 
@@ -50,13 +51,15 @@ Position::~Position () {
 
 }
 
-void Position::update (int msElapsed) {
+void Position::update (float msElapsed) {
 	Position::Translation t;
-	float dx, dy;
-	int ms, dt;
+	float dx, dy, ms, dt;
 
 	ms = msElapsed;
-	while (isTranslating && (ms > 0)) {
+	if (isTranslating && (ms > 0.0f)) {
+		Scene::setPropertyChanged ();
+	}
+	while (isTranslating && (ms > 0.0f)) {
 		dt = ms;
 		if (dt > translateClock) {
 			dt = translateClock;
@@ -64,7 +67,7 @@ void Position::update (int msElapsed) {
 		translateClock -= dt;
 		ms -= dt;
 
-		dx = translateDx * (float) dt;
+		dx = translateDx * dt;
 		x += dx;
 		if (translateDx < 0.0f) {
 			if (x < translateTargetX) {
@@ -77,7 +80,7 @@ void Position::update (int msElapsed) {
 			}
 		}
 
-		dy = translateDy * (float) dt;
+		dy = translateDy * dt;
 		y += dy;
 		if (translateDy < 0.0f) {
 			if (y < translateTargetY) {
@@ -90,7 +93,7 @@ void Position::update (int msElapsed) {
 			}
 		}
 
-		if (translateClock <= 0) {
+		if (translateClock <= 0.0f) {
 			x = translateTargetX;
 			y = translateTargetY;
 			if (translationQueue.empty ()) {
@@ -106,6 +109,9 @@ void Position::update (int msElapsed) {
 }
 
 void Position::assign (float positionX, float positionY) {
+	if ((! FLOAT_EQUALS (x, positionX)) || (! FLOAT_EQUALS (y, positionY))) {
+		Scene::setPropertyChanged ();
+	}
 	x = positionX;
 	y = positionY;
 	isTranslating = false;
@@ -162,12 +168,15 @@ void Position::translate (float targetX, float targetY, int durationMs) {
 	float dx, dy;
 
 	if (durationMs <= 0) {
+		if ((! FLOAT_EQUALS (x, targetX)) || (! FLOAT_EQUALS (y, targetY))) {
+			Scene::setPropertyChanged ();
+		}
 		x = targetX;
 		y = targetY;
 		translateTargetX = targetX;
 		translateTargetY = targetY;
 		translateDuration = 0;
-		translateClock = 0;
+		translateClock = 0.0f;
 		translateDx = 0.0f;
 		translateDy = 0.0f;
 		if (translationQueue.empty ()) {
@@ -191,7 +200,7 @@ void Position::translate (float targetX, float targetY, int durationMs) {
 	translateTargetX = targetX;
 	translateTargetY = targetY;
 	translateDuration = durationMs;
-	translateClock = durationMs;
+	translateClock = (float) durationMs;
 	translateDx = dx / (float) durationMs;
 	translateDy = dy / (float) durationMs;
 }
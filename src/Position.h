@@ -45,10 +45,10 @@ public:
 	float translateTargetX, translateTargetY;
 	float translateDx, translateDy;
 	int translateDuration;
-	int translateClock;
+	float translateClock;
 
 	// Update state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	void update (float msElapsed);
 
 	// Set the position's coordinate values
 	void assign (float positionX, float positionY);
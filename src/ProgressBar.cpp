@@ -36,8 +36,10 @@
 #include "Ui.h"
 #include "Input.h"
 #include "Sprite.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "UiConfiguration.h"
+#include "Scene.h"
 #include "ProgressBar.h"
 
 const float ProgressBar::AnimationFactor = 2.0f; // milliseconds per pixel
@@ -109,8 +111,9 @@ void ProgressBar::setIndeterminate (bool indeterminate) {
 	refreshLayout ();
 }
 
-void ProgressBar::doUpdate (int msElapsed) {
+void ProgressBar::doUpdate (float msElapsed) {
 	if (isIndeterminate) {
+		addSceneDamage ();
 		switch (fillStage) {
 			case 0: {
 				fillStart = 0.0f;
@@ -122,7 +125,7 @@ void ProgressBar::doUpdate (int msElapsed) {
 			}
 			case 1: {
 				if (fillEnd < fillEndTarget) {
-					fillEnd += ((float) msElapsed) / ProgressBar::AnimationFactor;
+					fillEnd += msElapsed / ProgressBar::AnimationFactor;
 					if (fillEnd >= fillEndTarget) {
 						fillEnd = fillEndTarget;
 					}
@@ -136,13 +139,13 @@ void ProgressBar::doUpdate (int msElapsed) {
 			}
 			case 2: {
 				if (fillEnd < fillEndTarget) {
-					fillEnd += ((float) msElapsed) / ProgressBar::AnimationFactor;
+					fillEnd += msElapsed / ProgressBar::AnimationFactor;
 					if (fillEnd >= fillEndTarget) {
 						fillEnd = fillEndTarget;
 					}
 				}
 				if (fillStart < fillStartTarget) {
-					fillStart += ((float) msElapsed) / ProgressBar::AnimationFactor;
+					fillStart += msElapsed / ProgressBar::AnimationFactor;
 					if (fillStart >= fillStartTarget) {
 						fillStart = fillStartTarget;
 					}
@@ -156,7 +159,7 @@ void ProgressBar::doUpdate (int msElapsed) {
 			}
 			case 3: {
 				if (fillStart < fillStartTarget) {
-					fillStart += ((float) msElapsed) / ProgressBar::AnimationFactor;
+					fillStart += msElapsed / ProgressBar::AnimationFactor;
 					if (fillStart >= fillStartTarget) {
 						fillStart = fillStartTarget;
 					}
@@ -176,18 +179,15 @@ void ProgressBar::doUpdate (int msElapsed) {
 	fillColor.update (msElapsed);
 }
 
-void ProgressBar::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
-	SDL_Renderer *render;
+void ProgressBar::doDraw (DrawList *drawList, float originX, float originY) {
 	SDL_Rect rect;
 	float x1, x2, w;
 
-	render = App::instance->render;
 	rect.x = (int) (originX + position.x);
 	rect.y = (int) (originY + position.y);
 	rect.w = (int) width;
 	rect.h = (int) height;
-	SDL_SetRenderDrawColor (render, bgColor.rByte, bgColor.gByte, bgColor.bByte, 255);
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (&rect, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 
 	x1 = floorf (fillStart);
 	x2 = floorf (fillEnd);
@@ -195,37 +195,32 @@ void ProgressBar::doDraw (SDL_Texture *targetTexture, float originX, float origi
 	if (w > 0.0f) {
 		rect.x = (int) (originX + position.x + x1);
 		rect.w = (int) w;
-		SDL_SetRenderDrawColor (render, fillColor.rByte, fillColor.gByte, fillColor.bByte, 255);
-		SDL_RenderFillRect (render, &rect);
+		drawList->fillRect (&rect, fillColor.rByte, fillColor.gByte, fillColor.bByte);
 	}
 
-	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_BLEND);
-	SDL_SetRenderDrawColor (render, 0, 0, 0, 128);
 	rect.x = (int) (originX + position.x);
 	rect.y = (int) (originY + position.y);
 	rect.w = (int) width;
 	rect.h = 1;
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (&rect, 0, 0, 0, 128);
 	++(rect.y);
 	rect.w = 1;
 	rect.h = ((int) height) - 1;
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (&rect, 0, 0, 0, 128);
 	++(rect.x);
 	rect.y = (int) (originY + position.y) + ((int) height) - 1;
 	rect.w = ((int) width) - 1;
 	rect.h = 1;
-	SDL_RenderFillRect (render, &rect);
+	drawList->fillRect (&rect, 0, 0, 0, 128);
 	rect.x = (int) (originX + position.x) + ((int) width) - 1;
 	rect.y = (int) (originY + position.y + 1);
 	rect.w = 1;
 	rect.h = ((int) height) - 2;
-	SDL_RenderFillRect (render, &rect);
-	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
-
-	SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
+	drawList->fillRect (&rect, 0, 0, 0, 128);
 }
 
 void ProgressBar::refreshLayout () {
+	addSceneDamage ();
 	if ((! isIndeterminate) && (targetProgressValue > 0.0f)) {
 		fillStart = 0.0f;
 		fillEnd = (width * progressValue) / targetProgressValue;
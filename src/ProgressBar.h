@@ -54,10 +54,10 @@ public:
 
 protected:
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period
-	virtual void doUpdate (int msElapsed);
+	virtual void doUpdate (float msElapsed);
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list's isTextureTarget value is set, commands are drawn to a render texture and coordinates should be adjusted as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
 
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
@@ -247,10 +247,13 @@ void Resource::compactFileMap () {
 void Resource::compactTextureMap () {
 	std::vector<StdString>::iterator i, end;
 	std::map<StdString, Resource::TextureData>::iterator mi;
+	std::vector<StdString> retainlist;
+	int64_t drawserial;
 
 	if (textureCompactList.empty ()) {
 		return;
 	}
+	drawserial = App::instance->drawListDrawSerial.load ();
 	SDL_LockMutex (textureMapMutex);
 	i = textureCompactList.begin ();
 	end = textureCompactList.end ();
@@ -258,14 +261,19 @@ void Resource::compactTextureMap () {
 		mi = textureMap.find (*i);
 		if (mi != textureMap.end ()) {
 			if (mi->second.refcount <= 0) {
-				SDL_DestroyTexture (mi->second.texture);
-				mi->second.texture = NULL;
-				textureMap.erase (mi);
+				if (mi->second.retireSerial >= drawserial) {
+					retainlist.push_back (*i);
+				}
+				else {
+					SDL_DestroyTexture (mi->second.texture);
+					mi->second.texture = NULL;
+					textureMap.erase (mi);
+				}
 			}
 		}
 		++i;
 	}
-	textureCompactList.clear ();
+	textureCompactList.swap (retainlist);
 	SDL_UnlockMutex (textureMapMutex);
 }
 
@@ -636,6 +644,7 @@ SDL_Texture *Resource::loadTexture (const StdString &path) {
 
 	data.texture = texture;
 	data.refcount = 1;
+	data.retireSerial = 0;
 	SDL_LockMutex (textureMapMutex);
 	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
 	SDL_UnlockMutex (textureMapMutex);
@@ -667,6 +676,7 @@ SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surfac
 
 	data.texture = texture;
 	data.refcount = 1;
+	data.retireSerial = 0;
 	SDL_LockMutex (textureMapMutex);
 	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
 	SDL_UnlockMutex (textureMapMutex);
@@ -701,6 +711,7 @@ SDL_Texture *Resource::createTexture (const StdString &path, int textureWidth, i
 
 	data.texture = texture;
 	data.refcount = 1;
+	data.retireSerial = 0;
 	SDL_LockMutex (textureMapMutex);
 	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
 	SDL_UnlockMutex (textureMapMutex);
@@ -718,6 +729,7 @@ void Resource::unloadTexture (const StdString &path) {
 			--(i->second.refcount);
 
 			if (i->second.refcount <= 0) {
+				i->second.retireSerial = App::instance->drawListRecordSerial.load ();
 				textureCompactList.push_back (i->first);
 			}
 		}
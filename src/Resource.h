@@ -116,6 +116,7 @@ private:
 	struct TextureData {
 		SDL_Texture *texture;
 		int refcount;
+		int64_t retireSerial; // The most recent draw list serial that might reference the texture after its refcount reached zero
 	};
 
 	struct FontData {
@@ -158,7 +159,7 @@ private:
 	// Remove unreferenced items from the file map
 	void compactFileMap ();
 
-	// Remove unreferenced items from the texture map
+	// Remove unreferenced items from the texture map, keeping any texture that might still be referenced by a draw list not yet replaced on the main thread
 	void compactTextureMap ();
 
 	// Remove unreferenced items from the font map
@@ -0,0 +1,161 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <math.h>
+#include <atomic>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "Scene.h"
+
+const int Scene::MaxDamageRectCount = 8;
+std::atomic<bool> Scene::isChanged (true);
+std::atomic<int64_t> Scene::changeCount (0);
+SDL_SpinLock Scene::damageLock = 0;
+std::vector<SDL_Rect> Scene::damageRectList;
+bool Scene::isFullDamage = true;
+thread_local int Scene::widgetUpdateDepth = 0;
+thread_local bool Scene::isWidgetPropertyChanged = false;
+
+void Scene::setChanged () {
+	SDL_AtomicLock (&damageLock);
+	isFullDamage = true;
+	damageRectList.clear ();
+	SDL_AtomicUnlock (&damageLock);
+	++changeCount;
+	isChanged.store (true, std::memory_order_release);
+}
+
+void Scene::addDamage (float x, float y, float w, float h) {
+	std::vector<SDL_Rect>::iterator i, end;
+	SDL_Rect rect, result;
+	bool merged;
+
+	if ((w <= 0.0f) || (h <= 0.0f)) {
+		return;
+	}
+	rect.x = (int) floorf (x);
+	rect.y = (int) floorf (y);
+	rect.w = ((int) ceilf (x + w)) - rect.x;
+	rect.h = ((int) ceilf (y + h)) - rect.y;
+
+	SDL_AtomicLock (&damageLock);
+	if (! isFullDamage) {
+		merged = true;
+		while (merged) {
+			merged = false;
+			i = damageRectList.begin ();
+			end = damageRectList.end ();
+			while (i != end) {
+				if (SDL_HasIntersection (&rect, &(*i))) {
+					SDL_UnionRect (&rect, &(*i), &result);
+					rect = result;
+					damageRectList.erase (i);
+					merged = true;
+					break;
+				}
+				++i;
+			}
+		}
+		damageRectList.push_back (rect);
+
+		if ((int) damageRectList.size () > Scene::MaxDamageRectCount) {
+			i = damageRectList.begin ();
+			end = damageRectList.end ();
+			rect = *i;
+			++i;
+			while (i != end) {
+				SDL_UnionRect (&rect, &(*i), &result);
+				rect = result;
+				++i;
+			}
+			damageRectList.clear ();
+			damageRectList.push_back (rect);
+		}
+	}
+	SDL_AtomicUnlock (&damageLock);
+	++changeCount;
+	isChanged.store (true, std::memory_order_release);
+}
+
+void Scene::requestPresent () {
+	isChanged.store (true, std::memory_order_release);
+}
+
+void Scene::setPropertyChanged () {
+	if (widgetUpdateDepth > 0) {
+		isWidgetPropertyChanged = true;
+	}
+	else {
+		Scene::setChanged ();
+	}
+}
+
+bool Scene::beginWidgetUpdate () {
+	bool result;
+
+	result = isWidgetPropertyChanged;
+	isWidgetPropertyChanged = false;
+	++widgetUpdateDepth;
+	return (result);
+}
+
+bool Scene::endWidgetUpdate (bool beginResult) {
+	bool result;
+
+	result = isWidgetPropertyChanged;
+	isWidgetPropertyChanged = beginResult;
+	--widgetUpdateDepth;
+	return (result);
+}
+
+int64_t Scene::getChangeCount () {
+	return (changeCount.load (std::memory_order_acquire));
+}
+
+bool Scene::isChangePending () {
+	return (isChanged.load ());
+}
+
+bool Scene::takeChanged (std::vector<SDL_Rect> *destDamageRects, bool *destIsFullDamage) {
+	if (! isChanged.exchange (false, std::memory_order_acq_rel)) {
+		return (false);
+	}
+	SDL_AtomicLock (&damageLock);
+	if (destDamageRects) {
+		destDamageRects->swap (damageRectList);
+	}
+	if (destIsFullDamage) {
+		*destIsFullDamage = isFullDamage;
+	}
+	damageRectList.clear ();
+	isFullDamage = false;
+	SDL_AtomicUnlock (&damageLock);
+	return (true);
+}
@@ -0,0 +1,82 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that tracks changes to the drawn scene and the screen regions that must be drawn again
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "SDL2/SDL.h"
+
+class Scene {
+public:
+	// The maximum number of separate damage rectangles to track before merging them into a single bounding rectangle
+	static const int MaxDamageRectCount;
+
+	// Mark the entire scene as changed, causing the next render cycle to draw a full frame. This method may be invoked from any thread.
+	static void setChanged ();
+
+	// Mark the specified screen region as changed, causing the next render cycle to draw it again. This method may be invoked from any thread.
+	static void addDamage (float x, float y, float w, float h);
+
+	// Mark the scene as needing to be presented, without changing any drawn region. This method may be invoked from any thread.
+	static void requestPresent ();
+
+	// Record a change to a drawn property such as a Color or Position value. If invoked during a widget update on the same thread, the change is attributed to the updating widget; otherwise, the entire scene is marked as changed.
+	static void setPropertyChanged ();
+
+	// Begin a widget update on the calling thread, returning a value that must be passed to the corresponding call to endWidgetUpdate
+	static bool beginWidgetUpdate ();
+
+	// End a widget update on the calling thread and return a boolean value indicating if setPropertyChanged was invoked during the update
+	static bool endWidgetUpdate (bool beginResult);
+
+	// Return a counter value that increases each time the scene is marked as changed or damaged
+	static int64_t getChangeCount ();
+
+	// Return a boolean value indicating if the scene has changed since the previous call to takeChanged, without clearing the changed state
+	static bool isChangePending ();
+
+	// Return a boolean value indicating if the scene has changed since the previous call, and clear the changed state. If the scene has changed, store merged damage rectangles in destDamageRects and a value indicating if the entire scene must be drawn in destIsFullDamage.
+	static bool takeChanged (std::vector<SDL_Rect> *destDamageRects, bool *destIsFullDamage);
+
+private:
+	static std::atomic<bool> isChanged;
+	static std::atomic<int64_t> changeCount;
+	static SDL_SpinLock damageLock;
+	static std::vector<SDL_Rect> damageRectList;
+	static bool isFullDamage;
+	static thread_local int widgetUpdateDepth;
+	static thread_local bool isWidgetPropertyChanged;
+};
+
+#endif
@@ -36,40 +36,20 @@
 SharedBuffer::SharedBuffer ()
 : Buffer ()
 , refcount (0)
-, refcountMutex (NULL)
 {
-	refcountMutex = SDL_CreateMutex ();
+
 }
 
 SharedBuffer::~SharedBuffer () {
-	if (refcountMutex) {
-		SDL_DestroyMutex (refcountMutex);
-		refcountMutex = NULL;
-	}
+
 }
 
 void SharedBuffer::retain () {
-
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
+	refcount.fetch_add (1, std::memory_order_relaxed);
 }
 
 void SharedBuffer::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
+	if (refcount.fetch_sub (1, std::memory_order_acq_rel) <= 1) {
 		delete (this);
 	}
 }
@@ -32,6 +32,7 @@
 #ifndef SHARED_BUFFER_H
 #define SHARED_BUFFER_H
 
+#include <atomic>
 #include "SDL2/SDL.h"
 #include "Buffer.h"
 
@@ -47,8 +48,7 @@ public:
 	void release ();
 
 private:
-	int refcount;
-	SDL_mutex *refcountMutex;
+	std::atomic<int> refcount;
 };
 
 #endif
@@ -30,12 +30,14 @@
 #include "Config.h"
 #include <stdlib.h>
 #include <vector>
+#include "SDL2/SDL.h"
 #include "OsUtil.h"
 #include "Log.h"
 #include "App.h"
 #include "StdString.h"
 #include "Resource.h"
 #include "Sprite.h"
+#include "TaskGraph.h"
 #include "SpriteGroup.h"
 
 SpriteGroup::SpriteGroup ()
@@ -65,9 +67,14 @@ void SpriteGroup::clearSpriteList () {
 
 OsUtil::Result SpriteGroup::load (const StdString &path, int imageScale) {
 	Resource *resource;
-	Sprite *sprite;
+	SpriteGroup::SpriteLoad *spriteload;
+	std::vector<SpriteGroup::SpriteLoad *> loadlist;
+	std::vector<SpriteGroup::SpriteLoad *>::iterator i, end;
+	TaskGraph graph;
+	StdString framepath;
 	OsUtil::Result result;
-	int i;
+	int spriteindex, frameindex, surfacenode, texturenode;
+	bool found;
 
 	if (isLoaded) {
 		if (! loadPath.equals (path)) {
@@ -80,23 +87,58 @@ OsUtil::Result SpriteGroup::load (const StdString &path, int imageScale) {
 	if (imageScale < 0) {
 		imageScale = App::instance->imageScale;
 	}
-	result = OsUtil::Success;
-	i = 0;
+
+	// Frame paths are gathered here as Sprite::load would choose them. Image files are then decoded on task threads while textures are created on this thread, each sprite's textures as soon as its images are ready.
+	spriteindex = 0;
 	while (true) {
-		if (! resource->fileExists (StdString::createSprintf ("%s/%03i/000_%i.png", path.c_str (), i, imageScale))) {
-			if (! resource->fileExists (StdString::createSprintf ("%s/%03i/000.png", path.c_str (), i))) {
+		if (! resource->fileExists (StdString::createSprintf ("%s/%03i/000_%i.png", path.c_str (), spriteindex, imageScale))) {
+			if (! resource->fileExists (StdString::createSprintf ("%s/%03i/000.png", path.c_str (), spriteindex))) {
 				break;
 			}
 		}
 
-		sprite = new Sprite ();
-		result = sprite->load (StdString::createSprintf ("%s/%03i", path.c_str (), i), imageScale);
-		if (result != OsUtil::Success) {
-			delete (sprite);
-			break;
+		spriteload = new SpriteGroup::SpriteLoad ();
+		frameindex = 0;
+		while (true) {
+			found = false;
+			if (imageScale >= 0) {
+				framepath.sprintf ("%s/%03i/%03i_%i.png", path.c_str (), spriteindex, frameindex, imageScale);
+				if (resource->fileExists (framepath)) {
+					found = true;
+				}
+			}
+			if (! found) {
+				framepath.sprintf ("%s/%03i/%03i.png", path.c_str (), spriteindex, frameindex);
+				if (resource->fileExists (framepath)) {
+					found = true;
+				}
+			}
+			if (! found) {
+				break;
+			}
+			spriteload->framePaths.push_back (framepath);
+			++frameindex;
 		}
+		spriteload->frameSurfaces.assign (spriteload->framePaths.size (), NULL);
+		loadlist.push_back (spriteload);
+
+		surfacenode = graph.addTask (SpriteGroup::loadFrameSurfaces, spriteload);
+		texturenode = graph.addTask (SpriteGroup::createFrameTextures, spriteload, true);
+		graph.addDependency (texturenode, surfacenode);
+		++spriteindex;
+	}
+	graph.run ();
 
-		spriteList.push_back (sprite);
+	result = OsUtil::Success;
+	i = loadlist.begin ();
+	end = loadlist.end ();
+	while (i != end) {
+		spriteload = *i;
+		if (result == OsUtil::Success) {
+			result = spriteload->result;
+		}
+		spriteList.push_back (spriteload->sprite);
+		delete (spriteload);
 		++i;
 	}
 
@@ -110,6 +152,58 @@ OsUtil::Result SpriteGroup::load (const StdString &path, int imageScale) {
 	return (result);
 }
 
+void SpriteGroup::loadFrameSurfaces (void *spriteLoadPtr) {
+	SpriteGroup::SpriteLoad *spriteload;
+	Resource *resource;
+	int i, count;
+
+	spriteload = (SpriteGroup::SpriteLoad *) spriteLoadPtr;
+	resource = &(App::instance->resource);
+	count = (int) spriteload->framePaths.size ();
+	for (i = 0; i < count; ++i) {
+		spriteload->frameSurfaces.at (i) = resource->loadSurface (spriteload->framePaths.at (i));
+		if (! spriteload->frameSurfaces.at (i)) {
+			break;
+		}
+	}
+}
+
+void SpriteGroup::createFrameTextures (void *spriteLoadPtr) {
+	SpriteGroup::SpriteLoad *spriteload;
+	Resource *resource;
+	SDL_Texture *texture;
+	int i, count;
+
+	spriteload = (SpriteGroup::SpriteLoad *) spriteLoadPtr;
+	resource = &(App::instance->resource);
+	spriteload->sprite = new Sprite ();
+	count = (int) spriteload->framePaths.size ();
+	for (i = 0; i < count; ++i) {
+		if (spriteload->result != OsUtil::Success) {
+			break;
+		}
+		if (! spriteload->frameSurfaces.at (i)) {
+			spriteload->result = OsUtil::SdlOperationFailedError;
+			break;
+		}
+		texture = resource->createTexture (spriteload->framePaths.at (i), spriteload->frameSurfaces.at (i));
+		if (! texture) {
+			spriteload->result = OsUtil::SdlOperationFailedError;
+			break;
+		}
+		spriteload->result = spriteload->sprite->addTexture (texture, spriteload->framePaths.at (i));
+		if (spriteload->result != OsUtil::Success) {
+			resource->unloadTexture (spriteload->framePaths.at (i));
+		}
+	}
+	for (i = 0; i < count; ++i) {
+		if (spriteload->frameSurfaces.at (i)) {
+			SDL_FreeSurface (spriteload->frameSurfaces.at (i));
+			spriteload->frameSurfaces.at (i) = NULL;
+		}
+	}
+}
+
 void SpriteGroup::unload () {
 	if (! isLoaded) {
 		return;
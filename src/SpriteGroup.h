@@ -33,6 +33,7 @@
 #define SPRITE_GROUP_H
 
 #include <vector>
+#include "SDL2/SDL.h"
 #include "StdString.h"
 #include "OsUtil.h"
 #include "Sprite.h"
@@ -59,9 +60,23 @@ public:
 	Sprite *getSprite (int index);
 
 private:
+	struct SpriteLoad {
+		std::vector<StdString> framePaths;
+		std::vector<SDL_Surface *> frameSurfaces;
+		Sprite *sprite;
+		OsUtil::Result result;
+		SpriteLoad ():
+			sprite (NULL),
+			result (OsUtil::Success) { }
+	};
+
 	// Remove all items from the sprite list
 	void clearSpriteList ();
 
+	// Task functions
+	static void loadFrameSurfaces (void *spriteLoadPtr);
+	static void createFrameTextures (void *spriteLoadPtr);
+
 	std::vector<Sprite *> spriteList;
 };
 
@@ -0,0 +1,100 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Bounded queue template for passing items from a single producer thread to a single consumer thread without locking
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+
+template<class T> class SpscQueue {
+public:
+	SpscQueue<T> (int minCapacity): items (NULL), capacity (1), mask (0), readPosition (0), writePosition (0) {
+		while (capacity < minCapacity) {
+			capacity <<= 1;
+		}
+		mask = capacity - 1;
+		items = new T[capacity];
+	}
+	~SpscQueue<T> () {
+		delete[] items;
+	}
+
+	// Add an item to the queue. Returns a boolean value indicating if the item was added, or false if the queue was full. Must be invoked only from the producer thread.
+	bool push (const T &item) {
+		unsigned int w;
+
+		w = writePosition.load (std::memory_order_relaxed);
+		if ((w - readPosition.load (std::memory_order_acquire)) >= (unsigned int) capacity) {
+			return (false);
+		}
+		items[w & mask] = item;
+		writePosition.store (w + 1, std::memory_order_release);
+		return (true);
+	}
+
+	// Remove the item at the front of the queue and write it to the provided pointer. Returns a boolean value indicating if an item was found. Must be invoked only from the consumer thread.
+	bool pop (T *destItem) {
+		unsigned int r;
+
+		r = readPosition.load (std::memory_order_relaxed);
+		if (r == writePosition.load (std::memory_order_acquire)) {
+			return (false);
+		}
+		*destItem = items[r & mask];
+		readPosition.store (r + 1, std::memory_order_release);
+		return (true);
+	}
+
+	// Return the number of items currently held in the queue
+	int size () const {
+		return ((int) (writePosition.load (std::memory_order_acquire) - readPosition.load (std::memory_order_acquire)));
+	}
+
+	// Return the maximum number of items the queue can hold
+	int getCapacity () const {
+		return (capacity);
+	}
+
+private:
+	T *items;
+	int capacity;
+	unsigned int mask;
+
+	// Producer and consumer positions are separated by padding of at least one cache line to avoid false sharing between the two threads. Padding is used instead of alignas because queues are members of objects allocated with plain new, which does not honor extended alignment before C++17.
+	static const int CacheLineSize = 64;
+	char positionPadding0[SpscQueue<T>::CacheLineSize];
+	std::atomic<unsigned int> readPosition;
+	char positionPadding1[SpscQueue<T>::CacheLineSize];
+	std::atomic<unsigned int> writePosition;
+	char positionPadding2[SpscQueue<T>::CacheLineSize];
+};
+
+#endif
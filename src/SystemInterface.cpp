@@ -29,12 +29,17 @@
 */
 #include <stdlib.h>
 #include "Config.h"
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "JsonArena.h"
 #include "SystemInterface.h"
 
 const char *SystemInterface::version = "25-stable-71094b9f";
 const char *SystemInterface::Command_ClearCache = "ClearCache";
 const char *SystemInterface::Command_CommandResult = "CommandResult";
 const char *SystemInterface::Command_EndSet = "EndSet";
+const char *SystemInterface::Command_ExecuteBatch = "ExecuteBatch";
 const char *SystemInterface::Command_GetStatus = "GetStatus";
 const char *SystemInterface::Command_PlayAnimation = "PlayAnimation";
 const char *SystemInterface::Command_RemoveWindow = "RemoveWindow";
@@ -43,6 +48,9 @@ const char *SystemInterface::Command_ShowCountdownWindow = "ShowCountdownWindow"
 const char *SystemInterface::Command_ShowFileImageBackground = "ShowFileImageBackground";
 const char *SystemInterface::Command_ShowIconLabelWindow = "ShowIconLabelWindow";
 const char *SystemInterface::Command_ShowResourceImageBackground = "ShowResourceImageBackground";
+const char *SystemInterface::Command_StartAnimation = "StartAnimation";
+const char *SystemInterface::Command_StopAnimation = "StopAnimation";
+const char *SystemInterface::Command_StoreAnimation = "StoreAnimation";
 const char *SystemInterface::Constant_AgentIdPrefixField = "b";
 const char *SystemInterface::Constant_AuthorizationHashAlgorithm = "sha256";
 const char *SystemInterface::Constant_AuthorizationHashPrefixField = "g";
@@ -56,6 +64,7 @@ void SystemInterface::populate () {
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("ClearCache"), SystemInterface::Command (59, StdString ("ClearCache"), StdString ("EmptyObject"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("CommandResult"), SystemInterface::Command (0, StdString ("CommandResult"), StdString ("CommandResult"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("EndSet"), SystemInterface::Command (21, StdString ("EndSet"), StdString ("EmptyObject"))));
+  commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("ExecuteBatch"), SystemInterface::Command (220, StdString ("ExecuteBatch"), StdString ("ExecuteBatch"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("GetStatus"), SystemInterface::Command (8, StdString ("GetStatus"), StdString ("EmptyObject"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("PlayAnimation"), SystemInterface::Command (215, StdString ("PlayAnimation"), StdString ("PlayAnimation"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("RemoveWindow"), SystemInterface::Command (217, StdString ("RemoveWindow"), StdString ("RemoveWindow"))));
@@ -64,9 +73,13 @@ void SystemInterface::populate () {
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("ShowFileImageBackground"), SystemInterface::Command (106, StdString ("ShowFileImageBackground"), StdString ("ShowFileImageBackground"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("ShowIconLabelWindow"), SystemInterface::Command (216, StdString ("ShowIconLabelWindow"), StdString ("ShowIconLabelWindow"))));
   commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("ShowResourceImageBackground"), SystemInterface::Command (81, StdString ("ShowResourceImageBackground"), StdString ("ShowResourceImageBackground"))));
+  commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("StartAnimation"), SystemInterface::Command (222, StdString ("StartAnimation"), StdString ("StartAnimation"))));
+  commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("StopAnimation"), SystemInterface::Command (223, StdString ("StopAnimation"), StdString ("EmptyObject"))));
+  commandMap.insert (std::pair<StdString, SystemInterface::Command> (StdString ("StoreAnimation"), SystemInterface::Command (221, StdString ("StoreAnimation"), StdString ("StoreAnimation"))));
   commandIdMap.insert (std::pair<int, StdString> (59, StdString ("ClearCache")));
   commandIdMap.insert (std::pair<int, StdString> (0, StdString ("CommandResult")));
   commandIdMap.insert (std::pair<int, StdString> (21, StdString ("EndSet")));
+  commandIdMap.insert (std::pair<int, StdString> (220, StdString ("ExecuteBatch")));
   commandIdMap.insert (std::pair<int, StdString> (8, StdString ("GetStatus")));
   commandIdMap.insert (std::pair<int, StdString> (215, StdString ("PlayAnimation")));
   commandIdMap.insert (std::pair<int, StdString> (217, StdString ("RemoveWindow")));
@@ -75,9 +88,14 @@ void SystemInterface::populate () {
   commandIdMap.insert (std::pair<int, StdString> (106, StdString ("ShowFileImageBackground")));
   commandIdMap.insert (std::pair<int, StdString> (216, StdString ("ShowIconLabelWindow")));
   commandIdMap.insert (std::pair<int, StdString> (81, StdString ("ShowResourceImageBackground")));
+  commandIdMap.insert (std::pair<int, StdString> (222, StdString ("StartAnimation")));
+  commandIdMap.insert (std::pair<int, StdString> (223, StdString ("StopAnimation")));
+  commandIdMap.insert (std::pair<int, StdString> (221, StdString ("StoreAnimation")));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("AnimationCommand"), SystemInterface::getParams_AnimationCommand));
+  getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("AnimationOverride"), SystemInterface::getParams_AnimationOverride));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("CommandResult"), SystemInterface::getParams_CommandResult));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("EmptyObject"), SystemInterface::getParams_EmptyObject));
+  getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("ExecuteBatch"), SystemInterface::getParams_ExecuteBatch));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("PlayAnimation"), SystemInterface::getParams_PlayAnimation));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("RemoveWindow"), SystemInterface::getParams_RemoveWindow));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("ShowColorFillBackground"), SystemInterface::getParams_ShowColorFillBackground));
@@ -85,9 +103,13 @@ void SystemInterface::populate () {
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("ShowFileImageBackground"), SystemInterface::getParams_ShowFileImageBackground));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("ShowIconLabelWindow"), SystemInterface::getParams_ShowIconLabelWindow));
   getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("ShowResourceImageBackground"), SystemInterface::getParams_ShowResourceImageBackground));
+  getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("StartAnimation"), SystemInterface::getParams_StartAnimation));
+  getParamsMap.insert (std::pair<StdString, SystemInterface::GetParamsFunction> (StdString ("StoreAnimation"), SystemInterface::getParams_StoreAnimation));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("AnimationCommand"), SystemInterface::populateDefaultFields_AnimationCommand));
+  populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("AnimationOverride"), SystemInterface::populateDefaultFields_AnimationOverride));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("CommandResult"), SystemInterface::populateDefaultFields_CommandResult));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("EmptyObject"), SystemInterface::populateDefaultFields_EmptyObject));
+  populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("ExecuteBatch"), SystemInterface::populateDefaultFields_ExecuteBatch));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("PlayAnimation"), SystemInterface::populateDefaultFields_PlayAnimation));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("RemoveWindow"), SystemInterface::populateDefaultFields_RemoveWindow));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("ShowColorFillBackground"), SystemInterface::populateDefaultFields_ShowColorFillBackground));
@@ -95,9 +117,13 @@ void SystemInterface::populate () {
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("ShowFileImageBackground"), SystemInterface::populateDefaultFields_ShowFileImageBackground));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("ShowIconLabelWindow"), SystemInterface::populateDefaultFields_ShowIconLabelWindow));
   populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("ShowResourceImageBackground"), SystemInterface::populateDefaultFields_ShowResourceImageBackground));
+  populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("StartAnimation"), SystemInterface::populateDefaultFields_StartAnimation));
+  populateDefaultFieldsMap.insert (std::pair<StdString, SystemInterface::PopulateDefaultFieldsFunction> (StdString ("StoreAnimation"), SystemInterface::populateDefaultFields_StoreAnimation));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("AnimationCommand"), SystemInterface::hashFields_AnimationCommand));
+  hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("AnimationOverride"), SystemInterface::hashFields_AnimationOverride));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("CommandResult"), SystemInterface::hashFields_CommandResult));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("EmptyObject"), SystemInterface::hashFields_EmptyObject));
+  hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("ExecuteBatch"), SystemInterface::hashFields_ExecuteBatch));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("PlayAnimation"), SystemInterface::hashFields_PlayAnimation));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("RemoveWindow"), SystemInterface::hashFields_RemoveWindow));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("ShowColorFillBackground"), SystemInterface::hashFields_ShowColorFillBackground));
@@ -105,6 +131,8 @@ void SystemInterface::populate () {
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("ShowFileImageBackground"), SystemInterface::hashFields_ShowFileImageBackground));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("ShowIconLabelWindow"), SystemInterface::hashFields_ShowIconLabelWindow));
   hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("ShowResourceImageBackground"), SystemInterface::hashFields_ShowResourceImageBackground));
+  hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("StartAnimation"), SystemInterface::hashFields_StartAnimation));
+  hashFieldsMap.insert (std::pair<StdString, SystemInterface::HashFieldsFunction> (StdString ("StoreAnimation"), SystemInterface::hashFields_StoreAnimation));
 }
 
 void SystemInterface::getParams_AnimationCommand (std::list<SystemInterface::Param> *destList) {
@@ -113,6 +141,12 @@ void SystemInterface::getParams_AnimationCommand (std::list<SystemInterface::Par
   destList->push_back (SystemInterface::Param (StdString ("command"), StdString ("object"), StdString (""), 257));
 }
 
+void SystemInterface::getParams_AnimationOverride (std::list<SystemInterface::Param> *destList) {
+  destList->clear ();
+  destList->push_back (SystemInterface::Param (StdString ("windowId"), StdString ("string"), StdString (""), 3));
+  destList->push_back (SystemInterface::Param (StdString ("labelText"), StdString ("string"), StdString (""), 0));
+}
+
 void SystemInterface::getParams_CommandResult (std::list<SystemInterface::Param> *destList) {
   destList->clear ();
   destList->push_back (SystemInterface::Param (StdString ("success"), StdString ("boolean"), StdString (""), 1));
@@ -127,9 +161,17 @@ void SystemInterface::getParams_EmptyObject (std::list<SystemInterface::Param> *
   destList->clear ();
 }
 
+void SystemInterface::getParams_ExecuteBatch (std::list<SystemInterface::Param> *destList) {
+  destList->clear ();
+  destList->push_back (SystemInterface::Param (StdString ("commands"), StdString ("array"), StdString ("object"), 259));
+}
+
 void SystemInterface::getParams_PlayAnimation (std::list<SystemInterface::Param> *destList) {
   destList->clear ();
   destList->push_back (SystemInterface::Param (StdString ("commands"), StdString ("array"), StdString ("AnimationCommand"), 1));
+  destList->push_back (SystemInterface::Param (StdString ("loopCount"), StdString ("number"), StdString (""), 8));
+  destList->push_back (SystemInterface::Param (StdString ("loopForever"), StdString ("boolean"), StdString (""), 0));
+  destList->push_back (SystemInterface::Param (StdString ("loopDuration"), StdString ("number"), StdString (""), 16));
 }
 
 void SystemInterface::getParams_RemoveWindow (std::list<SystemInterface::Param> *destList) {
@@ -174,19 +216,49 @@ void SystemInterface::getParams_ShowResourceImageBackground (std::list<SystemInt
   destList->push_back (SystemInterface::Param (StdString ("imagePath"), StdString ("string"), StdString (""), 3));
 }
 
+void SystemInterface::getParams_StartAnimation (std::list<SystemInterface::Param> *destList) {
+  destList->clear ();
+  destList->push_back (SystemInterface::Param (StdString ("name"), StdString ("string"), StdString (""), 3));
+  destList->push_back (SystemInterface::Param (StdString ("overrides"), StdString ("array"), StdString ("AnimationOverride"), 0));
+}
+
+void SystemInterface::getParams_StoreAnimation (std::list<SystemInterface::Param> *destList) {
+  destList->clear ();
+  destList->push_back (SystemInterface::Param (StdString ("name"), StdString ("string"), StdString (""), 3));
+  destList->push_back (SystemInterface::Param (StdString ("commands"), StdString ("array"), StdString ("AnimationCommand"), 1));
+  destList->push_back (SystemInterface::Param (StdString ("loopCount"), StdString ("number"), StdString (""), 8));
+  destList->push_back (SystemInterface::Param (StdString ("loopForever"), StdString ("boolean"), StdString (""), 0));
+  destList->push_back (SystemInterface::Param (StdString ("loopDuration"), StdString ("number"), StdString (""), 16));
+}
+
 void SystemInterface::populateDefaultFields_AnimationCommand (Json *destObject) {
   if (! destObject->exists ("executeTime")) {
     destObject->set ("executeTime", 0);
   }
 }
 
+void SystemInterface::populateDefaultFields_AnimationOverride (Json *destObject) {
+}
+
 void SystemInterface::populateDefaultFields_CommandResult (Json *destObject) {
 }
 
 void SystemInterface::populateDefaultFields_EmptyObject (Json *destObject) {
 }
 
+void SystemInterface::populateDefaultFields_ExecuteBatch (Json *destObject) {
+}
+
 void SystemInterface::populateDefaultFields_PlayAnimation (Json *destObject) {
+  if (! destObject->exists ("loopCount")) {
+    destObject->set ("loopCount", 1);
+  }
+  if (! destObject->exists ("loopForever")) {
+    destObject->set ("loopForever", false);
+  }
+  if (! destObject->exists ("loopDuration")) {
+    destObject->set ("loopDuration", 0);
+  }
 }
 
 void SystemInterface::populateDefaultFields_RemoveWindow (Json *destObject) {
@@ -225,6 +297,21 @@ void SystemInterface::populateDefaultFields_ShowIconLabelWindow (Json *destObjec
 void SystemInterface::populateDefaultFields_ShowResourceImageBackground (Json *destObject) {
 }
 
+void SystemInterface::populateDefaultFields_StartAnimation (Json *destObject) {
+}
+
+void SystemInterface::populateDefaultFields_StoreAnimation (Json *destObject) {
+  if (! destObject->exists ("loopCount")) {
+    destObject->set ("loopCount", 1);
+  }
+  if (! destObject->exists ("loopForever")) {
+    destObject->set ("loopForever", false);
+  }
+  if (! destObject->exists ("loopDuration")) {
+    destObject->set ("loopDuration", 0);
+  }
+}
+
 void SystemInterface::hashFields_AnimationCommand (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
   StdString s;
 
@@ -232,6 +319,19 @@ void SystemInterface::hashFields_AnimationCommand (Json *commandParams, SystemIn
   hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
 }
 
+void SystemInterface::hashFields_AnimationOverride (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
+  StdString s;
+
+  s = commandParams->getString ("labelText", "");
+  if (! s.empty ()) {
+    hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  }
+  s = commandParams->getString ("windowId", "");
+  if (! s.empty ()) {
+    hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  }
+}
+
 void SystemInterface::hashFields_CommandResult (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
   StdString s;
 
@@ -267,7 +367,12 @@ void SystemInterface::hashFields_EmptyObject (Json *commandParams, SystemInterfa
 
 }
 
+void SystemInterface::hashFields_ExecuteBatch (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
+
+}
+
 void SystemInterface::hashFields_PlayAnimation (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
+  StdString s;
   Json obj;
   int i, len;
 
@@ -277,6 +382,12 @@ void SystemInterface::hashFields_PlayAnimation (Json *commandParams, SystemInter
       SystemInterface::hashFields_AnimationCommand (&obj, hashUpdateFn, hashContextPtr);
     }
   }
+  s.sprintf ("%lli", (long long int) commandParams->getNumber ("loopCount", (int64_t) 0));
+  hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  s.sprintf ("%lli", (long long int) commandParams->getNumber ("loopDuration", (int64_t) 0));
+  hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  s.sprintf ("%s", commandParams->getBoolean ("loopForever", false) ? "true" : "false");
+  hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
 }
 
 void SystemInterface::hashFields_RemoveWindow (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
@@ -358,6 +469,46 @@ void SystemInterface::hashFields_ShowResourceImageBackground (Json *commandParam
     hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
   }
 }
+
+void SystemInterface::hashFields_StartAnimation (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
+  StdString s;
+  Json obj;
+  int i, len;
+
+  s = commandParams->getString ("name", "");
+  if (! s.empty ()) {
+    hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  }
+  len = commandParams->getArrayLength ("overrides");
+  for (i = 0; i < len; ++i) {
+    if (commandParams->getArrayObject ("overrides", i, &obj)) {
+      SystemInterface::hashFields_AnimationOverride (&obj, hashUpdateFn, hashContextPtr);
+    }
+  }
+}
+
+void SystemInterface::hashFields_StoreAnimation (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr) {
+  StdString s;
+  Json obj;
+  int i, len;
+
+  len = commandParams->getArrayLength ("commands");
+  for (i = 0; i < len; ++i) {
+    if (commandParams->getArrayObject ("commands", i, &obj)) {
+      SystemInterface::hashFields_AnimationCommand (&obj, hashUpdateFn, hashContextPtr);
+    }
+  }
+  s.sprintf ("%lli", (long long int) commandParams->getNumber ("loopCount", (int64_t) 0));
+  hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  s.sprintf ("%lli", (long long int) commandParams->getNumber ("loopDuration", (int64_t) 0));
+  hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  s.sprintf ("%s", commandParams->getBoolean ("loopForever", false) ? "true" : "false");
+  hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  s = commandParams->getString ("name", "");
+  if (! s.empty ()) {
+    hashUpdateFn (hashContextPtr, (unsigned char *) s.c_str (), s.length ());
+  }
+}
 SystemInterface *SystemInterface::instance = NULL;
 
 SystemInterface::SystemInterface ()
@@ -561,8 +712,11 @@ void SystemInterface::hashFields (const StdString &typeName, Json *commandParams
 
 bool SystemInterface::fieldsValid (Json *fields, std::list<SystemInterface::Param> *paramList) {
 	std::list<SystemInterface::Param>::iterator i, end;
+	std::list<SystemInterface::Param> itemparams;
 	double numbervalue;
 	StdString stringvalue;
+	Json item, itemfields;
+	int j, count;
 
 	// TODO: Check for unknown field keys
 	// TODO: Possibly allow validation to succeed if unknown field keys are present
@@ -570,11 +724,13 @@ bool SystemInterface::fieldsValid (Json *fields, std::list<SystemInterface::Para
 	i = paramList->begin ();
 	end = paramList->end ();
 	while (i != end) {
-		if (i->flags & SystemInterface::ParamFlag_Required) {
-			if (! fields->exists (i->name)) {
+		if (! fields->exists (i->name)) {
+			if (i->flags & SystemInterface::ParamFlag_Required) {
 				lastError.sprintf ("Missing required parameter field \"%s\"", i->name.c_str ());
 				return (false);
 			}
+			++i;
+			continue;
 		}
 
 		if (i->type.equals ("number")) {
@@ -583,7 +739,7 @@ bool SystemInterface::fieldsValid (Json *fields, std::list<SystemInterface::Para
 				return (false);
 			}
 
-			numbervalue = fields->getNumber (i->name, 0);
+			numbervalue = fields->getNumber (i->name, (double) 0.0f);
 			if (i->flags & SystemInterface::ParamFlag_GreaterThanZero) {
 				if (numbervalue <= 0.0f) {
 					lastError.sprintf ("Parameter field \"%s\" must be a number greater than zero", i->name.c_str ());
@@ -606,7 +762,10 @@ bool SystemInterface::fieldsValid (Json *fields, std::list<SystemInterface::Para
 			}
 
 			if (i->flags & SystemInterface::ParamFlag_EnumValue) {
-				// TODO: Implement this
+				if (numbervalue != floor (numbervalue)) {
+					lastError.sprintf ("Parameter field \"%s\" must contain an integer enum value", i->name.c_str ());
+					return (false);
+				}
 			}
 		}
 		else if (i->type.equals ("boolean")) {
@@ -630,58 +789,178 @@ bool SystemInterface::fieldsValid (Json *fields, std::list<SystemInterface::Para
 			}
 
 			if ((i->flags & SystemInterface::ParamFlag_Hostname) && (! stringvalue.empty ())) {
-				// TODO: Implement this
-				/*
-				if (value.search (/^[a-zA-Z][a-zA-Z0-9-\.]*(:[0-9]+){0,1}$/) != 0) {
-					return ("Parameter field \"" + param.name + "\" must contain a hostname string");
+				if (! SystemInterface::isHostname (stringvalue.c_str (), stringvalue.length ())) {
+					lastError.sprintf ("Parameter field \"%s\" must contain a hostname string", i->name.c_str ());
+					return (false);
 				}
-				*/
 			}
 
 			if ((i->flags & SystemInterface::ParamFlag_Uuid) && (! stringvalue.empty ())) {
-				// TODO: Implement this
-				/*
-				if (value.search (/^[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}$/) != 0) {
-					return ("Parameter field \"" + param.name + "\" must contain a UUID string");
+				if (! SystemInterface::isUuid (stringvalue.c_str (), stringvalue.length ())) {
+					lastError.sprintf ("Parameter field \"%s\" must contain a UUID string", i->name.c_str ());
+					return (false);
 				}
-				*/
 			}
 
 			if ((i->flags & SystemInterface::ParamFlag_Url) && (! stringvalue.empty ())) {
-				// TODO: Implement this
-				/*
-				if (value.search (/[^A-Za-z0-9\$\-_\.\+\!\*\?\(\),\/:;=&]/) != -1) {
-					return ("Parameter field \"" + param.name + "\" must contain a URL string");
+				if (! SystemInterface::isUrl (stringvalue.c_str (), stringvalue.length ())) {
+					lastError.sprintf ("Parameter field \"%s\" must contain a URL string", i->name.c_str ());
+					return (false);
 				}
-				*/
+			}
+		}
+		else if (i->type.equals ("array")) {
+			if (! fields->isArray (i->name)) {
+				lastError.sprintf ("Parameter field \"%s\" has incorrect type (expecting array)", i->name.c_str ());
+				return (false);
 			}
 
-			if (i->flags & SystemInterface::ParamFlag_EnumValue) {
-				// TODO: Implement this
+			count = fields->getArrayLength (i->name);
+			if ((i->flags & SystemInterface::ParamFlag_NotEmpty) && (count <= 0)) {
+				lastError.sprintf ("Parameter field \"%s\" cannot contain an empty array", i->name.c_str ());
+				return (false);
+			}
+			if (i->containerType.equals ("object")) {
+				for (j = 0; j < count; ++j) {
+					if (! fields->getArrayObject (i->name, j, &item)) {
+						lastError.sprintf ("Parameter field \"%s\" has incorrect item type at index %i (expecting object)", i->name.c_str (), j);
+						return (false);
+					}
+					if ((i->flags & SystemInterface::ParamFlag_Command) && (! commandValid (&item))) {
+						return (false);
+					}
+				}
+			}
+			else if (getType (i->containerType, &itemparams)) {
+				for (j = 0; j < count; ++j) {
+					if (! fields->getArrayObject (i->name, j, &item)) {
+						lastError.sprintf ("Parameter field \"%s\" has incorrect item type at index %i (expecting %s)", i->name.c_str (), j, i->containerType.c_str ());
+						return (false);
+					}
+					itemfields.copyValue (&item);
+					populateDefaultFields (i->containerType, &itemfields);
+					if (! fieldsValid (&itemfields, &itemparams)) {
+						return (false);
+					}
+				}
 			}
 		}
-		else if (i->type.equals ("array")) {
-			// TODO: Implement this
+		else if (i->type.equals ("map") || i->type.equals ("object")) {
+			if (! fields->getObject (i->name, &item)) {
+				lastError.sprintf ("Parameter field \"%s\" has incorrect type (expecting %s)", i->name.c_str (), i->type.c_str ());
+				return (false);
+			}
+			if (i->flags & SystemInterface::ParamFlag_Command) {
+				if (! commandValid (&item)) {
+					return (false);
+				}
+			}
+		}
+
+		++i;
+	}
+
+	return (true);
+}
+
+bool SystemInterface::commandValid (Json *command) {
+	std::map<int, StdString>::iterator i;
+	SystemInterface::Command cmd;
+	std::list<SystemInterface::Param> params;
+	Json paramsobject, fields;
+	int id;
+
+	id = getCommandId (command);
+	i = commandIdMap.find (id);
+	if ((i == commandIdMap.end ()) || (! getCommand (i->second, &cmd))) {
+		lastError.sprintf ("Unknown command ID %i", id);
+		return (false);
+	}
+	if (! getCommandParams (command, &paramsobject)) {
+		lastError.sprintf ("Command \"%s\" is missing its params object", cmd.name.c_str ());
+		return (false);
+	}
+	if (! getType (cmd.paramType, &params)) {
+		lastError.sprintf ("Command \"%s\" references unknown param type \"%s\"", cmd.name.c_str (), cmd.paramType.c_str ());
+		return (false);
+	}
+	fields.copyValue (&paramsobject);
+	populateDefaultFields (cmd.paramType, &fields);
+	return (fieldsValid (&fields, &params));
+}
+
+bool SystemInterface::isHostname (const char *str, int length) {
+	int i;
+	char c;
+	bool isport;
+
+	if ((length <= 0) || (! isalpha ((unsigned char) str[0]))) {
+		return (false);
+	}
+	isport = false;
+	for (i = 1; i < length; ++i) {
+		c = str[i];
+		if (isport) {
+			if (! isdigit ((unsigned char) c)) {
+				return (false);
+			}
 		}
-		else if (i->type.equals ("map")) {
-			// TODO: Implement this
+		else if (c == ':') {
+			if (i >= (length - 1)) {
+				return (false);
+			}
+			isport = true;
 		}
-		else if (i->type.equals ("object")) {
-			// TODO: Implement this
+		else if ((! isalnum ((unsigned char) c)) && (c != '-') && (c != '.')) {
+			return (false);
 		}
+	}
+	return (true);
+}
 
-		++i;
+bool SystemInterface::isUuid (const char *str, int length) {
+	int i;
+
+	if (length != 36) {
+		return (false);
 	}
+	for (i = 0; i < length; ++i) {
+		if ((i == 8) || (i == 13) || (i == 18) || (i == 23)) {
+			if (str[i] != '-') {
+				return (false);
+			}
+		}
+		else if (! isxdigit ((unsigned char) str[i])) {
+			return (false);
+		}
+	}
+	return (true);
+}
 
+bool SystemInterface::isUrl (const char *str, int length) {
+	int i;
+	char c;
+
+	for (i = 0; i < length; ++i) {
+		c = str[i];
+		if (isalnum ((unsigned char) c)) {
+			continue;
+		}
+		if (! strchr ("$-_.+!*?(),/:;=&", c)) {
+			return (false);
+		}
+	}
 	return (true);
 }
 
-bool SystemInterface::parseCommand (const StdString &commandString, Json **commandJson) {
+bool SystemInterface::parseCommand (const StdString &commandString, Json **commandJson, StdString *errorMessage) {
 	Json *json;
 
 	json = new Json ();
-	if (! json->parse (commandString.c_str (), commandString.length ())) {
-		lastError.assign ("JSON parse failed");
+	if (! json->parse (commandString.c_str (), commandString.length (), JsonArena::acquire ())) {
+		if (errorMessage) {
+			errorMessage->assign ("JSON parse failed");
+		}
 		delete (json);
 		return (false);
 	}
@@ -697,6 +976,27 @@ bool SystemInterface::parseCommand (const StdString &commandString, Json **comma
 	return (true);
 }
 
+bool SystemInterface::parseMsgPackCommand (const uint8_t *commandData, int commandDataLength, Json **commandJson, StdString *errorMessage) {
+	Json *json;
+
+	json = new Json ();
+	if (! json->parseMsgPack (commandData, commandDataLength)) {
+		if (errorMessage) {
+			errorMessage->assign ("MessagePack parse failed");
+		}
+		delete (json);
+		return (false);
+	}
+
+	if (commandJson) {
+		*commandJson = json;
+	}
+	else {
+		delete (json);
+	}
+	return (true);
+}
+
 int SystemInterface::getCommandId (Json *command) {
 	return (command->getNumber ("command", -1));
 }
@@ -745,12 +1045,13 @@ bool SystemInterface::getCommandParams (Json *command, Json *params) {
 }
 
 StdString SystemInterface::getCommandStringParam (Json *command, const StdString &paramName, const StdString &defaultValue) {
-	Json params;
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (defaultValue);
 	}
-	return (params.getString (paramName, defaultValue));
+	return (params->getString (paramName, defaultValue));
 }
 
 StdString SystemInterface::getCommandStringParam (Json *command, const char *paramName, const char *defaultValue) {
@@ -758,239 +1059,255 @@ StdString SystemInterface::getCommandStringParam (Json *command, const char *par
 }
 
 bool SystemInterface::getCommandBooleanParam (Json *command, const StdString &paramName, bool defaultValue) {
-	Json params;
+	return (getCommandBooleanParam (command, paramName.c_str (), defaultValue));
+}
+
+bool SystemInterface::getCommandBooleanParam (Json *command, const char *paramName, bool defaultValue) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (defaultValue);
 	}
-	return (params.getBoolean (paramName, defaultValue));
+	return (params->getBoolean (paramName, defaultValue));
 }
 
-bool SystemInterface::getCommandBooleanParam (Json *command, const char *paramName, bool defaultValue) {
-	return (getCommandBooleanParam (command, StdString (paramName), defaultValue));
+int SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const int defaultValue) {
+	return (getCommandNumberParam (command, paramName.c_str (), defaultValue));
 }
 
-int SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const int defaultValue) {
-	Json params;
+int SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const int defaultValue) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (defaultValue);
 	}
-	return (params.getNumber (paramName, defaultValue));
+	return (params->getNumber (paramName, defaultValue));
 }
 
-int SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const int defaultValue) {
-	return (getCommandNumberParam (command, StdString (paramName), defaultValue));
+int64_t SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const int64_t defaultValue) {
+	return (getCommandNumberParam (command, paramName.c_str (), defaultValue));
 }
 
-int64_t SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const int64_t defaultValue) {
-	Json params;
+int64_t SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const int64_t defaultValue) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (defaultValue);
 	}
-	return (params.getNumber (paramName, defaultValue));
+	return (params->getNumber (paramName, defaultValue));
 }
 
-int64_t SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const int64_t defaultValue) {
-	return (getCommandNumberParam (command, StdString (paramName), defaultValue));
+double SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const double defaultValue) {
+	return (getCommandNumberParam (command, paramName.c_str (), defaultValue));
 }
 
-double SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const double defaultValue) {
-	Json params;
+double SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const double defaultValue) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (defaultValue);
 	}
-	return (params.getNumber (paramName, defaultValue));
+	return (params->getNumber (paramName, defaultValue));
 }
 
-double SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const double defaultValue) {
-	return (getCommandNumberParam (command, StdString (paramName), defaultValue));
+float SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const float defaultValue) {
+	return (getCommandNumberParam (command, paramName.c_str (), defaultValue));
 }
 
-float SystemInterface::getCommandNumberParam (Json *command, const StdString &paramName, const float defaultValue) {
-	Json params;
+float SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const float defaultValue) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (defaultValue);
 	}
-	return (params.getNumber (paramName, defaultValue));
+	return (params->getNumber (paramName, defaultValue));
 }
 
-float SystemInterface::getCommandNumberParam (Json *command, const char *paramName, const float defaultValue) {
-	return (getCommandNumberParam (command, StdString (paramName), defaultValue));
+bool SystemInterface::getCommandObjectParam (Json *command, const StdString &paramName, Json *destJson) {
+	return (getCommandObjectParam (command, paramName.c_str (), destJson));
 }
 
-bool SystemInterface::getCommandObjectParam (Json *command, const StdString &paramName, Json *destJson) {
-	Json params;
+bool SystemInterface::getCommandObjectParam (Json *command, const char *paramName, Json *destJson) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (false);
 	}
-	return (params.getObject (paramName, destJson));
+	return (params->getObject (paramName, destJson));
 }
 
-bool SystemInterface::getCommandObjectParam (Json *command, const char *paramName, Json *destJson) {
-	return (getCommandObjectParam (command, StdString (paramName), destJson));
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<int> *destList, bool shouldClear) {
+	return (getCommandNumberArrayParam (command, paramName.c_str (), destList, shouldClear));
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<int> *destList, bool shouldClear) {
-	Json params;
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<int> *destList, bool shouldClear) {
+	Json *params;
 	int i, len;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (false);
 	}
-	if (! params.isArray (paramName)) {
+	if (! params->isArray (paramName)) {
 		return (false);
 	}
 
 	if (shouldClear) {
 		destList->clear ();
 	}
-	len = params.getArrayLength (paramName);
+	len = params->getArrayLength (paramName);
 	for (i = 0; i < len; ++i) {
-		destList->push_back (params.getArrayNumber (paramName, i, (int) 0));
+		destList->push_back (params->getArrayNumber (paramName, i, (int) 0));
 	}
 	return (true);
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<int> *destList, bool shouldClear) {
-	return (getCommandNumberArrayParam (command, StdString (paramName), destList, shouldClear));
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<int64_t> *destList, bool shouldClear) {
+	return (getCommandNumberArrayParam (command, paramName.c_str (), destList, shouldClear));
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<int64_t> *destList, bool shouldClear) {
-	Json params;
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<int64_t> *destList, bool shouldClear) {
+	Json *params;
 	int i, len;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (false);
 	}
-	if (! params.isArray (paramName)) {
+	if (! params->isArray (paramName)) {
 		return (false);
 	}
 
 	if (shouldClear) {
 		destList->clear ();
 	}
-	len = params.getArrayLength (paramName);
+	len = params->getArrayLength (paramName);
 	for (i = 0; i < len; ++i) {
-		destList->push_back (params.getArrayNumber (paramName, i, (int64_t) 0));
+		destList->push_back (params->getArrayNumber (paramName, i, (int64_t) 0));
 	}
 	return (true);
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<int64_t> *destList, bool shouldClear) {
-	return (getCommandNumberArrayParam (command, StdString (paramName), destList, shouldClear));
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<double> *destList, bool shouldClear) {
+	return (getCommandNumberArrayParam (command, paramName.c_str (), destList, shouldClear));
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<double> *destList, bool shouldClear) {
-	Json params;
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<double> *destList, bool shouldClear) {
+	Json *params;
 	int i, len;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (false);
 	}
-	if (! params.isArray (paramName)) {
+	if (! params->isArray (paramName)) {
 		return (false);
 	}
 
 	if (shouldClear) {
 		destList->clear ();
 	}
-	len = params.getArrayLength (paramName);
+	len = params->getArrayLength (paramName);
 	for (i = 0; i < len; ++i) {
-		destList->push_back (params.getArrayNumber (paramName, i, (double) 0.0f));
+		destList->push_back (params->getArrayNumber (paramName, i, (double) 0.0f));
 	}
 	return (true);
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<double> *destList, bool shouldClear) {
-	return (getCommandNumberArrayParam (command, StdString (paramName), destList, shouldClear));
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<float> *destList, bool shouldClear) {
+	return (getCommandNumberArrayParam (command, paramName.c_str (), destList, shouldClear));
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const StdString &paramName, std::vector<float> *destList, bool shouldClear) {
-	Json params;
+bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<float> *destList, bool shouldClear) {
+	Json *params;
 	int i, len;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (false);
 	}
-	if (! params.isArray (paramName)) {
+	if (! params->isArray (paramName)) {
 		return (false);
 	}
 
 	if (shouldClear) {
 		destList->clear ();
 	}
-	len = params.getArrayLength (paramName);
+	len = params->getArrayLength (paramName);
 	for (i = 0; i < len; ++i) {
-		destList->push_back (params.getArrayNumber (paramName, i, (float) 0.0f));
+		destList->push_back (params->getArrayNumber (paramName, i, (float) 0.0f));
 	}
 	return (true);
 }
 
-bool SystemInterface::getCommandNumberArrayParam (Json *command, const char *paramName, std::vector<float> *destList, bool shouldClear) {
-	return (getCommandNumberArrayParam (command, StdString (paramName), destList, shouldClear));
+int SystemInterface::getCommandArrayLength (Json *command, const StdString &paramName) {
+	return (getCommandArrayLength (command, paramName.c_str ()));
 }
 
-int SystemInterface::getCommandArrayLength (Json *command, const StdString &paramName) {
-	Json params;
+int SystemInterface::getCommandArrayLength (Json *command, const char *paramName) {
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (0);
 	}
-	return (params.getArrayLength (paramName));
-}
-
-int SystemInterface::getCommandArrayLength (Json *command, const char *paramName) {
-	return (getCommandArrayLength (command, StdString (paramName)));
+	return (params->getArrayLength (paramName));
 }
 
 int SystemInterface::getCommandNumberArrayItem (Json *command, const StdString &paramName, int index, int defaultValue) {
-	Json params;
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (0);
 	}
-	return (params.getArrayNumber (paramName, index, defaultValue));
+	return (params->getArrayNumber (paramName, index, defaultValue));
 }
 
 int64_t SystemInterface::getCommandNumberArrayItem (Json *command, const StdString &paramName, int index, int64_t defaultValue) {
-	Json params;
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (0);
 	}
-	return (params.getArrayNumber (paramName, index, defaultValue));
+	return (params->getArrayNumber (paramName, index, defaultValue));
 }
 
 double SystemInterface::getCommandNumberArrayItem (Json *command, const StdString &paramName, int index, double defaultValue) {
-	Json params;
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (0);
 	}
-	return (params.getArrayNumber (paramName, index, defaultValue));
+	return (params->getArrayNumber (paramName, index, defaultValue));
 }
 
 float SystemInterface::getCommandNumberArrayItem (Json *command, const StdString &paramName, int index, float defaultValue) {
-	Json params;
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (0);
 	}
-	return (params.getArrayNumber (paramName, index, defaultValue));
+	return (params->getArrayNumber (paramName, index, defaultValue));
 }
 
 StdString SystemInterface::getCommandStringArrayItem (Json *command, const StdString &paramName, int index, const StdString &defaultValue) {
-	Json params;
+	Json *params;
 
-	if (! command->getObject ("params", &params)) {
+	params = command->getObjectView ("params");
+	if (! params) {
 		return (0);
 	}
-	return (params.getArrayString (paramName, index, defaultValue));
+	return (params->getArrayString (paramName, index, defaultValue));
 }
 
 StdString SystemInterface::getCommandStringArrayItem (Json *command, const char *paramName, int index, const StdString &defaultValue) {
@@ -998,14 +1315,15 @@ StdString SystemInterface::getCommandStringArrayItem (Json *command, const char
 }
 
 bool SystemInterface::getCommandObjectArrayItem (Json *command, const StdString &paramName, int index, Json *destJson) {
-	Json params;
-
-	if (! command->getObject ("params", &params)) {
-		return (0);
-	}
-	return (params.getArrayObject (paramName, index, destJson));
+	return (getCommandObjectArrayItem (command, paramName.c_str (), index, destJson));
 }
 
 bool SystemInterface::getCommandObjectArrayItem (Json *command, const char *paramName, int index, Json *destJson) {
-	return (getCommandObjectArrayItem (command, StdString (paramName), index, destJson));
+	Json *params;
+
+	params = command->getObjectView ("params");
+	if (! params) {
+		return (0);
+	}
+	return (params->getArrayObject (paramName, index, destJson));
 }
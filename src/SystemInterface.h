@@ -43,6 +43,7 @@ public:
   static const char *Command_ClearCache;
   static const char *Command_CommandResult;
   static const char *Command_EndSet;
+  static const char *Command_ExecuteBatch;
   static const char *Command_GetStatus;
   static const char *Command_PlayAnimation;
   static const char *Command_RemoveWindow;
@@ -51,9 +52,13 @@ public:
   static const char *Command_ShowFileImageBackground;
   static const char *Command_ShowIconLabelWindow;
   static const char *Command_ShowResourceImageBackground;
+  static const char *Command_StartAnimation;
+  static const char *Command_StopAnimation;
+  static const char *Command_StoreAnimation;
   static const int CommandId_ClearCache = 59;
   static const int CommandId_CommandResult = 0;
   static const int CommandId_EndSet = 21;
+  static const int CommandId_ExecuteBatch = 220;
   static const int CommandId_GetStatus = 8;
   static const int CommandId_PlayAnimation = 215;
   static const int CommandId_RemoveWindow = 217;
@@ -62,6 +67,9 @@ public:
   static const int CommandId_ShowFileImageBackground = 106;
   static const int CommandId_ShowIconLabelWindow = 216;
   static const int CommandId_ShowResourceImageBackground = 81;
+  static const int CommandId_StartAnimation = 222;
+  static const int CommandId_StopAnimation = 223;
+  static const int CommandId_StoreAnimation = 221;
   static const int ParamFlag_Required = 1;
   static const int ParamFlag_NotEmpty = 2;
   static const int ParamFlag_Hostname = 4;
@@ -165,8 +173,23 @@ public:
 	// Return a boolean value indicating if the provided fields are valid according to rules appearing in a Param list. If the fields are found to be invalid, this method sets the lastError value.
 	bool fieldsValid (Json *fields, std::list<SystemInterface::Param> *paramList);
 
-	// Parse a command JSON string and store the resulting Json object using the provided pointer. Returns a boolean value indicating if the parse was successful. If the parse fails, this method sets the lastError value.
-	bool parseCommand (const StdString &commandString, Json **commandJson);
+	// Return a boolean value indicating if the provided object holds a known command ID and a params object with fields that are valid for its type, after applying default values for any missing fields. If the command is found to be invalid, this method sets the lastError value.
+	bool commandValid (Json *command);
+
+	// Return a boolean value indicating if the provided string contains a hostname, optionally followed by a port number
+	static bool isHostname (const char *str, int length);
+
+	// Return a boolean value indicating if the provided string contains a UUID in hyphenated hex digit form
+	static bool isUuid (const char *str, int length);
+
+	// Return a boolean value indicating if the provided string contains only characters that are valid in a URL
+	static bool isUrl (const char *str, int length);
+
+	// Parse a command JSON string and store the resulting Json object using the provided pointer. Returns a boolean value indicating if the parse was successful. If the parse fails and errorMessage is provided, store a description of the failure in that string. This method does not modify lastError and may be invoked from any thread.
+	bool parseCommand (const StdString &commandString, Json **commandJson, StdString *errorMessage = NULL);
+
+	// Parse a command MessagePack record and store the resulting Json object using the provided pointer. Returns a boolean value indicating if the parse was successful. If the parse fails and errorMessage is provided, store a description of the failure in that string. This method does not modify lastError and may be invoked from any thread.
+	bool parseMsgPackCommand (const uint8_t *commandData, int commandDataLength, Json **commandJson, StdString *errorMessage = NULL);
 
 	// Return the command ID value appearing in the provided command object, or -1 if no such ID was found
 	int getCommandId (Json *command);
@@ -240,8 +263,10 @@ public:
 	bool getCommandObjectArrayItem (Json *command, const char *paramName, int index, Json *destJson);
 
   static void getParams_AnimationCommand (std::list<SystemInterface::Param> *destList);
+  static void getParams_AnimationOverride (std::list<SystemInterface::Param> *destList);
   static void getParams_CommandResult (std::list<SystemInterface::Param> *destList);
   static void getParams_EmptyObject (std::list<SystemInterface::Param> *destList);
+  static void getParams_ExecuteBatch (std::list<SystemInterface::Param> *destList);
   static void getParams_PlayAnimation (std::list<SystemInterface::Param> *destList);
   static void getParams_RemoveWindow (std::list<SystemInterface::Param> *destList);
   static void getParams_ShowColorFillBackground (std::list<SystemInterface::Param> *destList);
@@ -249,9 +274,13 @@ public:
   static void getParams_ShowFileImageBackground (std::list<SystemInterface::Param> *destList);
   static void getParams_ShowIconLabelWindow (std::list<SystemInterface::Param> *destList);
   static void getParams_ShowResourceImageBackground (std::list<SystemInterface::Param> *destList);
+  static void getParams_StartAnimation (std::list<SystemInterface::Param> *destList);
+  static void getParams_StoreAnimation (std::list<SystemInterface::Param> *destList);
   static void populateDefaultFields_AnimationCommand (Json *destObject);
+  static void populateDefaultFields_AnimationOverride (Json *destObject);
   static void populateDefaultFields_CommandResult (Json *destObject);
   static void populateDefaultFields_EmptyObject (Json *destObject);
+  static void populateDefaultFields_ExecuteBatch (Json *destObject);
   static void populateDefaultFields_PlayAnimation (Json *destObject);
   static void populateDefaultFields_RemoveWindow (Json *destObject);
   static void populateDefaultFields_ShowColorFillBackground (Json *destObject);
@@ -259,9 +288,13 @@ public:
   static void populateDefaultFields_ShowFileImageBackground (Json *destObject);
   static void populateDefaultFields_ShowIconLabelWindow (Json *destObject);
   static void populateDefaultFields_ShowResourceImageBackground (Json *destObject);
+  static void populateDefaultFields_StartAnimation (Json *destObject);
+  static void populateDefaultFields_StoreAnimation (Json *destObject);
   static void hashFields_AnimationCommand (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
+  static void hashFields_AnimationOverride (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_CommandResult (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_EmptyObject (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
+  static void hashFields_ExecuteBatch (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_PlayAnimation (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_RemoveWindow (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_ShowColorFillBackground (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
@@ -269,5 +302,7 @@ public:
   static void hashFields_ShowFileImageBackground (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_ShowIconLabelWindow (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
   static void hashFields_ShowResourceImageBackground (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
+  static void hashFields_StartAnimation (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
+  static void hashFields_StoreAnimation (Json *commandParams, SystemInterface::HashUpdateFunction hashUpdateFn, void *hashContextPtr);
 };
 #endif
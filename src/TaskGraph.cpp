@@ -0,0 +1,208 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "WakeEvent.h"
+#include "TaskGroup.h"
+#include "TaskGraph.h"
+
+TaskGraph::TaskGraph ()
+: state (NULL)
+, isRun (false)
+{
+	state = new TaskGraph::State ();
+	state->mutex = SDL_CreateMutex ();
+}
+
+TaskGraph::~TaskGraph () {
+	TaskGraph::releaseState (state);
+	state = NULL;
+}
+
+void TaskGraph::releaseState (TaskGraph::State *state) {
+	if (state->refcount.fetch_sub (1) > 1) {
+		return;
+	}
+	if (state->mutex) {
+		SDL_DestroyMutex (state->mutex);
+		state->mutex = NULL;
+	}
+	delete (state);
+}
+
+int TaskGraph::addTask (TaskGroup::RunFunction fn, void *fnData, bool isCallerTask) {
+	TaskGraph::Node node;
+
+	node.fn = fn;
+	node.fnData = fnData;
+	node.isCallerTask = isCallerTask;
+	state->nodes.push_back (node);
+	return ((int) state->nodes.size () - 1);
+}
+
+void TaskGraph::addDependency (int nodeId, int dependencyNodeId) {
+	int count;
+
+	count = (int) state->nodes.size ();
+	if ((nodeId < 0) || (nodeId >= count) || (dependencyNodeId < 0) || (dependencyNodeId >= count) || (nodeId == dependencyNodeId)) {
+		return;
+	}
+	state->nodes.at (dependencyNodeId).nextNodes.push_back (nodeId);
+	++(state->nodes.at (nodeId).waitCount);
+}
+
+void TaskGraph::run () {
+	int i, count, nodeid, workercount;
+	bool complete;
+
+	if (isRun) {
+		return;
+	}
+	isRun = true;
+	count = (int) state->nodes.size ();
+	workercount = 0;
+	SDL_LockMutex (state->mutex);
+	for (i = 0; i < count; ++i) {
+		if (state->nodes.at (i).waitCount <= 0) {
+			if (state->nodes.at (i).isCallerTask) {
+				state->callerReadyList.push_back (i);
+			}
+			else {
+				state->readyList.push_back (i);
+				++workercount;
+			}
+		}
+	}
+	SDL_UnlockMutex (state->mutex);
+
+	// The calling thread takes one ready node itself, so workers are only needed for the rest
+	for (i = 1; i < workercount; ++i) {
+		TaskGraph::addWorkerTask (state);
+	}
+
+	while (true) {
+		SDL_LockMutex (state->mutex);
+		complete = (state->completeCount >= count);
+		nodeid = -1;
+		if (! complete) {
+			nodeid = TaskGraph::takeReadyNode (state, true);
+		}
+		SDL_UnlockMutex (state->mutex);
+		if (complete) {
+			break;
+		}
+		if (nodeid >= 0) {
+			TaskGraph::executeNode (state, nodeid);
+		}
+		else {
+			state->wakeEvent.wait (0);
+		}
+	}
+}
+
+int TaskGraph::takeReadyNode (TaskGraph::State *state, bool isCallerThread) {
+	int nodeid;
+
+	nodeid = -1;
+	if (isCallerThread && (! state->callerReadyList.empty ())) {
+		nodeid = state->callerReadyList.front ();
+		state->callerReadyList.pop_front ();
+	}
+	else if (! state->readyList.empty ()) {
+		nodeid = state->readyList.front ();
+		state->readyList.pop_front ();
+	}
+	return (nodeid);
+}
+
+void TaskGraph::executeNode (TaskGraph::State *state, int nodeId) {
+	TaskGraph::Node *node;
+	std::vector<int>::iterator i, end;
+	int workercount;
+
+	node = &(state->nodes.at (nodeId));
+	node->fn (node->fnData);
+
+	workercount = 0;
+	SDL_LockMutex (state->mutex);
+	i = node->nextNodes.begin ();
+	end = node->nextNodes.end ();
+	while (i != end) {
+		if (--(state->nodes.at (*i).waitCount) <= 0) {
+			if (state->nodes.at (*i).isCallerTask) {
+				state->callerReadyList.push_back (*i);
+			}
+			else {
+				state->readyList.push_back (*i);
+				++workercount;
+			}
+		}
+		++i;
+	}
+	++(state->completeCount);
+	SDL_UnlockMutex (state->mutex);
+
+	while (workercount > 0) {
+		TaskGraph::addWorkerTask (state);
+		--workercount;
+	}
+	state->wakeEvent.signal ();
+}
+
+void TaskGraph::addWorkerTask (TaskGraph::State *state) {
+	if (! TaskGroup::instance) {
+		return;
+	}
+	++(state->refcount);
+	if (! TaskGroup::instance->run (TaskGroup::RunContext (TaskGraph::runWorkerNodes, state, TaskGroup::HighPriority))) {
+		--(state->refcount);
+	}
+}
+
+void TaskGraph::runWorkerNodes (void *statePtr) {
+	TaskGraph::State *state;
+	int nodeid;
+
+	state = (TaskGraph::State *) statePtr;
+	while (true) {
+		SDL_LockMutex (state->mutex);
+		nodeid = TaskGraph::takeReadyNode (state, false);
+		SDL_UnlockMutex (state->mutex);
+		if (nodeid < 0) {
+			break;
+		}
+		TaskGraph::executeNode (state, nodeid);
+	}
+	TaskGraph::releaseState (state);
+}
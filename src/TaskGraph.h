@@ -0,0 +1,102 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Class that runs a set of tasks in the order required by dependencies between them
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "SDL2/SDL.h"
+#include "WakeEvent.h"
+#include "TaskGroup.h"
+
+class TaskGraph {
+public:
+	TaskGraph ();
+	~TaskGraph ();
+
+	// Add a task that invokes fn with fnData and return its node ID. If isCallerTask is true, the task always executes on the thread that invokes run, as required for operations such as texture creation.
+	int addTask (TaskGroup::RunFunction fn, void *fnData, bool isCallerTask = false);
+
+	// Prevent the task with ID nodeId from starting until the task with ID dependencyNodeId has completed
+	void addDependency (int nodeId, int dependencyNodeId);
+
+	// Execute all added tasks and return after they have completed. Tasks with no dependency path between them may execute concurrently on TaskGroup worker threads and on the calling thread. A graph executes its tasks only once.
+	void run ();
+
+private:
+	struct Node {
+		TaskGroup::RunFunction fn;
+		void *fnData;
+		bool isCallerTask;
+		int waitCount;
+		std::vector<int> nextNodes;
+		Node ():
+			fn (NULL),
+			fnData (NULL),
+			isCallerTask (false),
+			waitCount (0) { }
+	};
+	struct State {
+		std::vector<TaskGraph::Node> nodes;
+		SDL_mutex *mutex;
+		std::deque<int> readyList;
+		std::deque<int> callerReadyList;
+		int completeCount;
+		std::atomic<int> refcount;
+		WakeEvent wakeEvent;
+		State ():
+			mutex (NULL),
+			completeCount (0),
+			refcount (1) { }
+	};
+
+	// Remove and return the ID of a ready node from state's ready lists, or -1 if no node is ready. Caller must hold state's mutex.
+	static int takeReadyNode (TaskGraph::State *state, bool isCallerThread);
+
+	// Execute the node with ID nodeId and release nodes waiting on it
+	static void executeNode (TaskGraph::State *state, int nodeId);
+
+	// Add a task that executes ready nodes on a worker thread
+	static void addWorkerTask (TaskGraph::State *state);
+
+	// Decrease state's refcount and delete it if no references remain
+	static void releaseState (TaskGraph::State *state);
+
+	// Task functions
+	static void runWorkerNodes (void *statePtr);
+
+	TaskGraph::State *state;
+	bool isRun;
+};
+
+#endif
@@ -29,99 +29,418 @@
 */
 #include "Config.h"
 #include <stdlib.h>
-#include <list>
+#include <atomic>
+#include <deque>
+#include <vector>
 #include "SDL2/SDL.h"
 #include "StdString.h"
+#include "Log.h"
+#include "WakeEvent.h"
 #include "TaskGroup.h"
 
 TaskGroup *TaskGroup::instance = NULL;
+const int TaskGroup::MinWorkerCount = 2;
+thread_local int TaskGroup::currentWorkerIndex = -1;
 
 TaskGroup::TaskGroup ()
-: isStopped (false)
-, contextListMutex (NULL)
+: wakeEvent (NULL)
+, isStopped (false)
+, workerCount (0)
+, workerMutex (NULL)
+, isWorkerStarted (false)
+, isExiting (false)
+, queuedTaskCount (0)
+, activeTaskCount (0)
+, idleWorkerCount (0)
+, nextWorkerIndex (0)
+, idleMutex (NULL)
+, idleCond (NULL)
+, completionMutex (NULL)
 {
-	contextListMutex = SDL_CreateMutex ();
+	workerMutex = SDL_CreateMutex ();
+	idleMutex = SDL_CreateMutex ();
+	idleCond = SDL_CreateCond ();
+	completionMutex = SDL_CreateMutex ();
 }
 
 TaskGroup::~TaskGroup () {
-	if (contextListMutex) {
-		SDL_DestroyMutex (contextListMutex);
-		contextListMutex = NULL;
+	std::vector<TaskGroup::Worker *>::iterator i, end;
+	std::vector<TaskGroup::TaskContext *>::iterator j, jend;
+	std::deque<TaskGroup::TaskContext *>::iterator k, kend;
+	int priority;
+
+	waitThreads ();
+	i = workerList.begin ();
+	end = workerList.end ();
+	while (i != end) {
+		for (priority = 0; priority < TaskGroup::PriorityCount; ++priority) {
+			k = (*i)->queues[priority].begin ();
+			kend = (*i)->queues[priority].end ();
+			while (k != kend) {
+				TaskGroup::freeTask (*k);
+				++k;
+			}
+		}
+		delete (*i);
+		++i;
+	}
+	workerList.clear ();
+
+	j = completionList.begin ();
+	jend = completionList.end ();
+	while (j != jend) {
+		TaskGroup::freeTask (*j);
+		++j;
+	}
+	completionList.clear ();
+
+	if (workerMutex) {
+		SDL_DestroyMutex (workerMutex);
+		workerMutex = NULL;
+	}
+	if (idleMutex) {
+		SDL_DestroyMutex (idleMutex);
+		idleMutex = NULL;
+	}
+	if (idleCond) {
+		SDL_DestroyCond (idleCond);
+		idleCond = NULL;
+	}
+	if (completionMutex) {
+		SDL_DestroyMutex (completionMutex);
+		completionMutex = NULL;
+	}
+}
+
+TaskGroup::CancelToken::CancelToken ()
+: refcount (0)
+, isCancelRequested (false)
+{
+
+}
+
+void TaskGroup::CancelToken::retain () {
+	refcount.fetch_add (1, std::memory_order_relaxed);
+}
+
+void TaskGroup::CancelToken::release () {
+	if (refcount.fetch_sub (1, std::memory_order_acq_rel) <= 1) {
+		delete (this);
+	}
+}
+
+void TaskGroup::CancelToken::cancel () {
+	isCancelRequested.store (true, std::memory_order_release);
+}
+
+bool TaskGroup::CancelToken::isCancelled () {
+	return (isCancelRequested.load (std::memory_order_acquire));
+}
+
+bool TaskGroup::startWorkers () {
+	TaskGroup::Worker *worker;
+	int i, count;
+	bool result;
+
+	SDL_LockMutex (workerMutex);
+	if (isWorkerStarted.load () || isExiting) {
+		result = isWorkerStarted.load ();
+		SDL_UnlockMutex (workerMutex);
+		return (result);
 	}
+	count = SDL_GetCPUCount ();
+	if (count < TaskGroup::MinWorkerCount) {
+		count = TaskGroup::MinWorkerCount;
+	}
+	for (i = 0; i < count; ++i) {
+		worker = new TaskGroup::Worker ();
+		worker->group = this;
+		worker->index = i;
+		workerList.push_back (worker);
+	}
+	workerCount = count;
+
+	// Workers read workerList as they steal tasks, so the list must be complete before any worker starts
+	result = false;
+	for (i = 0; i < count; ++i) {
+		worker = workerList.at (i);
+		worker->thread = SDL_CreateThread (TaskGroup::runWorker, StdString::createSprintf ("TaskGroup::runWorker_%i", i).c_str (), (void *) worker);
+		if (! worker->thread) {
+			Log::err ("Failed to create task worker thread; err=\"%s\"", SDL_GetError ());
+		}
+		else {
+			result = true;
+		}
+	}
+	if (result) {
+		isWorkerStarted.store (true);
+	}
+	else {
+		// With no worker threads, queued tasks would never execute
+		isExiting = true;
+	}
+	SDL_UnlockMutex (workerMutex);
+
+	return (result);
 }
 
 bool TaskGroup::run (TaskGroup::RunContext fn, TaskGroup::EndCallbackContext endCallback) {
-	TaskGroup::TaskContext ctx;
+	TaskGroup::TaskContext *task;
+	TaskGroup::Worker *worker;
+	int index;
 
-	if (isStopped) {
+	if (isStopped || (! fn.fn)) {
+		return (false);
+	}
+	if ((! isWorkerStarted.load ()) && (! startWorkers ())) {
 		return (false);
 	}
-	ctx.fn = fn;
-	ctx.endCallback = endCallback;
+	task = new TaskGroup::TaskContext ();
+	task->fn = fn;
+	task->endCallback = endCallback;
+	if (task->fn.priority < 0) {
+		task->fn.priority = 0;
+	}
+	else if (task->fn.priority >= TaskGroup::PriorityCount) {
+		task->fn.priority = TaskGroup::PriorityCount - 1;
+	}
+	if (task->fn.cancelToken) {
+		task->fn.cancelToken->retain ();
+	}
 
-	SDL_LockMutex (contextListMutex);
-	contextList.push_back (ctx);
-	SDL_UnlockMutex (contextListMutex);
+	// A task added by a worker goes to that worker's own queues, where idle workers can steal it; other tasks are distributed round-robin
+	index = currentWorkerIndex;
+	if ((index < 0) || (index >= workerCount)) {
+		index = (int) (nextWorkerIndex.fetch_add (1, std::memory_order_relaxed) % (unsigned int) workerCount);
+	}
+	worker = workerList.at (index);
+	++activeTaskCount;
+	SDL_AtomicLock (&(worker->queueLock));
+	worker->queues[task->fn.priority].push_back (task);
+	SDL_AtomicUnlock (&(worker->queueLock));
+	++queuedTaskCount;
 
+	if (idleWorkerCount.load () > 0) {
+		SDL_LockMutex (idleMutex);
+		SDL_CondSignal (idleCond);
+		SDL_UnlockMutex (idleMutex);
+	}
+	if (wakeEvent) {
+		wakeEvent->signal ();
+	}
 	return (true);
 }
 
-int TaskGroup::executeTask (void *taskContextPtr) {
-	TaskGroup::TaskContext *ctx;
+int TaskGroup::runWorker (void *workerPtr) {
+	TaskGroup::Worker *worker;
+	TaskGroup *group;
+	TaskGroup::TaskContext *task;
 
-	ctx = (TaskGroup::TaskContext *) taskContextPtr;
-	ctx->fn.fn (ctx->fn.fnData);
-	ctx->isRunning = false;
+	worker = (TaskGroup::Worker *) workerPtr;
+	group = worker->group;
+	currentWorkerIndex = worker->index;
+	while (true) {
+		task = group->takeTask (worker->index);
+		if (task) {
+			group->executeTask (task);
+			continue;
+		}
+
+		SDL_LockMutex (group->idleMutex);
+		// idleWorkerCount must be raised before checking queuedTaskCount, so that a task added after the check also finds this worker idle and signals it
+		++(group->idleWorkerCount);
+		while ((group->queuedTaskCount.load () <= 0) && (! group->isExiting)) {
+			SDL_CondWait (group->idleCond, group->idleMutex);
+		}
+		--(group->idleWorkerCount);
+		if (group->isExiting && (group->queuedTaskCount.load () <= 0)) {
+			SDL_UnlockMutex (group->idleMutex);
+			break;
+		}
+		SDL_UnlockMutex (group->idleMutex);
+	}
 
 	return (0);
 }
 
-void TaskGroup::update (int msElapsed) {
-	std::list<TaskGroup::TaskContext>::iterator i, end;
-	std::list<TaskGroup::TaskContext> cblist;
-	int result;
-	bool found;
+TaskGroup::TaskContext *TaskGroup::takeTask (int workerIndex) {
+	TaskGroup::Worker *worker;
+	TaskGroup::TaskContext *task;
+	int priority, i, count;
 
-	SDL_LockMutex (contextListMutex);
-	i = contextList.begin ();
-	end = contextList.end ();
-	while (i != end) {
-		if (! i->thread) {
-			i->isRunning = true;
-			i->thread = SDL_CreateThread (TaskGroup::executeTask, "TaskGroup::executeTask", (void *) &(*i));
-		}
-		++i;
+	if (queuedTaskCount.load () <= 0) {
+		return (NULL);
 	}
+	count = (int) workerList.size ();
+	task = NULL;
+	for (priority = TaskGroup::PriorityCount - 1; priority >= 0; --priority) {
+		// Take from the front of the worker's own queue to preserve submission order, and steal from the back of other queues
+		worker = workerList.at (workerIndex);
+		SDL_AtomicLock (&(worker->queueLock));
+		if (! worker->queues[priority].empty ()) {
+			task = worker->queues[priority].front ();
+			worker->queues[priority].pop_front ();
+		}
+		SDL_AtomicUnlock (&(worker->queueLock));
+		if (task) {
+			break;
+		}
 
-	while (true) {
-		found = false;
-		i = contextList.begin ();
-		end = contextList.end ();
-		while (i != end) {
-			if (i->thread && (! i->isRunning)) {
-				found = true;
-				SDL_WaitThread (i->thread, &result);
-				i->thread = NULL;
-				if (i->endCallback.callback) {
-					cblist.push_back (*i);
-				}
-				contextList.erase (i);
+		for (i = 1; i < count; ++i) {
+			worker = workerList.at ((workerIndex + i) % count);
+			SDL_AtomicLock (&(worker->queueLock));
+			if (! worker->queues[priority].empty ()) {
+				task = worker->queues[priority].back ();
+				worker->queues[priority].pop_back ();
+			}
+			SDL_AtomicUnlock (&(worker->queueLock));
+			if (task) {
 				break;
 			}
-			++i;
 		}
-		if (! found) {
+		if (task) {
+			break;
+		}
+	}
+	if (task) {
+		--queuedTaskCount;
+	}
+	return (task);
+}
+
+void TaskGroup::executeTask (TaskGroup::TaskContext *task) {
+	if (task->fn.cancelToken && task->fn.cancelToken->isCancelled ()) {
+		if (task->fn.cancelFn) {
+			task->fn.cancelFn (task->fn.fnData);
+		}
+	}
+	else {
+		task->fn.fn (task->fn.fnData);
+	}
+
+	if (task->endCallback.callback) {
+		SDL_LockMutex (completionMutex);
+		completionList.push_back (task);
+		SDL_UnlockMutex (completionMutex);
+	}
+	else {
+		TaskGroup::freeTask (task);
+		--activeTaskCount;
+	}
+	if (wakeEvent) {
+		wakeEvent->signal ();
+	}
+}
+
+void TaskGroup::freeTask (TaskGroup::TaskContext *task) {
+	if (task->fn.cancelToken) {
+		task->fn.cancelToken->release ();
+		task->fn.cancelToken = NULL;
+	}
+	delete (task);
+}
+
+void TaskGroup::parallelFor (int count, int grainSize, TaskGroup::RangeFunction fn, void *fnData) {
+	TaskGroup::ParallelForContext *ctx;
+	int i, helpercount;
+
+	if (count <= 0) {
+		return;
+	}
+	if (grainSize < 1) {
+		grainSize = 1;
+	}
+	if ((count <= grainSize) || isStopped || ((! isWorkerStarted.load ()) && (! startWorkers ()))) {
+		fn (fnData, 0, count);
+		return;
+	}
+
+	// The context is shared with helper tasks that may start after this call returns, and is freed by whichever holder releases it last
+	ctx = new TaskGroup::ParallelForContext ();
+	ctx->fn = fn;
+	ctx->fnData = fnData;
+	ctx->count = count;
+	ctx->grainSize = grainSize;
+	ctx->rangeCount = (count + grainSize - 1) / grainSize;
+	ctx->refcount = 1;
+	helpercount = ctx->rangeCount - 1;
+	if (helpercount > workerCount) {
+		helpercount = workerCount;
+	}
+	for (i = 0; i < helpercount; ++i) {
+		++(ctx->refcount);
+		if (! run (TaskGroup::RunContext (TaskGroup::runParallelForRanges, ctx, TaskGroup::HighPriority))) {
+			--(ctx->refcount);
 			break;
 		}
 	}
-	SDL_UnlockMutex (contextListMutex);
 
-	i = cblist.begin ();
-	end = cblist.end ();
+	if (! TaskGroup::executeRanges (ctx)) {
+		while (ctx->completeRangeCount.load () < ctx->rangeCount) {
+			ctx->completeEvent.wait (0);
+		}
+	}
+	if (ctx->refcount.fetch_sub (1) <= 1) {
+		delete (ctx);
+	}
+}
+
+bool TaskGroup::executeRanges (TaskGroup::ParallelForContext *ctx) {
+	int range, start, end;
+	bool result;
+
+	result = false;
+	while (true) {
+		range = ctx->nextRange.fetch_add (1);
+		if (range >= ctx->rangeCount) {
+			break;
+		}
+		start = range * ctx->grainSize;
+		end = start + ctx->grainSize;
+		if (end > ctx->count) {
+			end = ctx->count;
+		}
+		ctx->fn (ctx->fnData, start, end);
+		if ((ctx->completeRangeCount.fetch_add (1) + 1) >= ctx->rangeCount) {
+			result = true;
+		}
+	}
+	return (result);
+}
+
+void TaskGroup::runParallelForRanges (void *contextPtr) {
+	TaskGroup::ParallelForContext *ctx;
+
+	ctx = (TaskGroup::ParallelForContext *) contextPtr;
+	if (TaskGroup::executeRanges (ctx)) {
+		ctx->completeEvent.signal ();
+	}
+	if (ctx->refcount.fetch_sub (1) <= 1) {
+		delete (ctx);
+	}
+}
+
+void TaskGroup::update (int msElapsed) {
+	std::vector<TaskGroup::TaskContext *>::iterator i, end;
+	TaskGroup::TaskContext *task;
+
+	SDL_LockMutex (completionMutex);
+	completionUpdateList.swap (completionList);
+	SDL_UnlockMutex (completionMutex);
+	if (completionUpdateList.empty ()) {
+		return;
+	}
+
+	i = completionUpdateList.begin ();
+	end = completionUpdateList.end ();
 	while (i != end) {
-		i->endCallback.callback (i->endCallback.callbackData, i->fn.fnData);
+		task = *i;
+		task->endCallback.callback (task->endCallback.callbackData, task->fn.fnData);
+		TaskGroup::freeTask (task);
+		--activeTaskCount;
 		++i;
 	}
+	completionUpdateList.clear ();
 }
 
 void TaskGroup::stop () {
@@ -129,32 +448,30 @@ void TaskGroup::stop () {
 }
 
 bool TaskGroup::isStopComplete () {
-	bool result;
-
 	if (! isStopped) {
 		return (false);
 	}
-	SDL_LockMutex (contextListMutex);
-	result = contextList.empty ();
-	SDL_UnlockMutex (contextListMutex);
-
-	return (result);
+	return (activeTaskCount.load () <= 0);
 }
 
 void TaskGroup::waitThreads () {
-	std::list<TaskGroup::TaskContext>::iterator i, end;
+	std::vector<TaskGroup::Worker *>::iterator i, end;
 	int result;
 
-	SDL_LockMutex (contextListMutex);
-	i = contextList.begin ();
-	end = contextList.end ();
+	SDL_LockMutex (workerMutex);
+	SDL_LockMutex (idleMutex);
+	isExiting = true;
+	SDL_CondBroadcast (idleCond);
+	SDL_UnlockMutex (idleMutex);
+
+	i = workerList.begin ();
+	end = workerList.end ();
 	while (i != end) {
-		if (i->thread) {
-			SDL_WaitThread (i->thread, &result);
-			i->thread = NULL;
+		if ((*i)->thread) {
+			SDL_WaitThread ((*i)->thread, &result);
+			(*i)->thread = NULL;
 		}
 		++i;
 	}
-	contextList.clear ();
-	SDL_UnlockMutex (contextListMutex);
+	SDL_UnlockMutex (workerMutex);
 }
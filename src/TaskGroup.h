@@ -27,13 +27,16 @@
 * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 * POSSIBILITY OF SUCH DAMAGE.
 */
-// Class that runs tasks in background threads
+// Class that runs tasks on a fixed pool of worker threads
 
 #ifndef TASK_GROUP_H
 #define TASK_GROUP_H
 
-#include <list>
+#include <atomic>
+#include <deque>
+#include <vector>
 #include "SDL2/SDL.h"
+#include "WakeEvent.h"
 
 class TaskGroup {
 public:
@@ -41,19 +44,65 @@ public:
 	~TaskGroup ();
 	static TaskGroup *instance;
 
+	// Task priority values. Workers take queued tasks of a higher priority before any task of a lower priority.
+	static const int LowPriority = 0;
+	static const int NormalPriority = 1;
+	static const int HighPriority = 2;
+	static const int PriorityCount = 3;
+
+	// The minimum number of worker threads, allowing short tasks to proceed while a long-running task such as a Lua script holds a worker
+	static const int MinWorkerCount;
+
+	// Read-write data members
+	WakeEvent *wakeEvent; // If set, signaled when a task is added or a running task ends
+
 	// Read-only data members
 	bool isStopped;
+	int workerCount;
 
 	typedef void (*RunFunction) (void *runPtr);
+	typedef void (*RangeFunction) (void *fnData, int rangeStart, int rangeEnd);
+
+	// Object that requests cancellation of the tasks it is attached to. A task whose token is cancelled before the task starts executes its cancel function in place of its run function, while a task already running may poll isCancelled to end early.
+	class CancelToken {
+	public:
+		CancelToken ();
+
+		// Increase the object's refcount
+		void retain ();
+
+		// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
+		void release ();
+
+		// Request cancellation of all tasks attached to the token
+		void cancel ();
+
+		// Return a boolean value indicating if cancel has been invoked
+		bool isCancelled ();
+
+	private:
+		std::atomic<int> refcount;
+		std::atomic<bool> isCancelRequested;
+	};
+
 	struct RunContext {
 		TaskGroup::RunFunction fn;
 		void *fnData;
+		int priority;
+		TaskGroup::CancelToken *cancelToken;
+		TaskGroup::RunFunction cancelFn; // If set, invoked with fnData in place of fn when cancelToken is cancelled before the task starts
 		RunContext ():
 			fn (NULL),
-			fnData (NULL) { }
-		RunContext (TaskGroup::RunFunction fn, void *fnData):
+			fnData (NULL),
+			priority (TaskGroup::NormalPriority),
+			cancelToken (NULL),
+			cancelFn (NULL) { }
+		RunContext (TaskGroup::RunFunction fn, void *fnData, int priority = TaskGroup::NormalPriority):
 			fn (fn),
-			fnData (fnData) { }
+			fnData (fnData),
+			priority (priority),
+			cancelToken (NULL),
+			cancelFn (NULL) { }
 	};
 	typedef void (*EndCallback) (void *callbackData, void *runPtr);
 	struct EndCallbackContext {
@@ -67,10 +116,13 @@ public:
 			callbackData (callbackData) { }
 	};
 
-	// Add fn as a run task and invoke endCallback when complete. Returns a boolean value indicating if the task was successfully queued.
+	// Add fn as a run task and invoke endCallback from the update method after the task completes or is cancelled. Returns a boolean value indicating if the task was successfully queued.
 	bool run (TaskGroup::RunContext fn, TaskGroup::EndCallbackContext endCallback = TaskGroup::EndCallbackContext ());
 
-	// Update state as appropriate for an elapsed millisecond time period
+	// Invoke fn for consecutive index ranges of at most grainSize indexes, together covering indexes from zero to count - 1, and return after all ranges have completed. Ranges execute on worker threads and on the calling thread, allowing the method to be invoked from a running task.
+	void parallelFor (int count, int grainSize, TaskGroup::RangeFunction fn, void *fnData);
+
+	// Invoke end callbacks for tasks completed since the last update. This method must be invoked from a single thread, normally the application's update thread.
 	void update (int msElapsed);
 
 	// Stop the task group and prevent further tasks from being started
@@ -79,27 +131,85 @@ public:
 	// Return a boolean value indicating if the task group has been stopped and holds no active tasks
 	bool isStopComplete ();
 
-	// Join any running task threads, blocking until the operation completes
+	// Stop and join all worker threads, blocking until queued tasks have completed
 	void waitThreads ();
 
 private:
-	// Run a thread that executes a task
-	static int executeTask (void *taskContextPtr);
-
 	struct TaskContext {
 		TaskGroup::RunContext fn;
 		TaskGroup::EndCallbackContext endCallback;
-		SDL_Thread *thread;
-		bool isRunning;
 		TaskContext ():
 			fn (),
-			endCallback (),
+			endCallback () { }
+	};
+	struct ParallelForContext {
+		TaskGroup::RangeFunction fn;
+		void *fnData;
+		int count;
+		int grainSize;
+		int rangeCount;
+		std::atomic<int> nextRange;
+		std::atomic<int> completeRangeCount;
+		std::atomic<int> refcount;
+		WakeEvent completeEvent;
+		ParallelForContext ():
+			fn (NULL),
+			fnData (NULL),
+			count (0),
+			grainSize (1),
+			rangeCount (0),
+			nextRange (0),
+			completeRangeCount (0),
+			refcount (0) { }
+	};
+	struct Worker {
+		TaskGroup *group;
+		int index;
+		SDL_Thread *thread;
+		SDL_SpinLock queueLock;
+		std::deque<TaskGroup::TaskContext *> queues[TaskGroup::PriorityCount];
+		Worker ():
+			group (NULL),
+			index (0),
 			thread (NULL),
-			isRunning (false) { }
+			queueLock (0) { }
 	};
 
-	std::list<TaskGroup::TaskContext> contextList;
-	SDL_mutex *contextListMutex;
+	// Create worker threads if not already running. Returns a boolean value indicating if the operation succeeded.
+	bool startWorkers ();
+
+	// Run a worker thread that executes queued tasks
+	static int runWorker (void *workerPtr);
+
+	// Remove and return the next task for the specified worker, taken from its own queues or stolen from another worker, or NULL if no task is queued
+	TaskGroup::TaskContext *takeTask (int workerIndex);
+
+	// Execute a task and queue its end callback, then free the task
+	void executeTask (TaskGroup::TaskContext *task);
+
+	// Free a task and release its cancel token
+	static void freeTask (TaskGroup::TaskContext *task);
+
+	// Execute ranges from a parallelFor context until none remain, and return a boolean value indicating if this call completed the final range
+	static bool executeRanges (TaskGroup::ParallelForContext *ctx);
+
+	// Task functions
+	static void runParallelForRanges (void *contextPtr);
+
+	static thread_local int currentWorkerIndex;
+	std::vector<TaskGroup::Worker *> workerList;
+	SDL_mutex *workerMutex;
+	std::atomic<bool> isWorkerStarted;
+	bool isExiting;
+	std::atomic<int> queuedTaskCount;
+	std::atomic<int> activeTaskCount; // Tasks queued or running, plus completions not yet delivered by update
+	std::atomic<int> idleWorkerCount;
+	std::atomic<unsigned int> nextWorkerIndex;
+	SDL_mutex *idleMutex;
+	SDL_cond *idleCond;
+	SDL_mutex *completionMutex;
+	std::vector<TaskGroup::TaskContext *> completionList;
+	std::vector<TaskGroup::TaskContext *> completionUpdateList;
 };
 
 #endif
@@ -0,0 +1,94 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Template for passing the latest of a series of values from a single producer thread to a single consumer thread without locking
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+template<class T> class TripleBuffer {
+public:
+	TripleBuffer<T> (): writeIndex (0), readIndex (1), middleIndex (2) { }
+	~TripleBuffer<T> () { }
+
+	// Return a pointer to the item owned by the producer, to be filled before a call to publish. Must be invoked only from the producer thread.
+	T *getWriteItem () {
+		return (&(items[writeIndex]));
+	}
+
+	// Make the write item available to the consumer, replacing any published item not yet taken, and take ownership of another item for the next write. Must be invoked only from the producer thread.
+	void publish () {
+		int prev;
+
+		prev = middleIndex.exchange (writeIndex | TripleBuffer<T>::FreshFlag, std::memory_order_acq_rel);
+		writeIndex = prev & TripleBuffer<T>::IndexMask;
+	}
+
+	// Take ownership of the most recently published item if it has not already been taken. Returns a boolean value indicating if a new item was taken. Must be invoked only from the consumer thread.
+	bool take () {
+		int prev;
+
+		if (! (middleIndex.load (std::memory_order_acquire) & TripleBuffer<T>::FreshFlag)) {
+			return (false);
+		}
+		prev = middleIndex.exchange (readIndex, std::memory_order_acq_rel);
+		readIndex = prev & TripleBuffer<T>::IndexMask;
+		return (true);
+	}
+
+	// Return a boolean value indicating if a published item is waiting for a call to take
+	bool isPending () {
+		return ((middleIndex.load (std::memory_order_acquire) & TripleBuffer<T>::FreshFlag) != 0);
+	}
+
+	// Return a pointer to the item owned by the consumer, as set by the most recent successful call to take. Must be invoked only from the consumer thread.
+	T *getReadItem () {
+		return (&(items[readIndex]));
+	}
+
+private:
+	static const int IndexMask = 0x3;
+	static const int FreshFlag = 0x4;
+
+	T items[3];
+
+	// The producer index, consumer index, and shared index are separated by cache-line sized padding to avoid false sharing between the two threads. The App object that holds a TripleBuffer is allocated with plain new, so alignas would not be honored under C++11.
+	static const int CacheLineSize = 64;
+	char indexPadding0[TripleBuffer<T>::CacheLineSize];
+	int writeIndex;
+	char indexPadding1[TripleBuffer<T>::CacheLineSize];
+	int readIndex;
+	char indexPadding2[TripleBuffer<T>::CacheLineSize];
+	std::atomic<int> middleIndex;
+	char indexPadding3[TripleBuffer<T>::CacheLineSize];
+};
+
+#endif
@@ -37,6 +37,7 @@
 #include "StdString.h"
 #include "StringList.h"
 #include "Json.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "Resource.h"
 #include "UiConfiguration.h"
@@ -51,11 +52,8 @@ Ui::Ui ()
 , isLoaded (false)
 , isFirstResumeComplete (false)
 , refcount (0)
-, refcountMutex (NULL)
 , lastWindowCloseCount (0)
 {
-	refcountMutex = SDL_CreateMutex ();
-
 	rootPanel = new Panel ();
 	rootPanel->keyEventCallback = Widget::KeyEventCallbackContext (Ui::keyEvent, this);
 	rootPanel->retain ();
@@ -66,34 +64,14 @@ Ui::~Ui () {
 		rootPanel->release ();
 		rootPanel = NULL;
 	}
-	if (refcountMutex) {
-		SDL_DestroyMutex (refcountMutex);
-		refcountMutex = NULL;
-	}
 }
 
 void Ui::retain () {
-
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
+	refcount.fetch_add (1, std::memory_order_relaxed);
 }
 
 void Ui::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
+	if (refcount.fetch_sub (1, std::memory_order_acq_rel) <= 1) {
 		delete (this);
 	}
 }
@@ -199,7 +177,7 @@ void Ui::pause () {
 	doPause ();
 }
 
-void Ui::update (int msElapsed) {
+void Ui::update (float msElapsed) {
 	int count;
 
 	count = Input::instance->windowCloseCount;
@@ -212,9 +190,9 @@ void Ui::update (int msElapsed) {
 	doUpdate (msElapsed);
 }
 
-void Ui::draw () {
+void Ui::draw (DrawList *drawList) {
 	// Base class method takes no action
-	doDraw ();
+	doDraw (drawList);
 }
 
 void Ui::refresh () {
@@ -252,11 +230,11 @@ void Ui::doPause () {
 	// Default implementation does nothing
 }
 
-void Ui::doUpdate (int msElapsed) {
+void Ui::doUpdate (float msElapsed) {
 	// Default implementation does nothing
 }
 
-void Ui::doDraw () {
+void Ui::doDraw (DrawList *drawList) {
 	// Default implementation does nothing
 }
 
@@ -32,9 +32,11 @@
 #ifndef UI_H
 #define UI_H
 
+#include <atomic>
 #include "SDL2/SDL.h"
 #include "StdString.h"
 #include "OsUtil.h"
+#include "DrawList.h"
 #include "Widget.h"
 #include "WidgetHandle.h"
 #include "Panel.h"
@@ -74,10 +76,10 @@ public:
 	void pause ();
 
 	// Update interface state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	void update (float msElapsed);
 
-	// Add draw commands for execution by the application
-	void draw ();
+	// Add draw commands to drawList for later execution by the application
+	void draw (DrawList *drawList);
 
 	// Refresh the interface's layout as appropriate for the current set of UiConfiguration values
 	void refresh ();
@@ -117,10 +119,10 @@ protected:
 	virtual void doPause ();
 
 	// Update subclass-specific interface state as appropriate for an elapsed millisecond time period
-	virtual void doUpdate (int msElapsed);
+	virtual void doUpdate (float msElapsed);
 
-	// Add subclass-specific draw commands for execution by the application
-	virtual void doDraw ();
+	// Add subclass-specific draw commands to drawList for later execution by the application
+	virtual void doDraw (DrawList *drawList);
 
 	// Execute subclass-specific actions to refresh the interface's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
@@ -140,8 +142,7 @@ private:
 	// Callback functions
 	static bool keyEvent (void *uiPtr, SDL_Keycode keycode, bool isShiftDown, bool isControlDown);
 
-	int refcount;
-	SDL_mutex *refcountMutex;
+	std::atomic<int> refcount;
 	int lastWindowCloseCount;
 };
 
@@ -38,6 +38,7 @@
 #include "Ui.h"
 #include "UiConfiguration.h"
 #include "TooltipWindow.h"
+#include "Scene.h"
 #include "UiStack.h"
 
 UiStack::UiStack ()
@@ -46,7 +47,7 @@ UiStack::UiStack ()
 , nextCommandType (-1)
 , nextCommandUi (NULL)
 , nextCommandMutex (NULL)
-, mouseHoverClock (0)
+, mouseHoverClock (0.0f)
 , isMouseHoverActive (false)
 , isMouseHoverSuspended (false)
 {
@@ -142,7 +143,7 @@ void UiStack::popUi () {
 	SDL_UnlockMutex (nextCommandMutex);
 }
 
-void UiStack::update (int msElapsed) {
+void UiStack::update (float msElapsed) {
 	Ui *ui;
 	Widget *keywidget, *mousewidget;
 
@@ -156,6 +157,7 @@ void UiStack::update (int msElapsed) {
 			}
 			activeUi = ui;
 			activeUi->retain ();
+			Scene::setChanged ();
 
 			tooltip.destroyAndClear ();
 			keyFocusTarget.clear ();
@@ -187,9 +189,12 @@ void UiStack::update (int msElapsed) {
 		else {
 			if ((! isMouseHoverActive) && (! isMouseHoverSuspended)) {
 				mouseHoverClock -= msElapsed;
-				if (mouseHoverClock <= 0) {
+				if (mouseHoverClock <= 0.0f) {
 					activateMouseHover ();
 				}
+				else {
+					App::instance->scheduleUpdate (((int) mouseHoverClock) + 1);
+				}
 			}
 		}
 	}
@@ -468,10 +473,11 @@ bool UiStack::openWidget (const StdString &targetName) {
 bool UiStack::inputCommand (const char *commandJson) {
 	Ui *ui;
 	Json *cmd;
+	StdString err;
 	bool result;
 
-	if (!(SystemInterface::instance->parseCommand (commandJson, &cmd))) {
-		Log::debug ("Command string parse failed; err=%s", SystemInterface::instance->lastError.c_str ());
+	if (!(SystemInterface::instance->parseCommand (commandJson, &cmd, &err))) {
+		Log::debug ("Command string parse failed; err=%s", err.c_str ());
 		return (false);
 	}
 	result = false;
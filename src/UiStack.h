@@ -58,7 +58,7 @@ public:
 	void popUi ();
 
 	// Execute operations to update state as appropriate for an elapsed millisecond time period
-	void update (int msElapsed);
+	void update (float msElapsed);
 
 	// Execute operations to change the top item of the Ui stack, as specified by previously received commands. This method must be invoked only from the application's main thread.
 	void executeStackCommands ();
@@ -107,7 +107,7 @@ private:
 	WidgetHandle tooltip;
 	WidgetHandle keyFocusTarget;
 	WidgetHandle mouseHoverTarget;
-	int mouseHoverClock;
+	float mouseHoverClock;
 	bool isMouseHoverActive;
 	bool isMouseHoverSuspended;
 };
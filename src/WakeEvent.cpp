@@ -0,0 +1,93 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Config.h"
+#include <stdlib.h>
+#include "SDL2/SDL.h"
+#include "OsUtil.h"
+#include "WakeEvent.h"
+
+WakeEvent::WakeEvent ()
+: mutex (NULL)
+, cond (NULL)
+, isSignaled (false)
+{
+	mutex = SDL_CreateMutex ();
+	cond = SDL_CreateCond ();
+}
+
+WakeEvent::~WakeEvent () {
+	if (cond) {
+		SDL_DestroyCond (cond);
+		cond = NULL;
+	}
+	if (mutex) {
+		SDL_DestroyMutex (mutex);
+		mutex = NULL;
+	}
+}
+
+void WakeEvent::signal () {
+	SDL_LockMutex (mutex);
+	if (! isSignaled) {
+		isSignaled = true;
+		SDL_CondSignal (cond);
+	}
+	SDL_UnlockMutex (mutex);
+}
+
+bool WakeEvent::wait (int64_t deadline) {
+	int64_t remaining;
+	bool result;
+
+	SDL_LockMutex (mutex);
+	while (! isSignaled) {
+		if (deadline <= 0) {
+			SDL_CondWait (cond, mutex);
+			continue;
+		}
+		remaining = deadline - OsUtil::getMonotonicTime ();
+		if (remaining <= 0) {
+			break;
+		}
+		if (remaining < 1000000) {
+			// SDL condition timeouts have millisecond resolution, so finish short waits on the monotonic clock
+			SDL_UnlockMutex (mutex);
+			OsUtil::sleepUntilMonotonicTime (deadline);
+			SDL_LockMutex (mutex);
+			break;
+		}
+		SDL_CondWaitTimeout (cond, mutex, (Uint32) (remaining / 1000000));
+	}
+	result = isSignaled;
+	isSignaled = false;
+	SDL_UnlockMutex (mutex);
+
+	return (result);
+}
@@ -36,6 +36,8 @@
 #include "StringList.h"
 #include "Input.h"
 #include "UiConfiguration.h"
+#include "Scene.h"
+#include "DrawList.h"
 #include "Widget.h"
 
 const int Widget::MinZLevel = -10;
@@ -57,45 +59,33 @@ Widget::Widget ()
 , tooltipAlignment (Widget::BottomAlignment)
 , width (0.0f)
 , height (0.0f)
-, destroyClock (0)
+, destroyClock (0.0f)
 , isFixedCenter (false)
 , isMouseEntered (false)
 , isMousePressed (false)
+, sceneMargin (0.0f)
+, sceneX (0.0f)
+, sceneY (0.0f)
+, sceneWidth (0.0f)
+, sceneHeight (0.0f)
+, isSceneVisible (false)
 , refcount (0)
-, refcountMutex (NULL)
 {
-	refcountMutex = SDL_CreateMutex ();
+
 }
 
 Widget::~Widget () {
-	if (refcountMutex) {
-		SDL_DestroyMutex (refcountMutex);
-		refcountMutex = NULL;
-	}
+
 }
 
 void Widget::retain () {
-
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
+	// The caller already holds a reference or owns the new object, so the increment needs no ordering
+	refcount.fetch_add (1, std::memory_order_relaxed);
 }
 
 void Widget::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
+	// Release ordering publishes this thread's writes to the object before the decrement, and acquire ordering makes all such writes visible to the thread that deletes it
+	if (refcount.fetch_sub (1, std::memory_order_acq_rel) <= 1) {
 		delete (this);
 	}
 }
@@ -117,20 +107,24 @@ void Widget::setMouseHoverTooltip (const StdString &text, Widget::Alignment alig
 	isMouseHoverEnabled = true;
 }
 
-void Widget::update (int msElapsed, float originX, float originY) {
+void Widget::update (float msElapsed, float originX, float originY) {
 	float x, y;
+	bool isparentchanged;
 
-
-	if (destroyClock > 0) {
+	if (destroyClock > 0.0f) {
 		destroyClock -= msElapsed;
-		if (destroyClock <= 0) {
+		if (destroyClock <= 0.0f) {
 			isDestroyed = true;
 		}
+		else {
+			App::instance->scheduleUpdate (((int) destroyClock) + 1);
+		}
 	}
 	if (isDestroyed) {
 		return;
 	}
 
+	isparentchanged = Scene::beginWidgetUpdate ();
 	position.update (msElapsed);
 	screenX = position.x + originX;
 	screenY = position.y + originY;
@@ -154,29 +148,47 @@ void Widget::update (int msElapsed, float originX, float originY) {
 	if (updateCallback.callback) {
 		updateCallback.callback (updateCallback.callbackData, msElapsed, this);
 	}
+	updateSceneState ();
+	if (Scene::endWidgetUpdate (isparentchanged)) {
+		addSceneDamage ();
+	}
+}
+
+void Widget::updateSceneState () {
+	if ((isVisible == isSceneVisible) && FLOAT_EQUALS (screenX, sceneX) && FLOAT_EQUALS (screenY, sceneY) && FLOAT_EQUALS (width, sceneWidth) && FLOAT_EQUALS (height, sceneHeight)) {
+		return;
+	}
+	addSceneDamage ();
+	sceneX = screenX;
+	sceneY = screenY;
+	sceneWidth = width;
+	sceneHeight = height;
+	isSceneVisible = isVisible;
+	addSceneDamage ();
+}
+
+void Widget::addSceneDamage () {
+	if (! isSceneVisible) {
+		return;
+	}
+	Scene::addDamage (sceneX - sceneMargin, sceneY - sceneMargin, sceneWidth + (sceneMargin * 2.0f), sceneHeight + (sceneMargin * 2.0f));
 }
 
-void Widget::doUpdate (int msElapsed) {
+void Widget::doUpdate (float msElapsed) {
 	// Default implementation does nothing
 }
 
-void Widget::draw (SDL_Texture *targetTexture, float originX, float originY) {
+void Widget::draw (DrawList *drawList, float originX, float originY) {
 	if (isDestroyed) {
 		return;
 	}
-	if (targetTexture) {
-		if (! isTextureTargetDrawEnabled) {
-			return;
-		}
-		SDL_SetRenderTarget (App::instance->render, targetTexture);
-	}
-	doDraw (targetTexture, originX, originY);
-	if (targetTexture) {
-		SDL_SetRenderTarget (App::instance->render, NULL);
+	if (drawList->isTextureTarget && (! isTextureTargetDrawEnabled)) {
+		return;
 	}
+	doDraw (drawList, originX, originY);
 }
 
-void Widget::doDraw (SDL_Texture *targetTexture, float originX, float originY) {
+void Widget::doDraw (DrawList *drawList, float originX, float originY) {
 	// Default implementation does nothing
 }
 
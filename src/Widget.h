@@ -33,15 +33,17 @@
 #define WIDGET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "SDL2/SDL.h"
 #include "StdString.h"
 #include "StringList.h"
 #include "Position.h"
+#include "DrawList.h"
 
 class Widget {
 public:
 	typedef void (*FreeFunction) (void *data);
-	typedef void (*UpdateCallback) (void *data, int msElapsed, Widget *widget);
+	typedef void (*UpdateCallback) (void *data, float msElapsed, Widget *widget);
 	typedef void (*EventCallback) (void *data, Widget *widget);
 	typedef bool (*KeyEventCallback) (void *data, SDL_Keycode keycode, bool isShiftDown, bool isControlDown);
 	struct UpdateCallbackContext {
@@ -147,10 +149,10 @@ public:
 	void resetInputState ();
 
 	// Execute operations to update object state as appropriate for an elapsed millisecond time period and origin position
-	void update (int msElapsed, float originX, float originY);
+	void update (float msElapsed, float originX, float originY);
 
-	// Add draw commands for execution by the App. If targetTexture is non-NULL, render to that texture instead the default render target.
-	void draw (SDL_Texture *targetTexture = NULL, float originX = 0.0f, float originY = 0.0f);
+	// Add draw commands to drawList for later execution by the App. This method must be invoked only from the application's update thread, or while the update thread is suspended.
+	void draw (DrawList *drawList, float originX = 0.0f, float originY = 0.0f);
 
 	// Refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	void refresh ();
@@ -235,15 +237,18 @@ public:
 	// Return a Rectangle struct containing the widget's screen extent values
 	Widget::Rectangle getScreenRect ();
 
+	// Mark the widget's most recently updated screen extent as needing to be drawn again
+	void addSceneDamage ();
+
 	// Callback functions
 	static bool compareZLevel (Widget *first, Widget *second);
 
 protected:
 	// Execute subclass-specific operations to update object state as appropriate for an elapsed millisecond time period
-	virtual void doUpdate (int msElapsed);
+	virtual void doUpdate (float msElapsed);
 
-	// Add subclass-specific draw commands for execution by the App. If targetTexture is non-NULL, it has been set as the render target and draw commands should adjust coordinates as appropriate.
-	virtual void doDraw (SDL_Texture *targetTexture, float originX, float originY);
+	// Add subclass-specific draw commands to drawList. If the list's isTextureTarget value is set, commands are drawn to a render texture and coordinates should be adjusted as appropriate.
+	virtual void doDraw (DrawList *drawList, float originX, float originY);
 
 	// Execute subclass-specific operations to refresh the widget's layout as appropriate for the current set of UiConfiguration values
 	virtual void doRefresh ();
@@ -260,15 +265,20 @@ protected:
 	// Return a string that should be included as part of the toString method's output
 	virtual StdString toStringDetail ();
 
-	int destroyClock;
+	float destroyClock;
 	bool isFixedCenter;
 	Position fixedCenterPosition;
 	bool isMouseEntered;
 	bool isMousePressed;
+	float sceneMargin; // Extent drawn outside the widget's bounds, such as a drop shadow
 
 private:
-	int refcount;
-	SDL_mutex *refcountMutex;
+	// Add scene damage for the widget's previous and current screen extents if either differs from the values recorded by the previous call
+	void updateSceneState ();
+
+	float sceneX, sceneY, sceneWidth, sceneHeight;
+	bool isSceneVisible;
+	std::atomic<int> refcount;
 };
 
 #endif
@@ -0,0 +1,1292 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Program that measures the throughput of core data handling classes and writes results as JSON records, one per line
+
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <atomic>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "Log.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+#include "SharedBuffer.h"
+#include "Json.h"
+#include "HashMap.h"
+#include "Prng.h"
+#include "SequenceList.h"
+#include "CommandReader.h"
+#include "CommandJournal.h"
+#include "SystemInterface.h"
+#include "CommandParams.h"
+#include "AnimationTimeline.h"
+#include "TaskGroup.h"
+
+// A function that executes a benchmark operation the specified number of times. Returns the number of payload bytes processed, or zero if the operation has no payload size.
+typedef int64_t (*BenchmarkFunction) (void *context, int iterations);
+
+struct Options {
+	StdString journalPath;
+	StdString filter;
+	int minSampleTime;
+	int sampleCount;
+	Options ():
+		journalPath (""),
+		filter (""),
+		minSampleTime (200),
+		sampleCount (5) { }
+};
+
+struct PayloadSet {
+	StdString source;
+	std::vector<StdString> jsonRecords;
+	std::vector<StdString> msgPackRecords;
+	std::vector<Json *> commands;
+	int64_t jsonByteCount;
+	PayloadSet ():
+		source (""),
+		jsonByteCount (0) { }
+	~PayloadSet () {
+		std::vector<Json *>::iterator i, end;
+
+		i = commands.begin ();
+		end = commands.end ();
+		while (i != end) {
+			delete (*i);
+			++i;
+		}
+		commands.clear ();
+	}
+};
+
+struct LookupContext {
+	Json *json;
+	std::vector<StdString> keys;
+	LookupContext ():
+		json (NULL) { }
+};
+
+struct ParamLookupContext {
+	Json *command;
+	std::vector<StdString> keys;
+	ParamLookupContext ():
+		command (NULL) { }
+};
+
+struct HashMapContext {
+	HashMap map;
+	StdString path;
+	std::vector<StdString> keys;
+	int64_t fileSize;
+	HashMapContext ():
+		path (""),
+		fileSize (0) { }
+};
+
+struct SequenceContext {
+	Prng prng;
+	SequenceList<int> list;
+};
+
+struct AnimationContext {
+	std::vector<int> executeTimes;
+	int tickPeriod;
+	AnimationContext ():
+		tickPeriod (16) { }
+};
+
+// An animation step as held in the std::list scanned by MainUi before AnimationTimeline, kept here for comparison
+struct ListAnimationStep {
+	int executeTime;
+	json_value *command;
+	ListAnimationStep ():
+		executeTime (0),
+		command (NULL) { }
+};
+
+// A refcounted object using the per-object SDL_mutex scheme held by Widget, Ui and SharedBuffer before their refcounts became atomic, kept here for comparison
+class MutexRefcountObject {
+public:
+	MutexRefcountObject ():
+		refcount (0),
+		refcountMutex (NULL) {
+		refcountMutex = SDL_CreateMutex ();
+	}
+	~MutexRefcountObject () {
+		if (refcountMutex) {
+			SDL_DestroyMutex (refcountMutex);
+			refcountMutex = NULL;
+		}
+	}
+	void retain () {
+		SDL_LockMutex (refcountMutex);
+		++refcount;
+		if (refcount < 1) {
+			refcount = 1;
+		}
+		SDL_UnlockMutex (refcountMutex);
+	}
+	void release () {
+		bool isdestroyed;
+
+		isdestroyed = false;
+		SDL_LockMutex (refcountMutex);
+		--refcount;
+		if (refcount <= 0) {
+			refcount = 0;
+			isdestroyed = true;
+		}
+		SDL_UnlockMutex (refcountMutex);
+		if (isdestroyed) {
+			delete (this);
+		}
+	}
+
+	int refcount;
+	SDL_mutex *refcountMutex;
+};
+
+struct TaskContext {
+	TaskGroup taskGroup;
+	std::atomic<int> runCount;
+	std::atomic<int> endCount;
+	std::vector<uint32_t> scaleSource;
+	std::vector<uint32_t> scaleDest;
+	TaskContext ():
+		runCount (0),
+		endCount (0) { }
+};
+
+// The number of tasks started by each iteration of a task throughput benchmark, matching a burst of image loads
+static const int TaskBurstCount = 1000;
+
+// Source and target sizes for image scale benchmarks, matching a camera photo scaled to fit a large window
+static const int ScaleSourceWidth = 4032;
+static const int ScaleSourceHeight = 3024;
+static const int ScaleTargetWidth = 1920;
+static const int ScaleTargetHeight = 1440;
+
+// The number of objects created by each iteration of a refcount benchmark, matching a scene with a very large widget count
+static const int RefcountObjectCount = 100000;
+
+static Options options;
+
+// Accumulates values produced by benchmark operations, preventing the compiler from discarding them
+static volatile int64_t resultSink = 0;
+
+// Parse command line arguments into options. Returns a boolean value indicating if the arguments were valid.
+static bool readOptions (int argc, char **argv);
+
+// Populate payloads with command records read from options.journalPath, or a built-in set of commands if no journal path was provided. Returns a boolean value indicating if the payloads were populated.
+static bool readPayloads (PayloadSet *payloads);
+
+// Add a command to payloads, storing its JSON and MessagePack encodings
+static void addPayload (PayloadSet *payloads, Json *command);
+
+// Return a newly created ShowIconLabelWindow command with the provided values
+static Json *createIconLabelCommand (const char *windowId, const char *labelText, float positionX, float positionY);
+
+// Measure a benchmark function and write its result record to stdout, unless options.filter excludes the benchmark name
+static void runBenchmark (const char *name, BenchmarkFunction fn, void *context);
+
+// Return the number of nanoseconds elapsed during the provided performance counter delta
+static double getCounterNanoseconds (uint64_t counterDelta);
+
+// Benchmark functions
+static int64_t parseCommand (void *context, int iterations);
+static int64_t parseHeapJson (void *context, int iterations);
+static int64_t parseMsgPackCommand (void *context, int iterations);
+static int64_t serializeJsonString (void *context, int iterations);
+static int64_t serializeJsonBuffer (void *context, int iterations);
+static int64_t serializeMsgPackBuffer (void *context, int iterations);
+static int64_t decodeParamsStruct (void *context, int iterations);
+static int64_t getCommandParamFields (void *context, int iterations);
+static int64_t lookupJsonKey (void *context, int iterations);
+static int64_t lookupCommandNumberParam (void *context, int iterations);
+static int64_t formatSprintf (void *context, int iterations);
+static int64_t splitString (void *context, int iterations);
+static int64_t urlEncodeString (void *context, int iterations);
+static int64_t writeHashMap (void *context, int iterations);
+static int64_t readHashMap (void *context, int iterations);
+static int64_t findHashMap (void *context, int iterations);
+static int64_t insertHashMap (void *context, int iterations);
+static int64_t addBufferData (void *context, int iterations);
+static int64_t getPrngValue (void *context, int iterations);
+static int64_t nextSequenceItem (void *context, int iterations);
+static int64_t playAnimationTimeline (void *context, int iterations);
+static int64_t playAnimationList (void *context, int iterations);
+static int64_t retainAtomicRefcount (void *context, int iterations);
+static int64_t retainMutexRefcount (void *context, int iterations);
+static int64_t runTaskGroupBurst (void *context, int iterations);
+static int64_t runThreadBurst (void *context, int iterations);
+static int64_t runTaskGroupLatency (void *context, int iterations);
+static int64_t runThreadLatency (void *context, int iterations);
+static int64_t runParallelScale (void *context, int iterations);
+static int64_t runSerialScale (void *context, int iterations);
+
+// Task functions for task benchmarks
+static void executeTask (void *contextPtr);
+static int executeThreadTask (void *contextPtr);
+static void endTask (void *callbackData, void *runPtr);
+static void scaleRows (void *contextPtr, int rangeStart, int rangeEnd);
+
+int main (int argc, char **argv) {
+	Log log;
+	SystemInterface interface;
+	PayloadSet payloads;
+	LookupContext smalllookup, largelookup;
+	ParamLookupContext paramlookups[3];
+	Json *params;
+	HashMapContext hashmap;
+	SequenceContext sequence;
+	AnimationContext animation;
+	TaskContext task;
+	Json header, *json;
+	Buffer *buffer;
+	StdString s;
+	int i, j;
+
+	log.isStdoutWriteEnabled = false;
+	Log::instance = &log;
+	SystemInterface::instance = &interface;
+	if (! readOptions (argc, argv)) {
+		fprintf (stderr, "Usage: %s [-j <journal path>] [-f <benchmark name filter>] [-t <minimum sample milliseconds>] [-n <sample count>]\n", argv[0]);
+		return (1);
+	}
+	if (! readPayloads (&payloads)) {
+		return (1);
+	}
+
+	smalllookup.json = payloads.commands.at (0);
+	smalllookup.keys.push_back (StdString ("command"));
+	smalllookup.keys.push_back (StdString ("commandName"));
+	smalllookup.keys.push_back (StdString ("prefix"));
+	smalllookup.keys.push_back (StdString ("params"));
+	smalllookup.keys.push_back (StdString ("missing"));
+
+	json = new Json ();
+	json->setEmpty ();
+	for (i = 0; i < 512; ++i) {
+		s.sprintf ("windowLabel%i", i);
+		json->set (s, i);
+		largelookup.keys.push_back (s);
+	}
+	largelookup.json = json;
+
+	// Commands with params objects of 4, 32, and 512 keys, read through SystemInterface::getCommandNumberParam as a command handler would
+	for (i = 0; i < 3; ++i) {
+		params = new Json ();
+		params->setEmpty ();
+		for (j = 0; j < ((i == 0) ? 4 : ((i == 1) ? 32 : 512)); ++j) {
+			s.sprintf ("field%i", j);
+			params->set (s, j);
+			paramlookups[i].keys.push_back (s);
+		}
+		json = new Json ();
+		json->setEmpty ();
+		json->set ("command", 0);
+		json->set ("params", params);
+		paramlookups[i].command = json;
+	}
+
+	hashmap.path = OsUtil::getAppendPath (OsUtil::getEnvValue ("TMPDIR", "/tmp"), StdString::createSprintf ("membrane-surface-benchmark-%i.conf", OsUtil::getProcessId ()));
+	for (i = 0; i < 10000; ++i) {
+		s.sprintf ("Pref_%i_%08x", i, (unsigned int) (i * 2654435761u));
+		hashmap.map.insert (s, StdString::createSprintf ("value %i with some text for prefs file %s", i * 31, s.c_str ()));
+		hashmap.keys.push_back (s);
+	}
+	if (hashmap.map.write (hashmap.path) != OsUtil::Success) {
+		fprintf (stderr, "Failed to write prefs file %s\n", hashmap.path.c_str ());
+		return (1);
+	}
+	buffer = OsUtil::readFile (hashmap.path);
+	if (buffer) {
+		hashmap.fileSize = buffer->length;
+		delete (buffer);
+	}
+
+	sequence.prng.seed (1);
+	for (i = 0; i < 1000; ++i) {
+		sequence.list.push_back (i);
+	}
+	sequence.list.randomizeOrder (&(sequence.prng));
+
+	for (i = 0; i < 10000; ++i) {
+		animation.executeTimes.push_back (sequence.prng.getRandomValue (0, 10000 * animation.tickPeriod));
+	}
+
+	header.setEmpty ();
+	header.set ("record", "run");
+	header.set ("buildId", BUILD_ID);
+	header.set ("platform", PLATFORM_ID);
+	header.set ("payloadSource", payloads.source);
+	header.set ("payloadCount", (int) payloads.jsonRecords.size ());
+	header.set ("payloadBytes", payloads.jsonByteCount);
+	header.set ("minSampleTimeMs", options.minSampleTime);
+	header.set ("sampleCount", options.sampleCount);
+	printf ("%s\n", header.toString ().c_str ());
+	fflush (stdout);
+
+	runBenchmark ("command.parse", parseCommand, &payloads);
+	runBenchmark ("command.parseHeap", parseHeapJson, &payloads);
+	runBenchmark ("command.parseMsgPack", parseMsgPackCommand, &payloads);
+	runBenchmark ("command.toString", serializeJsonString, &payloads);
+	runBenchmark ("command.writeJson", serializeJsonBuffer, &payloads);
+	runBenchmark ("command.writeMsgPack", serializeMsgPackBuffer, &payloads);
+	runBenchmark ("params.decodeStruct", decodeParamsStruct, &payloads);
+	runBenchmark ("params.getCommandParam", getCommandParamFields, &payloads);
+	runBenchmark ("json.lookupSmall", lookupJsonKey, &smalllookup);
+	runBenchmark ("json.lookupLarge", lookupJsonKey, &largelookup);
+	runBenchmark ("command.getNumberParam4", lookupCommandNumberParam, &(paramlookups[0]));
+	runBenchmark ("command.getNumberParam32", lookupCommandNumberParam, &(paramlookups[1]));
+	runBenchmark ("command.getNumberParam512", lookupCommandNumberParam, &(paramlookups[2]));
+	runBenchmark ("stdString.sprintf", formatSprintf, NULL);
+	runBenchmark ("stdString.split", splitString, NULL);
+	runBenchmark ("stdString.urlEncode", urlEncodeString, NULL);
+	runBenchmark ("hashMap.write", writeHashMap, &hashmap);
+	runBenchmark ("hashMap.read", readHashMap, &hashmap);
+	runBenchmark ("hashMap.find", findHashMap, &hashmap);
+	runBenchmark ("hashMap.insert", insertHashMap, &hashmap);
+	runBenchmark ("buffer.add", addBufferData, NULL);
+	runBenchmark ("prng.getRandomValue", getPrngValue, &sequence);
+	runBenchmark ("sequenceList.next", nextSequenceItem, &sequence);
+	runBenchmark ("animationTimeline.play10k", playAnimationTimeline, &animation);
+	runBenchmark ("animationList.play10k", playAnimationList, &animation);
+	runBenchmark ("task.poolBurst1k", runTaskGroupBurst, &task);
+	runBenchmark ("task.threadBurst1k", runThreadBurst, &task);
+	runBenchmark ("task.poolLatency", runTaskGroupLatency, &task);
+	runBenchmark ("task.threadLatency", runThreadLatency, &task);
+	runBenchmark ("task.parallelScale", runParallelScale, &task);
+	runBenchmark ("task.serialScale", runSerialScale, &task);
+	runBenchmark ("refcount.atomic100k", retainAtomicRefcount, NULL);
+	runBenchmark ("refcount.mutex100k", retainMutexRefcount, NULL);
+	if (options.filter.empty () || StdString ("refcount").contains (options.filter)) {
+		// Each mutex refcount also holds a heap-allocated SDL_mutex, which is not counted here
+		json = new Json ();
+		json->setEmpty ();
+		json->set ("record", "refcountSize");
+		json->set ("atomicRefcountBytes", (int) sizeof (std::atomic<int>));
+		json->set ("mutexRefcountBytes", (int) sizeof (MutexRefcountObject));
+		printf ("%s\n", json->toString ().c_str ());
+		fflush (stdout);
+		delete (json);
+	}
+
+	remove (hashmap.path.c_str ());
+	delete (largelookup.json);
+	for (i = 0; i < 3; ++i) {
+		delete (paramlookups[i].command);
+	}
+	SystemInterface::instance = NULL;
+	Log::instance = NULL;
+	return (0);
+}
+
+bool readOptions (int argc, char **argv) {
+	int i;
+
+	i = 1;
+	while (i < argc) {
+		if ((i + 1) >= argc) {
+			return (false);
+		}
+		if (! strcmp (argv[i], "-j")) {
+			options.journalPath.assign (argv[i + 1]);
+		}
+		else if (! strcmp (argv[i], "-f")) {
+			options.filter.assign (argv[i + 1]);
+		}
+		else if (! strcmp (argv[i], "-t")) {
+			if ((! StdString (argv[i + 1]).parseInt (&(options.minSampleTime))) || (options.minSampleTime <= 0)) {
+				return (false);
+			}
+		}
+		else if (! strcmp (argv[i], "-n")) {
+			if ((! StdString (argv[i + 1]).parseInt (&(options.sampleCount))) || (options.sampleCount <= 0)) {
+				return (false);
+			}
+		}
+		else {
+			return (false);
+		}
+		i += 2;
+	}
+	return (true);
+}
+
+bool readPayloads (PayloadSet *payloads) {
+	CommandJournal journal;
+	CommandJournal::Entry entry;
+	Json *cmd, *params, *item;
+	std::vector<Json *> steps;
+	SystemInterface::Prefix prefix;
+	int i;
+
+	if (! options.journalPath.empty ()) {
+		if (journal.openRead (options.journalPath) != OsUtil::Success) {
+			fprintf (stderr, "Failed to open journal %s\n", options.journalPath.c_str ());
+			return (false);
+		}
+		while (journal.read (&entry)) {
+			if (entry.format == CommandReader::MsgPackFormat) {
+				if (! SystemInterface::instance->parseMsgPackCommand ((const uint8_t *) entry.record.c_str (), (int) entry.record.length (), &cmd)) {
+					continue;
+				}
+			}
+			else {
+				if (! SystemInterface::instance->parseCommand (entry.record, &cmd)) {
+					continue;
+				}
+			}
+			addPayload (payloads, cmd);
+		}
+		journal.close ();
+		if (payloads->commands.empty ()) {
+			fprintf (stderr, "Journal %s contains no valid command records\n", options.journalPath.c_str ());
+			return (false);
+		}
+		payloads->source.assign (options.journalPath);
+		return (true);
+	}
+
+	prefix.createTime = 1650000000000LL;
+	addPayload (payloads, createIconLabelCommand ("status", "Lobby display: next session starts in the main hall", 0.05f, 0.9f));
+	addPayload (payloads, createIconLabelCommand ("clock", "12:45", 0.9f, 0.05f));
+
+	params = new Json ();
+	params->set ("windowId", "countdown");
+	params->set ("icon", 2);
+	params->set ("positionX", 0.5f);
+	params->set ("positionY", 0.5f);
+	params->set ("labelText", "Doors open");
+	params->set ("countdownTime", (int64_t) 300000);
+	addPayload (payloads, SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_ShowCountdownWindow, params));
+
+	params = new Json ();
+	params->set ("imagePath", "/var/lib/membrane/images/background-lobby-1920x1080.jpg");
+	params->set ("background", 1);
+	addPayload (payloads, SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_ShowFileImageBackground, params));
+
+	params = new Json ();
+	params->set ("windowId", "status");
+	addPayload (payloads, SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_RemoveWindow, params));
+
+	for (i = 0; i < 64; ++i) {
+		item = new Json ();
+		item->set ("executeTime", i * 250);
+		item->set ("command", createIconLabelCommand (StdString::createSprintf ("frame%i", i % 8).c_str (), StdString::createSprintf ("Animation frame %i", i).c_str (), (float) (i % 8) / 8.0f, 0.25f));
+		steps.push_back (item);
+	}
+	params = new Json ();
+	params->set ("commands", &steps);
+	addPayload (payloads, SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_PlayAnimation, params));
+
+	payloads->source.assign ("builtin");
+	return (true);
+}
+
+void addPayload (PayloadSet *payloads, Json *command) {
+	Buffer buffer;
+	StdString s;
+
+	if (! command) {
+		return;
+	}
+	s = command->toString ();
+	payloads->jsonRecords.push_back (s);
+	payloads->jsonByteCount += (int64_t) s.length ();
+	if (command->writeMsgPack (&buffer) == OsUtil::Success) {
+		payloads->msgPackRecords.push_back (StdString ((char *) buffer.data, buffer.length));
+	}
+	payloads->commands.push_back (command);
+}
+
+Json *createIconLabelCommand (const char *windowId, const char *labelText, float positionX, float positionY) {
+	Json *params;
+	SystemInterface::Prefix prefix;
+
+	prefix.createTime = 1650000000000LL;
+	params = new Json ();
+	params->set ("windowId", windowId);
+	params->set ("icon", 1);
+	params->set ("positionX", positionX);
+	params->set ("positionY", positionY);
+	params->set ("labelText", labelText);
+	return (SystemInterface::instance->createCommand (prefix, SystemInterface::CommandId_ShowIconLabelWindow, params));
+}
+
+void runBenchmark (const char *name, BenchmarkFunction fn, void *context) {
+	std::vector<double> samples;
+	Json record;
+	uint64_t start, elapsed, mintime;
+	int64_t bytes;
+	int iterations, i;
+	double ns, bytespersecond;
+
+	if ((! options.filter.empty ()) && (! StdString (name).contains (options.filter))) {
+		return;
+	}
+	mintime = (SDL_GetPerformanceFrequency () * (uint64_t) options.minSampleTime) / 1000;
+
+	// Calibrate the iteration count so that each sample runs for at least minSampleTime
+	iterations = 1;
+	while (true) {
+		start = SDL_GetPerformanceCounter ();
+		fn (context, iterations);
+		elapsed = SDL_GetPerformanceCounter () - start;
+		if ((elapsed >= mintime) || (iterations >= (1 << 28))) {
+			break;
+		}
+		if (elapsed <= (mintime / 100)) {
+			iterations *= 10;
+		}
+		else {
+			iterations = (int) (((double) iterations) * 1.2f * ((double) mintime) / ((double) elapsed)) + 1;
+		}
+	}
+
+	bytes = 0;
+	for (i = 0; i < options.sampleCount; ++i) {
+		start = SDL_GetPerformanceCounter ();
+		bytes = fn (context, iterations);
+		elapsed = SDL_GetPerformanceCounter () - start;
+		samples.push_back (getCounterNanoseconds (elapsed) / (double) iterations);
+	}
+	std::sort (samples.begin (), samples.end ());
+	ns = samples.at (samples.size () / 2);
+	bytespersecond = 0.0f;
+	if ((bytes > 0) && (ns > 0.0f)) {
+		bytespersecond = ((double) bytes / (double) iterations) * 1000000000.0f / ns;
+	}
+
+	record.setEmpty ();
+	record.set ("record", "benchmark");
+	record.set ("name", name);
+	record.set ("iterations", iterations);
+	record.set ("samples", options.sampleCount);
+	record.set ("nsPerOp", ns);
+	record.set ("nsPerOpMin", samples.front ());
+	record.set ("nsPerOpMax", samples.back ());
+	if (bytes > 0) {
+		record.set ("bytesPerOp", (double) bytes / (double) iterations);
+		record.set ("bytesPerSecond", bytespersecond);
+	}
+	printf ("%s\n", record.toString ().c_str ());
+	fflush (stdout);
+}
+
+double getCounterNanoseconds (uint64_t counterDelta) {
+	uint64_t freq;
+
+	freq = SDL_GetPerformanceFrequency ();
+	if (freq <= 0) {
+		return (0.0f);
+	}
+	return (((double) counterDelta) * 1000000000.0f / ((double) freq));
+}
+
+int64_t parseCommand (void *context, int iterations) {
+	PayloadSet *payloads;
+	Json *cmd;
+	int64_t bytes;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->jsonRecords.size ();
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		const StdString &record = payloads->jsonRecords.at (i % count);
+		if (SystemInterface::instance->parseCommand (record, &cmd)) {
+			resultSink += cmd->getNumber ("command", (int) 0);
+			delete (cmd);
+		}
+		bytes += (int64_t) record.length ();
+	}
+	return (bytes);
+}
+
+int64_t parseHeapJson (void *context, int iterations) {
+	PayloadSet *payloads;
+	Json json;
+	int64_t bytes;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->jsonRecords.size ();
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		const StdString &record = payloads->jsonRecords.at (i % count);
+		if (json.parse (record)) {
+			resultSink += json.getNumber ("command", (int) 0);
+		}
+		bytes += (int64_t) record.length ();
+	}
+	return (bytes);
+}
+
+int64_t parseMsgPackCommand (void *context, int iterations) {
+	PayloadSet *payloads;
+	Json *cmd;
+	int64_t bytes;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->msgPackRecords.size ();
+	if (count <= 0) {
+		return (0);
+	}
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		const StdString &record = payloads->msgPackRecords.at (i % count);
+		if (SystemInterface::instance->parseMsgPackCommand ((const uint8_t *) record.c_str (), (int) record.length (), &cmd)) {
+			resultSink += cmd->getNumber ("command", (int) 0);
+			delete (cmd);
+		}
+		bytes += (int64_t) record.length ();
+	}
+	return (bytes);
+}
+
+int64_t serializeJsonString (void *context, int iterations) {
+	PayloadSet *payloads;
+	StdString s;
+	int64_t bytes;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->commands.size ();
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		s = payloads->commands.at (i % count)->toString ();
+		bytes += (int64_t) s.length ();
+	}
+	resultSink += bytes;
+	return (bytes);
+}
+
+int64_t serializeJsonBuffer (void *context, int iterations) {
+	PayloadSet *payloads;
+	Buffer buffer;
+	int64_t bytes;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->commands.size ();
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		buffer.setDataLength (0);
+		payloads->commands.at (i % count)->writeJson (&buffer);
+		bytes += buffer.length;
+	}
+	resultSink += bytes;
+	return (bytes);
+}
+
+int64_t serializeMsgPackBuffer (void *context, int iterations) {
+	PayloadSet *payloads;
+	Buffer buffer;
+	int64_t bytes;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->commands.size ();
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		buffer.setDataLength (0);
+		payloads->commands.at (i % count)->writeMsgPack (&buffer);
+		bytes += buffer.length;
+	}
+	resultSink += bytes;
+	return (bytes);
+}
+
+int64_t decodeParamsStruct (void *context, int iterations) {
+	PayloadSet *payloads;
+	Json *cmd;
+	StdString err;
+	int64_t decoded;
+	int i, count;
+
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->commands.size ();
+	decoded = 0;
+	for (i = 0; i < iterations; ++i) {
+		cmd = payloads->commands.at (i % count);
+		switch (SystemInterface::instance->getCommandId (cmd)) {
+			case SystemInterface::CommandId_ShowIconLabelWindow: {
+				ShowIconLabelWindowParams params;
+				if (params.decode (cmd, &err)) {
+					decoded += (int64_t) params.labelText.length () + (int64_t) params.icon;
+				}
+				break;
+			}
+			case SystemInterface::CommandId_ShowCountdownWindow: {
+				ShowCountdownWindowParams params;
+				if (params.decode (cmd, &err)) {
+					decoded += (int64_t) params.labelText.length () + (int64_t) params.countdownTime;
+				}
+				break;
+			}
+			case SystemInterface::CommandId_ShowFileImageBackground: {
+				ShowFileImageBackgroundParams params;
+				if (params.decode (cmd, &err)) {
+					decoded += (int64_t) params.imagePath.length () + (int64_t) params.background;
+				}
+				break;
+			}
+			case SystemInterface::CommandId_RemoveWindow: {
+				RemoveWindowParams params;
+				if (params.decode (cmd, &err)) {
+					decoded += (int64_t) params.windowId.length ();
+				}
+				break;
+			}
+		}
+	}
+	resultSink += decoded;
+	return (0);
+}
+
+int64_t getCommandParamFields (void *context, int iterations) {
+	SystemInterface *interface;
+	PayloadSet *payloads;
+	Json *cmd;
+	int64_t decoded;
+	float x, y;
+	int i, count;
+
+	interface = SystemInterface::instance;
+	payloads = (PayloadSet *) context;
+	count = (int) payloads->commands.size ();
+	decoded = 0;
+	for (i = 0; i < iterations; ++i) {
+		cmd = payloads->commands.at (i % count);
+		switch (interface->getCommandId (cmd)) {
+			case SystemInterface::CommandId_ShowIconLabelWindow: {
+				decoded += (int64_t) interface->getCommandStringParam (cmd, "windowId", "").length ();
+				decoded += interface->getCommandNumberParam (cmd, "icon", (int) 0);
+				x = interface->getCommandNumberParam (cmd, "positionX", 0.0f);
+				y = interface->getCommandNumberParam (cmd, "positionY", 0.0f);
+				decoded += (int64_t) interface->getCommandStringParam (cmd, "labelText", "").length () + (int64_t) (x + y);
+				break;
+			}
+			case SystemInterface::CommandId_ShowCountdownWindow: {
+				decoded += (int64_t) interface->getCommandStringParam (cmd, "windowId", "").length ();
+				decoded += interface->getCommandNumberParam (cmd, "icon", (int) 0);
+				x = interface->getCommandNumberParam (cmd, "positionX", 0.0f);
+				y = interface->getCommandNumberParam (cmd, "positionY", 0.0f);
+				decoded += (int64_t) interface->getCommandStringParam (cmd, "labelText", "").length () + (int64_t) (x + y);
+				decoded += interface->getCommandNumberParam (cmd, "countdownTime", (int64_t) 20000);
+				break;
+			}
+			case SystemInterface::CommandId_ShowFileImageBackground: {
+				decoded += (int64_t) interface->getCommandStringParam (cmd, "imagePath", "").length ();
+				decoded += interface->getCommandNumberParam (cmd, "background", (int) 0);
+				break;
+			}
+			case SystemInterface::CommandId_RemoveWindow: {
+				decoded += (int64_t) interface->getCommandStringParam (cmd, "windowId", "").length ();
+				break;
+			}
+		}
+	}
+	resultSink += decoded;
+	return (0);
+}
+
+int64_t lookupJsonKey (void *context, int iterations) {
+	LookupContext *ctx;
+	int64_t found;
+	int i, count;
+
+	ctx = (LookupContext *) context;
+	count = (int) ctx->keys.size ();
+	found = 0;
+	for (i = 0; i < iterations; ++i) {
+		if (ctx->json->exists (ctx->keys.at ((i * 7) % count).c_str ())) {
+			++found;
+		}
+	}
+	resultSink += found;
+	return (0);
+}
+
+int64_t lookupCommandNumberParam (void *context, int iterations) {
+	ParamLookupContext *ctx;
+	int64_t sum;
+	int i, count;
+
+	ctx = (ParamLookupContext *) context;
+	count = (int) ctx->keys.size ();
+	sum = 0;
+	for (i = 0; i < iterations; ++i) {
+		sum += SystemInterface::instance->getCommandNumberParam (ctx->command, ctx->keys.at ((i * 7) % count).c_str (), (int) 0);
+	}
+	resultSink += sum;
+	return (0);
+}
+
+int64_t formatSprintf (void *context, int iterations) {
+	StdString s;
+	int i;
+
+	for (i = 0; i < iterations; ++i) {
+		s.sprintf ("windowId=%s positionX=%.3f count=%i time=%lli", "countdown", (float) i / 100.0f, i, (long long) i * 1000);
+		resultSink += (int64_t) s.length ();
+	}
+	return (0);
+}
+
+int64_t splitString (void *context, int iterations) {
+	StdString s;
+	std::list<StdString> parts;
+	int64_t bytes;
+	int i;
+
+	for (i = 0; i < 64; ++i) {
+		s.appendSprintf ("%sfield%i", (i > 0) ? "," : "", i);
+	}
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		s.split (",", &parts);
+		resultSink += (int64_t) parts.size ();
+		bytes += (int64_t) s.length ();
+	}
+	return (bytes);
+}
+
+int64_t urlEncodeString (void *context, int iterations) {
+	StdString s, text;
+	int64_t bytes;
+	int i;
+
+	text.assign ("/var/lib/membrane/images/Lobby Display (Main Hall) & Café #2/background image=1920x1080?v=3.jpg");
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		s = text.urlEncoded ();
+		resultSink += (int64_t) s.length ();
+		bytes += (int64_t) text.length ();
+	}
+	return (bytes);
+}
+
+int64_t writeHashMap (void *context, int iterations) {
+	HashMapContext *ctx;
+	int i;
+
+	ctx = (HashMapContext *) context;
+	for (i = 0; i < iterations; ++i) {
+		ctx->map.write (ctx->path);
+	}
+	return (ctx->fileSize * iterations);
+}
+
+int64_t readHashMap (void *context, int iterations) {
+	HashMapContext *ctx;
+	HashMap map;
+	int i;
+
+	ctx = (HashMapContext *) context;
+	for (i = 0; i < iterations; ++i) {
+		map.read (ctx->path, true);
+		resultSink += map.size ();
+	}
+	return (ctx->fileSize * iterations);
+}
+
+int64_t findHashMap (void *context, int iterations) {
+	HashMapContext *ctx;
+	int64_t found;
+	int i, count;
+
+	ctx = (HashMapContext *) context;
+	count = (int) ctx->keys.size ();
+	found = 0;
+	for (i = 0; i < iterations; ++i) {
+		found += (int64_t) ctx->map.find (ctx->keys.at ((i * 7919) % count), "").length ();
+	}
+	resultSink += found;
+	return (0);
+}
+
+int64_t insertHashMap (void *context, int iterations) {
+	HashMapContext *ctx;
+	int i, count;
+
+	ctx = (HashMapContext *) context;
+	count = (int) ctx->keys.size ();
+	for (i = 0; i < iterations; ++i) {
+		ctx->map.insert (ctx->keys.at ((i * 7919) % count), i);
+	}
+	resultSink += ctx->map.size ();
+	return (0);
+}
+
+int64_t addBufferData (void *context, int iterations) {
+	Buffer buffer;
+	uint8_t data[64];
+	int64_t bytes;
+	int i;
+
+	memset (data, 'x', sizeof (data));
+	bytes = 0;
+	for (i = 0; i < iterations; ++i) {
+		if ((i % 16384) == 0) {
+			buffer.reset ();
+		}
+		buffer.add (data, sizeof (data));
+		bytes += (int64_t) sizeof (data);
+	}
+	resultSink += buffer.length;
+	return (bytes);
+}
+
+int64_t getPrngValue (void *context, int iterations) {
+	SequenceContext *ctx;
+	int64_t sum;
+	int i;
+
+	ctx = (SequenceContext *) context;
+	sum = 0;
+	for (i = 0; i < iterations; ++i) {
+		sum += ctx->prng.getRandomValue (0, 1000);
+	}
+	resultSink += sum;
+	return (0);
+}
+
+int64_t nextSequenceItem (void *context, int iterations) {
+	SequenceContext *ctx;
+	int64_t sum;
+	int i, item;
+
+	ctx = (SequenceContext *) context;
+	sum = 0;
+	for (i = 0; i < iterations; ++i) {
+		if (ctx->list.next (&item)) {
+			sum += item;
+		}
+	}
+	resultSink += sum;
+	return (0);
+}
+
+int64_t playAnimationTimeline (void *context, int iterations) {
+	AnimationContext *ctx;
+	AnimationTimeline timeline;
+	std::vector<int>::iterator i, end;
+	int64_t now, count;
+	int j, step;
+
+	ctx = (AnimationContext *) context;
+	count = 0;
+	for (j = 0; j < iterations; ++j) {
+		timeline.clear ();
+		i = ctx->executeTimes.begin ();
+		end = ctx->executeTimes.end ();
+		while (i != end) {
+			timeline.addStep ((int64_t) *i * 1000, j);
+			++i;
+		}
+		now = 0;
+		while (! timeline.empty ()) {
+			now += ctx->tickPeriod * 1000;
+			while (timeline.nextDueStep (now, &step)) {
+				++count;
+			}
+		}
+	}
+	resultSink += count;
+	return (0);
+}
+
+int64_t playAnimationList (void *context, int iterations) {
+	AnimationContext *ctx;
+	std::list<ListAnimationStep> steplist;
+	std::list<ListAnimationStep>::iterator pos, end, k;
+	std::vector<int>::iterator i, iend;
+	ListAnimationStep step;
+	int64_t count;
+	int j, mintime;
+
+	ctx = (AnimationContext *) context;
+	count = 0;
+	for (j = 0; j < iterations; ++j) {
+		steplist.clear ();
+		i = ctx->executeTimes.begin ();
+		iend = ctx->executeTimes.end ();
+		while (i != iend) {
+			step.executeTime = *i;
+			steplist.push_back (step);
+			++i;
+		}
+		while (! steplist.empty ()) {
+			while (true) {
+				k = steplist.begin ();
+				end = steplist.end ();
+				mintime = -1;
+				pos = end;
+				while (k != end) {
+					if ((mintime < 0) || (k->executeTime < mintime)) {
+						mintime = k->executeTime;
+						pos = k;
+					}
+					++k;
+				}
+				if ((mintime > ctx->tickPeriod) || (pos == end)) {
+					break;
+				}
+				++count;
+				steplist.erase (pos);
+			}
+			k = steplist.begin ();
+			end = steplist.end ();
+			while (k != end) {
+				k->executeTime -= ctx->tickPeriod;
+				++k;
+			}
+		}
+	}
+	resultSink += count;
+	return (0);
+}
+
+int64_t retainAtomicRefcount (void *context, int iterations) {
+	std::vector<SharedBuffer *> objects;
+	std::vector<SharedBuffer *>::iterator i, end;
+	int j, k;
+
+	objects.reserve (RefcountObjectCount);
+	for (j = 0; j < iterations; ++j) {
+		objects.clear ();
+		for (k = 0; k < RefcountObjectCount; ++k) {
+			objects.push_back (new SharedBuffer ());
+		}
+		i = objects.begin ();
+		end = objects.end ();
+		while (i != end) {
+			(*i)->retain ();
+			(*i)->retain ();
+			++i;
+		}
+		i = objects.begin ();
+		while (i != end) {
+			(*i)->release ();
+			(*i)->release ();
+			++i;
+		}
+	}
+	resultSink += (int64_t) objects.size ();
+	return (0);
+}
+
+int64_t retainMutexRefcount (void *context, int iterations) {
+	std::vector<MutexRefcountObject *> objects;
+	std::vector<MutexRefcountObject *>::iterator i, end;
+	int j, k;
+
+	objects.reserve (RefcountObjectCount);
+	for (j = 0; j < iterations; ++j) {
+		objects.clear ();
+		for (k = 0; k < RefcountObjectCount; ++k) {
+			objects.push_back (new MutexRefcountObject ());
+		}
+		i = objects.begin ();
+		end = objects.end ();
+		while (i != end) {
+			(*i)->retain ();
+			(*i)->retain ();
+			++i;
+		}
+		i = objects.begin ();
+		while (i != end) {
+			(*i)->release ();
+			(*i)->release ();
+			++i;
+		}
+	}
+	resultSink += (int64_t) objects.size ();
+	return (0);
+}
+
+void executeTask (void *contextPtr) {
+	TaskContext *ctx;
+	int64_t sum;
+	int i;
+
+	// A short computation, standing in for a small decode or script step
+	ctx = (TaskContext *) contextPtr;
+	sum = 0;
+	for (i = 0; i < 2000; ++i) {
+		sum += (i * 2654435761u) >> 7;
+	}
+	resultSink += sum;
+	++(ctx->runCount);
+}
+
+int executeThreadTask (void *contextPtr) {
+	executeTask (contextPtr);
+	return (0);
+}
+
+void endTask (void *callbackData, void *runPtr) {
+	++(((TaskContext *) callbackData)->endCount);
+}
+
+int64_t runTaskGroupBurst (void *context, int iterations) {
+	TaskContext *ctx;
+	int i, j;
+
+	ctx = (TaskContext *) context;
+	for (i = 0; i < iterations; ++i) {
+		ctx->endCount = 0;
+		for (j = 0; j < TaskBurstCount; ++j) {
+			ctx->taskGroup.run (TaskGroup::RunContext (executeTask, ctx), TaskGroup::EndCallbackContext (endTask, ctx));
+		}
+		while (ctx->endCount.load () < TaskBurstCount) {
+			ctx->taskGroup.update (0);
+		}
+	}
+	return (0);
+}
+
+int64_t runThreadBurst (void *context, int iterations) {
+	TaskContext *ctx;
+	std::vector<SDL_Thread *> threads;
+	std::vector<SDL_Thread *>::iterator pos, end;
+	int i, j, result;
+
+	// The thread-per-task model used by TaskGroup before its worker pool, kept here for comparison
+	ctx = (TaskContext *) context;
+	for (i = 0; i < iterations; ++i) {
+		threads.clear ();
+		for (j = 0; j < TaskBurstCount; ++j) {
+			threads.push_back (SDL_CreateThread (executeThreadTask, "executeThreadTask", ctx));
+		}
+		pos = threads.begin ();
+		end = threads.end ();
+		while (pos != end) {
+			if (*pos) {
+				SDL_WaitThread (*pos, &result);
+				endTask (ctx, ctx);
+			}
+			++pos;
+		}
+	}
+	return (0);
+}
+
+int64_t runTaskGroupLatency (void *context, int iterations) {
+	TaskContext *ctx;
+	int i, count;
+
+	ctx = (TaskContext *) context;
+	for (i = 0; i < iterations; ++i) {
+		count = ctx->runCount.load ();
+		ctx->taskGroup.run (TaskGroup::RunContext (executeTask, ctx));
+		while (ctx->runCount.load () == count) {
+		}
+	}
+	return (0);
+}
+
+int64_t runThreadLatency (void *context, int iterations) {
+	TaskContext *ctx;
+	SDL_Thread *thread;
+	int i, result;
+
+	ctx = (TaskContext *) context;
+	for (i = 0; i < iterations; ++i) {
+		thread = SDL_CreateThread (executeThreadTask, "executeThreadTask", ctx);
+		if (thread) {
+			SDL_WaitThread (thread, &result);
+		}
+	}
+	return (0);
+}
+
+void scaleRows (void *contextPtr, int rangeStart, int rangeEnd) {
+	TaskContext *ctx;
+	uint32_t *src, *dest;
+	int x, y;
+	int64_t stepx, stepy, posx;
+
+	// The nearest-neighbor row loop used by ImageWindow when scaling a loaded image
+	ctx = (TaskContext *) contextPtr;
+	stepx = (((int64_t) ScaleSourceWidth) << 16) / ScaleTargetWidth;
+	stepy = (((int64_t) ScaleSourceHeight) << 16) / ScaleTargetHeight;
+	for (y = rangeStart; y < rangeEnd; ++y) {
+		src = &(ctx->scaleSource.at (((stepy * y) >> 16) * ScaleSourceWidth));
+		dest = &(ctx->scaleDest.at (y * ScaleTargetWidth));
+		posx = 0;
+		for (x = 0; x < ScaleTargetWidth; ++x) {
+			dest[x] = src[posx >> 16];
+			posx += stepx;
+		}
+	}
+}
+
+int64_t runParallelScale (void *context, int iterations) {
+	TaskContext *ctx;
+	int i;
+
+	ctx = (TaskContext *) context;
+	if (ctx->scaleSource.empty ()) {
+		ctx->scaleSource.assign (ScaleSourceWidth * ScaleSourceHeight, 0x80402010);
+		ctx->scaleDest.assign (ScaleTargetWidth * ScaleTargetHeight, 0);
+	}
+	for (i = 0; i < iterations; ++i) {
+		ctx->taskGroup.parallelFor (ScaleTargetHeight, 64, scaleRows, ctx);
+	}
+	resultSink += ctx->scaleDest.at (0);
+	return (0);
+}
+
+int64_t runSerialScale (void *context, int iterations) {
+	TaskContext *ctx;
+	int i;
+
+	ctx = (TaskContext *) context;
+	if (ctx->scaleSource.empty ()) {
+		ctx->scaleSource.assign (ScaleSourceWidth * ScaleSourceHeight, 0x80402010);
+		ctx->scaleDest.assign (ScaleTargetWidth * ScaleTargetHeight, 0);
+	}
+	for (i = 0; i < iterations; ++i) {
+		scaleRows (ctx, 0, ScaleTargetHeight);
+	}
+	resultSink += ctx->scaleDest.at (0);
+	return (0);
+}
@@ -0,0 +1,533 @@
+/*
+* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+* this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+* this list of conditions and the following disclaimer in the documentation
+* and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors
+* may be used to endorse or promote products derived from this software without
+* specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+// Program that generates typed command param structs and decode functions from SystemInterface definitions
+
+#include "Config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <map>
+#include <list>
+#include "StdString.h"
+#include "Log.h"
+#include "Json.h"
+#include "SystemInterface.h"
+
+struct FieldDefinition {
+	SystemInterface::Param param;
+	bool hasDefault;
+	StdString defaultValue;
+	FieldDefinition (): hasDefault (false), defaultValue ("") { }
+};
+typedef std::list<FieldDefinition> FieldList;
+typedef std::map<StdString, FieldList> TypeMap;
+
+// Local variable names used by generated decode functions, which must not collide with param field names
+static const char *reservedNames[] = { "cmdInv", "paramsValue", "entry", "value", "found", "i", "j", "errorMessage", NULL };
+
+// Store field definitions for all SystemInterface param types into destMap. Returns a boolean value indicating if all types were found to be supported.
+static bool readTypes (SystemInterface *interface, TypeMap *destMap);
+
+// Return a string containing a C++ literal for the provided number
+static StdString getNumberLiteral (double number);
+
+// Return a string containing a C++ string literal for the provided text
+static StdString getStringLiteral (const StdString &text);
+
+// Return the C++ type used to store the provided param in a generated struct, or an empty string if the param type is not supported
+static StdString getFieldType (const SystemInterface::Param &param, TypeMap *typeMap);
+
+// Append statements that reset a field to its default value, or its empty value if no default exists
+static void appendResetField (StdString *dest, const FieldDefinition &field, const char *indent);
+
+// Append statements that decode and validate a field from a json_value named "value"
+static void appendDecodeField (StdString *dest, const FieldDefinition &field, TypeMap *typeMap);
+
+// Return the text of the generated header file
+static StdString getHeaderText (SystemInterface *interface, TypeMap *typeMap);
+
+// Return the text of the generated source file
+static StdString getSourceText (SystemInterface *interface, TypeMap *typeMap);
+
+// Write text to the specified file path. Returns a boolean value indicating if the write succeeded.
+static bool writeFile (const StdString &path, const StdString &text);
+
+int main (int argc, char **argv) {
+	Log log;
+	SystemInterface interface;
+	TypeMap typemap;
+	StdString basepath;
+
+	log.isStdoutWriteEnabled = true;
+	Log::instance = &log;
+	if (argc < 2) {
+		fprintf (stderr, "Usage: %s <output path prefix>\n", argv[0]);
+		return (1);
+	}
+	basepath.assign (argv[1]);
+	if (! readTypes (&interface, &typemap)) {
+		return (1);
+	}
+	if (! writeFile (StdString::createSprintf ("%s.h", basepath.c_str ()), getHeaderText (&interface, &typemap))) {
+		return (1);
+	}
+	if (! writeFile (StdString::createSprintf ("%s.cpp", basepath.c_str ()), getSourceText (&interface, &typemap))) {
+		return (1);
+	}
+	Log::instance = NULL;
+	return (0);
+}
+
+bool readTypes (SystemInterface *interface, TypeMap *destMap) {
+	std::map<StdString, SystemInterface::GetParamsFunction>::iterator i, iend;
+	std::list<SystemInterface::Param> params;
+	std::list<SystemInterface::Param>::iterator j, jend;
+	FieldList::iterator k, kend;
+	FieldDefinition field;
+	Json defaults;
+	const char **name;
+
+	i = interface->getParamsMap.begin ();
+	iend = interface->getParamsMap.end ();
+	while (i != iend) {
+		params.clear ();
+		i->second (&params);
+		defaults.setEmpty ();
+		interface->populateDefaultFields (i->first, &defaults);
+
+		FieldList &fieldlist = (*destMap)[i->first];
+		j = params.begin ();
+		jend = params.end ();
+		while (j != jend) {
+			for (name = reservedNames; *name; ++name) {
+				if (j->name.equals (*name)) {
+					Log::err ("Param field name is reserved; type=%s field=%s", i->first.c_str (), j->name.c_str ());
+					return (false);
+				}
+			}
+
+			field = FieldDefinition ();
+			field.param = *j;
+			if (defaults.exists (j->name)) {
+				field.hasDefault = true;
+				if (defaults.isString (j->name)) {
+					field.defaultValue = getStringLiteral (defaults.getString (j->name, ""));
+				}
+				else if (defaults.isNumber (j->name)) {
+					field.defaultValue = getNumberLiteral (defaults.getNumber (j->name, (double) 0.0f));
+				}
+				else if (defaults.isBoolean (j->name)) {
+					field.defaultValue.assign (defaults.getBoolean (j->name, false) ? "true" : "false");
+				}
+				else {
+					Log::err ("Param field default value type is not supported; type=%s field=%s", i->first.c_str (), j->name.c_str ());
+					return (false);
+				}
+			}
+			fieldlist.push_back (field);
+			++j;
+		}
+		++i;
+	}
+
+	i = interface->getParamsMap.begin ();
+	while (i != iend) {
+		FieldList &fieldlist = (*destMap)[i->first];
+		if (fieldlist.size () > 31) {
+			Log::err ("Param type has too many fields; type=%s count=%i", i->first.c_str (), (int) fieldlist.size ());
+			return (false);
+		}
+		k = fieldlist.begin ();
+		kend = fieldlist.end ();
+		while (k != kend) {
+			if (getFieldType (k->param, destMap).empty ()) {
+				Log::err ("Param field type is not supported; type=%s field=%s fieldType=%s containerType=%s", i->first.c_str (), k->param.name.c_str (), k->param.type.c_str (), k->param.containerType.c_str ());
+				return (false);
+			}
+			++k;
+		}
+		++i;
+	}
+	return (true);
+}
+
+StdString getNumberLiteral (double number) {
+	if ((number == floor (number)) && (fabs (number) < 1e15)) {
+		return (StdString::createSprintf ("%lli", (long long) number));
+	}
+	return (StdString::createSprintf ("%.17g", number));
+}
+
+StdString getStringLiteral (const StdString &text) {
+	StdString s;
+	const char *c;
+
+	s.assign ("\"");
+	for (c = text.c_str (); *c; ++c) {
+		switch (*c) {
+			case '"':
+			case '\\': {
+				s.appendSprintf ("\\%c", *c);
+				break;
+			}
+			default: {
+				if ((*c < 0x20) || (*c >= 0x7F)) {
+					s.appendSprintf ("\\%03o", (unsigned char) *c);
+				}
+				else {
+					s.append (1, *c);
+				}
+				break;
+			}
+		}
+	}
+	s.append ("\"");
+	return (s);
+}
+
+StdString getFieldType (const SystemInterface::Param &param, TypeMap *typeMap) {
+	if (param.type.equals ("number")) {
+		return (StdString ("double"));
+	}
+	if (param.type.equals ("boolean")) {
+		return (StdString ("bool"));
+	}
+	if (param.type.equals ("string")) {
+		return (StdString ("StdString"));
+	}
+	if (param.type.equals ("object") || param.type.equals ("map")) {
+		return (StdString ("Json"));
+	}
+	if (param.type.equals ("array")) {
+		if (param.containerType.equals ("number")) {
+			return (StdString ("std::vector<double>"));
+		}
+		if (param.containerType.equals ("boolean")) {
+			return (StdString ("std::vector<bool>"));
+		}
+		if (param.containerType.equals ("string")) {
+			return (StdString ("std::vector<StdString>"));
+		}
+		if (param.containerType.equals ("object")) {
+			return (StdString ("std::vector<Json>"));
+		}
+		if (typeMap->find (param.containerType) != typeMap->end ()) {
+			return (StdString::createSprintf ("std::vector<%sParams>", param.containerType.c_str ()));
+		}
+	}
+	return (StdString (""));
+}
+
+void appendResetField (StdString *dest, const FieldDefinition &field, const char *indent) {
+	const SystemInterface::Param &p = field.param;
+
+	if (p.type.equals ("number")) {
+		dest->appendSprintf ("%s%s = %s;\n", indent, p.name.c_str (), field.hasDefault ? field.defaultValue.c_str () : "0");
+	}
+	else if (p.type.equals ("boolean")) {
+		dest->appendSprintf ("%s%s = %s;\n", indent, p.name.c_str (), field.hasDefault ? field.defaultValue.c_str () : "false");
+	}
+	else if (p.type.equals ("string")) {
+		dest->appendSprintf ("%s%s.assign (%s);\n", indent, p.name.c_str (), field.hasDefault ? field.defaultValue.c_str () : "\"\"");
+	}
+	else if (p.type.equals ("array")) {
+		dest->appendSprintf ("%s%s.clear ();\n", indent, p.name.c_str ());
+	}
+	else {
+		dest->appendSprintf ("%s%s.unassign ();\n", indent, p.name.c_str ());
+	}
+}
+
+void appendDecodeField (StdString *dest, const FieldDefinition &field, TypeMap *typeMap) {
+	const SystemInterface::Param &p = field.param;
+	const char *name;
+
+	name = p.name.c_str ();
+	if (p.type.equals ("number")) {
+		dest->appendSprintf ("        if ((value->type != json_integer) && (value->type != json_double)) {\n          return (CommandParams::setTypeError (errorMessage, \"%s\", \"number\"));\n        }\n", name);
+		dest->appendSprintf ("        %s = (value->type == json_integer) ? (double) value->u.integer : value->u.dbl;\n", name);
+		if (p.flags & SystemInterface::ParamFlag_GreaterThanZero) {
+			dest->appendSprintf ("        if (%s <= 0) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must be a number greater than zero\");\n          return (false);\n        }\n", name, name);
+		}
+		if (p.flags & SystemInterface::ParamFlag_ZeroOrGreater) {
+			dest->appendSprintf ("        if (%s < 0) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must be a number greater than or equal to zero\");\n          return (false);\n        }\n", name, name);
+		}
+		if (p.flags & SystemInterface::ParamFlag_RangedNumber) {
+			dest->appendSprintf ("        if ((%s < %s) || (%s > %s)) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must be a number in the range [%s..%s]\");\n          return (false);\n        }\n", name, getNumberLiteral (p.rangeMin).c_str (), name, getNumberLiteral (p.rangeMax).c_str (), name, getNumberLiteral (p.rangeMin).c_str (), getNumberLiteral (p.rangeMax).c_str ());
+		}
+		if (p.flags & SystemInterface::ParamFlag_EnumValue) {
+			dest->appendSprintf ("        if (value->type != json_integer) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must contain an integer enum value\");\n          return (false);\n        }\n", name);
+		}
+	}
+	else if (p.type.equals ("boolean")) {
+		dest->appendSprintf ("        if (value->type != json_boolean) {\n          return (CommandParams::setTypeError (errorMessage, \"%s\", \"boolean\"));\n        }\n", name);
+		dest->appendSprintf ("        %s = value->u.boolean ? true : false;\n", name);
+	}
+	else if (p.type.equals ("string")) {
+		dest->appendSprintf ("        if (value->type != json_string) {\n          return (CommandParams::setTypeError (errorMessage, \"%s\", \"string\"));\n        }\n", name);
+		if (p.flags & SystemInterface::ParamFlag_NotEmpty) {
+			dest->appendSprintf ("        if (value->u.string.length <= 0) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" cannot contain an empty string\");\n          return (false);\n        }\n", name);
+		}
+		if (p.flags & SystemInterface::ParamFlag_Hostname) {
+			dest->appendSprintf ("        if ((value->u.string.length > 0) && (! SystemInterface::isHostname (value->u.string.ptr, value->u.string.length))) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must contain a hostname string\");\n          return (false);\n        }\n", name);
+		}
+		if (p.flags & SystemInterface::ParamFlag_Uuid) {
+			dest->appendSprintf ("        if ((value->u.string.length > 0) && (! SystemInterface::isUuid (value->u.string.ptr, value->u.string.length))) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must contain a UUID string\");\n          return (false);\n        }\n", name);
+		}
+		if (p.flags & SystemInterface::ParamFlag_Url) {
+			dest->appendSprintf ("        if ((value->u.string.length > 0) && (! SystemInterface::isUrl (value->u.string.ptr, value->u.string.length))) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" must contain a URL string\");\n          return (false);\n        }\n", name);
+		}
+		dest->appendSprintf ("        %s.assign (value->u.string.ptr, value->u.string.length);\n", name);
+	}
+	else if (p.type.equals ("array")) {
+		dest->appendSprintf ("        if (value->type != json_array) {\n          return (CommandParams::setTypeError (errorMessage, \"%s\", \"array\"));\n        }\n", name);
+		if (p.flags & SystemInterface::ParamFlag_NotEmpty) {
+			dest->appendSprintf ("        if (value->u.array.length <= 0) {\n          errorMessage->assign (\"Parameter field \\\"%s\\\" cannot contain an empty array\");\n          return (false);\n        }\n", name);
+		}
+		dest->appendSprintf ("        %s.resize (value->u.array.length);\n", name);
+		dest->appendSprintf ("        for (j = 0; j < value->u.array.length; ++j) {\n");
+		if (p.containerType.equals ("number")) {
+			dest->appendSprintf ("          if ((value->u.array.values[j]->type != json_integer) && (value->u.array.values[j]->type != json_double)) {\n            return (CommandParams::setTypeError (errorMessage, \"%s\", \"number array\"));\n          }\n", name);
+			dest->appendSprintf ("          %s[j] = (value->u.array.values[j]->type == json_integer) ? (double) value->u.array.values[j]->u.integer : value->u.array.values[j]->u.dbl;\n", name);
+		}
+		else if (p.containerType.equals ("boolean")) {
+			dest->appendSprintf ("          if (value->u.array.values[j]->type != json_boolean) {\n            return (CommandParams::setTypeError (errorMessage, \"%s\", \"boolean array\"));\n          }\n", name);
+			dest->appendSprintf ("          %s[j] = value->u.array.values[j]->u.boolean ? true : false;\n", name);
+		}
+		else if (p.containerType.equals ("string")) {
+			dest->appendSprintf ("          if (value->u.array.values[j]->type != json_string) {\n            return (CommandParams::setTypeError (errorMessage, \"%s\", \"string array\"));\n          }\n", name);
+			dest->appendSprintf ("          %s[j].assign (value->u.array.values[j]->u.string.ptr, value->u.array.values[j]->u.string.length);\n", name);
+		}
+		else if (p.containerType.equals ("object")) {
+			dest->appendSprintf ("          if (value->u.array.values[j]->type != json_object) {\n            return (CommandParams::setTypeError (errorMessage, \"%s\", \"object array\"));\n          }\n", name);
+			if (p.flags & SystemInterface::ParamFlag_Command) {
+				dest->appendSprintf ("          if (! CommandParams::validateCommand (value->u.array.values[j], errorMessage)) {\n            return (false);\n          }\n");
+			}
+			dest->appendSprintf ("          %s[j].assignView (value->u.array.values[j]);\n", name);
+		}
+		else {
+			dest->appendSprintf ("          if (! %s[j].decodeFields (value->u.array.values[j], errorMessage)) {\n            return (false);\n          }\n", name);
+		}
+		dest->appendSprintf ("        }\n");
+	}
+	else {
+		dest->appendSprintf ("        if (value->type != json_object) {\n          return (CommandParams::setTypeError (errorMessage, \"%s\", \"%s\"));\n        }\n", name, p.type.c_str ());
+		if (p.flags & SystemInterface::ParamFlag_Command) {
+			dest->appendSprintf ("        if (! CommandParams::validateCommand (value, errorMessage)) {\n          return (false);\n        }\n");
+		}
+		dest->appendSprintf ("        %s.assignView (value);\n", name);
+	}
+}
+
+StdString getHeaderText (SystemInterface *interface, TypeMap *typeMap) {
+	StdString s;
+	TypeMap::iterator i, end;
+	FieldList::iterator j, jend;
+
+	s.append ("// Structs holding typed command params, generated from SystemInterface definitions by generate-command-params (do not edit). Each struct's decode method stores and validates fields from the params object of a command, or decodeFields from a params object value, replacing all struct values and returning false with errorMessage set if a field was invalid.\n\n");
+	s.append ("#ifndef COMMAND_PARAMS_H\n#define COMMAND_PARAMS_H\n\n");
+	s.append ("#include <vector>\n#include \"StdString.h\"\n#include \"Json.h\"\n\n");
+	s.append ("class CommandParams {\npublic:\n");
+	s.append ("  static const char *version;\n");
+	s.append ("  struct Field {\n    const char *name;\n    unsigned int nameLength;\n  };\n\n");
+	s.append ("  // Return the index of the item in fields with a name matching the provided value, or -1 if no such item was found\n");
+	s.append ("  static int findField (const CommandParams::Field *fields, int fieldCount, const char *name, unsigned int nameLength);\n\n");
+	s.append ("  // Return the named item from a json object value, or NULL if no such item was found\n");
+	s.append ("  static json_value *findValue (json_value *object, const char *name);\n\n");
+	s.append ("  // Return a boolean value indicating if the provided value holds a command with a known ID and valid params fields. If not, errorMessage is set.\n");
+	s.append ("  static bool validateCommand (json_value *command, StdString *errorMessage);\n\n");
+	s.append ("  // Set errorMessage to indicate that the named field holds the wrong type and return false\n");
+	s.append ("  static bool setTypeError (StdString *errorMessage, const char *fieldName, const char *typeName);\n");
+	s.append ("};\n");
+
+	i = typeMap->begin ();
+	end = typeMap->end ();
+	while (i != end) {
+		s.appendSprintf ("\nstruct %sParams {\n", i->first.c_str ());
+		j = i->second.begin ();
+		jend = i->second.end ();
+		while (j != jend) {
+			s.appendSprintf ("  %s %s;\n", getFieldType (j->param, typeMap).c_str (), j->param.name.c_str ());
+			++j;
+		}
+		s.appendSprintf ("  %sParams ()", i->first.c_str ());
+		j = i->second.begin ();
+		while (j != jend) {
+			if (j->param.type.equals ("number")) {
+				s.appendSprintf ("%s %s (%s)", (j == i->second.begin ()) ? ":" : ",", j->param.name.c_str (), j->hasDefault ? j->defaultValue.c_str () : "0");
+			}
+			else if (j->param.type.equals ("boolean")) {
+				s.appendSprintf ("%s %s (%s)", (j == i->second.begin ()) ? ":" : ",", j->param.name.c_str (), j->hasDefault ? j->defaultValue.c_str () : "false");
+			}
+			else if (j->param.type.equals ("string")) {
+				s.appendSprintf ("%s %s (%s)", (j == i->second.begin ()) ? ":" : ",", j->param.name.c_str (), j->hasDefault ? j->defaultValue.c_str () : "\"\"");
+			}
+			else {
+				s.appendSprintf ("%s %s ()", (j == i->second.begin ()) ? ":" : ",", j->param.name.c_str ());
+			}
+			++j;
+		}
+		s.append (" { }\n");
+		s.append ("  bool decode (Json *cmdInv, StdString *errorMessage);\n");
+		s.append ("  bool decodeFields (json_value *paramsValue, StdString *errorMessage);\n");
+		s.append ("};\n");
+		++i;
+	}
+	s.append ("#endif\n");
+	return (s);
+}
+
+StdString getSourceText (SystemInterface *interface, TypeMap *typeMap) {
+	StdString s;
+	TypeMap::iterator i, end;
+	FieldList::iterator j, jend;
+	std::map<int, StdString>::iterator k, kend;
+	SystemInterface::Command command;
+	int index;
+	bool hasarray;
+
+	s.append ("#include \"Config.h\"\n#include <stdlib.h>\n#include <string.h>\n#include \"SystemInterface.h\"\n#include \"CommandParams.h\"\n\n");
+	s.appendSprintf ("const char *CommandParams::version = \"%s\";\n\n", SystemInterface::version);
+
+	i = typeMap->begin ();
+	end = typeMap->end ();
+	while (i != end) {
+		if (! i->second.empty ()) {
+			s.appendSprintf ("static constexpr CommandParams::Field %sFields[] = {\n", i->first.c_str ());
+			j = i->second.begin ();
+			jend = i->second.end ();
+			while (j != jend) {
+				s.appendSprintf ("  { \"%s\", %i },\n", j->param.name.c_str (), (int) j->param.name.length ());
+				++j;
+			}
+			s.append ("};\n");
+		}
+		++i;
+	}
+
+	s.append ("\nint CommandParams::findField (const CommandParams::Field *fields, int fieldCount, const char *name, unsigned int nameLength) {\n");
+	s.append ("  int i;\n\n  for (i = 0; i < fieldCount; ++i) {\n    if ((fields[i].nameLength == nameLength) && (memcmp (fields[i].name, name, nameLength) == 0)) {\n      return (i);\n    }\n  }\n  return (-1);\n}\n");
+	s.append ("\njson_value *CommandParams::findValue (json_value *object, const char *name) {\n");
+	s.append ("  unsigned int i, len;\n\n  if ((! object) || (object->type != json_object)) {\n    return (NULL);\n  }\n  len = strlen (name);\n");
+	s.append ("  for (i = 0; i < object->u.object.length; ++i) {\n    if ((object->u.object.values[i].name_length == len) && (memcmp (object->u.object.values[i].name, name, len) == 0)) {\n      return (object->u.object.values[i].value);\n    }\n  }\n  return (NULL);\n}\n");
+	s.append ("\nbool CommandParams::setTypeError (StdString *errorMessage, const char *fieldName, const char *typeName) {\n");
+	s.append ("  errorMessage->sprintf (\"Parameter field \\\"%s\\\" has incorrect type (expecting %s)\", fieldName, typeName);\n  return (false);\n}\n");
+
+	s.append ("\nbool CommandParams::validateCommand (json_value *command, StdString *errorMessage) {\n");
+	s.append ("  json_value *value;\n  int64_t id;\n\n  value = CommandParams::findValue (command, \"command\");\n  if (value && (value->type == json_integer)) {\n    id = value->u.integer;\n  }\n  else if (value && (value->type == json_double)) {\n    id = (int64_t) value->u.dbl;\n  }\n  else {\n    errorMessage->assign (\"Command is missing its ID field\");\n    return (false);\n  }\n");
+	s.append ("  switch (id) {\n");
+	k = interface->commandIdMap.begin ();
+	kend = interface->commandIdMap.end ();
+	while (k != kend) {
+		if (interface->getCommand (k->second, &command)) {
+			s.appendSprintf ("    case SystemInterface::CommandId_%s: {\n      %sParams params;\n      return (params.decodeFields (CommandParams::findValue (command, \"params\"), errorMessage));\n    }\n", command.name.c_str (), command.paramType.c_str ());
+		}
+		++k;
+	}
+	s.append ("  }\n  errorMessage->sprintf (\"Unknown command ID %lli\", (long long) id);\n  return (false);\n}\n");
+
+	i = typeMap->begin ();
+	while (i != end) {
+		s.appendSprintf ("\nbool %sParams::decode (Json *cmdInv, StdString *errorMessage) {\n", i->first.c_str ());
+		s.append ("  return (decodeFields (CommandParams::findValue (cmdInv->getJsonValue (), \"params\"), errorMessage));\n}\n");
+
+		s.appendSprintf ("\nbool %sParams::decodeFields (json_value *paramsValue, StdString *errorMessage) {\n", i->first.c_str ());
+		hasarray = false;
+		j = i->second.begin ();
+		jend = i->second.end ();
+		while (j != jend) {
+			if (j->param.type.equals ("array")) {
+				hasarray = true;
+			}
+			++j;
+		}
+		if (! i->second.empty ()) {
+			s.append ("  json_object_entry *entry;\n  json_value *value;\n  unsigned int i;\n");
+			if (hasarray) {
+				s.append ("  unsigned int j;\n");
+			}
+			s.append ("  int found;\n\n");
+		}
+		s.append ("  if ((! paramsValue) || (paramsValue->type != json_object)) {\n    errorMessage->assign (\"Missing or invalid params object\");\n    return (false);\n  }\n");
+		if (! i->second.empty ()) {
+			s.append ("  found = 0;\n  for (i = 0; i < paramsValue->u.object.length; ++i) {\n    entry = &(paramsValue->u.object.values[i]);\n    value = entry->value;\n");
+			s.appendSprintf ("    switch (CommandParams::findField (%sFields, %i, entry->name, entry->name_length)) {\n", i->first.c_str (), (int) i->second.size ());
+			index = 0;
+			j = i->second.begin ();
+			while (j != jend) {
+				s.appendSprintf ("      case %i: {\n", index);
+				appendDecodeField (&s, *j, typeMap);
+				s.appendSprintf ("        found |= 0x%x;\n        break;\n      }\n", 1 << index);
+				++index;
+				++j;
+			}
+			s.append ("    }\n  }\n");
+			index = 0;
+			j = i->second.begin ();
+			while (j != jend) {
+				s.appendSprintf ("  if (! (found & 0x%x)) {\n", 1 << index);
+				if ((j->param.flags & SystemInterface::ParamFlag_Required) && (! j->hasDefault)) {
+					s.appendSprintf ("    errorMessage->assign (\"Missing required parameter field \\\"%s\\\"\");\n    return (false);\n", j->param.name.c_str ());
+				}
+				else {
+					appendResetField (&s, *j, "    ");
+				}
+				s.append ("  }\n");
+				++index;
+				++j;
+			}
+		}
+		s.append ("  return (true);\n}\n");
+		++i;
+	}
+	return (s);
+}
+
+bool writeFile (const StdString &path, const StdString &text) {
+	FILE *fp;
+	StdString license;
+
+	license.assign ("/*\n* Copyright 2018-2022 Membrane Software <author@membranesoftware.com> https://membranesoftware.com\n*\n* Redistribution and use in source and binary forms, with or without\n* modification, are permitted provided that the following conditions are met:\n*\n* 1. Redistributions of source code must retain the above copyright notice,\n* this list of conditions and the following disclaimer.\n*\n* 2. Redistributions in binary form must reproduce the above copyright notice,\n* this list of conditions and the following disclaimer in the documentation\n* and/or other materials provided with the distribution.\n*\n* 3. Neither the name of the copyright holder nor the names of its\n* contributors may be used to endorse or promote products derived from this\n* software without specific prior written permission.\n*\n* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS \"AS IS\"\n* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE\n* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE\n* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE\n* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR\n* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF\n* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS\n* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN\n* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)\n* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE\n* POSSIBILITY OF SUCH DAMAGE.\n*/\n");
+
+	fp = fopen (path.c_str (), "wb");
+	if (! fp) {
+		Log::err ("Failed to open output file; path=\"%s\"", path.c_str ());
+		return (false);
+	}
+	if ((fwrite (license.c_str (), 1, license.length (), fp) != license.length ()) || (fwrite (text.c_str (), 1, text.length (), fp) != text.length ())) {
+		Log::err ("Failed to write output file; path=\"%s\"", path.c_str ());
+		fclose (fp);
+		return (false);
+	}
+	fclose (fp);
+	printf ("Wrote %s\n", path.c_str ());
+	return (true);
+}